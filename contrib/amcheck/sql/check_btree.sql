@@ -74,9 +74,30 @@ CREATE INDEX bttest_a_expr_idx ON bttest_a ((ifun(id) + ifun(0)))
 
 SELECT bt_index_check('bttest_a_expr_idx');
 
+--
+-- Check deduplicated indexes, built in bulk and grown by insertions, and
+-- after vacuum has removed some of the heap TIDs in posting lists
+--
+CREATE TABLE bttest_dup(id int8, grp int4);
+INSERT INTO bttest_dup SELECT i, i % 10 FROM generate_series(1, 20000) i;
+CREATE INDEX bttest_dup_bulk_idx ON bttest_dup (grp) WITH (deduplicate_items = on);
+CREATE TABLE bttest_dup_ins(id int8, grp int4);
+CREATE INDEX bttest_dup_ins_idx ON bttest_dup_ins (grp) WITH (deduplicate_items = on);
+INSERT INTO bttest_dup_ins SELECT i, i % 10 FROM generate_series(1, 20000) i;
+DELETE FROM bttest_dup WHERE id % 3 = 0;
+DELETE FROM bttest_dup_ins WHERE id % 3 = 0;
+VACUUM bttest_dup;
+VACUUM bttest_dup_ins;
+SELECT bt_index_check('bttest_dup_bulk_idx');
+SELECT bt_index_parent_check('bttest_dup_bulk_idx');
+SELECT bt_index_check('bttest_dup_ins_idx');
+SELECT bt_index_parent_check('bttest_dup_ins_idx');
+
 -- cleanup
 DROP TABLE bttest_a;
 DROP TABLE bttest_b;
+DROP TABLE bttest_dup;
+DROP TABLE bttest_dup_ins;
 DROP FUNCTION ifun(int8);
 DROP OWNED BY bttest_role; -- permissions
 DROP ROLE bttest_role;
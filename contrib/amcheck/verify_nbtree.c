@@ -99,6 +99,8 @@ static void bt_check_every_level(Relation rel, bool readonly);
 static BtreeLevel bt_check_level_from_leftmost(BtreeCheckState *state,
 							 BtreeLevel level);
 static void bt_target_page_check(BtreeCheckState *state);
+static void bt_posting_check(BtreeCheckState *state, OffsetNumber offset,
+				 IndexTuple itup);
 static ScanKey bt_right_page_check_scankey(BtreeCheckState *state);
 static void bt_downlink_check(BtreeCheckState *state, BlockNumber childblock,
 				  ScanKey targetkey);
@@ -561,6 +563,24 @@ bt_target_page_check(BtreeCheckState *state)
 	elog(DEBUG2, "verifying %u items on %s block %u", max,
 		 P_ISLEAF(topaque) ? "leaf" : "internal", state->targetblock);
 
+	/* A high key never carries a posting list */
+	if (!P_RIGHTMOST(topaque))
+	{
+		IndexTuple	hikey;
+
+		hikey = (IndexTuple) PageGetItem(state->target,
+										 PageGetItemId(state->target, P_HIKEY));
+		if (BTreeTupleIsPosting(hikey))
+			ereport(ERROR,
+					(errcode(ERRCODE_INDEX_CORRUPTED),
+					 errmsg("high key with posting list found in index \"%s\"",
+							RelationGetRelationName(state->rel)),
+					 errdetail_internal("Block=%u page lsn=%X/%X.",
+										state->targetblock,
+										(uint32) (state->targetlsn >> 32),
+										(uint32) state->targetlsn)));
+	}
+
 	/*
 	 * Loop over page items, starting from first non-highkey item, not high
 	 * key (if any).  Also, immediately skip "negative infinity" real item (if
@@ -586,6 +606,8 @@ bt_target_page_check(BtreeCheckState *state)
 		/* Build insertion scankey for current page offset */
 		itemid = PageGetItemId(state->target, offset);
 		itup = (IndexTuple) PageGetItem(state->target, itemid);
+		if (BTreeTupleIsPosting(itup))
+			bt_posting_check(state, offset, itup);
 		skey = _bt_mkscankey(state->rel, itup);
 
 		/*
@@ -616,8 +638,8 @@ bt_target_page_check(BtreeCheckState *state)
 
 			itid = psprintf("(%u,%u)", state->targetblock, offset);
 			htid = psprintf("(%u,%u)",
-							ItemPointerGetBlockNumberNoCheck(&(itup->t_tid)),
-							ItemPointerGetOffsetNumberNoCheck(&(itup->t_tid)));
+							ItemPointerGetBlockNumberNoCheck(BTreeTupleGetHeapTID(itup)),
+							ItemPointerGetOffsetNumberNoCheck(BTreeTupleGetHeapTID(itup)));
 
 			ereport(ERROR,
 					(errcode(ERRCODE_INDEX_CORRUPTED),
@@ -648,8 +670,8 @@ bt_target_page_check(BtreeCheckState *state)
 
 			itid = psprintf("(%u,%u)", state->targetblock, offset);
 			htid = psprintf("(%u,%u)",
-							ItemPointerGetBlockNumberNoCheck(&(itup->t_tid)),
-							ItemPointerGetOffsetNumberNoCheck(&(itup->t_tid)));
+							ItemPointerGetBlockNumberNoCheck(BTreeTupleGetHeapTID(itup)),
+							ItemPointerGetOffsetNumberNoCheck(BTreeTupleGetHeapTID(itup)));
 			nitid = psprintf("(%u,%u)", state->targetblock,
 							 OffsetNumberNext(offset));
 
@@ -657,8 +679,8 @@ bt_target_page_check(BtreeCheckState *state)
 			itemid = PageGetItemId(state->target, OffsetNumberNext(offset));
 			itup = (IndexTuple) PageGetItem(state->target, itemid);
 			nhtid = psprintf("(%u,%u)",
-							 ItemPointerGetBlockNumberNoCheck(&(itup->t_tid)),
-							 ItemPointerGetOffsetNumberNoCheck(&(itup->t_tid)));
+							 ItemPointerGetBlockNumberNoCheck(BTreeTupleGetHeapTID(itup)),
+							 ItemPointerGetOffsetNumberNoCheck(BTreeTupleGetHeapTID(itup)));
 
 			ereport(ERROR,
 					(errcode(ERRCODE_INDEX_CORRUPTED),
@@ -751,6 +773,63 @@ bt_target_page_check(BtreeCheckState *state)
 	}
 }
 
+/*
+ * Check the structure of a posting list tuple: it must be on a leaf page,
+ * hold at least two heap TIDs that fit within the tuple, and those TIDs must
+ * be valid and in strictly ascending order.
+ */
+static void
+bt_posting_check(BtreeCheckState *state, OffsetNumber offset, IndexTuple itup)
+{
+	BTPageOpaque topaque = (BTPageOpaque) PageGetSpecialPointer(state->target);
+	char	   *itid = psprintf("(%u,%u)", state->targetblock, offset);
+	Size		postingoff;
+	int			nposting;
+	int			i;
+
+	if (!P_ISLEAF(topaque))
+		ereport(ERROR,
+				(errcode(ERRCODE_INDEX_CORRUPTED),
+				 errmsg("posting list tuple found on internal page in index \"%s\"",
+						RelationGetRelationName(state->rel)),
+				 errdetail_internal("Index tid=%s page lsn=%X/%X.",
+									itid,
+									(uint32) (state->targetlsn >> 32),
+									(uint32) state->targetlsn)));
+
+	postingoff = BTreeTupleGetPostingOffset(itup);
+	nposting = BTreeTupleGetNPosting(itup);
+	if (nposting < 2 ||
+		postingoff != MAXALIGN(postingoff) ||
+		postingoff < sizeof(IndexTupleData) ||
+		postingoff + nposting * sizeof(ItemPointerData) > IndexTupleSize(itup))
+		ereport(ERROR,
+				(errcode(ERRCODE_INDEX_CORRUPTED),
+				 errmsg("malformed posting list tuple in index \"%s\"",
+						RelationGetRelationName(state->rel)),
+				 errdetail_internal("Index tid=%s posting offset=%zu heap tids=%d tuple size=%zu page lsn=%X/%X.",
+									itid, postingoff, nposting,
+									IndexTupleSize(itup),
+									(uint32) (state->targetlsn >> 32),
+									(uint32) state->targetlsn)));
+
+	for (i = 0; i < nposting; i++)
+	{
+		ItemPointer htid = BTreeTupleGetPostingN(itup, i);
+
+		if (!ItemPointerIsValid(htid) ||
+			(i > 0 && ItemPointerCompare(htid - 1, htid) >= 0))
+			ereport(ERROR,
+					(errcode(ERRCODE_INDEX_CORRUPTED),
+					 errmsg("invalid or out-of-order heap TID in posting list of index \"%s\"",
+							RelationGetRelationName(state->rel)),
+					 errdetail_internal("Index tid=%s posting list offset=%d page lsn=%X/%X.",
+										itid, i,
+										(uint32) (state->targetlsn >> 32),
+										(uint32) state->targetlsn)));
+	}
+}
+
 /*
  * Return a scankey for an item on page to right of current target (or the
  * first non-ignorable page), sufficient to check ordering invariant on last
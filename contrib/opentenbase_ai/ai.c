@@ -8,6 +8,16 @@
 #include "utils/jsonb.h"
 #include "fmgr.h"
 #include "miscadmin.h"
+#include "catalog/pg_type.h"
+#include "utils/array.h"
+#include "access/xact.h"
+#include "pgstat.h"
+#include "pgxc/pgxc.h"
+#include "postmaster/bgworker.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "utils/snapmgr.h"
 #include <curl/curl.h>
 #include <pthread.h>
 
@@ -21,6 +31,12 @@ static int batch_size = 10;
 static int batch_timeout_ms = 500;
 static int max_concurrent_requests = 50;
 static bool enable_batch_processing = true;
+static char *embedding_worker_database = NULL;
+static int embedding_worker_naptime = 10;
+
+/* Flags set by the embedding worker's signal handlers */
+static volatile sig_atomic_t got_sighup = false;
+static volatile sig_atomic_t got_sigterm = false;
 
 /* Batch processing structures */
 typedef struct BatchRequest {
@@ -49,6 +65,15 @@ typedef struct {
     size_t size;
 } HttpResponse;
 
+/* One request of ai_invoke_model_multi */
+typedef struct MultiRequest {
+    CURL *handle;
+    char *body;
+    HttpResponse response;
+    CURLcode result;
+    long status;
+} MultiRequest;
+
 /* Global batch context */
 static BatchContext *global_batch_ctx = NULL;
 static pthread_t batch_processor_thread;
@@ -56,14 +81,20 @@ static pthread_t batch_processor_thread;
 /* Function declarations */
 void _PG_init(void);
 void _PG_fini(void);
+#ifdef ENABLE_AI_CACHE
+extern void _PG_init_cache_enhancement(void);
+#endif
 static void* batch_processor(void *arg);
 static size_t WriteCallback(void *contents, size_t size, size_t nmemb, HttpResponse *response);
 static void process_batch_requests(BatchRequest *requests, int count);
+static void process_batch_requests_enhanced(BatchRequest *requests, int count);
 static void init_batch_context(void);
 static void cleanup_batch_context(void);
+void ai_embedding_worker_main(Datum main_arg) pg_attribute_noreturn();
 
 PG_FUNCTION_INFO_V1(ai_batch_invoke);
 PG_FUNCTION_INFO_V1(ai_configure_batch);
+PG_FUNCTION_INFO_V1(ai_invoke_model_multi);
 
 /* libcurl write callback */
 static size_t WriteCallback(void *contents, size_t size, size_t nmemb, HttpResponse *response)
@@ -338,6 +369,67 @@ void _PG_init(void)
         NULL
     );
 
+#ifdef ENABLE_AI_CACHE
+    _PG_init_cache_enhancement();
+#endif
+
+    DefineCustomIntVariable(
+        "ai.max_concurrent_requests",
+        "Sets the max number of model requests in flight per call",
+        "Used by ai.invoke_model_multi to bound concurrent HTTP requests.",
+        &max_concurrent_requests,
+        50,
+        1, 200,
+        PGC_USERSET,
+        0,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    DefineCustomStringVariable(
+        "ai.embedding_worker_database",
+        "Database in which the embedding worker maintains embedding columns",
+        "The worker only runs when opentenbase_ai is in shared_preload_libraries. "
+        "Set it on one coordinator only.",
+        &embedding_worker_database,
+        NULL,
+        PGC_POSTMASTER,
+        0,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    DefineCustomIntVariable(
+        "ai.embedding_worker_naptime",
+        "Sets the delay between runs of the embedding worker",
+        "The worker sleeps this long once the embedding queue is empty.",
+        &embedding_worker_naptime,
+        10,
+        1, 3600,
+        PGC_SIGHUP,
+        GUC_UNIT_S,
+        NULL,
+        NULL,
+        NULL
+    );
+
+    if (process_shared_preload_libraries_in_progress &&
+        embedding_worker_database != NULL && embedding_worker_database[0] != '\0') {
+        BackgroundWorker worker;
+
+        memset(&worker, 0, sizeof(worker));
+        worker.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
+        worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+        worker.bgw_restart_time = 60;
+        snprintf(worker.bgw_library_name, BGW_MAXLEN, "ai");
+        snprintf(worker.bgw_function_name, BGW_MAXLEN, "ai_embedding_worker_main");
+        snprintf(worker.bgw_name, BGW_MAXLEN, "opentenbase_ai embedding worker");
+        snprintf(worker.bgw_type, BGW_MAXLEN, "opentenbase_ai embedding worker");
+        RegisterBackgroundWorker(&worker);
+    }
+
     /* Initialize libcurl */
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
@@ -478,6 +570,246 @@ Datum ai_configure_batch(PG_FUNCTION_ARGS)
     PG_RETURN_BOOL(true);
 }
 
+/* Release curl handles and response buffers of ai_invoke_model_multi */
+static void cleanup_multi_requests(CURLM *multi_handle, MultiRequest *requests, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (requests[i].handle) {
+            curl_multi_remove_handle(multi_handle, requests[i].handle);
+            curl_easy_cleanup(requests[i].handle);
+            requests[i].handle = NULL;
+        }
+        if (requests[i].response.data) {
+            free(requests[i].response.data);
+            requests[i].response.data = NULL;
+        }
+    }
+
+    curl_multi_cleanup(multi_handle);
+}
+
+/*
+ * Invoke a model once per element of user_args, keeping up to
+ * ai.max_concurrent_requests requests in flight on one curl multi handle.
+ * Returns the raw response contents in input order. NULL elements give NULL
+ * results.
+ */
+Datum ai_invoke_model_multi(PG_FUNCTION_ARGS)
+{
+    text *model_name_text = PG_GETARG_TEXT_PP(0);
+    ArrayType *args_array = PG_GETARG_ARRAYTYPE_P(1);
+    char *model_name = text_to_cstring(model_name_text);
+    MemoryContext callercxt = CurrentMemoryContext;
+    MemoryContext oldcxt;
+    Oid argtypes[1] = {TEXTOID};
+    Datum values[1];
+    Datum *args_datums;
+    bool *args_nulls;
+    int nargs;
+    char *request_type;
+    char *uri;
+    char *content_type;
+    char *header_lines;
+    Datum default_args;
+    bool isnull;
+    struct curl_slist *headers = NULL;
+    MultiRequest *requests;
+    CURLM *multi_handle;
+    int next = 0;
+    int running = 0;
+    Datum *result_datums;
+    bool *result_nulls;
+    int dims[1];
+    int lbs[1];
+    int i;
+
+    deconstruct_array(args_array, JSONBOID, -1, false, 'i',
+                      &args_datums, &args_nulls, &nargs);
+
+    if (nargs == 0)
+        PG_RETURN_ARRAYTYPE_P(construct_empty_array(TEXTOID));
+
+    if (SPI_connect() != SPI_OK_CONNECT)
+        elog(ERROR, "SPI_connect failed");
+
+    /* Get model configuration, with headers as "field: value" lines */
+    values[0] = PointerGetDatum(model_name_text);
+    if (SPI_execute_with_args(
+            "SELECT m.request_type, m.uri, m.content_type, m.default_args, "
+            "(SELECT string_agg(h.field || ': ' || h.value, E'\\n') "
+            " FROM unnest(m.request_header) h) "
+            "FROM public.ai_model_list m WHERE m.model_name = $1",
+            1, argtypes, values, NULL, true, 1) != SPI_OK_SELECT || SPI_processed == 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_OBJECT),
+                 errmsg("Model %s not found", model_name)));
+
+    /* Copy the configuration out before SPI_finish releases it */
+    oldcxt = MemoryContextSwitchTo(callercxt);
+    request_type = SPI_getvalue(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1);
+    uri = SPI_getvalue(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 2);
+    content_type = SPI_getvalue(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 3);
+    default_args = SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 4, &isnull);
+    default_args = PointerGetDatum(PG_DETOAST_DATUM_COPY(default_args));
+    header_lines = SPI_getvalue(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 5);
+    MemoryContextSwitchTo(oldcxt);
+
+    SPI_finish();
+
+    headers = curl_slist_append(headers, psprintf("Content-Type: %s", content_type));
+    if (header_lines) {
+        char *line;
+        char *saveptr;
+
+        for (line = strtok_r(header_lines, "\n", &saveptr); line != NULL;
+             line = strtok_r(NULL, "\n", &saveptr))
+            headers = curl_slist_append(headers, line);
+    }
+
+    /* Build request bodies up front so errors happen before any transfer */
+    requests = palloc0(sizeof(MultiRequest) * nargs);
+    for (i = 0; i < nargs; i++) {
+        Jsonb *exec_args;
+
+        if (args_nulls[i])
+            continue;
+
+        exec_args = DatumGetJsonbP(DirectFunctionCall2(jsonb_concat, default_args,
+                                                       args_datums[i]));
+        requests[i].body = JsonbToCString(NULL, &exec_args->root, VARSIZE(exec_args));
+    }
+
+    multi_handle = curl_multi_init();
+
+    /* Let requests to the same host share an HTTP/2 connection */
+    curl_multi_setopt(multi_handle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    PG_TRY();
+    {
+        while (next < nargs || running > 0) {
+            CURLMsg *msg;
+            int msgs_left;
+            int still_running;
+
+            /* Keep the window of in-flight requests full */
+            while (next < nargs && running < max_concurrent_requests) {
+                MultiRequest *req = &requests[next++];
+
+                if (req->body == NULL)
+                    continue;
+
+                req->handle = curl_easy_init();
+                if (req->handle == NULL)
+                    elog(ERROR, "could not initialize curl handle");
+
+                req->response.data = malloc(1);
+                req->response.size = 0;
+                if (req->response.data == NULL)
+                    ereport(ERROR,
+                            (errcode(ERRCODE_OUT_OF_MEMORY),
+                             errmsg("out of memory")));
+                req->response.data[0] = '\0';
+
+                curl_easy_setopt(req->handle, CURLOPT_URL, uri);
+                curl_easy_setopt(req->handle, CURLOPT_HTTPHEADER, headers);
+                curl_easy_setopt(req->handle, CURLOPT_PRIVATE, req);
+                curl_easy_setopt(req->handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+                curl_easy_setopt(req->handle, CURLOPT_WRITEDATA, &req->response);
+                curl_easy_setopt(req->handle, CURLOPT_TIMEOUT, 30);
+                curl_easy_setopt(req->handle, CURLOPT_NOSIGNAL, 1L);
+
+                if (pg_strcasecmp(request_type, "GET") != 0) {
+                    curl_easy_setopt(req->handle, CURLOPT_POSTFIELDS, req->body);
+                    if (pg_strcasecmp(request_type, "POST") != 0)
+                        curl_easy_setopt(req->handle, CURLOPT_CUSTOMREQUEST, request_type);
+                }
+
+                curl_multi_add_handle(multi_handle, req->handle);
+                running++;
+            }
+
+            if (running == 0)
+                break;
+
+            curl_multi_perform(multi_handle, &still_running);
+
+            /* Collect finished requests to make room for more */
+            while ((msg = curl_multi_info_read(multi_handle, &msgs_left)) != NULL) {
+                MultiRequest *req;
+
+                if (msg->msg != CURLMSG_DONE)
+                    continue;
+
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **) &req);
+                req->result = msg->data.result;
+                curl_easy_getinfo(req->handle, CURLINFO_RESPONSE_CODE, &req->status);
+
+                curl_multi_remove_handle(multi_handle, req->handle);
+                curl_easy_cleanup(req->handle);
+                req->handle = NULL;
+                running--;
+            }
+
+            if (running > 0)
+                curl_multi_wait(multi_handle, NULL, 0, 1000, NULL);
+
+            CHECK_FOR_INTERRUPTS();
+        }
+    }
+    PG_CATCH();
+    {
+        cleanup_multi_requests(multi_handle, requests, nargs);
+        curl_slist_free_all(headers);
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+
+    curl_slist_free_all(headers);
+
+    /* Check every response before building the result, as invoke_model does */
+    for (i = 0; i < nargs; i++) {
+        MultiRequest *req = &requests[i];
+
+        if (req->body == NULL)
+            continue;
+
+        if (req->result != CURLE_OK) {
+            char *message = pstrdup(curl_easy_strerror(req->result));
+
+            cleanup_multi_requests(multi_handle, requests, nargs);
+            ereport(ERROR,
+                    (errmsg("Failure in http-request: %s", message)));
+        }
+
+        if (req->status != 200) {
+            char *content = pstrdup(req->response.data);
+            long status = req->status;
+
+            cleanup_multi_requests(multi_handle, requests, nargs);
+            ereport(ERROR,
+                    (errmsg("Failure in http-request. http_code: %ld, content: %s",
+                            status, content)));
+        }
+    }
+
+    result_datums = palloc(sizeof(Datum) * nargs);
+    result_nulls = palloc(sizeof(bool) * nargs);
+    for (i = 0; i < nargs; i++) {
+        result_nulls[i] = (requests[i].body == NULL);
+        result_datums[i] = result_nulls[i] ? (Datum) 0 :
+            CStringGetTextDatum(requests[i].response.data);
+    }
+
+    cleanup_multi_requests(multi_handle, requests, nargs);
+
+    dims[0] = nargs;
+    lbs[0] = 1;
+    PG_RETURN_ARRAYTYPE_P(construct_md_array(result_datums, result_nulls, 1, dims, lbs,
+                                             TEXTOID, -1, false, 'i'));
+}
+
 /* Enhanced batch processing with SPI integration */
 static void process_batch_requests_enhanced(BatchRequest *requests, int count)
 {
@@ -615,6 +947,111 @@ static void process_batch_requests_enhanced(BatchRequest *requests, int count)
     curl_multi_cleanup(multi_handle);
 }
 
+static void ai_embedding_worker_sighup(SIGNAL_ARGS)
+{
+    int save_errno = errno;
+
+    got_sighup = true;
+    SetLatch(MyLatch);
+
+    errno = save_errno;
+}
+
+static void ai_embedding_worker_sigterm(SIGNAL_ARGS)
+{
+    int save_errno = errno;
+
+    got_sigterm = true;
+    SetLatch(MyLatch);
+
+    errno = save_errno;
+}
+
+/*
+ * Run one pass of ai.process_embedding_queue() in its own transaction.
+ * Returns the number of rows embedded, or 0 if the extension is not
+ * installed in the worker's database.
+ */
+static int64 embedding_worker_run(void)
+{
+    int64 processed = 0;
+    int ret;
+
+    SetCurrentStatementStartTimestamp();
+    StartTransactionCommand();
+    SPI_connect();
+    PushActiveSnapshot(GetTransactionSnapshot());
+
+    ret = SPI_execute("SELECT 1 FROM pg_catalog.pg_extension WHERE extname = 'opentenbase_ai'",
+                      true, 1);
+    if (ret == SPI_OK_SELECT && SPI_processed > 0) {
+        bool isnull;
+
+        pgstat_report_activity(STATE_RUNNING, "SELECT ai.process_embedding_queue()");
+        ret = SPI_execute("SELECT ai.process_embedding_queue()", false, 1);
+        if (ret != SPI_OK_SELECT || SPI_processed != 1)
+            elog(ERROR, "ai.process_embedding_queue() failed: error code %d", ret);
+
+        processed = DatumGetInt32(SPI_getbinval(SPI_tuptable->vals[0],
+                                                SPI_tuptable->tupdesc, 1, &isnull));
+    }
+
+    SPI_finish();
+    PopActiveSnapshot();
+    CommitTransactionCommand();
+    pgstat_report_stat(false);
+    pgstat_report_activity(STATE_IDLE, NULL);
+
+    return processed;
+}
+
+/*
+ * Background worker that drains ai.embedding_queue. It runs passes back
+ * to back while there is work, and sleeps ai.embedding_worker_naptime
+ * once a pass finds nothing to embed.
+ */
+void ai_embedding_worker_main(Datum main_arg)
+{
+    pqsignal(SIGHUP, ai_embedding_worker_sighup);
+    pqsignal(SIGTERM, ai_embedding_worker_sigterm);
+    BackgroundWorkerUnblockSignals();
+
+    /* Distributed tables can only be updated through a coordinator */
+    if (!IS_PGXC_COORDINATOR)
+        proc_exit(0);
+
+    BackgroundWorkerInitializeConnection(embedding_worker_database, NULL);
+
+    elog(LOG, "%s started in database \"%s\"",
+         MyBgworkerEntry->bgw_name, embedding_worker_database);
+
+    while (!got_sigterm) {
+        int64 processed;
+
+        if (got_sighup) {
+            got_sighup = false;
+            ProcessConfigFile(PGC_SIGHUP);
+        }
+
+        processed = embedding_worker_run();
+
+        if (processed == 0) {
+            int rc = WaitLatch(MyLatch,
+                               WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+                               embedding_worker_naptime * 1000L,
+                               PG_WAIT_EXTENSION);
+            ResetLatch(MyLatch);
+
+            if (rc & WL_POSTMASTER_DEATH)
+                proc_exit(1);
+        }
+
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    proc_exit(1);
+}
+
 void _PG_fini(void)
 {
     cleanup_batch_context();
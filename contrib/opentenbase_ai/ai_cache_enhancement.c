@@ -8,8 +8,13 @@
  * Integration approach:
  * - Extends existing ai.c with caching functions
  * - Adds new SQL functions while preserving existing API
- * - Uses PostgreSQL tables for persistent cache storage
+ * - Keeps results in a shared-memory hash table with CLOCK eviction, so a
+ *   cache hit costs a hash probe instead of an SPI query
+ * - Optionally spills evicted entries to a PostgreSQL table
  * - Leverages existing batch processing infrastructure
+ *
+ * The shared cache is only available when the library is loaded through
+ * shared_preload_libraries; otherwise the table is used directly.
  */
 
 #include "postgres.h"
@@ -18,23 +23,34 @@
 #include "utils/builtins.h"
 #include "executor/spi.h"
 #include "funcapi.h"
+#include "access/hash.h"
 #include "access/htup_details.h"
 #include "utils/jsonb.h"
 #include "fmgr.h"
 #include "miscadmin.h"
+#include "parser/parse_func.h"
+#include "port/atomics.h"
+#include "portability/instr_time.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/array.h"
+#include "utils/dsa.h"
+#include "utils/hsearch.h"
 #include "utils/timestamp.h"
 #include "utils/lsyscache.h"
 #include "catalog/pg_type.h"
+#include <math.h>
 #include <curl/curl.h>
 #include <pthread.h>
 
-PG_MODULE_MAGIC;
-
 /* Add to existing configuration variables */
 static bool enable_ai_result_cache = true;
 static int ai_cache_default_ttl = 3600;  /* 1 hour default TTL */
 static int ai_cache_max_entries = 10000;
 static char *ai_cache_similarity_threshold = "0.95";
+static int ai_cache_memory = 64;  /* MB of result text in shared memory */
+static bool ai_cache_spill_to_table = true;
 
 /* Cache-related structures (add to existing) */
 typedef struct AIResultCacheKey {
@@ -43,12 +59,65 @@ typedef struct AIResultCacheKey {
     char *content_hash; /* Hash of actual content for similarity matching */
 } AIResultCacheKey;
 
-typedef struct CacheStats {
-    int64 total_requests;
-    int64 cache_hits;
-    int64 cache_misses;
-    double hit_ratio;
-} CacheStats;
+/*
+ * Cache counters. These live in shared memory when the shared cache is
+ * available, and in backend-local memory otherwise.
+ */
+typedef struct AICacheCounters {
+    pg_atomic_uint64 total_requests;
+    pg_atomic_uint64 cache_hits;
+    pg_atomic_uint64 cache_misses;
+    pg_atomic_uint64 batch_requests;
+    pg_atomic_uint64 evictions;
+    pg_atomic_uint64 spills;
+    pg_atomic_uint64 hit_time_ns;     /* total time spent serving hits */
+    pg_atomic_uint64 miss_time_ns;    /* total time spent serving misses */
+} AICacheCounters;
+
+/* Shared cache entry key: hashed model name plus the args hash */
+typedef struct AICacheKey {
+    uint64 model_hash;
+    char args_hash[17];
+} AICacheKey;
+
+/*
+ * Shared cache entry. The model name and result text are stored together in
+ * the DSA area as two NUL-terminated strings.
+ */
+typedef struct AICacheEntry {
+    AICacheKey key;             /* hash key, must be first */
+    int slot;                   /* position in the CLOCK ring */
+    bool referenced;            /* CLOCK reference bit */
+    TimestampTz created_time;
+    TimestampTz expiry_time;
+    dsa_pointer data;           /* model name, then result text */
+    Size model_len;
+} AICacheEntry;
+
+typedef struct AICacheSharedState {
+    LWLock *lock;               /* protects everything but the counters */
+    int dsa_tranche_id;
+    dsa_handle dsa;             /* created by the first backend to store */
+    int nentries;
+    int clock_hand;
+    AICacheCounters counters;
+    AICacheEntry *ring[FLEXIBLE_ARRAY_MEMBER];  /* entries by slot */
+} AICacheSharedState;
+
+/* An entry copied out of the shared cache for spilling to the table */
+typedef struct AICacheSpill {
+    char *model_name;
+    char *args_hash;
+    char *result;
+    TimestampTz expiry_time;
+} AICacheSpill;
+
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+static AICacheSharedState *ai_cache_state = NULL;
+static HTAB *ai_cache_hash = NULL;
+static dsa_area *ai_cache_area = NULL;
+static AICacheCounters ai_cache_local_counters;
+static AICacheCounters *ai_cache_counters = NULL;
 
 /* Function declarations (add to existing) */
 PG_FUNCTION_INFO_V1(ai_invoke_model_cached);
@@ -56,6 +125,8 @@ PG_FUNCTION_INFO_V1(ai_cache_stats);
 PG_FUNCTION_INFO_V1(ai_cache_clear);
 PG_FUNCTION_INFO_V1(ai_batch_invoke_cached);
 
+void _PG_init_cache_enhancement(void);
+
 static char *compute_args_hash(Jsonb *args);
 static char *compute_content_hash(const char *content);
 static bool lookup_cache_result(const char *model_name, const char *args_hash,
@@ -65,6 +136,24 @@ static void store_cache_result(const char *model_name, const char *args_hash,
                               const char *content_hash, const char *result,
                               int ttl_seconds);
 static void cleanup_expired_cache_entries(void);
+static Size ai_cache_shmem_size(void);
+static void ai_cache_shmem_startup(void);
+static AICacheCounters *ai_cache_get_counters(void);
+static void ai_cache_count(bool hit, instr_time start);
+static bool ai_cache_attach(void);
+static void ai_cache_make_key(AICacheKey *key, const char *model_name,
+                              const char *args_hash);
+static bool shared_cache_lookup(const char *model_name, const char *args_hash,
+                                char **cached_result, TimestampTz *cache_time);
+static List *shared_cache_store(const char *model_name, const char *args_hash,
+                                const char *result, TimestampTz expiry_time);
+static AICacheEntry *shared_cache_victim(AICacheEntry *keep);
+static AICacheSpill *shared_cache_evict(AICacheEntry *entry, bool spill);
+static int shared_cache_clear(bool clear_all);
+static void spill_cache_entries(List *spilled);
+
+/* Whether the last ai_invoke_model_cached call in this backend was a hit */
+static bool last_call_hit = false;
 
 /* Enhanced invoke_model function with caching */
 Datum
@@ -78,8 +167,11 @@ ai_invoke_model_cached(PG_FUNCTION_ARGS)
     char *args_hash = compute_args_hash(user_args);
     char *cached_result = NULL;
     char *final_result = NULL;
-    TimestampTz cache_time;
+    TimestampTz cache_time = 0;
     bool cache_hit = false;
+    instr_time start;
+
+    INSTR_TIME_SET_CURRENT(start);
 
     /* Only use cache if enabled */
     if (enable_ai_result_cache && ttl_seconds > 0) {
@@ -91,17 +183,10 @@ ai_invoke_model_cached(PG_FUNCTION_ARGS)
         /* Cache hit - return cached result */
         final_result = cached_result;
 
-        /* Update cache statistics */
-        if (SPI_connect() == SPI_OK_CONNECT) {
-            SPI_exec("UPDATE ai.cache_stats SET cache_hits = cache_hits + 1, "
-                    "total_requests = total_requests + 1", 0);
-            SPI_finish();
-        }
-
         ereport(DEBUG1,
                 (errmsg("AI cache hit for model: %s, age: %d seconds",
                         model_name,
-                        (int)(GetCurrentTimestamp() - cache_time))));
+                        (int) ((GetCurrentTimestamp() - cache_time) / USECS_PER_SEC))));
     } else {
         /* Cache miss - call original invoke_model function */
         Datum result_datum;
@@ -127,18 +212,15 @@ ai_invoke_model_cached(PG_FUNCTION_ARGS)
             pfree(content_hash);
         }
 
-        /* Update cache statistics */
-        if (SPI_connect() == SPI_OK_CONNECT) {
-            SPI_exec("UPDATE ai.cache_stats SET cache_misses = cache_misses + 1, "
-                    "total_requests = total_requests + 1", 0);
-            SPI_finish();
-        }
-
         ereport(DEBUG1,
                 (errmsg("AI cache miss for model: %s, result cached with TTL: %d",
                         model_name, ttl_seconds)));
     }
 
+    /* Update cache statistics */
+    ai_cache_count(cache_hit, start);
+    last_call_hit = cache_hit;
+
     /* Cleanup */
     pfree(model_name);
     pfree(args_hash);
@@ -158,7 +240,6 @@ ai_batch_invoke_cached(PG_FUNCTION_ARGS)
     text *user_args_text = PG_ARGISNULL(2) ? NULL : PG_GETARG_TEXT_PP(2);
     int32 ttl_seconds = PG_ARGISNULL(3) ? ai_cache_default_ttl : PG_GETARG_INT32(3);
 
-    char *model_name = text_to_cstring(model_name_text);
     ArrayBuildState *astate = NULL;
     Datum *input_datums;
     bool *input_nulls;
@@ -177,57 +258,43 @@ ai_batch_invoke_cached(PG_FUNCTION_ARGS)
 
         char *input_text = TextDatumGetCString(input_datums[i]);
         char *result = NULL;
-        bool found_in_cache = false;
-
-        /* Try cache lookup if enabled */
-        if (enable_ai_result_cache && ttl_seconds > 0) {
-            /* Create a simple args hash for batch processing */
-            char *simple_hash = psprintf("batch_%s_%d", input_text, i);
-            char *cached_result;
-            TimestampTz cache_time;
-
-            if (lookup_cache_result(model_name, simple_hash, ttl_seconds,
-                                   &cached_result, &cache_time)) {
-                result = cached_result;
-                found_in_cache = true;
-                cache_hits++;
-            }
-            pfree(simple_hash);
-        }
 
-        if (!found_in_cache) {
-            /* Call original batch processing logic or individual invoke */
-            Jsonb *args_jsonb = DatumGetJsonbP(
-                DirectFunctionCall1(jsonb_in, CStringGetDatum("{}"))
-            );
-
-            if (user_args_text) {
-                char *user_args_str = text_to_cstring(user_args_text);
-                args_jsonb = DatumGetJsonbP(
-                    DirectFunctionCall1(jsonb_in, CStringGetDatum(user_args_str))
-                );
-            }
+        Jsonb *args_jsonb = DatumGetJsonbP(
+            DirectFunctionCall1(jsonb_in, CStringGetDatum("{}"))
+        );
 
-            /* Add input to args */
-            Jsonb *input_jsonb = DatumGetJsonbP(
-                DirectFunctionCall1(jsonb_in,
-                    CStringGetDatum(psprintf("{\"input\": \"%s\"}", input_text)))
+        if (user_args_text) {
+            char *user_args_str = text_to_cstring(user_args_text);
+            args_jsonb = DatumGetJsonbP(
+                DirectFunctionCall1(jsonb_in, CStringGetDatum(user_args_str))
             );
+        }
 
-            /* Merge args */
-            Datum merged_args = DirectFunctionCall2(jsonb_concat,
-                                                   JsonbPGetDatum(args_jsonb),
-                                                   JsonbPGetDatum(input_jsonb));
-
-            /* Call cached invoke function */
-            Datum result_datum = DirectFunctionCall3(ai_invoke_model_cached,
-                                                    PointerGetDatum(model_name_text),
-                                                    merged_args,
-                                                    Int32GetDatum(ttl_seconds));
+        /* Add input to args */
+        Jsonb *input_jsonb = DatumGetJsonbP(
+            DirectFunctionCall1(jsonb_in,
+                CStringGetDatum(psprintf("{\"input\": \"%s\"}", input_text)))
+        );
 
-            result = TextDatumGetCString(result_datum);
+        /* Merge args */
+        Datum merged_args = DirectFunctionCall2(jsonb_concat,
+                                               JsonbPGetDatum(args_jsonb),
+                                               JsonbPGetDatum(input_jsonb));
+
+        /*
+         * Call cached invoke function, which looks up and stores the result
+         * under the hash of the merged args
+         */
+        Datum result_datum = DirectFunctionCall3(ai_invoke_model_cached,
+                                                PointerGetDatum(model_name_text),
+                                                merged_args,
+                                                Int32GetDatum(ttl_seconds));
+
+        result = TextDatumGetCString(result_datum);
+        if (last_call_hit)
+            cache_hits++;
+        else
             cache_misses++;
-        }
 
         /* Add result to output array */
         astate = accumArrayResult(astate, CStringGetTextDatum(result),
@@ -238,19 +305,7 @@ ai_batch_invoke_cached(PG_FUNCTION_ARGS)
     }
 
     /* Update batch statistics */
-    if (SPI_connect() == SPI_OK_CONNECT) {
-        char *update_sql = psprintf(
-            "UPDATE ai.cache_stats SET "
-            "cache_hits = cache_hits + %d, "
-            "cache_misses = cache_misses + %d, "
-            "total_requests = total_requests + %d, "
-            "batch_requests = batch_requests + 1",
-            cache_hits, cache_misses, input_count
-        );
-        SPI_exec(update_sql, 0);
-        pfree(update_sql);
-        SPI_finish();
-    }
+    pg_atomic_fetch_add_u64(&ai_cache_get_counters()->batch_requests, 1);
 
     ereport(NOTICE,
             (errmsg("AI batch processing completed: %d items, %d cache hits, %d cache misses",
@@ -269,8 +324,12 @@ ai_cache_stats(PG_FUNCTION_ARGS)
 {
     TupleDesc tupdesc;
     HeapTuple tuple;
-    Datum values[8];
-    bool nulls[8];
+    AICacheCounters *counters = ai_cache_get_counters();
+    uint64 total_requests;
+    uint64 cache_hits;
+    uint64 cache_misses;
+    Datum values[12];
+    bool nulls[12];
 
     /* Build tuple descriptor */
     if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
@@ -282,39 +341,31 @@ ai_cache_stats(PG_FUNCTION_ARGS)
     /* Initialize values */
     memset(nulls, false, sizeof(nulls));
 
-    /* Query cache statistics from database */
-    if (SPI_connect() == SPI_OK_CONNECT) {
-        int ret = SPI_exec("SELECT total_requests, cache_hits, cache_misses, "
-                          "batch_requests, "
-                          "CASE WHEN total_requests > 0 THEN "
-                          "    round(cache_hits * 100.0 / total_requests, 2) "
-                          "ELSE 0 END as hit_ratio, "
-                          "current_entries, max_entries, cache_enabled "
-                          "FROM ai.cache_stats LIMIT 1", 0);
+    total_requests = pg_atomic_read_u64(&counters->total_requests);
+    cache_hits = pg_atomic_read_u64(&counters->cache_hits);
+    cache_misses = pg_atomic_read_u64(&counters->cache_misses);
 
-        if (ret == SPI_OK_SELECT && SPI_processed > 0) {
-            HeapTuple spi_tuple = SPI_tuptable->vals[0];
-            TupleDesc spi_tupdesc = SPI_tuptable->tupdesc;
-
-            values[0] = SPI_getbinval(spi_tuple, spi_tupdesc, 1, &nulls[0]); /* total_requests */
-            values[1] = SPI_getbinval(spi_tuple, spi_tupdesc, 2, &nulls[1]); /* cache_hits */
-            values[2] = SPI_getbinval(spi_tuple, spi_tupdesc, 3, &nulls[2]); /* cache_misses */
-            values[3] = SPI_getbinval(spi_tuple, spi_tupdesc, 5, &nulls[3]); /* hit_ratio */
-            values[4] = SPI_getbinval(spi_tuple, spi_tupdesc, 6, &nulls[4]); /* current_entries */
-            values[5] = Int32GetDatum(ai_cache_max_entries);                 /* max_entries */
-            values[6] = BoolGetDatum(enable_ai_result_cache);                /* cache_enabled */
-            values[7] = SPI_getbinval(spi_tuple, spi_tupdesc, 4, &nulls[7]); /* batch_requests */
-        } else {
-            /* No stats found, return zeros */
-            for (int i = 0; i < 8; i++) {
-                values[i] = Int64GetDatum(0);
-                nulls[i] = false;
-            }
-            values[6] = BoolGetDatum(enable_ai_result_cache);
-        }
+    values[0] = Int64GetDatum(total_requests);
+    values[1] = Int64GetDatum(cache_hits);
+    values[2] = Int64GetDatum(cache_misses);
+    values[3] = Float8GetDatum(total_requests > 0 ?
+                               rint(cache_hits * 10000.0 / total_requests) / 100.0 : 0);
 
-        SPI_finish();
-    }
+    /* Entries are only counted for the shared cache */
+    if (ai_cache_state != NULL)
+        values[4] = Int32GetDatum(ai_cache_state->nentries);
+    else
+        nulls[4] = true;
+
+    values[5] = Int32GetDatum(ai_cache_max_entries);
+    values[6] = BoolGetDatum(enable_ai_result_cache);
+    values[7] = Int64GetDatum(pg_atomic_read_u64(&counters->batch_requests));
+    values[8] = Float8GetDatum(cache_hits > 0 ?
+                               pg_atomic_read_u64(&counters->hit_time_ns) / 1000.0 / cache_hits : 0);
+    values[9] = Float8GetDatum(cache_misses > 0 ?
+                               pg_atomic_read_u64(&counters->miss_time_ns) / 1000.0 / cache_misses : 0);
+    values[10] = Int64GetDatum(pg_atomic_read_u64(&counters->evictions));
+    values[11] = Int64GetDatum(pg_atomic_read_u64(&counters->spills));
 
     /* Build and return tuple */
     tuple = heap_form_tuple(tupdesc, values, nulls);
@@ -328,6 +379,9 @@ ai_cache_clear(PG_FUNCTION_ARGS)
     bool clear_all = PG_ARGISNULL(0) ? true : PG_GETARG_BOOL(0);
     int deleted_count = 0;
 
+    if (ai_cache_attach())
+        deleted_count += shared_cache_clear(clear_all);
+
     if (SPI_connect() == SPI_OK_CONNECT) {
         char *delete_sql;
 
@@ -341,23 +395,27 @@ ai_cache_clear(PG_FUNCTION_ARGS)
 
         int ret = SPI_exec(delete_sql, 0);
         if (ret == SPI_OK_DELETE) {
-            deleted_count = SPI_processed;
+            deleted_count += SPI_processed;
         }
 
-        /* Reset statistics if clearing all */
-        if (clear_all) {
-            SPI_exec("UPDATE ai.cache_stats SET "
-                    "cache_hits = 0, cache_misses = 0, "
-                    "total_requests = 0, current_entries = 0", 0);
-        } else {
-            /* Update current entries count */
-            SPI_exec("UPDATE ai.cache_stats SET "
-                    "current_entries = (SELECT count(*) FROM ai.result_cache)", 0);
-        }
+        /* Update current entries count */
+        SPI_exec("UPDATE ai.cache_stats SET "
+                "current_entries = (SELECT count(*) FROM ai.result_cache)", 0);
 
         SPI_finish();
     }
 
+    /* Reset statistics if clearing all */
+    if (clear_all) {
+        AICacheCounters *counters = ai_cache_get_counters();
+
+        pg_atomic_write_u64(&counters->total_requests, 0);
+        pg_atomic_write_u64(&counters->cache_hits, 0);
+        pg_atomic_write_u64(&counters->cache_misses, 0);
+        pg_atomic_write_u64(&counters->hit_time_ns, 0);
+        pg_atomic_write_u64(&counters->miss_time_ns, 0);
+    }
+
     ereport(NOTICE,
             (errmsg("AI cache cleared: %d entries removed", deleted_count)));
 
@@ -370,8 +428,9 @@ static char *
 compute_args_hash(Jsonb *args)
 {
     char *json_str = JsonbToCString(NULL, &args->root, VARSIZE(args));
-    uint32 hash = hash_any((unsigned char *) json_str, strlen(json_str));
-    return psprintf("%08x", hash);
+    uint64 hash = DatumGetUInt64(hash_any_extended((unsigned char *) json_str,
+                                                   strlen(json_str), 0));
+    return psprintf("%016" INT64_MODIFIER "x", hash);
 }
 
 static char *
@@ -386,14 +445,24 @@ lookup_cache_result(const char *model_name, const char *args_hash,
                    int ttl_seconds, char **cached_result, TimestampTz *cache_time)
 {
     bool found = false;
+    TimestampTz expiry_time = 0;
+
+    if (ai_cache_attach()) {
+        if (shared_cache_lookup(model_name, args_hash, cached_result, cache_time))
+            return true;
+
+        /* Without spilling, the table is never written */
+        if (!ai_cache_spill_to_table)
+            return false;
+    }
 
     if (SPI_connect() == SPI_OK_CONNECT) {
         char *query_sql = psprintf(
-            "SELECT result_text, created_time FROM ai.result_cache "
-            "WHERE model_name = '%s' AND args_hash = '%s' "
+            "SELECT result_text, created_time, expiry_time FROM ai.result_cache "
+            "WHERE model_name = %s AND args_hash = '%s' "
             "AND expiry_time > now() "
             "ORDER BY created_time DESC LIMIT 1",
-            model_name, args_hash
+            quote_literal_cstr(model_name), args_hash
         );
 
         int ret = SPI_exec(query_sql, 0);
@@ -405,13 +474,22 @@ lookup_cache_result(const char *model_name, const char *args_hash,
 
             Datum result_datum = SPI_getbinval(tuple, tupdesc, 1, &isnull);
             if (!isnull) {
-                *cached_result = pstrdup(TextDatumGetCString(result_datum));
+                char *result_str = TextDatumGetCString(result_datum);
+
+                /* Copy out of the SPI context, which SPI_finish releases */
+                *cached_result = SPI_palloc(strlen(result_str) + 1);
+                strcpy(*cached_result, result_str);
 
                 Datum time_datum = SPI_getbinval(tuple, tupdesc, 2, &isnull);
                 if (!isnull) {
                     *cache_time = DatumGetTimestampTz(time_datum);
                 }
 
+                time_datum = SPI_getbinval(tuple, tupdesc, 3, &isnull);
+                if (!isnull) {
+                    expiry_time = DatumGetTimestampTz(time_datum);
+                }
+
                 found = true;
             }
         }
@@ -420,6 +498,11 @@ lookup_cache_result(const char *model_name, const char *args_hash,
         SPI_finish();
     }
 
+    /* Bring spilled entries back into the shared cache */
+    if (found && ai_cache_area != NULL && expiry_time != 0)
+        spill_cache_entries(shared_cache_store(model_name, args_hash,
+                                               *cached_result, expiry_time));
+
     return found;
 }
 
@@ -427,18 +510,28 @@ static void
 store_cache_result(const char *model_name, const char *args_hash,
                   const char *content_hash, const char *result, int ttl_seconds)
 {
+    /* The table is only written when entries are evicted from shared memory */
+    if (ai_cache_attach()) {
+        TimestampTz expiry_time = TimestampTzPlusMilliseconds(GetCurrentTimestamp(),
+                                                              ttl_seconds * (int64) 1000);
+
+        spill_cache_entries(shared_cache_store(model_name, args_hash, result,
+                                               expiry_time));
+        return;
+    }
+
     if (SPI_connect() == SPI_OK_CONNECT) {
         char *insert_sql = psprintf(
             "INSERT INTO ai.result_cache "
             "(model_name, args_hash, content_hash, result_text, "
             " created_time, expiry_time, access_count) "
-            "VALUES ('%s', '%s', '%s', %s, now(), now() + interval '%d seconds', 1) "
+            "VALUES (%s, '%s', '%s', %s, now(), now() + interval '%d seconds', 1) "
             "ON CONFLICT (model_name, args_hash) DO UPDATE SET "
             "result_text = EXCLUDED.result_text, "
             "created_time = EXCLUDED.created_time, "
             "expiry_time = EXCLUDED.expiry_time, "
             "access_count = ai.result_cache.access_count + 1",
-            model_name, args_hash, content_hash,
+            quote_literal_cstr(model_name), args_hash, content_hash,
             quote_literal_cstr(result), ttl_seconds
         );
 
@@ -453,6 +546,418 @@ store_cache_result(const char *model_name, const char *args_hash,
     }
 }
 
+/*
+ * Shared memory needed for the cache: the state with its CLOCK ring, and
+ * the hash table. Result text is kept in a DSA area created on first use.
+ */
+static Size
+ai_cache_shmem_size(void)
+{
+    Size size;
+
+    size = add_size(offsetof(AICacheSharedState, ring),
+                    mul_size(ai_cache_max_entries, sizeof(AICacheEntry *)));
+    size = add_size(size, hash_estimate_size(ai_cache_max_entries,
+                                             sizeof(AICacheEntry)));
+
+    return size;
+}
+
+static void
+ai_cache_init_counters(AICacheCounters *counters)
+{
+    pg_atomic_init_u64(&counters->total_requests, 0);
+    pg_atomic_init_u64(&counters->cache_hits, 0);
+    pg_atomic_init_u64(&counters->cache_misses, 0);
+    pg_atomic_init_u64(&counters->batch_requests, 0);
+    pg_atomic_init_u64(&counters->evictions, 0);
+    pg_atomic_init_u64(&counters->spills, 0);
+    pg_atomic_init_u64(&counters->hit_time_ns, 0);
+    pg_atomic_init_u64(&counters->miss_time_ns, 0);
+}
+
+static void
+ai_cache_shmem_startup(void)
+{
+    bool found;
+    HASHCTL info;
+
+    if (prev_shmem_startup_hook)
+        prev_shmem_startup_hook();
+
+    LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+    ai_cache_state = ShmemInitStruct("ai result cache",
+                                     add_size(offsetof(AICacheSharedState, ring),
+                                              mul_size(ai_cache_max_entries,
+                                                       sizeof(AICacheEntry *))),
+                                     &found);
+    if (!found) {
+        ai_cache_state->lock = &(GetNamedLWLockTranche("ai_result_cache"))->lock;
+        ai_cache_state->dsa_tranche_id = LWLockNewTrancheId();
+        ai_cache_state->dsa = DSM_HANDLE_INVALID;
+        ai_cache_state->nentries = 0;
+        ai_cache_state->clock_hand = 0;
+        ai_cache_init_counters(&ai_cache_state->counters);
+    }
+
+    memset(&info, 0, sizeof(info));
+    info.keysize = sizeof(AICacheKey);
+    info.entrysize = sizeof(AICacheEntry);
+    ai_cache_hash = ShmemInitHash("ai result cache hash",
+                                  ai_cache_max_entries, ai_cache_max_entries,
+                                  &info, HASH_ELEM | HASH_BLOBS);
+
+    LWLockRelease(AddinShmemInitLock);
+}
+
+static AICacheCounters *
+ai_cache_get_counters(void)
+{
+    if (ai_cache_counters == NULL) {
+        if (ai_cache_state != NULL) {
+            ai_cache_counters = &ai_cache_state->counters;
+        } else {
+            ai_cache_init_counters(&ai_cache_local_counters);
+            ai_cache_counters = &ai_cache_local_counters;
+        }
+    }
+
+    return ai_cache_counters;
+}
+
+/* Count a request and the time spent serving it since start */
+static void
+ai_cache_count(bool hit, instr_time start)
+{
+    AICacheCounters *counters = ai_cache_get_counters();
+    instr_time duration;
+    uint64 elapsed_ns;
+
+    INSTR_TIME_SET_CURRENT(duration);
+    INSTR_TIME_SUBTRACT(duration, start);
+    elapsed_ns = (uint64) (INSTR_TIME_GET_DOUBLE(duration) * 1000000000.0);
+
+    pg_atomic_fetch_add_u64(&counters->total_requests, 1);
+    if (hit) {
+        pg_atomic_fetch_add_u64(&counters->cache_hits, 1);
+        pg_atomic_fetch_add_u64(&counters->hit_time_ns, elapsed_ns);
+    } else {
+        pg_atomic_fetch_add_u64(&counters->cache_misses, 1);
+        pg_atomic_fetch_add_u64(&counters->miss_time_ns, elapsed_ns);
+    }
+}
+
+/*
+ * Attach to the DSA area holding result text, creating it if this is the
+ * first backend to use the cache. Returns false if the shared cache is not
+ * available because the library was not preloaded.
+ */
+static bool
+ai_cache_attach(void)
+{
+    MemoryContext oldcontext;
+
+    if (ai_cache_state == NULL)
+        return false;
+
+    if (ai_cache_area != NULL)
+        return true;
+
+    oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+    LWLockRegisterTranche(ai_cache_state->dsa_tranche_id, "ai_result_cache_dsa");
+
+    LWLockAcquire(ai_cache_state->lock, LW_EXCLUSIVE);
+    if (ai_cache_state->dsa == DSM_HANDLE_INVALID) {
+        ai_cache_area = dsa_create(ai_cache_state->dsa_tranche_id);
+        dsa_set_size_limit(ai_cache_area, (Size) ai_cache_memory * 1024 * 1024);
+        dsa_pin(ai_cache_area);
+        ai_cache_state->dsa = dsa_get_handle(ai_cache_area);
+    } else {
+        ai_cache_area = dsa_attach(ai_cache_state->dsa);
+    }
+    dsa_pin_mapping(ai_cache_area);
+    LWLockRelease(ai_cache_state->lock);
+
+    MemoryContextSwitchTo(oldcontext);
+
+    return true;
+}
+
+static void
+ai_cache_make_key(AICacheKey *key, const char *model_name, const char *args_hash)
+{
+    memset(key, 0, sizeof(AICacheKey));
+    key->model_hash = DatumGetUInt64(hash_any_extended((unsigned char *) model_name,
+                                                       strlen(model_name), 0));
+    strlcpy(key->args_hash, args_hash, sizeof(key->args_hash));
+}
+
+static bool
+shared_cache_lookup(const char *model_name, const char *args_hash,
+                    char **cached_result, TimestampTz *cache_time)
+{
+    AICacheKey key;
+    AICacheEntry *entry;
+    TimestampTz now = GetCurrentTimestamp();
+    bool found = false;
+
+    ai_cache_make_key(&key, model_name, args_hash);
+
+    LWLockAcquire(ai_cache_state->lock, LW_SHARED);
+
+    entry = (AICacheEntry *) hash_search(ai_cache_hash, &key, HASH_FIND, NULL);
+    if (entry != NULL && entry->expiry_time > now) {
+        char *data = dsa_get_address(ai_cache_area, entry->data);
+
+        *cached_result = pstrdup(data + entry->model_len + 1);
+        *cache_time = entry->created_time;
+
+        /*
+         * Set without an exclusive lock. A lost update only gives the entry
+         * one less pass of the clock hand.
+         */
+        entry->referenced = true;
+        found = true;
+    }
+
+    LWLockRelease(ai_cache_state->lock);
+
+    return found;
+}
+
+/*
+ * Pick an entry to evict with the CLOCK algorithm, skipping keep. Expired
+ * entries are taken first. Caller must hold the lock exclusively.
+ */
+static AICacheEntry *
+shared_cache_victim(AICacheEntry *keep)
+{
+    TimestampTz now = GetCurrentTimestamp();
+
+    if (ai_cache_state->nentries == 0 ||
+        (ai_cache_state->nentries == 1 && ai_cache_state->ring[0] == keep))
+        return NULL;
+
+    /* Finishes within two passes since each pass clears reference bits */
+    for (;;) {
+        AICacheEntry *entry;
+
+        if (ai_cache_state->clock_hand >= ai_cache_state->nentries)
+            ai_cache_state->clock_hand = 0;
+
+        entry = ai_cache_state->ring[ai_cache_state->clock_hand++];
+
+        if (entry == keep)
+            continue;
+
+        if (entry->referenced && entry->expiry_time > now) {
+            entry->referenced = false;
+            continue;
+        }
+
+        return entry;
+    }
+}
+
+/*
+ * Remove an entry from the shared cache. If spill is set and the entry has
+ * not expired, a copy is returned for writing to the table once the lock is
+ * released. Caller must hold the lock exclusively.
+ */
+static AICacheSpill *
+shared_cache_evict(AICacheEntry *entry, bool spill)
+{
+    AICacheSpill *spilled = NULL;
+    int slot = entry->slot;
+    AICacheEntry *last;
+
+    if (DsaPointerIsValid(entry->data)) {
+        if (spill && entry->expiry_time > GetCurrentTimestamp()) {
+            char *data = dsa_get_address(ai_cache_area, entry->data);
+
+            spilled = (AICacheSpill *) palloc(sizeof(AICacheSpill));
+            spilled->model_name = pstrdup(data);
+            spilled->args_hash = pstrdup(entry->key.args_hash);
+            spilled->result = pstrdup(data + entry->model_len + 1);
+            spilled->expiry_time = entry->expiry_time;
+        }
+
+        dsa_free(ai_cache_area, entry->data);
+    }
+
+    /* Keep the ring dense by moving the last entry into the hole */
+    last = ai_cache_state->ring[--ai_cache_state->nentries];
+    ai_cache_state->ring[slot] = last;
+    last->slot = slot;
+    ai_cache_state->ring[ai_cache_state->nentries] = NULL;
+
+    hash_search(ai_cache_hash, &entry->key, HASH_REMOVE, NULL);
+
+    return spilled;
+}
+
+/*
+ * Store a result in the shared cache, evicting entries as needed. Returns the
+ * evicted entries that should be spilled to the table.
+ */
+static List *
+shared_cache_store(const char *model_name, const char *args_hash,
+                   const char *result, TimestampTz expiry_time)
+{
+    AICacheKey key;
+    AICacheEntry *entry;
+    AICacheEntry *victim;
+    AICacheSpill *spilled;
+    Size model_len = strlen(model_name);
+    Size result_len = strlen(result);
+    dsa_pointer data;
+    char *ptr;
+    bool found;
+    List *spills = NIL;
+
+    ai_cache_make_key(&key, model_name, args_hash);
+
+    LWLockAcquire(ai_cache_state->lock, LW_EXCLUSIVE);
+
+    /* Replace an existing result */
+    entry = (AICacheEntry *) hash_search(ai_cache_hash, &key, HASH_FIND, NULL);
+    if (entry != NULL && DsaPointerIsValid(entry->data)) {
+        dsa_free(ai_cache_area, entry->data);
+        entry->data = InvalidDsaPointer;
+    }
+
+    /* Make room for the result text */
+    for (;;) {
+        data = dsa_allocate_extended(ai_cache_area, model_len + result_len + 2,
+                                     DSA_ALLOC_NO_OOM);
+        if (DsaPointerIsValid(data))
+            break;
+
+        victim = shared_cache_victim(entry);
+        if (victim == NULL)
+            break;
+
+        spilled = shared_cache_evict(victim, ai_cache_spill_to_table);
+        if (spilled != NULL)
+            spills = lappend(spills, spilled);
+        pg_atomic_fetch_add_u64(&ai_cache_state->counters.evictions, 1);
+    }
+
+    /* Too large for the cache, so it can only go to the table */
+    if (!DsaPointerIsValid(data)) {
+        if (entry != NULL)
+            shared_cache_evict(entry, false);
+
+        LWLockRelease(ai_cache_state->lock);
+
+        if (ai_cache_spill_to_table) {
+            spilled = (AICacheSpill *) palloc(sizeof(AICacheSpill));
+            spilled->model_name = pstrdup(model_name);
+            spilled->args_hash = pstrdup(args_hash);
+            spilled->result = pstrdup(result);
+            spilled->expiry_time = expiry_time;
+            spills = lappend(spills, spilled);
+        }
+
+        return spills;
+    }
+
+    if (entry == NULL) {
+        if (ai_cache_state->nentries >= ai_cache_max_entries) {
+            victim = shared_cache_victim(NULL);
+            spilled = shared_cache_evict(victim, ai_cache_spill_to_table);
+            if (spilled != NULL)
+                spills = lappend(spills, spilled);
+            pg_atomic_fetch_add_u64(&ai_cache_state->counters.evictions, 1);
+        }
+
+        entry = (AICacheEntry *) hash_search(ai_cache_hash, &key, HASH_ENTER, &found);
+        Assert(!found);
+        entry->slot = ai_cache_state->nentries;
+        ai_cache_state->ring[ai_cache_state->nentries++] = entry;
+    }
+
+    ptr = dsa_get_address(ai_cache_area, data);
+    memcpy(ptr, model_name, model_len + 1);
+    memcpy(ptr + model_len + 1, result, result_len + 1);
+
+    entry->referenced = false;
+    entry->created_time = GetCurrentTimestamp();
+    entry->expiry_time = expiry_time;
+    entry->data = data;
+    entry->model_len = model_len;
+
+    LWLockRelease(ai_cache_state->lock);
+
+    return spills;
+}
+
+/* Remove all entries, or only expired ones, from the shared cache */
+static int
+shared_cache_clear(bool clear_all)
+{
+    TimestampTz now = GetCurrentTimestamp();
+    int removed = 0;
+
+    LWLockAcquire(ai_cache_state->lock, LW_EXCLUSIVE);
+
+    /* Walk backwards since eviction moves the last entry into the hole */
+    for (int i = ai_cache_state->nentries - 1; i >= 0; i--) {
+        AICacheEntry *entry = ai_cache_state->ring[i];
+
+        if (clear_all || entry->expiry_time <= now) {
+            shared_cache_evict(entry, false);
+            removed++;
+        }
+    }
+
+    LWLockRelease(ai_cache_state->lock);
+
+    return removed;
+}
+
+/* Write entries evicted from the shared cache to the table */
+static void
+spill_cache_entries(List *spilled)
+{
+    ListCell *lc;
+    Oid argtypes[5] = {TEXTOID, TEXTOID, TEXTOID, TEXTOID, TIMESTAMPTZOID};
+
+    if (spilled == NIL)
+        return;
+
+    if (SPI_connect() != SPI_OK_CONNECT)
+        return;
+
+    foreach(lc, spilled) {
+        AICacheSpill *spill = (AICacheSpill *) lfirst(lc);
+        char *content_hash = compute_content_hash(spill->result);
+        Datum values[5];
+
+        values[0] = CStringGetTextDatum(spill->model_name);
+        values[1] = CStringGetTextDatum(spill->args_hash);
+        values[2] = CStringGetTextDatum(content_hash);
+        values[3] = CStringGetTextDatum(spill->result);
+        values[4] = TimestampTzGetDatum(spill->expiry_time);
+
+        SPI_execute_with_args(
+            "INSERT INTO ai.result_cache "
+            "(model_name, args_hash, content_hash, result_text, "
+            " created_time, expiry_time, access_count) "
+            "VALUES ($1, $2, $3, $4, now(), $5, 1) "
+            "ON CONFLICT (model_name, args_hash) DO UPDATE SET "
+            "result_text = EXCLUDED.result_text, "
+            "expiry_time = EXCLUDED.expiry_time",
+            5, argtypes, values, NULL, false, 0);
+
+        pg_atomic_fetch_add_u64(&ai_cache_get_counters()->spills, 1);
+    }
+
+    SPI_finish();
+}
+
 /* Enhanced _PG_init function (add to existing) */
 void _PG_init_cache_enhancement(void)
 {
@@ -504,4 +1009,38 @@ void _PG_init_cache_enhancement(void)
         0,
         NULL, NULL, NULL
     );
+
+    DefineCustomIntVariable(
+        "ai.cache_memory",
+        "Maximum memory for AI results in the shared cache",
+        "Entries are evicted when results exceed this size.",
+        &ai_cache_memory,
+        64,
+        4,
+        MAX_KILOBYTES / 1024,
+        PGC_POSTMASTER,
+        GUC_UNIT_MB,
+        NULL, NULL, NULL
+    );
+
+    DefineCustomBoolVariable(
+        "ai.cache_spill_to_table",
+        "Write entries evicted from the shared cache to ai.result_cache",
+        "Spilled entries are looked up when the shared cache misses.",
+        &ai_cache_spill_to_table,
+        true,
+        PGC_SUSET,
+        0,
+        NULL, NULL, NULL
+    );
+
+    /* The shared cache needs shared_preload_libraries */
+    if (!process_shared_preload_libraries_in_progress)
+        return;
+
+    RequestAddinShmemSpace(ai_cache_shmem_size());
+    RequestNamedLWLockTranche("ai_result_cache", 1);
+
+    prev_shmem_startup_hook = shmem_startup_hook;
+    shmem_startup_hook = ai_cache_shmem_startup;
 }
\ No newline at end of file
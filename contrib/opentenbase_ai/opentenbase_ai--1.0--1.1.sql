@@ -79,7 +79,11 @@ RETURNS TABLE (
     current_entries INTEGER,
     max_entries INTEGER,
     cache_enabled BOOLEAN,
-    batch_requests BIGINT
+    batch_requests BIGINT,
+    avg_hit_latency_us FLOAT8,
+    avg_miss_latency_us FLOAT8,
+    evictions BIGINT,
+    spills BIGINT
 ) AS 'MODULE_PATHNAME', 'ai_cache_stats'
 LANGUAGE C;
 
@@ -670,6 +670,244 @@ BEGIN
 END;
 $$ LANGUAGE plpgsql;
 
+-- Invoke a model for every element of user_args with concurrent HTTP
+-- requests, returning the raw response contents in input order. Up to
+-- ai.max_concurrent_requests requests are in flight at once.
+CREATE OR REPLACE FUNCTION ai.raw_invoke_model_multi(
+    model_name_v text,
+    user_args jsonb[]
+) RETURNS text[] AS 'MODULE_PATHNAME', 'ai_invoke_model_multi'
+LANGUAGE C STRICT VOLATILE;
+
+-- Multi-row version of invoke_model, e.g. for all rows of a table:
+--   SELECT ai.invoke_model_multi('model', array_agg(args ORDER BY id)) FROM t;
+CREATE OR REPLACE FUNCTION ai.invoke_model_multi(
+    model_name_v text,
+    user_args jsonb[]
+) RETURNS text[] AS $$
+DECLARE
+    model_name text;
+    json_path_v text;
+    response_content text;
+    result text;
+    results text[] := '{}';
+BEGIN
+    SELECT m.model_name, m.json_path
+    FROM public.ai_model_list m
+    WHERE m.model_name = model_name_v
+    INTO model_name, json_path_v;
+
+    IF model_name IS NULL THEN
+        RAISE EXCEPTION 'Model % not found', model_name_v;
+    END IF;
+
+    IF json_path_v IS NULL THEN
+        RAISE EXCEPTION 'Invalid json path for model %', model_name_v;
+    END IF;
+
+    FOREACH response_content IN ARRAY ai.raw_invoke_model_multi(model_name_v, user_args)
+    LOOP
+        result := NULL;
+        IF response_content IS NOT NULL THEN
+            EXECUTE format(json_path_v, response_content) INTO result;
+        END IF;
+        results := array_append(results, result);
+    END LOOP;
+
+    RETURN results;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Embedding columns: a column kept equal to the embedding of another column
+-- of the same table. A trigger queues the key of each changed row, and
+-- ai.process_embedding_queue() embeds queued rows in batches, either from
+-- the embedding worker (ai.embedding_worker_database) or when called.
+CREATE TABLE ai.embedding_columns (
+    relid regclass NOT NULL,
+    target_column name NOT NULL,
+    source_column name NOT NULL,
+    key_column name NOT NULL,
+    model_name text NOT NULL,
+    batch_size integer NOT NULL DEFAULT 64 CHECK (batch_size > 0),
+    PRIMARY KEY (relid, target_column)
+) DISTRIBUTE BY REPLICATION;
+
+CREATE TABLE ai.embedding_queue (
+    id BIGSERIAL,
+    relid regclass NOT NULL,
+    target_column name NOT NULL,
+    key_value text NOT NULL,
+    attempts integer NOT NULL DEFAULT 0,
+    last_error text,
+    queued_at timestamptz NOT NULL DEFAULT now()
+) DISTRIBUTE BY HASH(key_value);
+
+CREATE INDEX embedding_queue_column_idx ON ai.embedding_queue (relid, target_column, id);
+
+-- Row trigger of an embedding column, arguments are the key column and
+-- the target column. Only the key is queued, so writes never wait on
+-- the model. Runs as the extension owner so writers of the table need
+-- no privileges on the queue.
+CREATE OR REPLACE FUNCTION ai.embedding_queue_trigger()
+RETURNS trigger AS $$
+BEGIN
+    INSERT INTO ai.embedding_queue (relid, target_column, key_value)
+    VALUES (TG_RELID, TG_ARGV[1], to_jsonb(NEW) ->> TG_ARGV[0]);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql SECURITY DEFINER SET search_path = pg_catalog, pg_temp;
+
+-- Keep target_column of table_name filled with the embedding of
+-- source_column. Rows are identified by key_column, which defaults to the
+-- single column primary key. Existing rows are queued immediately.
+CREATE OR REPLACE FUNCTION ai.create_embedding_column(
+    table_name regclass,
+    source_column name,
+    target_column name,
+    model_name text = NULL,
+    key_column name = NULL,
+    batch_size integer = 64
+) RETURNS void AS $$
+DECLARE
+    model_name_v text;
+    key_column_v name;
+BEGIN
+    model_name_v := COALESCE(model_name, current_setting('ai.embedding_model', true));
+
+    IF model_name_v IS NULL THEN
+        RAISE EXCEPTION 'Embedding model name is not set';
+    END IF;
+
+    key_column_v := key_column;
+    IF key_column_v IS NULL THEN
+        SELECT a.attname INTO key_column_v
+        FROM pg_index i
+        JOIN pg_attribute a ON a.attrelid = i.indrelid AND a.attnum = i.indkey[0]
+        WHERE i.indrelid = table_name AND i.indisprimary AND i.indnatts = 1;
+
+        IF key_column_v IS NULL THEN
+            RAISE EXCEPTION 'Table % has no single column primary key, key_column must be given', table_name;
+        END IF;
+    END IF;
+
+    IF NOT EXISTS (SELECT 1 FROM pg_attribute
+                   WHERE attrelid = table_name AND attname = target_column
+                     AND attnum > 0 AND NOT attisdropped) THEN
+        RAISE EXCEPTION 'Column "%" of table % does not exist', target_column, table_name;
+    END IF;
+
+    INSERT INTO ai.embedding_columns
+    VALUES (table_name, target_column, source_column, key_column_v, model_name_v, batch_size);
+
+    EXECUTE format('CREATE TRIGGER %I AFTER INSERT OR UPDATE OF %I ON %s '
+                   'FOR EACH ROW EXECUTE PROCEDURE ai.embedding_queue_trigger(%L, %L)',
+                   'ai_embedding_' || target_column, source_column, table_name,
+                   key_column_v, target_column);
+
+    EXECUTE format('INSERT INTO ai.embedding_queue (relid, target_column, key_value) '
+                   'SELECT %L::regclass, %L, %I::text FROM %s WHERE %I IS NOT NULL',
+                   table_name, target_column, key_column_v, table_name, source_column);
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION ai.drop_embedding_column(
+    table_name regclass,
+    target_column name
+) RETURNS void AS $$
+BEGIN
+    EXECUTE format('DROP TRIGGER IF EXISTS %I ON %s',
+                   'ai_embedding_' || target_column, table_name);
+
+    DELETE FROM ai.embedding_queue q
+    WHERE q.relid = table_name AND q.target_column = drop_embedding_column.target_column;
+
+    DELETE FROM ai.embedding_columns c
+    WHERE c.relid = table_name AND c.target_column = drop_embedding_column.target_column;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Embed up to max_batches batches of queued rows and return the number of
+-- rows updated. The requests of a batch run concurrently through
+-- ai.invoke_model_multi and the batch is written with one UPDATE. A batch
+-- that fails stays queued; rows are skipped after 5 failed attempts and
+-- keep their last error in ai.embedding_queue.
+CREATE OR REPLACE FUNCTION ai.process_embedding_queue(max_batches integer = 10)
+RETURNS integer AS $$
+DECLARE
+    col record;
+    target_type text;
+    ids bigint[];
+    keys text[];
+    inputs text[];
+    args jsonb[];
+    embeddings text[];
+    batches integer := 0;
+    processed integer := 0;
+BEGIN
+    FOR col IN SELECT * FROM ai.embedding_columns ORDER BY relid::oid, target_column
+    LOOP
+        SELECT format_type(a.atttypid, a.atttypmod) INTO target_type
+        FROM pg_attribute a
+        WHERE a.attrelid = col.relid AND a.attname = col.target_column;
+
+        LOOP
+            EXIT WHEN batches >= max_batches;
+
+            SELECT array_agg(q.id), array_agg(DISTINCT q.key_value)
+            INTO ids, keys
+            FROM (SELECT e.id, e.key_value
+                  FROM ai.embedding_queue e
+                  WHERE e.relid = col.relid AND e.target_column = col.target_column
+                    AND e.attempts < 5
+                  ORDER BY e.id
+                  LIMIT col.batch_size) q;
+
+            EXIT WHEN ids IS NULL;
+            batches := batches + 1;
+
+            BEGIN
+                -- Rows whose source was cleared lose their embedding
+                EXECUTE format('UPDATE %s SET %I = NULL WHERE %I::text = ANY ($1) AND %I IS NULL',
+                               col.relid, col.target_column, col.key_column, col.source_column)
+                USING keys;
+
+                -- Deleted rows simply drop out here
+                EXECUTE format('SELECT array_agg(%I::text), array_agg(%I::text) FROM %s '
+                               'WHERE %I::text = ANY ($1) AND %I IS NOT NULL',
+                               col.key_column, col.source_column, col.relid,
+                               col.key_column, col.source_column)
+                INTO keys, inputs
+                USING keys;
+
+                IF keys IS NOT NULL THEN
+                    SELECT array_agg(jsonb_build_object('input', u.input) ORDER BY u.n)
+                    INTO args
+                    FROM unnest(inputs) WITH ORDINALITY AS u(input, n);
+
+                    embeddings := ai.invoke_model_multi(col.model_name, args);
+
+                    EXECUTE format('UPDATE %s t SET %I = e.embedding::%s '
+                                   'FROM unnest($1, $2) AS e(key_value, embedding) '
+                                   'WHERE t.%I::text = e.key_value',
+                                   col.relid, col.target_column, target_type, col.key_column)
+                    USING keys, embeddings;
+
+                    processed := processed + array_length(keys, 1);
+                END IF;
+
+                DELETE FROM ai.embedding_queue WHERE id = ANY (ids);
+            EXCEPTION WHEN OTHERS THEN
+                UPDATE ai.embedding_queue
+                SET attempts = attempts + 1, last_error = SQLERRM
+                WHERE id = ANY (ids);
+            END;
+        END LOOP;
+    END LOOP;
+
+    RETURN processed;
+END;
+$$ LANGUAGE plpgsql;
+
 -- Utility function to get batch processing status
 CREATE OR REPLACE FUNCTION ai.batch_status()
 RETURNS table(
@@ -681,7 +919,8 @@ BEGIN
     RETURN QUERY VALUES
         ('batch_size'::text, current_setting('ai.batch_size', true)::text, 'Number of requests to batch together'::text),
         ('batch_timeout_ms'::text, current_setting('ai.batch_timeout_ms', true)::text, 'Maximum wait time before processing batch'::text),
-        ('enable_batch_processing'::text, current_setting('ai.enable_batch_processing', true)::text, 'Whether batch processing is enabled'::text);
+        ('enable_batch_processing'::text, current_setting('ai.enable_batch_processing', true)::text, 'Whether batch processing is enabled'::text),
+        ('max_concurrent_requests'::text, current_setting('ai.max_concurrent_requests', true)::text, 'Max number of requests in flight for invoke_model_multi'::text);
 END;
 $$ LANGUAGE plpgsql;
 
@@ -743,3 +982,8 @@ GRANT EXECUTE ON FUNCTION ai.batch_completion(text[], text, jsonb) TO PUBLIC;
 GRANT EXECUTE ON FUNCTION ai.batch_embedding(text[], text, jsonb) TO PUBLIC;
 GRANT EXECUTE ON FUNCTION ai.batch_status() TO PUBLIC;
 GRANT EXECUTE ON FUNCTION ai.process_table_batch(text, text, text, text, integer, text) TO PUBLIC;
+GRANT EXECUTE ON FUNCTION ai.raw_invoke_model_multi(text, jsonb[]) TO PUBLIC;
+GRANT EXECUTE ON FUNCTION ai.invoke_model_multi(text, jsonb[]) TO PUBLIC;
+REVOKE EXECUTE ON FUNCTION ai.create_embedding_column(regclass, name, name, text, name, integer) FROM PUBLIC;
+REVOKE EXECUTE ON FUNCTION ai.drop_embedding_column(regclass, name) FROM PUBLIC;
+REVOKE EXECUTE ON FUNCTION ai.process_embedding_queue(integer) FROM PUBLIC;
@@ -0,0 +1,53 @@
+-- Test setup
+CREATE EXTENSION IF NOT EXISTS http;
+CREATE EXTENSION IF NOT EXISTS vector;
+CREATE EXTENSION IF NOT EXISTS opentenbase_ai;
+ALTER EXTENSION opentenbase_ai UPDATE TO '1.1';
+SELECT ai.cache_clear(true);
+
+-- Test 1: Add a model that echoes the prompt back
+SELECT ai.add_model(
+    'cache_test_model',
+    ARRAY[ROW('Content-Type', 'application/json')::http_header],
+    'https://httpbin.org/post',
+    '{}'::jsonb,
+    'test-provider',
+    'POST',
+    'application/json',
+    'SELECT %L::jsonb->''json''->>''prompt'''
+);
+
+-- Test 2: The first call misses and stores the result, the second one hits
+SELECT ai.invoke_model_cached('cache_test_model', '{"prompt": "cached hello"}', 3600);
+SELECT ai.invoke_model_cached('cache_test_model', '{"prompt": "cached hello"}', 3600);
+
+-- Test 3: Cache hits don't call the model, so they work with a broken uri
+SELECT ai.update_model('cache_test_model', 'uri', 'http://127.0.0.1:1/');
+SELECT ai.invoke_model_cached('cache_test_model', '{"prompt": "cached hello"}', 3600);
+SELECT total_requests, cache_hits, cache_misses FROM ai.cache_stats();
+SELECT model_name, result_text FROM ai.result_cache;
+
+-- Test 4: Batch invocations are served from entries stored under the merged args
+INSERT INTO ai.result_cache (model_name, args_hash, result_text, expiry_time)
+SELECT 'cache_test_model', lpad(to_hex(hashtextextended(args::text, 0)), 16, '0'),
+       'seeded ' || i, now() + interval '1 hour'
+FROM (VALUES (1, '{"input": "first"}'::jsonb), (2, '{"input": "second"}'::jsonb)) v(i, args);
+SELECT ai.batch_invoke_cached('cache_test_model', ARRAY['first', 'second'], '{}', 3600);
+SELECT total_requests, cache_hits, cache_misses, batch_requests FROM ai.cache_stats();
+
+-- Test 5: Expired entries are removed by a partial clear
+UPDATE ai.result_cache SET expiry_time = now() - interval '1 second'
+WHERE result_text = 'seeded 2';
+SELECT ai.cache_clear(false);
+SELECT count(*) AS remaining_entries FROM ai.result_cache;
+
+-- Test 6: Clearing everything empties the cache and resets the counters
+SELECT ai.cache_clear(true);
+SELECT count(*) AS remaining_entries FROM ai.result_cache;
+SELECT total_requests, cache_hits, cache_misses FROM ai.cache_stats();
+
+-- Clean up
+SELECT ai.delete_model('cache_test_model');
+DROP EXTENSION IF EXISTS opentenbase_ai CASCADE;
+DROP EXTENSION IF EXISTS vector;
+DROP EXTENSION IF EXISTS http;
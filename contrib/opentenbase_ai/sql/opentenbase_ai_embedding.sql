@@ -0,0 +1,59 @@
+-- Test setup
+CREATE EXTENSION IF NOT EXISTS http;
+CREATE EXTENSION IF NOT EXISTS opentenbase_ai;
+
+-- Test 1: Add a model whose "embedding" is the input echoed back
+SELECT ai.add_model(
+    'embedding_test_model',
+    ARRAY[]::http_header[],
+    'https://httpbin.org/post',
+    '{}'::jsonb,
+    'test-provider',
+    'POST',
+    'application/json',
+    'SELECT %L::jsonb->''json''->>''input'''
+);
+CREATE TABLE test_embedded (id int PRIMARY KEY, body text, body_embedding text) DISTRIBUTE BY HASH(id);
+INSERT INTO test_embedded VALUES (1, 'first'), (2, 'second');
+
+-- Test 2: Existing rows and new rows are queued
+SELECT ai.create_embedding_column('test_embedded', 'body', 'body_embedding', 'embedding_test_model');
+INSERT INTO test_embedded VALUES (3, 'third');
+SELECT count(*) AS queued FROM ai.embedding_queue WHERE relid = 'test_embedded'::regclass;
+
+-- Test 3: Processing the queue fills the column and empties the queue
+SELECT ai.process_embedding_queue() AS embedded;
+SELECT * FROM test_embedded ORDER BY id;
+SELECT count(*) AS queued FROM ai.embedding_queue WHERE relid = 'test_embedded'::regclass;
+
+-- Test 4: Updates of the source column are queued, other columns are not
+UPDATE test_embedded SET body = 'second v2' WHERE id = 2;
+UPDATE test_embedded SET body = NULL WHERE id = 3;
+UPDATE test_embedded SET body_embedding = 'stale' WHERE id = 1;
+SELECT count(*) AS queued FROM ai.embedding_queue WHERE relid = 'test_embedded'::regclass;
+SELECT ai.process_embedding_queue() AS embedded;
+SELECT * FROM test_embedded ORDER BY id;
+
+-- Test 5: Queued rows that were deleted are dropped
+INSERT INTO test_embedded VALUES (4, 'fourth');
+DELETE FROM test_embedded WHERE id = 4;
+SELECT ai.process_embedding_queue() AS embedded;
+SELECT count(*) AS queued FROM ai.embedding_queue WHERE relid = 'test_embedded'::regclass;
+
+-- Test 6: Check the arguments
+CREATE TABLE test_embedded_nopk (id int, body text, body_embedding text) DISTRIBUTE BY HASH(id);
+SELECT ai.create_embedding_column('test_embedded_nopk', 'body', 'body_embedding', 'embedding_test_model');
+SELECT ai.create_embedding_column('test_embedded', 'body', 'no_such_column', 'embedding_test_model');
+DROP TABLE test_embedded_nopk;
+
+-- Test 7: Dropping the embedding column stops the queueing
+SELECT ai.drop_embedding_column('test_embedded', 'body_embedding');
+INSERT INTO test_embedded VALUES (5, 'fifth');
+SELECT count(*) AS queued FROM ai.embedding_queue WHERE relid = 'test_embedded'::regclass;
+SELECT count(*) AS embedding_columns FROM ai.embedding_columns WHERE relid = 'test_embedded'::regclass;
+
+-- Clean up
+DROP TABLE test_embedded;
+SELECT ai.delete_model('embedding_test_model');
+DROP EXTENSION IF EXISTS opentenbase_ai;
+DROP EXTENSION IF EXISTS http;
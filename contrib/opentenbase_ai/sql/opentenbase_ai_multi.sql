@@ -0,0 +1,51 @@
+-- Test setup
+CREATE EXTENSION IF NOT EXISTS http;
+CREATE EXTENSION IF NOT EXISTS opentenbase_ai;
+
+-- Test 1: Add a model that echoes the prompt back
+SELECT ai.add_model(
+    'multi_test_model',
+    ARRAY[]::http_header[],
+    'https://httpbin.org/post',
+    '{}'::jsonb,
+    'test-provider',
+    'POST',
+    'application/json',
+    'SELECT %L::jsonb->''json''->>''prompt'''
+);
+
+-- Test 2: Concurrent requests keep input order, and NULL inputs give NULL
+SET ai.max_concurrent_requests = 2;
+SELECT ai.invoke_model_multi('multi_test_model',
+    ARRAY['{"prompt": "row 1"}', '{"prompt": "row 2"}', NULL,
+          '{"prompt": "row 4"}', '{"prompt": "row 5"}']::jsonb[]);
+RESET ai.max_concurrent_requests;
+
+-- Test 3: The raw version returns the whole responses
+SELECT array_length(r, 1) AS responses,
+       r[2] IS NULL AS null_kept,
+       (r[3]::jsonb)->'json'->>'prompt' AS third_prompt
+FROM ai.raw_invoke_model_multi('multi_test_model',
+    ARRAY['{"prompt": "row 1"}', NULL, '{"prompt": "row 3"}']::jsonb[]) r;
+
+-- Test 4: One request per element of an aggregated column
+CREATE TABLE test_multi (id int PRIMARY KEY, prompt text) DISTRIBUTE BY HASH(id);
+INSERT INTO test_multi SELECT i, 'prompt ' || i FROM generate_series(1, 6) i;
+SELECT unnest(ai.invoke_model_multi('multi_test_model',
+                                    array_agg(jsonb_build_object('prompt', prompt) ORDER BY id)))
+FROM test_multi;
+DROP TABLE test_multi;
+
+-- Test 5: Empty input and unknown models
+SELECT ai.raw_invoke_model_multi('multi_test_model', '{}'::jsonb[]);
+SELECT ai.raw_invoke_model_multi('no_such_model', ARRAY['{}']::jsonb[]);
+SELECT ai.invoke_model_multi('no_such_model', ARRAY['{}']::jsonb[]);
+
+-- Test 6: Check the limit on concurrent requests
+SELECT ai.configure_batch('max_concurrent_requests', 0);
+SELECT * FROM ai.batch_status() WHERE parameter = 'max_concurrent_requests';
+
+-- Clean up
+SELECT ai.delete_model('multi_test_model');
+DROP EXTENSION IF EXISTS opentenbase_ai;
+DROP EXTENSION IF EXISTS http;
@@ -0,0 +1,68 @@
+-- Test setup
+CREATE EXTENSION IF NOT EXISTS http;
+CREATE EXTENSION IF NOT EXISTS vector;
+CREATE EXTENSION IF NOT EXISTS opentenbase_ai;
+ALTER EXTENSION opentenbase_ai UPDATE TO '1.1';
+SELECT ai.cache_clear(true);
+
+-- Test 1: The library is preloaded, so results are kept in shared memory
+SHOW ai.cache_max_entries;
+SELECT current_entries, evictions, spills FROM ai.cache_stats();
+
+-- Test 2: Fill the cache past its capacity. Every call is answered from
+-- ai.result_cache and promotes the entry into shared memory, which evicts
+-- the oldest entries once the cache is full and spills them to the table.
+INSERT INTO ai.result_cache (model_name, args_hash, result_text, expiry_time)
+SELECT 'shared_cache_model',
+       lpad(to_hex(hashtextextended(jsonb_build_object('prompt', 'p' || i)::text, 0)), 16, '0'),
+       'result ' || i, now() + interval '1 hour'
+FROM generate_series(1, 150) i;
+DO $$
+BEGIN
+    FOR i IN 1..150 LOOP
+        PERFORM ai.invoke_model_cached('shared_cache_model',
+                                       jsonb_build_object('prompt', 'p' || i), 3600);
+    END LOOP;
+END
+$$;
+SELECT total_requests, cache_hits, cache_misses, current_entries, evictions, spills
+FROM ai.cache_stats();
+SELECT count(*) AS table_entries FROM ai.result_cache;
+
+-- Test 3: Entries still in shared memory are hits without the table
+DELETE FROM ai.result_cache;
+DO $$
+BEGIN
+    FOR i IN 51..60 LOOP
+        PERFORM ai.invoke_model_cached('shared_cache_model',
+                                       jsonb_build_object('prompt', 'p' || i), 3600);
+    END LOOP;
+END
+$$;
+SELECT total_requests, cache_hits, cache_misses, current_entries, evictions, spills
+FROM ai.cache_stats();
+
+-- Test 4: CLOCK eviction passes over the entries that were just hit, so the
+-- next unreferenced one (p61) is evicted and spilled to the table
+INSERT INTO ai.result_cache (model_name, args_hash, result_text, expiry_time)
+VALUES ('shared_cache_model',
+        lpad(to_hex(hashtextextended('{"prompt": "p151"}', 0)), 16, '0'),
+        'result 151', now() + interval '1 hour');
+SELECT ai.invoke_model_cached('shared_cache_model', '{"prompt": "p151"}', 3600);
+SELECT result_text FROM ai.result_cache ORDER BY result_text;
+SELECT ai.invoke_model_cached('shared_cache_model', '{"prompt": "p51"}', 3600);
+
+-- Test 5: A spilled entry is promoted back, evicting the next one
+SELECT ai.invoke_model_cached('shared_cache_model', '{"prompt": "p61"}', 3600);
+SELECT result_text FROM ai.result_cache ORDER BY result_text;
+SELECT total_requests, cache_hits, cache_misses, hit_ratio_percent, current_entries, evictions, spills
+FROM ai.cache_stats();
+
+-- Test 6: Clearing empties both shared memory and the table
+SELECT ai.cache_clear(true);
+SELECT total_requests, current_entries FROM ai.cache_stats();
+
+-- Clean up
+DROP EXTENSION IF EXISTS opentenbase_ai CASCADE;
+DROP EXTENSION IF EXISTS vector;
+DROP EXTENSION IF EXISTS http;
@@ -0,0 +1,10 @@
+CREATE FUNCTION http_send(request @extschema@.http_request)
+    RETURNS integer
+    AS 'MODULE_PATHNAME', 'http_send'
+    LANGUAGE 'c';
+
+CREATE FUNCTION http_fetch(id integer)
+    RETURNS http_response
+    AS 'MODULE_PATHNAME', 'http_fetch'
+    LANGUAGE 'c'
+    STRICT;
@@ -51,6 +51,17 @@ CREATE FUNCTION http(request @extschema@.http_request)
     AS 'MODULE_PATHNAME', 'http_request'
     LANGUAGE 'c';
 
+CREATE FUNCTION http_send(request @extschema@.http_request)
+    RETURNS integer
+    AS 'MODULE_PATHNAME', 'http_send'
+    LANGUAGE 'c';
+
+CREATE FUNCTION http_fetch(id integer)
+    RETURNS http_response
+    AS 'MODULE_PATHNAME', 'http_fetch'
+    LANGUAGE 'c'
+    STRICT;
+
 CREATE FUNCTION http_get(uri VARCHAR)
     RETURNS http_response
     AS $$ SELECT @extschema@.http(('GET', $1, NULL, NULL, NULL)::@extschema@.http_request) $$
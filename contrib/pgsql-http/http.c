@@ -28,7 +28,7 @@
  ***********************************************************************/
 
 /* Constants */
-#define HTTP_VERSION "1.7"
+#define HTTP_VERSION "1.8"
 #define HTTP_ENCODING "gzip"
 #define CURL_MIN_VERSION 0x071400 /* 7.20.0 */
 
@@ -65,6 +65,8 @@
 #include <utils/typcache.h>
 #include <utils/fmgroids.h>
 #include <utils/guc.h>
+#include <utils/memutils.h>
+#include <access/xact.h>
 
 #if PG_VERSION_NUM >= 90300
 #  include <access/htup_details.h>
@@ -122,6 +124,25 @@ enum {
 	HEADER_VALUE = 1
 } http_header_type;
 
+/*
+* State of one transfer. The synchronous http() function uses one on the
+* stack with the global handle, http_send() allocates one with its own
+* handle and memory context that lives until http_fetch() or the end of
+* the transaction.
+*/
+typedef struct {
+	int id;
+	CURL *handle;
+	MemoryContext context;
+	struct curl_slist *headers;
+	StringInfoData si_data;
+	StringInfoData si_headers;
+	StringInfoData si_read;
+	bool done;
+	CURLcode result;
+	char error_buffer[CURL_ERROR_SIZE];
+} http_transfer;
+
 /*
  * String/Long for strings and numbers, blob only for
  * CURLOPT_SSLKEY_BLOB and CURLOPT_SSLCERT_BLOB
@@ -203,9 +224,20 @@ void _PG_init(void);
 void _PG_fini(void);
 static size_t http_writeback(void *contents, size_t size, size_t nmemb, void *userp);
 static size_t http_readback(void *buffer, size_t size, size_t nitems, void *instream);
+static void http_xact_callback(XactEvent event, void *arg);
 
 /* Global variables */
 CURL * g_http_handle = NULL;
+CURLSH * g_http_share = NULL;
+CURLM * g_http_multi = NULL;
+
+/* GUC variables */
+static bool http_connection_pool = false;
+static int http_max_host_connections = 8;
+
+/* Transfers started by http_send() and not yet fetched */
+static List *http_pending = NIL;
+static int http_next_id = 1;
 
 /*
 * Interrupt support is dependent on CURLOPT_XFERINFOFUNCTION which
@@ -377,6 +409,31 @@ void _PG_init(void)
 	 */
 	http_guc_init();
 
+	DefineCustomBoolVariable(
+		"http.connection_pool",
+		"Share connections, TLS sessions and DNS lookups between requests.",
+		"Connections are held open for reuse and HTTP/2 is negotiated "
+		"on TLS connections, so concurrent requests sent with http_send() "
+		"to the same host are multiplexed over one connection.",
+		&http_connection_pool,
+		false,
+		PGC_USERSET,
+		0, NULL, NULL, NULL
+		);
+
+	DefineCustomIntVariable(
+		"http.max_host_connections",
+		"Maximum number of connections to one host used by http_send().",
+		"Further requests to the host are queued. Zero means no limit.",
+		&http_max_host_connections,
+		8, 0, 1000,
+		PGC_USERSET,
+		0, NULL, NULL, NULL
+		);
+
+	/* Transfers started by http_send() end with the transaction */
+	RegisterXactCallback(http_xact_callback, NULL);
+
 #ifdef HTTP_MEM_CALLBACKS
 	/*
 	* Use PgSQL memory management in Curl
@@ -400,12 +457,24 @@ void _PG_init(void)
 /* Tear-down */
 void _PG_fini(void)
 {
+	if (g_http_multi)
+	{
+		curl_multi_cleanup(g_http_multi);
+		g_http_multi = NULL;
+	}
+
 	if (g_http_handle)
 	{
 		curl_easy_cleanup(g_http_handle);
 		g_http_handle = NULL;
 	}
 
+	if (g_http_share)
+	{
+		curl_share_cleanup(g_http_share);
+		g_http_share = NULL;
+	}
+
 	curl_global_cleanup();
 	elog(NOTICE, "Goodbye from HTTP %s", HTTP_VERSION);
 }
@@ -441,7 +510,7 @@ http_readback(void *buffer, size_t size, size_t nitems, void *instream)
 	return readsize;
 }
 
-static void
+static void pg_attribute_noreturn()
 http_error(CURLcode err, const char *error_buffer)
 {
 	if ( strlen(error_buffer) > 0 )
@@ -456,7 +525,6 @@ http_error(CURLcode err, const char *error_buffer)
 	if ( err != CURLE_OK ) \
 	{ \
 		http_error(err, http_error_buffer); \
-		PG_RETURN_NULL(); \
 	} \
 	} while (0);
 
@@ -858,25 +926,67 @@ set_curlopt(CURL* handle, const http_curlopt *opt)
 	return true;
 }
 
-/* Check/create the global CURL* handle */
-static CURL *
-http_get_handle()
+/* Are connections held open after a request? */
+static bool
+http_keep_connection(void)
 {
-	CURL *handle = g_http_handle;
-	http_curlopt *opt = settable_curlopts;
+	return http_connection_pool || curlopt_is_set(CURLOPT_TCP_KEEPALIVE);
+}
 
-	/* Initialize the global handle if needed */
-	if (!handle)
+/*
+* The share handle holds the connection cache, TLS session cache and
+* DNS cache of the session. Attaching it to every handle lets requests
+* on new handles, such as those from http_send(), pick up connections
+* and TLS sessions established by earlier requests.
+*/
+static CURLSH *
+http_get_share(void)
+{
+	if (!g_http_share)
 	{
-		handle = curl_easy_init();
+		CURLSH *share = curl_share_init();
+		if (!share)
+			ereport(ERROR, (errmsg("Unable to initialize CURL share handle")));
+
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900 /* 7.57.0 */
+		curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+		g_http_share = share;
 	}
-	/* Always reset because we are going to fill in the user */
-	/* set options down below */
-	else
+	return g_http_share;
+}
+
+/* Check/create the CURLM* handle that runs http_send() transfers */
+static CURLM *
+http_get_multi(void)
+{
+	if (!g_http_multi)
 	{
-		curl_easy_reset(handle);
+		g_http_multi = curl_multi_init();
+		if (!g_http_multi)
+			ereport(ERROR, (errmsg("Unable to initialize CURL multi handle")));
+
+#if LIBCURL_VERSION_NUM >= 0x072B00 /* 7.43.0 */
+		/* Run concurrent requests over one HTTP/2 connection when possible */
+		curl_multi_setopt(g_http_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
 	}
 
+#if LIBCURL_VERSION_NUM >= 0x071E00 /* 7.30.0 */
+	curl_multi_setopt(g_http_multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long) http_max_host_connections);
+#endif
+
+	return g_http_multi;
+}
+
+/* Apply the default and user set options to a fresh or reset handle */
+static void
+http_init_handle(CURL *handle)
+{
+	http_curlopt *opt = settable_curlopts;
+
 	/* Always want a default fast (1 second) connection timeout */
 	/* User can over-ride with http_set_curlopt() if they wish */
 	curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, 1000);
@@ -885,8 +995,18 @@ http_get_handle()
 	/* Set the user agent. If not set, use PG_VERSION as default */
    	curl_easy_setopt(handle, CURLOPT_USERAGENT, PG_VERSION_STR);
 
-	if (!handle)
-		ereport(ERROR, (errmsg("Unable to initialize CURL")));
+	if (http_connection_pool)
+	{
+		curl_easy_setopt(handle, CURLOPT_SHARE, http_get_share());
+#if LIBCURL_VERSION_NUM >= 0x072F00 /* 7.47.0 */
+		/* Use HTTP/2 where the server offers it over TLS */
+		curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, (long) CURL_HTTP_VERSION_2TLS);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072B00 /* 7.43.0 */
+		/* Prefer waiting to multiplex over opening another connection */
+		curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+#endif
+	}
 
 	/* Bring in any options the user has set this session */
 	while (opt->curlopt)
@@ -896,6 +1016,30 @@ http_get_handle()
 			set_curlopt(handle, opt);
 		opt++;
 	}
+}
+
+/* Check/create the global CURL* handle */
+static CURL *
+http_get_handle()
+{
+	CURL *handle = g_http_handle;
+
+	/* Initialize the global handle if needed */
+	if (!handle)
+	{
+		handle = curl_easy_init();
+	}
+	/* Always reset because we are going to fill in the user */
+	/* set options down below */
+	else
+	{
+		curl_easy_reset(handle);
+	}
+
+	if (!handle)
+		ereport(ERROR, (errmsg("Unable to initialize CURL")));
+
+	http_init_handle(handle);
 
 	g_http_handle = handle;
 	return handle;
@@ -1025,15 +1169,13 @@ Datum http_set_curlopt(PG_FUNCTION_ARGS)
 
 
 /**
-* Master HTTP request function, takes in an http_request tuple and outputs
-* an http_response tuple.
+* Fill in a transfer from an http_request tuple and set up its handle,
+* which must already carry the default and user options.
 */
-Datum http_request(PG_FUNCTION_ARGS);
-PG_FUNCTION_INFO_V1(http_request);
-Datum http_request(PG_FUNCTION_ARGS)
+static void
+http_transfer_setup(http_transfer *t, HeapTupleHeader rec)
 {
 	/* Input */
-	HeapTupleHeader rec;
 	HeapTupleData tuple;
 	Oid tup_type;
 	int32 tup_typmod;
@@ -1048,40 +1190,8 @@ Datum http_request(PG_FUNCTION_ARGS)
 
 	/* Processing */
 	CURLcode err;
-	char http_error_buffer[CURL_ERROR_SIZE] = "\0";
-
+	char *http_error_buffer = t->error_buffer;
 	struct curl_slist *headers = NULL;
-	StringInfoData si_data;
-	StringInfoData si_headers;
-	StringInfoData si_read;
-
-	int http_return;
-	long long_status;
-	int status;
-	char *content_type = NULL;
-	int content_charset = -1;
-
-	/* Output */
-	HeapTuple tuple_out;
-
-	/* Version check */
-	http_check_curl_version(curl_version_info(CURLVERSION_NOW));
-
-	/* We cannot handle a null request */
-	if ( ! PG_ARGISNULL(0) )
-		rec = PG_GETARG_HEAPTUPLEHEADER(0);
-	else
-	{
-		elog(ERROR, "An http_request must be provided");
-		PG_RETURN_NULL();
-	}
-
-	/*************************************************************************
-	* Build and run a curl request from the http_request argument
-	*************************************************************************/
-
-	/* Zero out static memory */
-	memset(http_error_buffer, 0, sizeof(http_error_buffer));
 
 	/* Extract type info from the tuple itself */
 	tup_type = HeapTupleHeaderGetTypeId(rec);
@@ -1114,71 +1224,70 @@ Datum http_request(PG_FUNCTION_ARGS)
 	method = request_type(method_str);
 	elog(DEBUG2, "pgsql-http: method_str: '%s', method: %d", method_str, method);
 
-	/* Set up global HTTP handle */
-	g_http_handle = http_get_handle();
-
 	/* Set up the error buffer */
-	CURL_SETOPT(g_http_handle, CURLOPT_ERRORBUFFER, http_error_buffer);
+	CURL_SETOPT(t->handle, CURLOPT_ERRORBUFFER, http_error_buffer);
 
 	/* Set the target URL */
-	CURL_SETOPT(g_http_handle, CURLOPT_URL, uri);
+	CURL_SETOPT(t->handle, CURLOPT_URL, uri);
+	elog(DEBUG2, "pgsql-http: querying '%s'", uri);
 
 
 	/* Restrict to just http/https. Leaving unrestricted */
 	/* opens possibility of users requesting file:/// urls */
 	/* locally */
 #if LIBCURL_VERSION_NUM >= 0x075400  /* 7.84.0 */
-	CURL_SETOPT(g_http_handle, CURLOPT_PROTOCOLS_STR, "http,https");
+	CURL_SETOPT(t->handle, CURLOPT_PROTOCOLS_STR, "http,https");
 #else
-	CURL_SETOPT(g_http_handle, CURLOPT_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS);
+	CURL_SETOPT(t->handle, CURLOPT_PROTOCOLS, CURLPROTO_HTTP | CURLPROTO_HTTPS);
 #endif
 
-	if ( curlopt_is_set(CURLOPT_TCP_KEEPALIVE) )
+	if ( http_keep_connection() )
 	{
 		/* Keep sockets held open */
-		CURL_SETOPT(g_http_handle, CURLOPT_FORBID_REUSE, 0);
+		CURL_SETOPT(t->handle, CURLOPT_FORBID_REUSE, 0);
 	}
 	else
 	{
 		/* Keep sockets from being held open */
-		CURL_SETOPT(g_http_handle, CURLOPT_FORBID_REUSE, 1);
+		CURL_SETOPT(t->handle, CURLOPT_FORBID_REUSE, 1);
 	}
 
 	/* Set up the write-back function */
-	CURL_SETOPT(g_http_handle, CURLOPT_WRITEFUNCTION, http_writeback);
+	CURL_SETOPT(t->handle, CURLOPT_WRITEFUNCTION, http_writeback);
 
 	/* Set up the write-back buffer */
-	initStringInfo(&si_data);
-	initStringInfo(&si_headers);
-	CURL_SETOPT(g_http_handle, CURLOPT_WRITEDATA, (void*)(&si_data));
-	CURL_SETOPT(g_http_handle, CURLOPT_WRITEHEADER, (void*)(&si_headers));
+	initStringInfo(&t->si_data);
+	initStringInfo(&t->si_headers);
+	CURL_SETOPT(t->handle, CURLOPT_WRITEDATA, (void*)(&t->si_data));
+	CURL_SETOPT(t->handle, CURLOPT_WRITEHEADER, (void*)(&t->si_headers));
 
 #if LIBCURL_VERSION_NUM >= 0x072700 /* 7.39.0 */
 	/* Connect the progress callback for interrupt support */
-	CURL_SETOPT(g_http_handle, CURLOPT_XFERINFOFUNCTION, http_progress_callback);
-	CURL_SETOPT(g_http_handle, CURLOPT_NOPROGRESS, 0);
+	CURL_SETOPT(t->handle, CURLOPT_XFERINFOFUNCTION, http_progress_callback);
+	CURL_SETOPT(t->handle, CURLOPT_NOPROGRESS, 0);
 #endif
 
 	/* Set the HTTP content encoding to all curl supports */
-	CURL_SETOPT(g_http_handle, CURLOPT_ACCEPT_ENCODING, "");
+	CURL_SETOPT(t->handle, CURLOPT_ACCEPT_ENCODING, "");
 
 	if ( method != HTTP_HEAD )
 	{
 		/* Follow redirects, as many as 5 */
-		CURL_SETOPT(g_http_handle, CURLOPT_FOLLOWLOCATION, 1);
-		CURL_SETOPT(g_http_handle, CURLOPT_MAXREDIRS, 5);
+		CURL_SETOPT(t->handle, CURLOPT_FOLLOWLOCATION, 1);
+		CURL_SETOPT(t->handle, CURLOPT_MAXREDIRS, 5);
 	}
 
-	if ( curlopt_is_set(CURLOPT_TCP_KEEPALIVE) )
-	{
-		/* Add a keep alive option to the headers to reuse network sockets */
-		headers = curl_slist_append(headers, "Connection: Keep-Alive");
-	}
-	else
+	if ( ! http_keep_connection() )
 	{
 		/* Add a close option to the headers to avoid open network sockets */
 		headers = curl_slist_append(headers, "Connection: close");
 	}
+	else if ( ! http_connection_pool )
+	{
+		/* Add a keep alive option to the headers to reuse network sockets */
+		headers = curl_slist_append(headers, "Connection: Keep-Alive");
+	}
+	/* The pool leaves connection handling to curl, HTTP/2 forbids the header */
 
 	/* Let our charset preference be known */
 	headers = curl_slist_append(headers, "Charsets: utf-8");
@@ -1190,6 +1299,9 @@ Datum http_request(PG_FUNCTION_ARGS)
 		headers = header_array_to_slist(array, headers);
 	}
 
+	/* Hand the list to the transfer so it is freed after an error too */
+	t->headers = headers;
+
 	/* If we have a payload we send it, assuming we're either POST, GET, PATCH, PUT or DELETE or UNKNOWN */
 	if ( ! nulls[REQ_CONTENT] && values[REQ_CONTENT] )
 	{
@@ -1206,45 +1318,46 @@ Datum http_request(PG_FUNCTION_ARGS)
 		/* Add content type to the headers */
 		snprintf(buffer, sizeof(buffer), "Content-Type: %s", cstr);
 		headers = curl_slist_append(headers, buffer);
+		t->headers = headers;
 		pfree(cstr);
 
-		/* Read the content */
+		/* Read the content, keeping a copy that lives as long as the transfer */
 		content_text = DatumGetTextP(values[REQ_CONTENT]);
 		content_size = VARSIZE_ANY_EXHDR(content_text);
+		initStringInfo(&t->si_read);
+		appendBinaryStringInfo(&t->si_read, VARDATA(content_text), content_size);
 
 		if ( method == HTTP_GET || method == HTTP_POST || method == HTTP_DELETE )
 		{
 			/* Add the content to the payload */
-			CURL_SETOPT(g_http_handle, CURLOPT_POST, 1);
+			CURL_SETOPT(t->handle, CURLOPT_POST, 1);
 			if ( method == HTTP_GET )
 			{
 				/* Force the verb to be GET */
-				CURL_SETOPT(g_http_handle, CURLOPT_CUSTOMREQUEST, "GET");
+				CURL_SETOPT(t->handle, CURLOPT_CUSTOMREQUEST, "GET");
 			}
 			else if( method == HTTP_DELETE )
 			{
 				/* Force the verb to be DELETE */
-				CURL_SETOPT(g_http_handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+				CURL_SETOPT(t->handle, CURLOPT_CUSTOMREQUEST, "DELETE");
 			}
 
-			CURL_SETOPT(g_http_handle, CURLOPT_POSTFIELDS, (char *)(VARDATA(content_text)));
-			CURL_SETOPT(g_http_handle, CURLOPT_POSTFIELDSIZE, content_size);
+			CURL_SETOPT(t->handle, CURLOPT_POSTFIELDS, t->si_read.data);
+			CURL_SETOPT(t->handle, CURLOPT_POSTFIELDSIZE, content_size);
 		}
 		else if ( method == HTTP_PUT || method == HTTP_PATCH || method == HTTP_UNKNOWN )
 		{
 			if ( method == HTTP_PATCH )
-				CURL_SETOPT(g_http_handle, CURLOPT_CUSTOMREQUEST, "PATCH");
+				CURL_SETOPT(t->handle, CURLOPT_CUSTOMREQUEST, "PATCH");
 
 			/* Assume the user knows what they are doing and pass unchanged */
 			if ( method == HTTP_UNKNOWN )
-				CURL_SETOPT(g_http_handle, CURLOPT_CUSTOMREQUEST, method_str);
-
-			initStringInfo(&si_read);
-			appendBinaryStringInfo(&si_read, VARDATA(content_text), content_size);
-			CURL_SETOPT(g_http_handle, CURLOPT_UPLOAD, 1);
-			CURL_SETOPT(g_http_handle, CURLOPT_READFUNCTION, http_readback);
-			CURL_SETOPT(g_http_handle, CURLOPT_READDATA, &si_read);
-			CURL_SETOPT(g_http_handle, CURLOPT_INFILESIZE, content_size);
+				CURL_SETOPT(t->handle, CURLOPT_CUSTOMREQUEST, method_str);
+
+			CURL_SETOPT(t->handle, CURLOPT_UPLOAD, 1);
+			CURL_SETOPT(t->handle, CURLOPT_READFUNCTION, http_readback);
+			CURL_SETOPT(t->handle, CURLOPT_READDATA, &t->si_read);
+			CURL_SETOPT(t->handle, CURLOPT_INFILESIZE, content_size);
 		}
 		else
 		{
@@ -1254,11 +1367,11 @@ Datum http_request(PG_FUNCTION_ARGS)
 	}
 	else if ( method == HTTP_DELETE )
 	{
-		CURL_SETOPT(g_http_handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+		CURL_SETOPT(t->handle, CURLOPT_CUSTOMREQUEST, "DELETE");
 	}
 	else if ( method == HTTP_HEAD )
 	{
-		CURL_SETOPT(g_http_handle, CURLOPT_NOBODY, 1);
+		CURL_SETOPT(t->handle, CURLOPT_NOBODY, 1);
 	}
 	else if ( method == HTTP_PUT || method == HTTP_POST )
 	{
@@ -1267,62 +1380,51 @@ Datum http_request(PG_FUNCTION_ARGS)
 	}
 	else if ( method == HTTP_UNKNOWN ){
 		/* Assume the user knows what they are doing and pass unchanged */
-		CURL_SETOPT(g_http_handle, CURLOPT_CUSTOMREQUEST, method_str);
+		CURL_SETOPT(t->handle, CURLOPT_CUSTOMREQUEST, method_str);
 	}
 
 	pfree(method_str);
 	/* Set the headers */
-	CURL_SETOPT(g_http_handle, CURLOPT_HTTPHEADER, headers);
-
-	/*************************************************************************
-	* PERFORM THE REQUEST!
-	**************************************************************************/
-	http_return = curl_easy_perform(g_http_handle);
-	elog(DEBUG2, "pgsql-http: queried '%s'", uri);
-	elog(DEBUG2, "pgsql-http: http_return '%d'", http_return);
+	CURL_SETOPT(t->handle, CURLOPT_HTTPHEADER, headers);
 
 	/* Clean up some input things we don't need anymore */
 	ReleaseTupleDesc(tup_desc);
 	pfree(values);
 	pfree(nulls);
+}
 
-	/*************************************************************************
-	* Create an http_response object from the curl results
-	*************************************************************************/
-
-	/* Write out an error on failure */
-	if ( http_return != CURLE_OK )
-	{
-		curl_slist_free_all(headers);
-		curl_easy_cleanup(g_http_handle);
-		g_http_handle = NULL;
+/**
+* Create an http_response tuple from a completed transfer, in the
+* current memory context.
+*/
+static Datum
+http_transfer_response(FunctionCallInfo fcinfo, http_transfer *t)
+{
+	TupleDesc tup_desc;
+	int ncolumns;
+	Datum *values;
+	bool *nulls;
 
-#if LIBCURL_VERSION_NUM >= 0x072700 /* 7.39.0 */
-		/*
-		* If the request was aborted by an interrupt request
-		* report back.
-		*/
-		if (http_return == CURLE_ABORTED_BY_CALLBACK)
-			elog(ERROR, "canceling statement due to user request");
-#endif
+	long long_status;
+	int status;
+	char *content_type = NULL;
+	int content_charset = -1;
 
-		http_error(http_return, http_error_buffer);
-	}
+	/* Output */
+	HeapTuple tuple_out;
 
 	/* Read the metadata from the handle directly */
-	if ( (CURLE_OK != curl_easy_getinfo(g_http_handle, CURLINFO_RESPONSE_CODE, &long_status)) ||
-		 (CURLE_OK != curl_easy_getinfo(g_http_handle, CURLINFO_CONTENT_TYPE, &content_type)) )
+	if ( (CURLE_OK != curl_easy_getinfo(t->handle, CURLINFO_RESPONSE_CODE, &long_status)) ||
+		 (CURLE_OK != curl_easy_getinfo(t->handle, CURLINFO_CONTENT_TYPE, &content_type)) )
 	{
-		curl_slist_free_all(headers);
-		curl_easy_cleanup(g_http_handle);
-		g_http_handle = NULL;
 		ereport(ERROR, (errmsg("CURL: Error in curl_easy_getinfo")));
 	}
 
 	/* Prepare our return object */
 	if (get_call_result_type(fcinfo, 0, &tup_desc) != TYPEFUNC_COMPOSITE) {
 	    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-	        errmsg("%s called with incompatible return type", __func__)));
+	        errmsg("%s called with incompatible return type",
+	               get_func_name(fcinfo->flinfo->fn_oid))));
 	}
 
 	ncolumns = tup_desc->natts;
@@ -1370,11 +1472,11 @@ Datum http_request(PG_FUNCTION_ARGS)
 	}
 
 	/* Headers array */
-	if ( si_headers.len )
+	if ( t->si_headers.len )
 	{
 		/* Strip the carriage-returns, because who cares? */
-		string_info_remove_cr(&si_headers);
-		values[RESP_HEADERS] = PointerGetDatum(header_string_to_array(&si_headers));
+		string_info_remove_cr(&t->si_headers);
+		values[RESP_HEADERS] = PointerGetDatum(header_string_to_array(&t->si_headers));
 		nulls[RESP_HEADERS] = false;
 	}
 	else
@@ -1384,7 +1486,7 @@ Datum http_request(PG_FUNCTION_ARGS)
 	}
 
 	/* Content */
-	if ( si_data.len )
+	if ( t->si_data.len )
 	{
 		char *content_str;
 		size_t content_len;
@@ -1393,12 +1495,12 @@ Datum http_request(PG_FUNCTION_ARGS)
 		/* Apply character transcoding if necessary */
 		if ( content_charset < 0 )
 		{
-			content_str = si_data.data;
-			content_len = si_data.len;
+			content_str = t->si_data.data;
+			content_len = t->si_data.len;
 		}
 		else
 		{
-			content_str = pg_any_to_server(si_data.data, si_data.len, content_charset, false, false);
+			content_str = pg_any_to_server(t->si_data.data, t->si_data.len, content_charset, false, false);
 			content_len = strlen(content_str);
 		}
 
@@ -1416,21 +1518,321 @@ Datum http_request(PG_FUNCTION_ARGS)
 
 	/* Clean up */
 	ReleaseTupleDesc(tup_desc);
-	if ( ! curlopt_is_set(CURLOPT_TCP_KEEPALIVE) )
+	pfree(values);
+	pfree(nulls);
+
+	return HeapTupleGetDatum(tuple_out);
+}
+
+/**
+* Master HTTP request function, takes in an http_request tuple and outputs
+* an http_response tuple.
+*/
+Datum http_request(PG_FUNCTION_ARGS);
+PG_FUNCTION_INFO_V1(http_request);
+Datum http_request(PG_FUNCTION_ARGS)
+{
+	http_transfer transfer;
+	int http_return;
+	Datum result;
+
+	/* Version check */
+	http_check_curl_version(curl_version_info(CURLVERSION_NOW));
+
+	/* We cannot handle a null request */
+	if ( PG_ARGISNULL(0) )
 	{
+		elog(ERROR, "An http_request must be provided");
+		PG_RETURN_NULL();
+	}
+
+	/*************************************************************************
+	* Build and run a curl request from the http_request argument
+	*************************************************************************/
+
+	/* Zero out static memory */
+	memset(&transfer, 0, sizeof(transfer));
+
+	/* Set up global HTTP handle */
+	g_http_handle = http_get_handle();
+	transfer.handle = g_http_handle;
+
+	PG_TRY();
+	{
+		http_transfer_setup(&transfer, PG_GETARG_HEAPTUPLEHEADER(0));
+	}
+	PG_CATCH();
+	{
+		curl_slist_free_all(transfer.headers);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	/*************************************************************************
+	* PERFORM THE REQUEST!
+	**************************************************************************/
+	http_return = curl_easy_perform(g_http_handle);
+	elog(DEBUG2, "pgsql-http: http_return '%d'", http_return);
+
+	/*************************************************************************
+	* Create an http_response object from the curl results
+	*************************************************************************/
+
+	/* Write out an error on failure */
+	if ( http_return != CURLE_OK )
+	{
+		curl_slist_free_all(transfer.headers);
+		curl_easy_cleanup(g_http_handle);
+		g_http_handle = NULL;
+
+#if LIBCURL_VERSION_NUM >= 0x072700 /* 7.39.0 */
+		/*
+		* If the request was aborted by an interrupt request
+		* report back.
+		*/
+		if (http_return == CURLE_ABORTED_BY_CALLBACK)
+			elog(ERROR, "canceling statement due to user request");
+#endif
+
+		http_error(http_return, transfer.error_buffer);
+	}
+
+	PG_TRY();
+	{
+		result = http_transfer_response(fcinfo, &transfer);
+	}
+	PG_CATCH();
+	{
+		curl_slist_free_all(transfer.headers);
 		curl_easy_cleanup(g_http_handle);
 		g_http_handle = NULL;
+		PG_RE_THROW();
 	}
-	curl_slist_free_all(headers);
-	pfree(si_headers.data);
-	pfree(si_data.data);
-	pfree(values);
-	pfree(nulls);
+	PG_END_TRY();
+
+	/* Clean up */
+	if ( ! http_keep_connection() )
+	{
+		curl_easy_cleanup(g_http_handle);
+		g_http_handle = NULL;
+	}
+	curl_slist_free_all(transfer.headers);
+	pfree(transfer.si_headers.data);
+	pfree(transfer.si_data.data);
 
 	/* Return */
-	PG_RETURN_DATUM(HeapTupleGetDatum(tuple_out));
+	PG_RETURN_DATUM(result);
+}
+
+/* Release an http_send() transfer and everything it allocated */
+static void
+http_transfer_free(http_transfer *t)
+{
+	if (g_http_multi)
+		curl_multi_remove_handle(g_http_multi, t->handle);
+	curl_easy_cleanup(t->handle);
+	curl_slist_free_all(t->headers);
+	MemoryContextDelete(t->context);
+}
+
+/*
+* Transfers hold pointers into memory that belongs to the transaction,
+* so those not fetched by the end of it are abandoned.
+*/
+static void
+http_xact_callback(XactEvent event, void *arg)
+{
+	ListCell *lc;
+
+	if (event != XACT_EVENT_COMMIT && event != XACT_EVENT_ABORT &&
+		event != XACT_EVENT_PARALLEL_COMMIT && event != XACT_EVENT_PARALLEL_ABORT &&
+		event != XACT_EVENT_PREPARE)
+		return;
+
+	foreach(lc, http_pending)
+	{
+		http_transfer *t = (http_transfer *) lfirst(lc);
+		if (g_http_multi)
+			curl_multi_remove_handle(g_http_multi, t->handle);
+		curl_easy_cleanup(t->handle);
+		curl_slist_free_all(t->headers);
+	}
+
+	/* The list and the transfer contexts go with TopTransactionContext */
+	http_pending = NIL;
+}
+
+/*
+* Move the http_send() transfers along as far as possible without
+* blocking, and note the result of those that finished.
+*/
+static void
+http_multi_perform(void)
+{
+	CURLMcode mc;
+	CURLMsg *msg;
+	int running;
+	int queued;
+
+	mc = curl_multi_perform(g_http_multi, &running);
+	if ( mc != CURLM_OK )
+		ereport(ERROR, (errmsg("%s", curl_multi_strerror(mc))));
+
+	while ( (msg = curl_multi_info_read(g_http_multi, &queued)) != NULL )
+	{
+		char *priv = NULL;
+		http_transfer *t;
+
+		if ( msg->msg != CURLMSG_DONE )
+			continue;
+
+		curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &priv);
+		t = (http_transfer *) priv;
+		t->done = true;
+		t->result = msg->data.result;
+	}
 }
 
+/**
+* Start a request and return without waiting for it. The returned id is
+* passed to http_fetch() to collect the response. Transfers run
+* concurrently, on one connection per host when HTTP/2 is available.
+*/
+Datum http_send(PG_FUNCTION_ARGS);
+PG_FUNCTION_INFO_V1(http_send);
+Datum http_send(PG_FUNCTION_ARGS)
+{
+	MemoryContext context;
+	MemoryContext oldcontext;
+	http_transfer *t;
+	CURLMcode mc;
+
+	/* Version check */
+	http_check_curl_version(curl_version_info(CURLVERSION_NOW));
+
+	/* We cannot handle a null request */
+	if ( PG_ARGISNULL(0) )
+	{
+		elog(ERROR, "An http_request must be provided");
+		PG_RETURN_NULL();
+	}
+
+	context = AllocSetContextCreate(TopTransactionContext,
+									"pgsql-http transfer",
+									ALLOCSET_SMALL_SIZES);
+
+	t = MemoryContextAllocZero(context, sizeof(http_transfer));
+	t->context = context;
+	t->id = http_next_id++;
+	t->handle = curl_easy_init();
+	if ( ! t->handle )
+		ereport(ERROR, (errmsg("Unable to initialize CURL")));
+
+	/* Track it from here on so that an error releases the handle */
+	oldcontext = MemoryContextSwitchTo(TopTransactionContext);
+	http_pending = lappend(http_pending, t);
+
+	MemoryContextSwitchTo(context);
+	http_init_handle(t->handle);
+	curl_easy_setopt(t->handle, CURLOPT_PRIVATE, (void *) t);
+	http_transfer_setup(t, PG_GETARG_HEAPTUPLEHEADER(0));
+	MemoryContextSwitchTo(oldcontext);
+
+	mc = curl_multi_add_handle(http_get_multi(), t->handle);
+	if ( mc != CURLM_OK )
+		ereport(ERROR, (errmsg("%s", curl_multi_strerror(mc))));
+
+	/* Get the connection going before returning to the caller */
+	http_multi_perform();
+
+	PG_RETURN_INT32(t->id);
+}
+
+/**
+* Wait for a request started by http_send() and return its response.
+* Other pending requests keep running while we wait.
+*/
+Datum http_fetch(PG_FUNCTION_ARGS);
+PG_FUNCTION_INFO_V1(http_fetch);
+Datum http_fetch(PG_FUNCTION_ARGS)
+{
+	int id = PG_GETARG_INT32(0);
+	http_transfer *t = NULL;
+	ListCell *lc;
+	Datum result;
+
+	foreach(lc, http_pending)
+	{
+		if ( ((http_transfer *) lfirst(lc))->id == id )
+		{
+			t = (http_transfer *) lfirst(lc);
+			break;
+		}
+	}
+
+	if ( ! t )
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("http request %d does not exist", id),
+				 errhint("Requests must be fetched once, in the transaction that sent them.")));
+
+	while ( ! t->done )
+	{
+		CURLMcode mc;
+		int numfds;
+
+		CHECK_FOR_INTERRUPTS();
+
+		http_multi_perform();
+		if ( t->done )
+			break;
+
+#if LIBCURL_VERSION_NUM >= 0x071C00 /* 7.28.0 */
+		mc = curl_multi_wait(g_http_multi, NULL, 0, 100, &numfds);
+#else
+		mc = CURLM_OK;
+		numfds = 0;
+		pg_usleep(1000L);
+#endif
+		if ( mc != CURLM_OK )
+			ereport(ERROR, (errmsg("%s", curl_multi_strerror(mc))));
+	}
+
+	http_pending = list_delete_ptr(http_pending, t);
+
+	/* Write out an error on failure */
+	if ( t->result != CURLE_OK )
+	{
+		CURLcode http_return = t->result;
+		char *error_str = pstrdup(strlen(t->error_buffer) > 0 ?
+								  t->error_buffer :
+								  curl_easy_strerror(http_return));
+
+		http_transfer_free(t);
+
+#if LIBCURL_VERSION_NUM >= 0x072700 /* 7.39.0 */
+		if (http_return == CURLE_ABORTED_BY_CALLBACK)
+			elog(ERROR, "canceling statement due to user request");
+#endif
+
+		ereport(ERROR, (errmsg("%s", error_str)));
+	}
+
+	PG_TRY();
+	{
+		result = http_transfer_response(fcinfo, t);
+	}
+	PG_CATCH();
+	{
+		http_transfer_free(t);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	http_transfer_free(t);
+
+	PG_RETURN_DATUM(result);
+}
 
 
 
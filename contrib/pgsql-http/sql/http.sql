@@ -107,6 +107,21 @@ FROM (
 ) a
 WHERE field ILIKE 'Abcde';
 
+-- Asynchronous requests over the connection pool
+SET http.connection_pool = on;
+WITH sent AS (
+	SELECT array_agg(http_send(('GET', current_setting('http.server_host') || '/anything?n=' || n, NULL, NULL, NULL)::http_request) ORDER BY n) AS ids
+	FROM generate_series(1, 3) n
+)
+SELECT r.status, r.content::json->'args'->>'n' AS n
+FROM sent, unnest(ids) WITH ORDINALITY AS u(id, i), http_fetch(u.id) r
+ORDER BY u.i;
+SELECT status
+FROM http_fetch(http_send(('GET', current_setting('http.server_host') || '/status/202', NULL, NULL, NULL)::http_request));
+-- Error because the request was already fetched
+SELECT status FROM http_fetch(1);
+RESET http.connection_pool;
+
 -- Follow redirect
 SELECT status,
 replace((content::json)->>'url', current_setting('http.server_host'),'') AS path
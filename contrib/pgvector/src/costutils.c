@@ -0,0 +1,18 @@
+#include "postgres.h"
+
+#include "costutils.h"
+#include "optimizer/cost.h"
+
+/*
+ * Estimate the fraction of returned tuples that pass the executor filters
+ */
+Selectivity
+GetFilterSelectivity(PlannerInfo *root, IndexPath *path)
+{
+	RelOptInfo *rel = path->indexinfo->rel;
+
+	if (rel->baserestrictinfo == NIL)
+		return 1.0;
+
+	return clauselist_selectivity(root, rel->baserestrictinfo, rel->relid, JOIN_INNER, NULL);
+}
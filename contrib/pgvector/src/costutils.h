@@ -0,0 +1,10 @@
+#ifndef COSTUTILS_H
+#define COSTUTILS_H
+
+#include "postgres.h"
+
+#include "nodes/relation.h"
+
+Selectivity GetFilterSelectivity(PlannerInfo *root, IndexPath *path);
+
+#endif
@@ -7,6 +7,8 @@
 #include "access/reloptions.h"
 #include "commands/progress.h"
 #include "commands/vacuum.h"
+#include "costutils.h"
+#include "optimizer/cost.h"
 #include "hnsw.h"
 #include "miscadmin.h"
 #include "utils/builtins.h"
@@ -23,6 +25,7 @@ static const struct config_enum_entry hnsw_iterative_scan_options[] = {
 	{"off", HNSW_ITERATIVE_SCAN_OFF, false},
 	{"relaxed_order", HNSW_ITERATIVE_SCAN_RELAXED, false},
 	{"strict_order", HNSW_ITERATIVE_SCAN_STRICT, false},
+	{"auto", HNSW_ITERATIVE_SCAN_AUTO, false},
 	{NULL, 0, false}
 };
 
@@ -176,6 +179,14 @@ hnswcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 
 		ratio = (entryLevel * m + layer0TuplesMax * layer0Selectivity) / path->indexinfo->tuples;
 
+		/*
+		 * Iterative scans keep traversing the graph until enough tuples pass
+		 * the filters, so selective filters make the first row more costly
+		 * and favor an exact scan instead
+		 */
+		if (hnsw_iterative_scan != HNSW_ITERATIVE_SCAN_OFF)
+			ratio /= Max(GetFilterSelectivity(root, path), 1e-10);
+
 		if (ratio > 1)
 			ratio = 1;
 	}
@@ -123,7 +123,8 @@ typedef enum HnswIterativeScanMode
 {
 	HNSW_ITERATIVE_SCAN_OFF,
 	HNSW_ITERATIVE_SCAN_RELAXED,
-	HNSW_ITERATIVE_SCAN_STRICT
+	HNSW_ITERATIVE_SCAN_STRICT,
+	HNSW_ITERATIVE_SCAN_AUTO
 }			HnswIterativeScanMode;
 
 typedef struct HnswElementData HnswElementData;
@@ -377,6 +378,7 @@ typedef struct HnswScanOpaqueData
 	pairingheap *discarded;
 	HnswQuery	q;
 	int			m;
+	int			iterative;
 	int64		tuples;
 	double		previousDistance;
 	Size		maxMemory;
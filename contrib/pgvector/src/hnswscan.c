@@ -8,6 +8,36 @@
 #include "utils/builtins.h"
 #include "utils/memutils.h"
 
+/*
+ * Get the size of the dynamic candidate list
+ *
+ * A LIMIT pushed down to the scan (for instance, to each datanode of a
+ * distributed query) raises ef_search so one pass returns enough tuples
+ */
+static int
+GetEfSearch(IndexScanDesc scan)
+{
+	if (scan->xs_tuples_needed > hnsw_ef_search)
+		return (int) Min(scan->xs_tuples_needed, HNSW_MAX_EF_SEARCH);
+
+	return hnsw_ef_search;
+}
+
+/*
+ * Get the iterative scan mode for this scan
+ *
+ * In auto mode, keep expanding the search only when the executor filters the
+ * returned tuples, so selective filters still produce enough rows.
+ */
+static int
+GetIterativeScan(IndexScanDesc scan)
+{
+	if (hnsw_iterative_scan == HNSW_ITERATIVE_SCAN_AUTO)
+		return scan->xs_filtered ? HNSW_ITERATIVE_SCAN_STRICT : HNSW_ITERATIVE_SCAN_OFF;
+
+	return hnsw_iterative_scan;
+}
+
 /*
  * Algorithm 5 from paper
  */
@@ -41,7 +71,7 @@ GetScanItems(IndexScanDesc scan, Datum value)
 		ep = w;
 	}
 
-	return HnswSearchLayer(base, q, ep, hnsw_ef_search, 0, index, support, m, false, NULL, &so->v, hnsw_iterative_scan != HNSW_ITERATIVE_SCAN_OFF ? &so->discarded : NULL, true, &so->tuples);
+	return HnswSearchLayer(base, q, ep, GetEfSearch(scan), 0, index, support, m, false, NULL, &so->v, so->iterative != HNSW_ITERATIVE_SCAN_OFF ? &so->discarded : NULL, true, &so->tuples);
 }
 
 /*
@@ -54,7 +84,7 @@ ResumeScanItems(IndexScanDesc scan)
 	Relation	index = scan->indexRelation;
 	List	   *ep = NIL;
 	char	   *base = NULL;
-	int			batch_size = hnsw_ef_search;
+	int			batch_size = GetEfSearch(scan);
 
 	if (pairingheap_is_empty(so->discarded))
 		return NIL;
@@ -206,6 +236,8 @@ hnswgettuple(IndexScanDesc scan, ScanDirection dir)
 		/* Get scan value */
 		value = GetScanValue(scan);
 
+		so->iterative = GetIterativeScan(scan);
+
 		/*
 		 * Get a shared lock. This allows vacuum to ensure no in-flight scans
 		 * before marking tuples as deleted.
@@ -233,7 +265,7 @@ hnswgettuple(IndexScanDesc scan, ScanDirection dir)
 
 		if (list_length(so->w) == 0)
 		{
-			if (hnsw_iterative_scan == HNSW_ITERATIVE_SCAN_OFF)
+			if (so->iterative == HNSW_ITERATIVE_SCAN_OFF)
 				break;
 
 			/* Empty index */
@@ -284,7 +316,7 @@ hnswgettuple(IndexScanDesc scan, ScanDirection dir)
 			so->w = list_delete_last(so->w);
 
 			/* Mark memory as free for next iteration */
-			if (hnsw_iterative_scan != HNSW_ITERATIVE_SCAN_OFF)
+			if (so->iterative != HNSW_ITERATIVE_SCAN_OFF)
 			{
 				pfree(element);
 				pfree(sc);
@@ -295,7 +327,7 @@ hnswgettuple(IndexScanDesc scan, ScanDirection dir)
 
 		heaptid = &element->heaptids[--element->heaptidsLength];
 
-		if (hnsw_iterative_scan == HNSW_ITERATIVE_SCAN_STRICT)
+		if (so->iterative == HNSW_ITERATIVE_SCAN_STRICT)
 		{
 			if (sc->distance < so->previousDistance)
 				continue;
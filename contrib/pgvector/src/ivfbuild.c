@@ -179,6 +179,10 @@ AddTupleToSort(Relation index, ItemPointer tid, Datum *values, IvfflatBuildState
 	buildstate->listCounts[closestCenter]++;
 #endif
 
+	/* Quantize after assignment so the sort also holds the smaller entries */
+	if (buildstate->quantizer == IVFFLAT_QUANTIZER_INT8)
+		value = IvfflatQuantizeValue(value);
+
 	/* Create a virtual tuple */
 	ExecClearTuple(slot);
 	slot->tts_values[0] = Int32GetDatum(closestCenter);
@@ -317,6 +321,7 @@ InitBuildState(IvfflatBuildState * buildstate, Relation heap, Relation index, In
 	buildstate->tupdesc = RelationGetDescr(index);
 
 	buildstate->lists = IvfflatGetLists(index);
+	buildstate->quantizer = IvfflatGetQuantizer(index);
 	buildstate->dimensions = TupleDescAttr(index->rd_att, 0)->atttypmod;
 
 	/* Disallow varbit since require fixed dimensions */
@@ -336,6 +341,13 @@ InitBuildState(IvfflatBuildState * buildstate, Relation heap, Relation index, In
 				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
 				 errmsg("column cannot have more than %d dimensions for ivfflat index", buildstate->typeInfo->maxDimensions)));
 
+	/* Quantized entries are decoded as vector during scans */
+	if (buildstate->quantizer != IVFFLAT_QUANTIZER_NONE &&
+		OidIsValid(index_getprocid(index, 1, IVFFLAT_TYPE_INFO_PROC)))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("quantizer is only supported for vector type")));
+
 	buildstate->reltuples = 0;
 	buildstate->indtuples = 0;
 
@@ -437,7 +449,7 @@ ComputeCenters(IvfflatBuildState * buildstate)
  * Create the metapage
  */
 static void
-CreateMetaPage(Relation index, int dimensions, int lists, ForkNumber forkNum)
+CreateMetaPage(Relation index, int dimensions, int lists, int quantizer, ForkNumber forkNum)
 {
 	Buffer		buf;
 	Page		page;
@@ -453,6 +465,7 @@ CreateMetaPage(Relation index, int dimensions, int lists, ForkNumber forkNum)
 	metap->version = IVFFLAT_VERSION;
 	metap->dimensions = dimensions;
 	metap->lists = lists;
+	metap->quantizer = quantizer;
 	((PageHeader) page)->pd_lower =
 		((char *) metap + sizeof(IvfflatMetaPageData)) - (char *) page;
 
@@ -959,7 +972,7 @@ BuildIndex(Relation heap, Relation index, IndexInfo *indexInfo,
 	ComputeCenters(buildstate);
 
 	/* Create pages */
-	CreateMetaPage(index, buildstate->dimensions, buildstate->lists, forkNum);
+	CreateMetaPage(index, buildstate->dimensions, buildstate->lists, buildstate->quantizer, forkNum);
 	CreateListPages(index, buildstate->centers, buildstate->dimensions, buildstate->lists, forkNum, &buildstate->listInfo);
 	CreateEntryPages(buildstate, forkNum);
 
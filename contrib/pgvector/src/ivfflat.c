@@ -6,6 +6,8 @@
 #include "access/reloptions.h"
 #include "commands/progress.h"
 #include "commands/vacuum.h"
+#include "costutils.h"
+#include "optimizer/cost.h"
 #include "ivfflat.h"
 #include "utils/builtins.h"
 #include "utils/numeric.h"
@@ -25,6 +27,7 @@ static relopt_kind ivfflat_relopt_kind;
 static const struct config_enum_entry ivfflat_iterative_scan_options[] = {
 	{"off", IVFFLAT_ITERATIVE_SCAN_OFF, false},
 	{"relaxed_order", IVFFLAT_ITERATIVE_SCAN_RELAXED, false},
+	{"auto", IVFFLAT_ITERATIVE_SCAN_AUTO, false},
 	{NULL, 0, false}
 };
 
@@ -38,6 +41,8 @@ IvfflatInit(void)
 	add_int_reloption(ivfflat_relopt_kind, "lists", "Number of inverted lists",
 	                  IVFFLAT_DEFAULT_LISTS, IVFFLAT_MIN_LISTS, IVFFLAT_MAX_LISTS);
 	add_bool_reloption(ivfflat_relopt_kind, "checksum", "enable checksum for page verify", true);
+	add_string_reloption(ivfflat_relopt_kind, "quantizer", "Quantizer for list entries (none or int8)",
+	                     "none", (validate_string_relopt) IvfflatValidateQuantizer);
 	
 	DefineCustomIntVariable("ivfflat.probes", "Sets the number of probes",
 							"Valid range is 1..lists.", &ivfflat_probes,
@@ -95,11 +100,19 @@ ivfflatcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	genericcostestimate(root, path, loop_count, qinfos, &costs);
 
 	index = index_open(path->indexinfo->indexoid, NoLock);
-	IvfflatGetMetaPageInfo(index, &lists, NULL);
+	IvfflatGetMetaPageInfo(index, &lists, NULL, NULL);
 	index_close(index, NoLock);
 
 	/* Get the ratio of lists that we need to visit */
 	ratio = ((double) ivfflat_probes) / lists;
+
+	/* Iterative scans probe more lists until enough tuples pass the filters */
+	if (ivfflat_iterative_scan != IVFFLAT_ITERATIVE_SCAN_OFF)
+	{
+		double		maxRatio = ((double) Max(ivfflat_max_probes, ivfflat_probes)) / lists;
+
+		ratio = Min(ratio / Max(GetFilterSelectivity(root, path), 1e-10), maxRatio);
+	}
 	if (ratio > 1.0)
 		ratio = 1.0;
 
@@ -138,6 +151,7 @@ ivfflatoptions(Datum reloptions, bool validate)
 	static const relopt_parse_elt tab[] = {
 		{"lists", RELOPT_TYPE_INT, offsetof(IvfflatOptions, lists)},
 		{"checksum", RELOPT_TYPE_BOOL, offsetof(IvfflatOptions, checksum)},
+		{"quantizer", RELOPT_TYPE_STRING, offsetof(IvfflatOptions, quantizerOffset)},
 	};
 
 #if PG_VERSION_NUM >= 130000
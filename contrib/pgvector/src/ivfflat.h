@@ -44,6 +44,10 @@
 #define IVFFLAT_MAX_LISTS		32768
 #define IVFFLAT_DEFAULT_PROBES	1
 
+/* Quantizers for list entries */
+#define IVFFLAT_QUANTIZER_NONE	0
+#define IVFFLAT_QUANTIZER_INT8	1
+
 /* Build phases */
 /* PROGRESS_CREATEIDX_SUBPHASE_INITIALIZE is 1 */
 #define PROGRESS_IVFFLAT_PHASE_KMEANS	2
@@ -51,6 +55,7 @@
 #define PROGRESS_IVFFLAT_PHASE_LOAD		4
 
 #define IVFFLAT_LIST_SIZE(size)	(offsetof(IvfflatListData, center) + size)
+#define IVFFLAT_INT8_SIZE(_dim)	(offsetof(IvfflatInt8Vector, x) + sizeof(int8)*(_dim))
 
 #define IvfflatPageGetOpaque(page)	((IvfflatPageOpaque) PageGetSpecialPointer(page))
 #define IvfflatPageGetMeta(page)	((IvfflatMetaPageData *) PageGetContents(page))
@@ -89,9 +94,17 @@ extern int	ivfflat_max_probes;
 typedef enum IvfflatIterativeScanMode
 {
 	IVFFLAT_ITERATIVE_SCAN_OFF,
-	IVFFLAT_ITERATIVE_SCAN_RELAXED
+	IVFFLAT_ITERATIVE_SCAN_RELAXED,
+	IVFFLAT_ITERATIVE_SCAN_AUTO
 }			IvfflatIterativeScanMode;
 
+typedef enum IvfflatMetric
+{
+	IVFFLAT_METRIC_L2,
+	IVFFLAT_METRIC_INNER_PRODUCT,
+	IVFFLAT_METRIC_COSINE
+}			IvfflatMetric;
+
 typedef struct VectorArrayData
 {
 	int			length;
@@ -115,6 +128,7 @@ typedef struct IvfflatOptions
 	int32		vl_len_;		/* varlena header (do not touch directly!) */
 	int			lists;			/* number of lists */
 	bool        checksum;       /* enable checksum */
+	int			quantizerOffset;	/* offset of quantizer name */
 }			IvfflatOptions;
 
 typedef struct IvfflatSpool
@@ -181,6 +195,7 @@ typedef struct IvfflatBuildState
 	/* Settings */
 	int			dimensions;
 	int			lists;
+	int			quantizer;
 
 	/* Statistics */
 	double		indtuples;
@@ -226,6 +241,8 @@ typedef struct IvfflatMetaPageData
 	uint32		version;
 	uint16		dimensions;
 	uint16		lists;
+	uint16		quantizer;		/* zero for indexes built before quantizers */
+	uint16		unused;
 }			IvfflatMetaPageData;
 
 typedef IvfflatMetaPageData * IvfflatMetaPage;
@@ -248,6 +265,23 @@ typedef struct IvfflatListData
 
 typedef IvfflatListData * IvfflatList;
 
+/*
+ * List entry for int8 quantization
+ *
+ * Element k is approximated by x[k] * scale. error is the L2 norm of the
+ * difference between the original vector and its approximation, which lets
+ * scans compute a lower bound of the exact distance.
+ */
+typedef struct IvfflatInt8Vector
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	int16		dim;			/* number of dimensions */
+	int16		unused;			/* reserved for future use, always zero */
+	float		scale;
+	float		error;
+	int8		x[FLEXIBLE_ARRAY_MEMBER];
+}			IvfflatInt8Vector;
+
 typedef struct IvfflatScanList
 {
 	pairingheap_node ph_node;
@@ -261,10 +295,16 @@ typedef struct IvfflatScanOpaqueData
 	int			probes;
 	int			maxProbes;
 	int			dimensions;
+	int			quantizer;
 	bool		first;
 	Datum		value;
 	MemoryContext tmpCtx;
 
+	/* Quantization */
+	Vector	   *dequantized;
+	double		valueNorm;
+	IvfflatMetric metric;
+
 	/* Sorting */
 	Tuplesortstate *sortstate;
 	TupleDesc	tupdesc;
@@ -311,7 +351,11 @@ FmgrInfo   *IvfflatOptionalProcInfo(Relation index, uint16 procnum);
 Datum		IvfflatNormValue(const IvfflatTypeInfo * typeInfo, Oid collation, Datum value);
 bool		IvfflatCheckNorm(FmgrInfo *procinfo, Oid collation, Datum value);
 int			IvfflatGetLists(Relation index);
-void		IvfflatGetMetaPageInfo(Relation index, int *lists, int *dimensions);
+int			IvfflatGetQuantizer(Relation index);
+void		IvfflatGetMetaPageInfo(Relation index, int *lists, int *dimensions, int *quantizer);
+Datum		IvfflatQuantizeValue(Datum value);
+void		IvfflatDequantize(IvfflatInt8Vector * qvec, Vector * result);
+void		IvfflatValidateQuantizer(const char *value);
 void		IvfflatUpdateList(Relation index, ListInfo listInfo, BlockNumber insertPage, BlockNumber originalInsertPage, BlockNumber startPage, ForkNumber forkNum);
 void		IvfflatCommitBuffer(Buffer buf, GenericXLogState *state);
 void		IvfflatAppendPage(Relation index, Buffer *buf, Page *page, GenericXLogState **state, ForkNumber forkNum);
@@ -78,6 +78,7 @@ InsertTuple(Relation index, Datum *values, bool *isnull, ItemPointer heap_tid, R
 	BlockNumber insertPage = InvalidBlockNumber;
 	ListInfo	listInfo;
 	BlockNumber originalInsertPage;
+	int			quantizer;
 
 	/* Detoast once for all calls */
 	value = PointerGetDatum(PG_DETOAST_DATUM(values[0]));
@@ -95,13 +96,17 @@ InsertTuple(Relation index, Datum *values, bool *isnull, ItemPointer heap_tid, R
 	}
 
 	/* Ensure index is valid */
-	IvfflatGetMetaPageInfo(index, NULL, NULL);
+	IvfflatGetMetaPageInfo(index, NULL, NULL, &quantizer);
 
 	/* Find the insert page - sets the page and list info */
 	FindInsertPage(index, &value, &insertPage, &listInfo);
 	Assert(BlockNumberIsValid(insertPage));
 	originalInsertPage = insertPage;
 
+	/* Store the quantized value in the list */
+	if (quantizer == IVFFLAT_QUANTIZER_INT8)
+		value = IvfflatQuantizeValue(value);
+
 	/* Form tuple */
 	itup = index_form_tuple(RelationGetDescr(index), &value, isnull);
 	itup->t_tid = *heap_tid;
@@ -1,6 +1,7 @@
 #include "postgres.h"
 
 #include <float.h>
+#include <math.h>
 
 #include "access/relscan.h"
 #include "catalog/pg_operator.h"
@@ -106,6 +107,54 @@ GetScanLists(IndexScanDesc scan, Datum value)
 	Assert(pairingheap_is_empty(so->listQueue));
 }
 
+PGDLLEXPORT Datum vector_l2_squared_distance(PG_FUNCTION_ARGS);
+
+static Datum ZeroDistance(FmgrInfo *flinfo, Oid collation, Datum arg1, Datum arg2);
+
+/*
+ * Get a lower bound of the exact distance for a quantized entry
+ *
+ * The bound is in the units of the order by operator, so the executor can
+ * recheck it against the heap vector and re-rank.
+ */
+static double
+GetQuantizedDistance(IvfflatScanOpaque so, Datum datum, Datum value)
+{
+	IvfflatInt8Vector *qvec = (IvfflatInt8Vector *) PG_DETOAST_DATUM(datum);
+	double		distance;
+	double		error;
+
+	IvfflatDequantize(qvec, so->dequantized);
+	distance = DatumGetFloat8(so->distfunc(so->procinfo, so->collation, PointerGetDatum(so->dequantized), value));
+
+	switch (so->metric)
+	{
+		case IVFFLAT_METRIC_L2:
+			/* Triangle inequality */
+			distance = sqrt(Max(distance, 0));
+			error = qvec->error;
+			break;
+		case IVFFLAT_METRIC_INNER_PRODUCT:
+			/* Cauchy-Schwarz */
+			error = so->valueNorm * qvec->error;
+			break;
+		case IVFFLAT_METRIC_COSINE:
+			/* Entries and value are normalized */
+			distance = 1 + distance;
+			error = qvec->error;
+			break;
+		default:
+			elog(ERROR, "unknown metric");
+	}
+
+	/* Short varlena headers are copied to align the entry */
+	if ((Pointer) qvec != DatumGetPointer(datum))
+		pfree(qvec);
+
+	/* Leave room for rounding in the distance functions */
+	return distance - error - 1e-4 * (fabs(distance) + error) - 1e-6;
+}
+
 /*
  * Get items
  */
@@ -151,7 +200,10 @@ GetScanItems(IndexScanDesc scan, Datum value)
 				 * performance
 				 */
 				ExecClearTuple(slot);
-				slot->tts_values[0] = so->distfunc(so->procinfo, so->collation, datum, value);
+				if (so->quantizer == IVFFLAT_QUANTIZER_INT8 && so->distfunc != ZeroDistance)
+					slot->tts_values[0] = Float8GetDatum(GetQuantizedDistance(so, datum, value));
+				else
+					slot->tts_values[0] = so->distfunc(so->procinfo, so->collation, datum, value);
 				slot->tts_isnull[0] = false;
 				slot->tts_values[1] = PointerGetDatum(&itup->t_tid);
 				slot->tts_isnull[1] = false;
@@ -214,6 +266,17 @@ GetScanValue(IndexScanDesc scan)
 
 			MemoryContextSwitchTo(oldCtx);
 		}
+
+		if (so->quantizer == IVFFLAT_QUANTIZER_INT8)
+		{
+			Vector	   *vec = (Vector *) DatumGetPointer(value);
+			double		norm = 0;
+
+			for (int i = 0; i < vec->dim; i++)
+				norm += (double) vec->x[i] * (double) vec->x[i];
+
+			so->valueNorm = sqrt(norm);
+		}
 	}
 
 	return value;
@@ -246,12 +309,13 @@ ivfflatbeginscan(Relation index, int nkeys, int norderbys)
 	int			dimensions;
 	int			probes = ivfflat_probes;
 	int			maxProbes;
+	int			quantizer;
 	MemoryContext oldCtx;
 
 	scan = RelationGetIndexScan(index, nkeys, norderbys);
 
-	/* Get lists and dimensions from metapage */
-	IvfflatGetMetaPageInfo(index, &lists, &dimensions);
+	/* Get lists, dimensions, and quantizer from metapage */
+	IvfflatGetMetaPageInfo(index, &lists, &dimensions, &quantizer);
 
 	if (ivfflat_iterative_scan != IVFFLAT_ITERATIVE_SCAN_OFF)
 		maxProbes = Max(ivfflat_max_probes, probes);
@@ -276,12 +340,31 @@ ivfflatbeginscan(Relation index, int nkeys, int norderbys)
 	so->normprocinfo = IvfflatOptionalProcInfo(index, IVFFLAT_NORM_PROC);
 	so->collation = index->rd_indcollation[0];
 
+	/* Set quantization */
+	so->quantizer = quantizer;
+	so->valueNorm = 0;
+	if (so->procinfo->fn_addr == vector_l2_squared_distance)
+		so->metric = IVFFLAT_METRIC_L2;
+	else if (so->normprocinfo != NULL)
+		so->metric = IVFFLAT_METRIC_COSINE;
+	else
+		so->metric = IVFFLAT_METRIC_INNER_PRODUCT;
+
 	so->tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
 									   "Ivfflat scan temporary context",
 									   ALLOCSET_DEFAULT_SIZES);
 
 	oldCtx = MemoryContextSwitchTo(so->tmpCtx);
 
+	/* Quantized entries return a lower bound that the executor rechecks */
+	so->dequantized = NULL;
+	if (quantizer != IVFFLAT_QUANTIZER_NONE)
+	{
+		so->dequantized = InitVector(dimensions);
+		scan->xs_orderbyvals = palloc0(sizeof(Datum) * norderbys);
+		scan->xs_orderbynulls = palloc0(sizeof(bool) * norderbys);
+	}
+
 	/* Create tuple description for sorting */
 	so->tupdesc = CreateTemplateTupleDesc(2, false);
 	TupleDescInitEntry(so->tupdesc, (AttrNumber) 1, "distance", FLOAT8OID, -1, 0);
@@ -321,6 +404,17 @@ ivfflatrescan(IndexScanDesc scan, ScanKey keys, int nkeys, ScanKey orderbys, int
 {
 	IvfflatScanOpaque so = (IvfflatScanOpaque) scan->opaque;
 
+	/* Start over with a new sort state since tuples may have been added */
+	if (!so->first)
+	{
+		MemoryContext oldCtx = MemoryContextSwitchTo(so->tmpCtx);
+
+		tuplesort_end(so->sortstate);
+		so->sortstate = InitScanSortState(so->tupdesc);
+
+		MemoryContextSwitchTo(oldCtx);
+	}
+
 	so->first = true;
 	pairingheap_reset(so->listQueue);
 	so->listIndex = 0;
@@ -365,6 +459,20 @@ ivfflatgettuple(IndexScanDesc scan, ScanDirection dir)
 			elog(ERROR, "non-MVCC snapshots are not supported with ivfflat");
 
 		value = GetScanValue(scan);
+
+		/* In auto mode, only probe more lists when the executor filters */
+		if (ivfflat_iterative_scan == IVFFLAT_ITERATIVE_SCAN_AUTO && !scan->xs_filtered)
+			so->maxProbes = so->probes;
+
+		/*
+		 * Keep only the closest tuples when the number needed is known, such
+		 * as a LIMIT pushed down to each datanode. Quantized entries need
+		 * more candidates for re-ranking, and iterative scans need the rest.
+		 */
+		if (scan->xs_tuples_needed > 0 && so->quantizer == IVFFLAT_QUANTIZER_NONE &&
+			so->maxProbes == so->probes)
+			tuplesort_set_bound(so->sortstate, scan->xs_tuples_needed);
+
 		IvfflatBench("GetScanLists", GetScanLists(scan, value));
 		IvfflatBench("GetScanItems", GetScanItems(scan, value));
 		so->first = false;
@@ -384,6 +492,14 @@ ivfflatgettuple(IndexScanDesc scan, ScanDirection dir)
 	scan->xs_ctup.t_self = *heaptid;
 	scan->xs_recheck = false;
 	scan->xs_recheckorderby = false;
+
+	if (so->quantizer != IVFFLAT_QUANTIZER_NONE && so->distfunc != ZeroDistance)
+	{
+		scan->xs_orderbyvals[0] = slot_getattr(so->mslot, 1, &isnull);
+		scan->xs_orderbynulls[0] = false;
+		scan->xs_recheckorderby = true;
+	}
+
 	return true;
 }
 
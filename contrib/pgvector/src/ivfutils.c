@@ -1,5 +1,8 @@
 #include "postgres.h"
 
+#include <float.h>
+#include <math.h>
+
 #include "access/generic_xlog.h"
 #include "bitvec.h"
 #include "catalog/pg_type.h"
@@ -52,6 +55,39 @@ IvfflatGetLists(Relation index)
 	return IVFFLAT_DEFAULT_LISTS;
 }
 
+/*
+ * Get the quantizer from the index options
+ *
+ * Only used at build time, since scans and inserts rely on the metapage
+ */
+int
+IvfflatGetQuantizer(Relation index)
+{
+	IvfflatOptions *opts = (IvfflatOptions *) index->rd_options;
+
+	if (opts && opts->quantizerOffset > 0 &&
+		strcmp((char *) opts + opts->quantizerOffset, "int8") == 0)
+		return IVFFLAT_QUANTIZER_INT8;
+
+	return IVFFLAT_QUANTIZER_NONE;
+}
+
+/*
+ * Validate the quantizer option
+ */
+void
+IvfflatValidateQuantizer(const char *value)
+{
+	if (value == NULL)
+		return;
+
+	if (strcmp(value, "none") != 0 && strcmp(value, "int8") != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for quantizer option: \"%s\"", value),
+				 errdetail("Valid values are \"none\" and \"int8\".")));
+}
+
 /*
  * Get proc
  */
@@ -159,7 +195,7 @@ IvfflatAppendPage(Relation index, Buffer *buf, Page *page, GenericXLogState **st
  * Get the metapage info
  */
 void
-IvfflatGetMetaPageInfo(Relation index, int *lists, int *dimensions)
+IvfflatGetMetaPageInfo(Relation index, int *lists, int *dimensions, int *quantizer)
 {
 	Buffer		buf;
 	Page		page;
@@ -179,6 +215,9 @@ IvfflatGetMetaPageInfo(Relation index, int *lists, int *dimensions)
 	if (dimensions != NULL)
 		*dimensions = metap->dimensions;
 
+	if (quantizer != NULL)
+		*quantizer = metap->quantizer;
+
 	UnlockReleaseBuffer(buf);
 }
 
@@ -229,6 +268,70 @@ IvfflatUpdateList(Relation index, ListInfo listInfo,
 	}
 }
 
+/*
+ * Quantize a vector to int8 with a per-vector scale
+ */
+Datum
+IvfflatQuantizeValue(Datum value)
+{
+	Vector	   *vec = DatumGetVector(value);
+	IvfflatInt8Vector *result;
+	float		maxabs = 0;
+	float		scale;
+	double		error = 0;
+
+	for (int i = 0; i < vec->dim; i++)
+	{
+		float		ax = fabsf(vec->x[i]);
+
+		if (ax > maxabs)
+			maxabs = ax;
+	}
+
+	scale = maxabs / 127;
+
+	result = (IvfflatInt8Vector *) palloc0(IVFFLAT_INT8_SIZE(vec->dim));
+	SET_VARSIZE(result, IVFFLAT_INT8_SIZE(vec->dim));
+	result->dim = vec->dim;
+	result->scale = scale;
+
+	for (int i = 0; i < vec->dim; i++)
+	{
+		double		diff;
+		int			code = 0;
+
+		if (scale > 0)
+		{
+			code = (int) rint(vec->x[i] / scale);
+			code = Min(Max(code, -127), 127);
+		}
+
+		result->x[i] = (int8) code;
+
+		diff = (double) vec->x[i] - (double) code * scale;
+		error += diff * diff;
+	}
+
+	/* Round up so the bound stays conservative after conversion to float */
+	result->error = nextafterf((float) sqrt(error), FLT_MAX);
+
+	return PointerGetDatum(result);
+}
+
+/*
+ * Dequantize an int8 vector into preallocated storage
+ */
+void
+IvfflatDequantize(IvfflatInt8Vector * qvec, Vector * result)
+{
+	SET_VARSIZE(result, VECTOR_SIZE(qvec->dim));
+	result->dim = qvec->dim;
+	result->unused = 0;
+
+	for (int i = 0; i < qvec->dim; i++)
+		result->x[i] = qvec->x[i] * qvec->scale;
+}
+
 PGDLLEXPORT Datum l2_normalize(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum halfvec_l2_normalize(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum sparsevec_l2_normalize(PG_FUNCTION_ARGS);
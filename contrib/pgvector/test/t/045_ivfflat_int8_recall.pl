@@ -0,0 +1,142 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $node;
+my @queries = ();
+my @expected;
+my $limit = 20;
+my $dim = 32;
+
+sub test_recall
+{
+	my ($probes, $min, $operator) = @_;
+	my $correct = 0;
+	my $total = 0;
+
+	my $explain = $node->safe_psql("postgres", qq(
+		SET enable_seqscan = off;
+		SET ivfflat.probes = $probes;
+		EXPLAIN ANALYZE SELECT i FROM tst ORDER BY v $operator '$queries[0]' LIMIT $limit;
+	));
+	like($explain, qr/Index Scan using idx on tst/);
+
+	for my $i (0 .. $#queries)
+	{
+		my $actual = $node->safe_psql("postgres", qq(
+			SET enable_seqscan = off;
+			SET ivfflat.probes = $probes;
+			SELECT i FROM tst ORDER BY v $operator '$queries[$i]' LIMIT $limit;
+		));
+		my @actual_ids = split("\n", $actual);
+
+		my @expected_ids = split("\n", $expected[$i]);
+		my %expected_set = map { $_ => 1 } @expected_ids;
+
+		foreach (@actual_ids)
+		{
+			if (exists($expected_set{$_}))
+			{
+				$correct++;
+			}
+		}
+
+		$total += $limit;
+	}
+
+	cmp_ok($correct / $total, ">=", $min, $operator);
+}
+
+# Initialize node
+$node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create table
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (i int4, v vector($dim));");
+$node->safe_psql("postgres",
+	"INSERT INTO tst SELECT i, ARRAY(SELECT random() FROM generate_series(1, $dim) WHERE i > 0) FROM generate_series(1, 50000) i;"
+);
+
+# Generate queries
+for (1 .. 20)
+{
+	my @r = map { rand() } (1 .. $dim);
+	push(@queries, "[" . join(",", @r) . "]");
+}
+
+# Test invalid quantizer
+my ($ret, $stdout, $stderr) = $node->psql("postgres",
+	"CREATE INDEX ON tst USING ivfflat (v vector_l2_ops) WITH (quantizer = 'pq');"
+);
+like($stderr, qr/invalid value for quantizer option/);
+
+# Check each index type
+my @operators = ("<->", "<#>", "<=>");
+my @opclasses = ("vector_l2_ops", "vector_ip_ops", "vector_cosine_ops");
+
+for my $i (0 .. $#operators)
+{
+	my $operator = $operators[$i];
+	my $opclass = $opclasses[$i];
+
+	# Get exact results
+	@expected = ();
+	foreach (@queries)
+	{
+		my $res = $node->safe_psql("postgres", qq(
+			WITH top AS (
+				SELECT v $operator '$_' AS distance FROM tst ORDER BY distance LIMIT $limit
+			)
+			SELECT i FROM tst WHERE (v $operator '$_') <= (SELECT MAX(distance) FROM top)
+		));
+		push(@expected, $res);
+	}
+
+	# Build full-precision index for size comparison
+	$node->safe_psql("postgres", "CREATE INDEX idx ON tst USING ivfflat (v $opclass);");
+	my $size = $node->safe_psql("postgres", "SELECT pg_relation_size('idx');");
+	$node->safe_psql("postgres", "DROP INDEX idx;");
+
+	# Build quantized index
+	$node->safe_psql("postgres", "CREATE INDEX idx ON tst USING ivfflat (v $opclass) WITH (quantizer = 'int8');");
+	my $int8_size = $node->safe_psql("postgres", "SELECT pg_relation_size('idx');");
+	cmp_ok($int8_size, "<", $size / 2, "$operator size");
+	diag("$operator index size: $size bytes, int8: $int8_size bytes");
+
+	# Test approximate results (re-ranked against heap vectors)
+	if ($operator ne "<#>")
+	{
+		test_recall(10, 0.9, $operator);
+	}
+
+	# Test probes equals lists
+	if ($operator eq "<=>")
+	{
+		test_recall(100, 0.9925, $operator);
+	}
+	else
+	{
+		test_recall(100, 1.00, $operator);
+	}
+
+	# Test inserts go through the quantizer
+	if ($operator eq "<->")
+	{
+		$node->safe_psql("postgres", "INSERT INTO tst SELECT i, '$queries[0]' FROM generate_series(50001, 50005) i;");
+		my $res = $node->safe_psql("postgres", qq(
+			SET enable_seqscan = off;
+			SET ivfflat.probes = 100;
+			SELECT COUNT(*) FROM (SELECT i FROM tst ORDER BY v <-> '$queries[0]' LIMIT 5) t WHERE i > 50000;
+		));
+		is($res, 5);
+		$node->safe_psql("postgres", "DELETE FROM tst WHERE i > 50000;");
+	}
+
+	$node->safe_psql("postgres", "DROP INDEX idx;");
+}
+
+done_testing();
@@ -0,0 +1,64 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $dim = 3;
+my $array_sql = join(",", ('random()') x $dim);
+
+# Initialize node
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create table
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (i int4 PRIMARY KEY, v vector($dim));");
+$node->safe_psql("postgres",
+	"INSERT INTO tst SELECT i, ARRAY[$array_sql] FROM generate_series(1, 10000) i;"
+);
+
+# Test LIMIT above ef_search returns enough rows in one pass
+$node->safe_psql("postgres", "CREATE INDEX hnsw_idx ON tst USING hnsw (v vector_l2_ops);");
+my $count = $node->safe_psql("postgres", qq(
+	SET enable_seqscan = off;
+	SET hnsw.ef_search = 10;
+	SELECT COUNT(*) FROM (SELECT i FROM tst ORDER BY v <-> '[0.5,0.5,0.5]' LIMIT 100) t;
+));
+is($count, 100);
+
+# Test bound is not applied with a filter
+$count = $node->safe_psql("postgres", qq(
+	SET enable_seqscan = off;
+	SET hnsw.ef_search = 10;
+	SELECT COUNT(*) FROM (SELECT i FROM tst WHERE i % 2 = 0 ORDER BY v <-> '[0.5,0.5,0.5]' LIMIT 100) t;
+));
+cmp_ok($count, "<=", 10);
+$node->safe_psql("postgres", "DROP INDEX hnsw_idx;");
+
+# Test bounded sort returns the same rows as a full sort
+$node->safe_psql("postgres", "CREATE INDEX ivfflat_idx ON tst USING ivfflat (v vector_l2_ops) WITH (lists = 10);");
+my $expected = $node->safe_psql("postgres", qq(
+	SET enable_seqscan = off;
+	SET ivfflat.probes = 3;
+	SELECT i FROM (SELECT i, row_number() OVER () AS n FROM (SELECT i FROM tst ORDER BY v <-> '[0.5,0.5,0.5]') s) t WHERE n <= 20;
+));
+my $actual = $node->safe_psql("postgres", qq(
+	SET enable_seqscan = off;
+	SET ivfflat.probes = 3;
+	SELECT i FROM tst ORDER BY v <-> '[0.5,0.5,0.5]' LIMIT 20;
+));
+is($actual, $expected);
+
+# Test rescans
+$count = $node->safe_psql("postgres", qq(
+	SET enable_seqscan = off;
+	SET enable_hashjoin = off;
+	SET enable_mergejoin = off;
+	SET ivfflat.probes = 10;
+	SELECT COUNT(*) FROM generate_series(1, 3) g, LATERAL (SELECT i FROM tst ORDER BY v <-> ARRAY[g, g, g]::vector LIMIT 5) t;
+));
+is($count, 15);
+
+done_testing();
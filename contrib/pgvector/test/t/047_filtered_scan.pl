@@ -0,0 +1,59 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $dim = 3;
+my $array_sql = join(",", ('random()') x $dim);
+
+# Initialize node
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create table
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (i int4 PRIMARY KEY, v vector($dim), c int4);");
+$node->safe_psql("postgres",
+	"INSERT INTO tst SELECT i, ARRAY[$array_sql], i % 100 FROM generate_series(1, 20000) i;"
+);
+$node->safe_psql("postgres", "CREATE INDEX ON tst (c);");
+$node->safe_psql("postgres", "ANALYZE tst;");
+
+for my $type (("hnsw", "ivfflat"))
+{
+	my $opts = $type eq "ivfflat" ? "WITH (lists = 100)" : "";
+	$node->safe_psql("postgres", "CREATE INDEX idx ON tst USING $type (v vector_l2_ops) $opts;");
+
+	# Test auto expands the scan for filtered queries
+	my $count = $node->safe_psql("postgres", qq(
+		SET enable_seqscan = off;
+		SET enable_bitmapscan = off;
+		SET enable_indexscan = on;
+		SET $type.iterative_scan = auto;
+		SELECT COUNT(*) FROM (SELECT i FROM tst WHERE c = 5 ORDER BY v <-> '[0.5,0.5,0.5]' LIMIT 10) t;
+	));
+	is($count, 10, "$type filtered");
+
+	# Test auto does not expand the scan without a filter
+	$count = $node->safe_psql("postgres", qq(
+		SET enable_seqscan = off;
+		SET hnsw.ef_search = 10;
+		SET ivfflat.probes = 1;
+		SET $type.iterative_scan = auto;
+		SELECT COUNT(*) FROM (SELECT i FROM tst ORDER BY v <-> '[0.5,0.5,0.5]') t;
+	));
+	cmp_ok($count, "<", 20000, "$type unfiltered");
+
+	# Test selective filters favor an exact scan
+	my $explain = $node->safe_psql("postgres", qq(
+		SET $type.iterative_scan = auto;
+		EXPLAIN SELECT i FROM tst WHERE c = 5 ORDER BY v <-> '[0.5,0.5,0.5]' LIMIT 10;
+	));
+	unlike($explain, qr/Index Scan using idx/, "$type selective filter");
+
+	$node->safe_psql("postgres", "DROP INDEX idx;");
+}
+
+done_testing();
@@ -0,0 +1,39 @@
+-- predictability
+SET synchronous_commit = on;
+CREATE TABLE shard_tbl(id int primary key, data text);
+SELECT 'init' FROM pg_create_logical_replication_slot('regression_slot', 'test_decoding');
+INSERT INTO shard_tbl SELECT i, 'row ' || i FROM generate_series(1, 20) i;
+UPDATE shard_tbl SET data = 'updated' WHERE id <= 10;
+
+-- the rows are spread over several shards
+SELECT count(DISTINCT shardid) > 1 AS several_shards FROM shard_tbl;
+
+-- without a shard list, every change is decoded
+SELECT count(*) FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1')
+WHERE data LIKE 'table public.shard_tbl:%';
+
+-- only the changes to the shard of row 1
+SELECT d.decoded = e.expected AS filtered, d.row1
+FROM (SELECT count(*) AS decoded, count(*) FILTER (WHERE data LIKE '%id[integer]:1 %') AS row1
+      FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1',
+                                        'only-shards', (SELECT shardid::text FROM shard_tbl WHERE id = 1))
+      WHERE data LIKE 'table public.shard_tbl:%') d,
+     (SELECT count(*) + count(*) FILTER (WHERE id <= 10) AS expected
+      FROM shard_tbl WHERE shardid = (SELECT shardid FROM shard_tbl WHERE id = 1)) e;
+
+-- only the changes to the shards of rows 1 and 2
+SELECT d.decoded = e.expected AS filtered
+FROM (SELECT count(*) AS decoded
+      FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1',
+                                        'only-shards', (SELECT string_agg(DISTINCT shardid::text, ',') FROM shard_tbl WHERE id IN (1, 2)))
+      WHERE data LIKE 'table public.shard_tbl:%') d,
+     (SELECT count(*) + count(*) FILTER (WHERE id <= 10) AS expected
+      FROM shard_tbl WHERE shardid IN (SELECT shardid FROM shard_tbl WHERE id IN (1, 2))) e;
+
+-- fail because of invalid shard lists
+SELECT data FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'only-shards', 'frakbar');
+SELECT data FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'only-shards', '1,');
+SELECT data FROM pg_logical_slot_peek_changes('regression_slot', NULL, NULL, 'only-shards', '-1');
+SELECT count(*) FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL, 'include-xids', '0', 'skip-empty-xacts', '1');
+SELECT pg_drop_replication_slot('regression_slot');
+DROP TABLE shard_tbl;
@@ -46,6 +46,7 @@ typedef struct
 	bool		skip_empty_xacts;
 	bool		xact_wrote_changes;
 	bool		only_local;
+	Bitmapset  *only_shards;	/* shards to decode, NULL for all */
 } TestDecodingData;
 
 static void pg_decode_startup(LogicalDecodingContext *ctx, OutputPluginOptions *opt,
@@ -64,6 +65,8 @@ static void pg_decode_change(LogicalDecodingContext *ctx,
 				 ReorderBufferChange *change);
 static bool pg_decode_filter(LogicalDecodingContext *ctx,
 				 RepOriginId origin_id);
+static bool pg_decode_filter_shard(LogicalDecodingContext *ctx,
+					   ShardID shardid);
 static void pg_decode_message(LogicalDecodingContext *ctx,
 				  ReorderBufferTXN *txn, XLogRecPtr message_lsn,
 				  bool transactional, const char *prefix,
@@ -86,6 +89,7 @@ _PG_output_plugin_init(OutputPluginCallbacks *cb)
 	cb->change_cb = pg_decode_change;
 	cb->commit_cb = pg_decode_commit_txn;
 	cb->filter_by_origin_cb = pg_decode_filter;
+	cb->filter_by_shard_cb = pg_decode_filter_shard;
 	cb->shutdown_cb = pg_decode_shutdown;
 	cb->message_cb = pg_decode_message;
 }
@@ -107,6 +111,7 @@ pg_decode_startup(LogicalDecodingContext *ctx, OutputPluginOptions *opt,
 	data->include_timestamp = false;
 	data->skip_empty_xacts = false;
 	data->only_local = false;
+	data->only_shards = NULL;
 
 	ctx->output_plugin_private = data;
 
@@ -176,6 +181,29 @@ pg_decode_startup(LogicalDecodingContext *ctx, OutputPluginOptions *opt,
 						 errmsg("could not parse value \"%s\" for parameter \"%s\"",
 								strVal(elem->arg), elem->defname)));
 		}
+		else if (strcmp(elem->defname, "only-shards") == 0)
+		{
+			/* a comma separated list of shard ids */
+			char	   *str = elem->arg ? strVal(elem->arg) : "";
+			char	   *endptr;
+			long		shardid;
+
+			do
+			{
+				errno = 0;
+				shardid = strtol(str, &endptr, 10);
+				if (endptr == str || errno != 0 || !ShardIDIsValid(shardid) ||
+					(*endptr != ',' && *endptr != '\0'))
+					ereport(ERROR,
+							(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+							 errmsg("could not parse value \"%s\" for parameter \"%s\"",
+									elem->arg ? strVal(elem->arg) : "(null)",
+									elem->defname)));
+				data->only_shards = bms_add_member(data->only_shards,
+												   (int) shardid);
+				str = endptr + 1;
+			} while (*endptr == ',');
+		}
 		else
 		{
 			ereport(ERROR,
@@ -255,6 +283,17 @@ pg_decode_filter(LogicalDecodingContext *ctx,
 	return false;
 }
 
+static bool
+pg_decode_filter_shard(LogicalDecodingContext *ctx,
+					   ShardID shardid)
+{
+	TestDecodingData *data = ctx->output_plugin_private;
+
+	if (data->only_shards && !bms_is_member(shardid, data->only_shards))
+		return true;
+	return false;
+}
+
 /*
  * Print literal `outputstr' already represented as string of type `typid'
  * into stringbuf `s'.
@@ -134,6 +134,16 @@ static relopt_bool boolRelOpts[] =
 		},
 		true
 	},
+	{
+		{
+			"deduplicate_items",
+			"Enables \"deduplicate items\" feature for this btree index",
+			RELOPT_KIND_BTREE,
+			ShareUpdateExclusiveLock	/* since it applies only to later
+										 * inserts */
+		},
+		false
+	},
 	{
 		{
 			"security_barrier",
@@ -1558,7 +1568,9 @@ default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
 		{"rel_parallel_dml", RELOPT_TYPE_STRING,
 		offsetof(StdRdOptions, rel_parallel_dml)},
 		{"checksum", RELOPT_TYPE_BOOL,
-		offsetof(StdRdOptions, checksum)}
+		offsetof(StdRdOptions, checksum)},
+		{"deduplicate_items", RELOPT_TYPE_BOOL,
+		offsetof(StdRdOptions, deduplicate_items)}
 	};
 
 	options = parseRelOptions(reloptions, validate, kind, &numoptions);
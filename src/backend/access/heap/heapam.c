@@ -112,8 +112,9 @@
 /* Cap the size of parallel I/O chunks to this number of blocks */
 #define PARALLEL_SEQSCAN_MAX_CHUNK_SIZE		8192
 
-/* GUC variable */
+/* GUC variables */
 bool		synchronize_seqscans = true;
+int			seqscan_prefetch_pages = 0;
 
 /* inplace upgrade */
 Oid			inplace_upgrade_next_general_oid = InvalidOid;
@@ -130,6 +131,7 @@ static HeapScanDesc heap_beginscan_internal(Relation relation,
 						bool temp_snap);
 static void heap_parallelscan_startblock_init(HeapScanDesc scan);
 static BlockNumber heap_parallelscan_nextpage(HeapScanDesc scan);
+static void heap_prefetch_pages(HeapScanDesc scan, BlockNumber page);
 
 static XLogRecPtr log_heap_update(Relation reln, Buffer oldbuf,
 				Buffer newbuf, HeapTuple oldtup,
@@ -340,6 +342,8 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 	ItemPointerSetInvalid(&scan->rs_ctup.t_self);
 	scan->rs_cbuf = InvalidBuffer;
 	scan->rs_cblock = InvalidBlockNumber;
+	scan->rs_prefetch_target = 0;
+	scan->rs_prefetch_next = 0;
 
 	/* page-at-a-time fields are always invalid when not rs_inited */
 
@@ -415,6 +419,14 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
 	/* read page using selected strategy */
 	scan->rs_cbuf = ReadBufferExtended(scan->rs_rd, MAIN_FORKNUM, page,
 									   RBM_NORMAL, scan->rs_strategy);
+
+	/*
+	 * Issue prefetch requests for the pages ahead of this one after reading
+	 * it, so that they don't delay the read we have to wait for anyway.
+	 */
+	if (seqscan_prefetch_pages > 0)
+		heap_prefetch_pages(scan, page);
+
 	scan->rs_cblock = page;
 
 	if (!scan->rs_pageatatime)
@@ -512,6 +524,78 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
 	scan->rs_ntuples = ntup;
 }
 
+/*
+ * heap_prefetch_pages - prefetch the pages a forward scan will read next
+ *
+ * A sequential scan relies on the kernel's readahead to overlap its reads,
+ * which doesn't keep enough requests in flight to saturate storage that
+ * works best with many concurrent requests.  So, like a bitmap heap scan,
+ * we issue prefetch requests for up to seqscan_prefetch_pages pages ahead
+ * of the page just read.  The distance starts small and grows with every
+ * page read, so that a scan that stops early doesn't do much useless I/O.
+ *
+ * Pages are numbered by their position in the scan, counting from
+ * rs_startblock and wrapping around at the end of the relation.  We only
+ * prefetch while the scan moves forward; whenever it moves any other way,
+ * the distance starts over.  Parallel scans are not handled, since the next
+ * pages of this backend are not known in advance.
+ */
+static void
+heap_prefetch_pages(HeapScanDesc scan, BlockNumber page)
+{
+	BlockNumber nblocks = scan->rs_nblocks;
+	BlockNumber pos;
+	BlockNumber end;
+	BlockNumber first;
+	BlockNumber count;
+
+	if (scan->rs_parallel != NULL || scan->rs_samplescan ||
+		scan->rs_bitmapscan)
+		return;
+
+	pos = (page + nblocks - scan->rs_startblock) % nblocks;
+
+	if (!BlockNumberIsValid(scan->rs_cblock) ||
+		pos <= (scan->rs_cblock + nblocks - scan->rs_startblock) % nblocks)
+	{
+		/* first page, or not moving forward: start over */
+		scan->rs_prefetch_target = 0;
+		scan->rs_prefetch_next = pos + 1;
+		if (BlockNumberIsValid(scan->rs_cblock))
+			return;
+	}
+
+	if (scan->rs_prefetch_target < seqscan_prefetch_pages)
+		scan->rs_prefetch_target = Min(scan->rs_prefetch_target * 2 + 1,
+									   seqscan_prefetch_pages);
+	else if (scan->rs_prefetch_target > seqscan_prefetch_pages)
+		scan->rs_prefetch_target = seqscan_prefetch_pages;
+
+	/* the scan may have skipped pages, e.g. unused extents */
+	if (scan->rs_prefetch_next <= pos)
+		scan->rs_prefetch_next = pos + 1;
+
+	/* don't prefetch past the end of the scan */
+	end = Min((uint64) pos + scan->rs_prefetch_target + 1, nblocks);
+	if (scan->rs_numblocks != InvalidBlockNumber)
+		end = Min((uint64) end, (uint64) pos + scan->rs_numblocks);
+
+	if (scan->rs_prefetch_next >= end)
+		return;
+
+	/* one request per contiguous range, split where the scan wraps around */
+	first = (scan->rs_startblock + scan->rs_prefetch_next) % nblocks;
+	count = end - scan->rs_prefetch_next;
+	if (first + count > nblocks)
+	{
+		PrefetchBufferRange(scan->rs_rd, MAIN_FORKNUM, first, nblocks - first);
+		count -= nblocks - first;
+		first = 0;
+	}
+	PrefetchBufferRange(scan->rs_rd, MAIN_FORKNUM, first, count);
+	scan->rs_prefetch_next = end;
+}
+
 /* ----------------
  *		heapgettup - fetch next heap tuple
  *
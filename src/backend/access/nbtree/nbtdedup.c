@@ -0,0 +1,350 @@
+/*-------------------------------------------------------------------------
+ *
+ * nbtdedup.c
+ *	  Deduplicate items in Postgres btrees.
+ *
+ * A run of leaf tuples whose keys are bitwise equal can be replaced by a
+ * single posting list tuple that stores the key once, followed by the heap
+ * TIDs of all tuples of the run (see BTreeTupleIsPosting in nbtree.h).  This
+ * saves a lot of space in indexes on low-cardinality columns.
+ *
+ * Bitwise equality is stricter than opclass equality, so merging never
+ * changes the order of the items on a page, nor what an index-only scan
+ * returns.  Since this btree version does not use the heap TID as a key
+ * attribute, tuples with equal keys may appear in any order, and new
+ * tuples never have to be inserted into the middle of an existing posting
+ * list.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/nbtree/nbtdedup.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/nbtree.h"
+#include "access/xloginsert.h"
+#include "miscadmin.h"
+#include "utils/rel.h"
+
+static Size _bt_dedup_keysize(IndexTuple itup);
+static int	_bt_dedup_htid_cmp(const void *a, const void *b);
+static int	_bt_dedup_flush(BTDedupState state, Page newpage,
+				OffsetNumber newoff);
+static void _bt_dedup_addtup(Page page, IndexTuple itup, OffsetNumber off);
+
+/*
+ * Initialize a deduplication state.  The heap TID workspace is allocated in
+ * the current memory context.
+ */
+void
+_bt_dedup_init(BTDedupState state, Size maxpostingsize)
+{
+	state->maxpostingsize = maxpostingsize;
+	state->base = NULL;
+	state->basekeysz = 0;
+	/* a posting list never holds more TIDs than fit into maxpostingsize */
+	state->htids = (ItemPointer) palloc(maxpostingsize);
+	state->nhtids = 0;
+	state->nitems = 0;
+}
+
+/*
+ * Are the keys of two leaf tuples bitwise equal?
+ *
+ * index_form_tuple() zeroes alignment padding, so comparing the whole key
+ * image including the null bitmap is enough.
+ */
+bool
+_bt_dedup_keyequal(IndexTuple itup1, IndexTuple itup2)
+{
+	Size		keysz = _bt_dedup_keysize(itup1);
+
+	if (keysz != _bt_dedup_keysize(itup2))
+		return false;
+	if ((itup1->t_info & (INDEX_NULL_MASK | INDEX_VAR_MASK)) !=
+		(itup2->t_info & (INDEX_NULL_MASK | INDEX_VAR_MASK)))
+		return false;
+
+	return memcmp((char *) itup1 + sizeof(IndexTupleData),
+				  (char *) itup2 + sizeof(IndexTupleData),
+				  keysz - sizeof(IndexTupleData)) == 0;
+}
+
+/*
+ * Start a new pending run with 'base' as its first tuple.  'base' must stay
+ * valid until _bt_dedup_finish_pending() is called.
+ */
+void
+_bt_dedup_start_pending(BTDedupState state, IndexTuple base)
+{
+	int			nhtids = BTreeTupleGetNHeapTIDs(base);
+
+	state->base = base;
+	state->basekeysz = _bt_dedup_keysize(base);
+	memcpy(state->htids, BTreeTupleGetHeapTID(base),
+		   nhtids * sizeof(ItemPointerData));
+	state->nhtids = nhtids;
+	state->nitems = 1;
+}
+
+/*
+ * Add the heap TIDs of 'itup' to the pending run.  The caller has checked
+ * that its key equals the key of the base tuple.  Returns false, leaving the
+ * run unchanged, if the merged tuple would become too large.
+ */
+bool
+_bt_dedup_save_htid(BTDedupState state, IndexTuple itup)
+{
+	int			nhtids = BTreeTupleGetNHeapTIDs(itup);
+	Size		mergedsz;
+
+	mergedsz = MAXALIGN(state->basekeysz +
+						(state->nhtids + nhtids) * sizeof(ItemPointerData));
+	if (mergedsz > state->maxpostingsize)
+		return false;
+
+	memcpy(state->htids + state->nhtids, BTreeTupleGetHeapTID(itup),
+		   nhtids * sizeof(ItemPointerData));
+	state->nhtids += nhtids;
+	state->nitems++;
+
+	return true;
+}
+
+/*
+ * Finish the pending run.  Returns the base tuple itself if nothing was
+ * merged into it, else a palloc'd posting list tuple.
+ */
+IndexTuple
+_bt_dedup_finish_pending(BTDedupState state)
+{
+	IndexTuple	result;
+
+	Assert(state->nitems > 0);
+
+	if (state->nitems == 1)
+		result = state->base;
+	else
+	{
+		qsort(state->htids, state->nhtids, sizeof(ItemPointerData),
+			  _bt_dedup_htid_cmp);
+		result = _bt_form_posting(state->base, state->htids, state->nhtids);
+	}
+
+	state->base = NULL;
+	state->nhtids = 0;
+	state->nitems = 0;
+
+	return result;
+}
+
+/*
+ * Try to make room on a full leaf page by merging runs of equal tuples into
+ * posting list tuples.  Called right before the page would be split.
+ *
+ * Items marked LP_DEAD are left alone; the caller has normally removed them
+ * already.  The page is rebuilt in a temporary copy outside the critical
+ * section, and the result is WAL-logged as a full page image, which needs
+ * no support in redo.  Returns true if anything was merged.
+ *
+ * No heap TID goes away, so this never conflicts with hot standby queries.
+ * Scans holding a pin on the page cope the same way as with a concurrent
+ * insertion: _bt_killitems() locates items by heap TID, not by offset.
+ */
+bool
+_bt_dedup_pass(Relation rel, Buffer buf)
+{
+	Page		page = BufferGetPage(buf);
+	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+	OffsetNumber minoff = P_FIRSTDATAKEY(opaque);
+	OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
+	OffsetNumber offnum;
+	OffsetNumber newoff;
+	BTDedupStateData state;
+	Page		newpage;
+	int			nmerged = 0;
+	bool		found = false;
+
+	Assert(P_ISLEAF(opaque));
+
+	/*
+	 * Cheap precheck: don't bother with a temp page unless there is at least
+	 * one pair of adjacent equal items.
+	 */
+	for (offnum = minoff; offnum < maxoff; offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+		ItemId		nextid = PageGetItemId(page, OffsetNumberNext(offnum));
+
+		if (ItemIdIsDead(itemid) || ItemIdIsDead(nextid))
+			continue;
+		if (_bt_dedup_keyequal((IndexTuple) PageGetItem(page, itemid),
+							   (IndexTuple) PageGetItem(page, nextid)))
+		{
+			found = true;
+			break;
+		}
+	}
+	if (!found)
+		return false;
+
+	_bt_dedup_init(&state, BTMaxPostingSize(page));
+
+	newpage = PageGetTempPageCopySpecial(page, RelationHasChecksum(rel));
+	PageSetLSN(newpage, PageGetLSN(page));
+
+	/* copy the high key, if any */
+	newoff = P_HIKEY;
+	if (!P_RIGHTMOST(opaque))
+	{
+		ItemId		hitemid = PageGetItemId(page, P_HIKEY);
+
+		_bt_dedup_addtup(newpage, (IndexTuple) PageGetItem(page, hitemid),
+						 newoff);
+		newoff = OffsetNumberNext(newoff);
+	}
+
+	for (offnum = minoff; offnum <= maxoff; offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+		IndexTuple	itup = (IndexTuple) PageGetItem(page, itemid);
+
+		if (state.base != NULL && !ItemIdIsDead(itemid) &&
+			_bt_dedup_keyequal(state.base, itup) &&
+			_bt_dedup_save_htid(&state, itup))
+			continue;
+
+		/* flush the pending run, if any */
+		if (state.base != NULL)
+		{
+			nmerged += _bt_dedup_flush(&state, newpage, newoff);
+			newoff = OffsetNumberNext(newoff);
+		}
+
+		if (ItemIdIsDead(itemid))
+		{
+			/* keep LP_DEAD items as they are, so that they can be removed */
+			_bt_dedup_addtup(newpage, itup, newoff);
+			ItemIdMarkDead(PageGetItemId(newpage, newoff));
+			newoff = OffsetNumberNext(newoff);
+		}
+		else
+			_bt_dedup_start_pending(&state, itup);
+	}
+
+	if (state.base != NULL)
+		nmerged += _bt_dedup_flush(&state, newpage, newoff);
+
+	pfree(state.htids);
+
+	if (nmerged == 0)
+	{
+		/* all equal runs were too large to be merged further */
+		pfree(newpage);
+		return false;
+	}
+
+	/* No ereport(ERROR) until changes are logged */
+	START_CRIT_SECTION();
+
+	PageRestoreTempPage(newpage, page);
+	MarkBufferDirty(buf);
+
+	if (RelationNeedsWAL(rel))
+		log_newpage_buffer(buf, true, RelationHasChecksum(rel));
+
+	END_CRIT_SECTION();
+
+	return true;
+}
+
+/*
+ * Form a leaf tuple with the key of 'base' and the given heap TIDs, which
+ * must be in ascending order.  With a single heap TID the result is a plain
+ * tuple; this is also how a posting list is stripped off to form a pivot.
+ */
+IndexTuple
+_bt_form_posting(IndexTuple base, ItemPointer htids, int nhtids)
+{
+	Size		keysz = _bt_dedup_keysize(base);
+	Size		newsize;
+	IndexTuple	itup;
+
+	Assert(nhtids > 0);
+
+	if (nhtids > 1)
+		newsize = MAXALIGN(keysz + nhtids * sizeof(ItemPointerData));
+	else
+		newsize = keysz;
+
+	Assert(newsize <= INDEX_SIZE_MASK);
+
+	itup = (IndexTuple) palloc0(newsize);
+	memcpy(itup, base, keysz);
+	itup->t_info &= ~(INDEX_SIZE_MASK | INDEX_ALT_TID_MASK);
+	itup->t_info |= newsize;
+
+	if (nhtids > 1)
+	{
+		itup->t_info |= INDEX_ALT_TID_MASK;
+		ItemPointerSetBlockNumber(&itup->t_tid, keysz);
+		ItemPointerSetOffsetNumber(&itup->t_tid, nhtids);
+		memcpy(BTreeTupleGetPosting(itup), htids,
+			   nhtids * sizeof(ItemPointerData));
+	}
+	else
+		ItemPointerCopy(htids, &itup->t_tid);
+
+	return itup;
+}
+
+/*
+ * Size of the key image of a leaf tuple, i.e. the tuple without its posting
+ * list.  Always MAXALIGN'd.
+ */
+static Size
+_bt_dedup_keysize(IndexTuple itup)
+{
+	if (BTreeTupleIsPosting(itup))
+		return BTreeTupleGetPostingOffset(itup);
+
+	return IndexTupleSize(itup);
+}
+
+static int
+_bt_dedup_htid_cmp(const void *a, const void *b)
+{
+	return ItemPointerCompare((ItemPointer) a, (ItemPointer) b);
+}
+
+/*
+ * Finish the pending run and add the result to 'newpage' at 'newoff'.
+ * Returns the number of tuples that were merged away.
+ */
+static int
+_bt_dedup_flush(BTDedupState state, Page newpage, OffsetNumber newoff)
+{
+	IndexTuple	base = state->base;
+	int			nmerged = state->nitems - 1;
+	IndexTuple	merged;
+
+	merged = _bt_dedup_finish_pending(state);
+	_bt_dedup_addtup(newpage, merged, newoff);
+	if (merged != base)
+		pfree(merged);
+
+	return nmerged;
+}
+
+static void
+_bt_dedup_addtup(Page page, IndexTuple itup, OffsetNumber off)
+{
+	if (PageAddItem(page, (Item) itup, IndexTupleSize(itup), off,
+					false, false) == InvalidOffsetNumber)
+		elog(ERROR, "failed to add tuple to temporary page during deduplication");
+}
@@ -663,6 +663,18 @@ _bt_findinsertloc(Relation rel,
 		vacuumed = false;
 	}
 
+	/*
+	 * If the leaf page is still full, try to avoid the split by merging
+	 * duplicates into posting list tuples.  That moves items around just
+	 * like vacuuming does, so the caller's hint becomes invalid.
+	 */
+	if (PageGetFreeSpace(page) < itemsz && P_ISLEAF(lpageop) &&
+		BTDeduplicationEnabled(rel))
+	{
+		if (_bt_dedup_pass(rel, buf))
+			vacuumed = true;
+	}
+
 	/*
 	 * Now we are on the right page, so find the insert position. If we moved
 	 * right at all, we know we should insert at the start of the page. If we
@@ -1111,6 +1123,16 @@ _bt_split(Relation rel, Buffer buf, Buffer cbuf, OffsetNumber firstright,
 		itemsz = ItemIdGetLength(itemid);
 		item = (IndexTuple) PageGetItem(origpage, itemid);
 	}
+
+	/*
+	 * A high key never carries a posting list; btree_xlog_split() strips it
+	 * the same way when it rebuilds the left page's high key.
+	 */
+	if (isleaf && BTreeTupleIsPosting(item))
+	{
+		item = _bt_form_posting(item, BTreeTupleGetPosting(item), 1);
+		itemsz = IndexTupleSize(item);
+	}
 	if (PageAddItem(leftpage, (Item) item, itemsz, leftoff,
 					false, false) == InvalidOffsetNumber)
 	{
@@ -796,6 +796,10 @@ _bt_page_recyclable(Page page)
  * This routine assumes that the caller has pinned and locked the buffer.
  * Also, the given itemnos *must* appear in increasing order in the array.
  *
+ * Posting list tuples that lost only some of their heap TIDs are passed in
+ * 'updated', with their offsets in 'updatedoffsets'; each replaces the tuple
+ * at its offset.  None of those offsets may appear in itemnos.
+ *
  * We record VACUUMs and b-tree deletes differently in WAL. InHotStandby
  * we need to be able to pin all of the blocks in the btree in physical
  * order when replaying the effects of a VACUUM, just as we do for the
@@ -809,15 +813,56 @@ _bt_page_recyclable(Page page)
 void
 _bt_delitems_vacuum(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems,
-					BlockNumber lastBlockVacuumed)
+					OffsetNumber *updatedoffsets, IndexTuple *updated,
+					int nupdated, BlockNumber lastBlockVacuumed)
 {
 	Page		page = BufferGetPage(buf);
 	BTPageOpaque opaque;
+	char	   *updatedbuf = NULL;
+	Size		updatedbuflen = 0;
+	int			i;
+
+	/*
+	 * Assemble the WAL data describing the updated tuples up front, we can't
+	 * palloc in the critical section.
+	 */
+	if (nupdated > 0 && RelationNeedsWAL(rel))
+	{
+		Size		offset;
+
+		updatedbuflen = nupdated * sizeof(OffsetNumber);
+		for (i = 0; i < nupdated; i++)
+			updatedbuflen += MAXALIGN(IndexTupleSize(updated[i]));
+
+		updatedbuf = palloc(updatedbuflen);
+		memcpy(updatedbuf, updatedoffsets, nupdated * sizeof(OffsetNumber));
+		offset = nupdated * sizeof(OffsetNumber);
+		for (i = 0; i < nupdated; i++)
+		{
+			Size		itemsz = MAXALIGN(IndexTupleSize(updated[i]));
+
+			memcpy(updatedbuf + offset, updated[i], itemsz);
+			offset += itemsz;
+		}
+	}
 
 	/* No ereport(ERROR) until changes are logged */
 	START_CRIT_SECTION();
 
-	/* Fix the page */
+	/*
+	 * Fix the page.  Replace the updated tuples first, since deleting items
+	 * renumbers the ones after them.
+	 */
+	for (i = 0; i < nupdated; i++)
+	{
+		Size		itemsz = MAXALIGN(IndexTupleSize(updated[i]));
+
+		if (!PageIndexTupleOverwrite(page, updatedoffsets[i],
+									 (Item) updated[i], itemsz))
+			elog(PANIC, "failed to update partially dead item in block %u of index \"%s\"",
+				 BufferGetBlockNumber(buf), RelationGetRelationName(rel));
+	}
+
 	if (nitems > 0)
 		PageIndexMultiDelete(page, itemnos, nitems);
 
@@ -846,6 +891,8 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 		xl_btree_vacuum xlrec_vacuum;
 
 		xlrec_vacuum.lastBlockVacuumed = lastBlockVacuumed;
+		xlrec_vacuum.ndeleted = nitems;
+		xlrec_vacuum.nupdated = nupdated;
 
 		XLogBeginInsert();
 		XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
@@ -854,10 +901,12 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 		/*
 		 * The target-offsets array is not in the buffer, but pretend that it
 		 * is.  When XLogInsert stores the whole buffer, the offsets array
-		 * need not be stored too.
+		 * need not be stored too.  The same goes for the updated tuples.
 		 */
 		if (nitems > 0)
 			XLogRegisterBufData(0, (char *) itemnos, nitems * sizeof(OffsetNumber));
+		if (nupdated > 0)
+			XLogRegisterBufData(0, updatedbuf, updatedbuflen);
 
 		recptr = XLogInsert(RM_BTREE_ID, XLOG_BTREE_VACUUM);
 
@@ -865,6 +914,9 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 	}
 
 	END_CRIT_SECTION();
+
+	if (updatedbuf != NULL)
+		pfree(updatedbuf);
 }
 
 /*
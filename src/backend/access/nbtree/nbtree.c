@@ -392,8 +392,8 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 				 */
 				if (so->killedItems == NULL)
 					so->killedItems = (int *)
-						palloc(MaxIndexTuplesPerPage * sizeof(int));
-				if (so->numKilled < MaxIndexTuplesPerPage)
+						palloc(MaxTIDsPerBTreePage * sizeof(int));
+				if (so->numKilled < MaxTIDsPerBTreePage)
 					so->killedItems[so->numKilled++] = so->currPos.itemIndex;
 			}
 
@@ -1106,7 +1106,8 @@ btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 								 RBM_NORMAL, info->strategy);
 		LockBufferForCleanup(buf);
 		_bt_checkpage(rel, buf);
-		_bt_delitems_vacuum(rel, buf, NULL, 0, vstate.lastBlockVacuumed);
+		_bt_delitems_vacuum(rel, buf, NULL, 0, NULL, NULL, 0,
+							vstate.lastBlockVacuumed);
 		_bt_relbuf(rel, buf);
 	}
 
@@ -1204,6 +1205,14 @@ restart:
 	{
 		OffsetNumber deletable[MaxOffsetNumber];
 		int			ndeletable;
+		OffsetNumber updatedoffsets[MaxIndexTuplesPerPage];
+		IndexTuple	updated[MaxIndexTuplesPerPage];
+		int			nupdated;
+		ItemPointerData livetids[MaxTIDsPerBTreePage];
+		int			nlive;
+		double		nhtidslive;
+		int			nhtidsdead;
+		int			i;
 		OffsetNumber offnum,
 					minoff,
 					maxoff;
@@ -1243,52 +1252,91 @@ restart:
 		 * callback function.
 		 */
 		ndeletable = 0;
+		nupdated = 0;
+		nhtidslive = 0;
+		nhtidsdead = 0;
 		minoff = P_FIRSTDATAKEY(opaque);
 		maxoff = PageGetMaxOffsetNumber(page);
-		if (callback)
+		for (offnum = minoff;
+			 offnum <= maxoff;
+			 offnum = OffsetNumberNext(offnum))
 		{
-			for (offnum = minoff;
-				 offnum <= maxoff;
-				 offnum = OffsetNumberNext(offnum))
+			IndexTuple	itup;
+			ItemPointer htup;
+			int			nhtids;
+
+			itup = (IndexTuple) PageGetItem(page,
+											PageGetItemId(page, offnum));
+			nhtids = BTreeTupleGetNHeapTIDs(itup);
+
+			if (!callback)
 			{
-				IndexTuple	itup;
-				ItemPointer htup;
+				nhtidslive += nhtids;
+				continue;
+			}
 
-				itup = (IndexTuple) PageGetItem(page,
-												PageGetItemId(page, offnum));
+			/*
+			 * During Hot Standby we currently assume that
+			 * XLOG_BTREE_VACUUM records do not produce conflicts. That is
+			 * only true as long as the callback function depends only
+			 * upon whether the index tuple refers to heap tuples removed
+			 * in the initial heap scan. When vacuum starts it derives a
+			 * value of OldestXmin. Backends taking later snapshots could
+			 * have a RecentGlobalXmin with a later xid than the vacuum's
+			 * OldestXmin, so it is possible that row versions deleted
+			 * after OldestXmin could be marked as killed by other
+			 * backends. The callback function *could* look at the index
+			 * tuple state in isolation and decide to delete the index
+			 * tuple, though currently it does not. If it ever did, we
+			 * would need to reconsider whether XLOG_BTREE_VACUUM records
+			 * should cause conflicts. If they did cause conflicts they
+			 * would be fairly harsh conflicts, since we haven't yet
+			 * worked out a way to pass a useful value for
+			 * latestRemovedXid on the XLOG_BTREE_VACUUM records. This
+			 * applies to *any* type of index that marks index tuples as
+			 * killed.
+			 */
+			if (!BTreeTupleIsPosting(itup))
+			{
 				htup = &(itup->t_tid);
-
-				/*
-				 * During Hot Standby we currently assume that
-				 * XLOG_BTREE_VACUUM records do not produce conflicts. That is
-				 * only true as long as the callback function depends only
-				 * upon whether the index tuple refers to heap tuples removed
-				 * in the initial heap scan. When vacuum starts it derives a
-				 * value of OldestXmin. Backends taking later snapshots could
-				 * have a RecentGlobalXmin with a later xid than the vacuum's
-				 * OldestXmin, so it is possible that row versions deleted
-				 * after OldestXmin could be marked as killed by other
-				 * backends. The callback function *could* look at the index
-				 * tuple state in isolation and decide to delete the index
-				 * tuple, though currently it does not. If it ever did, we
-				 * would need to reconsider whether XLOG_BTREE_VACUUM records
-				 * should cause conflicts. If they did cause conflicts they
-				 * would be fairly harsh conflicts, since we haven't yet
-				 * worked out a way to pass a useful value for
-				 * latestRemovedXid on the XLOG_BTREE_VACUUM records. This
-				 * applies to *any* type of index that marks index tuples as
-				 * killed.
-				 */
 				if (callback(htup, callback_state))
+				{
 					deletable[ndeletable++] = offnum;
+					nhtidsdead++;
+				}
+				else
+					nhtidslive++;
+				continue;
+			}
+
+			/*
+			 * A posting list tuple is deleted once all of its heap TIDs are
+			 * dead, and otherwise replaced by one with the remaining TIDs.
+			 */
+			nlive = 0;
+			for (i = 0; i < nhtids; i++)
+			{
+				htup = BTreeTupleGetPostingN(itup, i);
+				if (!callback(htup, callback_state))
+					livetids[nlive++] = *htup;
 			}
+
+			if (nlive == 0)
+				deletable[ndeletable++] = offnum;
+			else if (nlive < nhtids)
+			{
+				updatedoffsets[nupdated] = offnum;
+				updated[nupdated++] = _bt_form_posting(itup, livetids, nlive);
+			}
+			nhtidslive += nlive;
+			nhtidsdead += nhtids - nlive;
 		}
 
 		/*
 		 * Apply any needed deletes.  We issue just one _bt_delitems_vacuum()
 		 * call per page, so as to minimize WAL traffic.
 		 */
-		if (ndeletable > 0)
+		if (ndeletable > 0 || nupdated > 0)
 		{
 			/*
 			 * Notice that the issued XLOG_BTREE_VACUUM WAL record includes
@@ -1305,6 +1353,7 @@ restart:
 			 * that.
 			 */
 			_bt_delitems_vacuum(rel, buf, deletable, ndeletable,
+								updatedoffsets, updated, nupdated,
 								vstate->lastBlockVacuumed);
 
 			/*
@@ -1314,9 +1363,12 @@ restart:
 			if (blkno > vstate->lastBlockVacuumed)
 				vstate->lastBlockVacuumed = blkno;
 
-			stats->tuples_removed += ndeletable;
+			stats->tuples_removed += nhtidsdead;
 			/* must recompute maxoff */
 			maxoff = PageGetMaxOffsetNumber(page);
+
+			for (i = 0; i < nupdated; i++)
+				pfree(updated[i]);
 		}
 		else
 		{
@@ -1346,7 +1398,7 @@ restart:
 		if (minoff > maxoff)
 			delete_now = (blkno == orig_blkno);
 		else
-			stats->num_index_tuples += maxoff - minoff + 1;
+			stats->num_index_tuples += nhtidslive;
 	}
 
 	if (delete_now)
@@ -134,6 +134,8 @@ static void _bt_sortaddtup(Page page, Size itemsize,
 			   IndexTuple itup, OffsetNumber itup_off);
 static void _bt_buildadd(BTWriteState *wstate, BTPageState *state,
 			 IndexTuple itup);
+static void _bt_sort_dedup_finish_pending(BTWriteState *wstate,
+							  BTPageState *state, BTDedupState dstate);
 static void _bt_uppershutdown(BTWriteState *wstate, BTPageState *state);
 static void _bt_load(BTWriteState *wstate,
 		 BTSpool *btspool, BTSpool *btspool2);
@@ -545,6 +547,23 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		ItemIdSetUnused(ii);	/* redundant */
 		((PageHeader) opage)->pd_lower -= sizeof(ItemIdData);
 
+		/*
+		 * A high key never carries a posting list, and neither does the
+		 * minimum key copied below, which becomes a downlink.
+		 */
+		if (BTreeTupleIsPosting(oitup))
+		{
+			IndexTuple	pivot;
+
+			pivot = _bt_form_posting(oitup, BTreeTupleGetPosting(oitup), 1);
+			if (!PageIndexTupleOverwrite(opage, P_HIKEY, (Item) pivot,
+										 IndexTupleSize(pivot)))
+				elog(ERROR, "failed to rewrite high key in index \"%s\"",
+					 RelationGetRelationName(wstate->index));
+			oitup = (IndexTuple) PageGetItem(opage, hii);
+			pfree(pivot);
+		}
+
 		/*
 		 * Link the old page into its parent, using its minimum key. If we
 		 * don't have a parent, we have to create one; this adds a new btree
@@ -598,7 +617,12 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 	if (last_off == P_HIKEY)
 	{
 		Assert(state->btps_minkey == NULL);
-		state->btps_minkey = CopyIndexTuple(itup);
+		if (BTreeTupleIsPosting(itup))
+			state->btps_minkey = _bt_form_posting(itup,
+												  BTreeTupleGetPosting(itup),
+												  1);
+		else
+			state->btps_minkey = CopyIndexTuple(itup);
 	}
 
 	/*
@@ -612,6 +636,25 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 	state->btps_lastoff = last_off;
 }
 
+/*
+ * Add the pending run of equal tuples to the leaf level, merged into a
+ * posting list tuple if it has more than one.  The base tuple of the run
+ * is a private copy.
+ */
+static void
+_bt_sort_dedup_finish_pending(BTWriteState *wstate, BTPageState *state,
+							  BTDedupState dstate)
+{
+	IndexTuple	base = dstate->base;
+	IndexTuple	final;
+
+	final = _bt_dedup_finish_pending(dstate);
+	_bt_buildadd(wstate, state, final);
+	if (final != base)
+		pfree(final);
+	pfree(base);
+}
+
 /*
  * Finish writing out the completed btree.
  */
@@ -789,6 +832,41 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 		}
 		pfree(sortKeys);
 	}
+	else if (BTDeduplicationEnabled(wstate->index))
+	{
+		/* merge runs of equal tuples into posting list tuples */
+		BTDedupStateData dstate;
+
+		dstate.base = NULL;
+		while ((itup = tuplesort_getindextuple(btspool->sortstate,
+											   true)) != NULL)
+		{
+			/* When we see first tuple, create first index page */
+			if (state == NULL)
+			{
+				state = _bt_pagestate(wstate, 0);
+				_bt_dedup_init(&dstate, BTMaxPostingSize(state->btps_page));
+			}
+
+			if (dstate.base != NULL &&
+				_bt_dedup_keyequal(dstate.base, itup) &&
+				_bt_dedup_save_htid(&dstate, itup))
+				continue;
+
+			if (dstate.base != NULL)
+				_bt_sort_dedup_finish_pending(wstate, state, &dstate);
+
+			/* the tuplesort may recycle itup's memory, so copy it */
+			_bt_dedup_start_pending(&dstate, CopyIndexTuple(itup));
+		}
+
+		if (state != NULL)
+		{
+			if (dstate.base != NULL)
+				_bt_sort_dedup_finish_pending(wstate, state, &dstate);
+			pfree(dstate.htids);
+		}
+	}
 	else
 	{
 		/* merge is unnecessary */
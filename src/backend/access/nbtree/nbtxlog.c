@@ -212,6 +212,7 @@ btree_xlog_split(bool onleft, bool isroot, XLogReaderState *record)
 	Size		datalen;
 	IndexTuple	left_hikey = NULL;
 	Size		left_hikeysz = 0;
+	bool		free_hikey = false;
 	BlockNumber leftsib;
 	BlockNumber rightsib;
 	BlockNumber rnext;
@@ -247,7 +248,8 @@ btree_xlog_split(bool onleft, bool isroot, XLogReaderState *record)
 
 	/*
 	 * On leaf level, the high key of the left page is equal to the first key
-	 * on the right page.
+	 * on the right page, without its posting list if it has one (see
+	 * _bt_split).
 	 */
 	if (isleaf)
 	{
@@ -255,6 +257,13 @@ btree_xlog_split(bool onleft, bool isroot, XLogReaderState *record)
 
 		left_hikey = (IndexTuple) PageGetItem(rpage, hiItemId);
 		left_hikeysz = ItemIdGetLength(hiItemId);
+		if (BTreeTupleIsPosting(left_hikey))
+		{
+			left_hikey = _bt_form_posting(left_hikey,
+										  BTreeTupleGetPosting(left_hikey), 1);
+			left_hikeysz = IndexTupleSize(left_hikey);
+			free_hikey = true;
+		}
 	}
 
 	PageSetLSN(rpage, lsn);
@@ -357,6 +366,9 @@ btree_xlog_split(bool onleft, bool isroot, XLogReaderState *record)
 		MarkBufferDirty(lbuf);
 	}
 
+	if (free_hikey)
+		pfree(left_hikey);
+
 	/* We no longer need the buffers */
 	if (BufferIsValid(lbuf))
 		UnlockReleaseBuffer(lbuf);
@@ -393,11 +405,11 @@ static void
 btree_xlog_vacuum(XLogReaderState *record)
 {
 	XLogRecPtr	lsn = record->EndRecPtr;
+	xl_btree_vacuum *xlrec = (xl_btree_vacuum *) XLogRecGetData(record);
 	Buffer		buffer;
 	Page		page;
 	BTPageOpaque opaque;
 #ifdef UNUSED
-	xl_btree_vacuum *xlrec = (xl_btree_vacuum *) XLogRecGetData(record);
 
 	/*
 	 * This section of code is thought to be no longer needed, after analysis
@@ -488,14 +500,29 @@ btree_xlog_vacuum(XLogReaderState *record)
 
 		if (len > 0)
 		{
-			OffsetNumber *unused;
-			OffsetNumber *unend;
+			OffsetNumber *deleted;
+			OffsetNumber *updatedoffsets;
+			char	   *updated;
+			int			i;
 
-			unused = (OffsetNumber *) ptr;
-			unend = (OffsetNumber *) ((char *) ptr + len);
+			deleted = (OffsetNumber *) ptr;
+			updatedoffsets = deleted + xlrec->ndeleted;
+			updated = (char *) (updatedoffsets + xlrec->nupdated);
 
-			if ((unend - unused) > 0)
-				PageIndexMultiDelete(page, unused, unend - unused);
+			/* replace posting list tuples that lost some of their TIDs */
+			for (i = 0; i < xlrec->nupdated; i++)
+			{
+				IndexTuple	itup = (IndexTuple) updated;
+				Size		itemsz = MAXALIGN(IndexTupleSize(itup));
+
+				if (!PageIndexTupleOverwrite(page, updatedoffsets[i],
+											 (Item) itup, itemsz))
+					elog(PANIC, "failed to update partially dead item");
+				updated += itemsz;
+			}
+
+			if (xlrec->ndeleted > 0)
+				PageIndexMultiDelete(page, deleted, xlrec->ndeleted);
 		}
 
 		/*
@@ -541,7 +568,8 @@ btree_xlog_delete_get_latestRemovedXid(XLogReaderState *record)
 	BlockNumber hblkno;
 	OffsetNumber hoffnum;
 	TransactionId latestRemovedXid = InvalidTransactionId;
-	int			i;
+	int			i,
+				j;
 
 	/*
 	 * If there's nothing running on the standby we don't need to derive a
@@ -588,69 +616,79 @@ btree_xlog_delete_get_latestRemovedXid(XLogReaderState *record)
 
 	for (i = 0; i < xlrec->nitems; i++)
 	{
+		int			nhtids;
+
 		/*
 		 * Identify the index tuple about to be deleted
 		 */
 		iitemid = PageGetItemId(ipage, unused[i]);
 		itup = (IndexTuple) PageGetItem(ipage, iitemid);
 
-		/*
-		 * Locate the heap page that the index tuple points at
-		 */
-		hblkno = ItemPointerGetBlockNumber(&(itup->t_tid));
-		hbuffer = XLogReadBufferExtended(xlrec->hnode, MAIN_FORKNUM, hblkno, RBM_NORMAL_NO_LOG, record->checksum_enabled);
-		if (!BufferIsValid(hbuffer))
+		/* a posting list tuple references several heap tuples */
+		nhtids = BTreeTupleGetNHeapTIDs(itup);
+		for (j = 0; j < nhtids; j++)
 		{
-			UnlockReleaseBuffer(ibuffer);
-			return InvalidTransactionId;
-		}
-		LockBuffer(hbuffer, BUFFER_LOCK_SHARE);
-		hpage = (Page) BufferGetPage(hbuffer);
+			ItemPointer htid = BTreeTupleGetHeapTID(itup) + j;
 
-		/*
-		 * Look up the heap tuple header that the index tuple points at by
-		 * using the heap node supplied with the xlrec. We can't use
-		 * heap_fetch, since it uses ReadBuffer rather than XLogReadBuffer.
-		 * Note that we are not looking at tuple data here, just headers.
-		 */
-		hoffnum = ItemPointerGetOffsetNumberNoCheck(&(itup->t_tid));
-		hitemid = PageGetItemId(hpage, hoffnum);
+			/*
+			 * Locate the heap page that the index tuple points at
+			 */
+			hblkno = ItemPointerGetBlockNumber(htid);
+			hbuffer = XLogReadBufferExtended(xlrec->hnode, MAIN_FORKNUM, hblkno, RBM_NORMAL_NO_LOG, record->checksum_enabled);
+			if (!BufferIsValid(hbuffer))
+			{
+				UnlockReleaseBuffer(ibuffer);
+				return InvalidTransactionId;
+			}
+			LockBuffer(hbuffer, BUFFER_LOCK_SHARE);
+			hpage = (Page) BufferGetPage(hbuffer);
 
-		/*
-		 * Follow any redirections until we find something useful.
-		 */
-		while (ItemIdIsRedirected(hitemid))
-		{
-			hoffnum = ItemIdGetRedirect(hitemid);
+			/*
+			 * Look up the heap tuple header that the index tuple points at by
+			 * using the heap node supplied with the xlrec. We can't use
+			 * heap_fetch, since it uses ReadBuffer rather than
+			 * XLogReadBuffer. Note that we are not looking at tuple data
+			 * here, just headers.
+			 */
+			hoffnum = ItemPointerGetOffsetNumberNoCheck(htid);
 			hitemid = PageGetItemId(hpage, hoffnum);
-			CHECK_FOR_INTERRUPTS();
-		}
 
-		/*
-		 * If the heap item has storage, then read the header and use that to
-		 * set latestRemovedXid.
-		 *
-		 * Some LP_DEAD items may not be accessible, so we ignore them.
-		 */
-		if (ItemIdHasStorage(hitemid))
-		{
-			htuphdr = (HeapTupleHeader) PageGetItem(hpage, hitemid);
+			/*
+			 * Follow any redirections until we find something useful.
+			 */
+			while (ItemIdIsRedirected(hitemid))
+			{
+				hoffnum = ItemIdGetRedirect(hitemid);
+				hitemid = PageGetItemId(hpage, hoffnum);
+				CHECK_FOR_INTERRUPTS();
+			}
 
-			HeapTupleHeaderAdvanceLatestRemovedXid(htuphdr, &latestRemovedXid);
-		}
-		else if (ItemIdIsDead(hitemid))
-		{
 			/*
-			 * Conjecture: if hitemid is dead then it had xids before the xids
-			 * marked on LP_NORMAL items. So we just ignore this item and move
-			 * onto the next, for the purposes of calculating
-			 * latestRemovedxids.
+			 * If the heap item has storage, then read the header and use that
+			 * to set latestRemovedXid.
+			 *
+			 * Some LP_DEAD items may not be accessible, so we ignore them.
 			 */
-		}
-		else
-			Assert(!ItemIdIsUsed(hitemid));
+			if (ItemIdHasStorage(hitemid))
+			{
+				htuphdr = (HeapTupleHeader) PageGetItem(hpage, hitemid);
 
-		UnlockReleaseBuffer(hbuffer);
+				HeapTupleHeaderAdvanceLatestRemovedXid(htuphdr, &latestRemovedXid);
+			}
+			else if (ItemIdIsDead(hitemid))
+			{
+				/*
+				 * Conjecture: if hitemid is dead then it had xids before the
+				 * xids marked on LP_NORMAL items. So we just ignore this item
+				 * and move onto the next, for the purposes of calculating
+				 * latestRemovedxids.
+				 */
+			}
+			else
+				Assert(!ItemIdIsUsed(hitemid));
+
+			UnlockReleaseBuffer(hbuffer);
+		}
 	}
 
 	UnlockReleaseBuffer(ibuffer);
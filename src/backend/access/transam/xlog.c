@@ -36,6 +36,8 @@
 #include "access/xact.h"
 #include "access/xlog_internal.h"
 #include "access/xloginsert.h"
+#include "access/xlogparallel.h"
+#include "access/xlogprefetch.h"
 #include "access/xlogreader.h"
 #include "access/xlogutils.h"
 #include "catalog/catversion.h"
@@ -49,6 +51,7 @@
 #include "pgstat.h"
 #include "port/atomics.h"
 #include "port/pg_iovec.h"
+#include "portability/instr_time.h"
 #include "postmaster/bgwriter.h"
 #include "postmaster/walwriter.h"
 #include "postmaster/startup.h"
@@ -114,6 +117,7 @@ int			max_wal_size_mb = 1024; /* 1 GB */
 int			min_wal_size_mb = 80;	/* 80 MB */
 int			wal_keep_segments = 0;
 int			XLOGbuffers = -1;
+int			XLOGinsertLocks = -1;
 int			XLogArchiveTimeout = 0;
 int			XLogArchiveMode = ARCHIVE_MODE_OFF;
 char	   *XLogArchiveCommand = NULL;
@@ -128,6 +132,7 @@ int			sync_method = DEFAULT_SYNC_METHOD;
 int			wal_level = WAL_LEVEL_MINIMAL;
 int			CommitDelay = 0;	/* precommit delay in microseconds */
 int			CommitSiblings = 5; /* # concurrent xacts needed to sleep */
+bool		CommitDelayAdaptive = false;
 int			wal_retrieve_retry_interval = 5000;
 int	        gts_track_segment = 0;
 #ifdef WAL_DEBUG
@@ -156,14 +161,11 @@ typedef struct
 bool       i_am_standby = false;
 #endif
 
-/*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
- */
-#define NUM_XLOGINSERT_LOCKS  8
 #define SIZE_OF_UINT64 8
 
+/* Weight of the latest sample in the average flush time */
+#define FLUSH_TIME_WEIGHT	0.1
+
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
  * checkpoint.
@@ -646,6 +648,12 @@ typedef struct XLogCtlData
 	pg_time_t	lastSegSwitchTime;
 	XLogRecPtr	lastSegSwitchLSN;
 
+	/*
+	 * Moving average of the time XLogFlush() takes to write and flush WAL, in
+	 * microseconds, for commit_delay_adaptive.  Protected by WALWriteLock.
+	 */
+	double		avgFlushTime;
+
 	/*
 	 * Protected by info_lck and WALWriteLock (you must hold either lock to
 	 * read it, but both to update)
@@ -1057,8 +1065,8 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * To keep track of which insertions are still in-progress, each concurrent
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
-	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * has progressed. There is a small number of insertion locks, determined
+	 * by wal_insert_locks. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -1728,7 +1736,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProc->pgprocno % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProc->pgprocno % XLOGinsertLocks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1746,7 +1754,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % XLOGinsertLocks;
 	}
 }
 
@@ -1764,7 +1772,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < XLOGinsertLocks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1790,7 +1798,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < XLOGinsertLocks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1818,8 +1826,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-						&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[XLOGinsertLocks - 1].l.lock,
+						&WALInsertLocks[XLOGinsertLocks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1891,7 +1899,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < XLOGinsertLocks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -2936,6 +2944,7 @@ XLogFlush(XLogRecPtr record)
 {
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
+	int			commitDelay;
 
 	/*
 	 * During REDO, we are reading not writing WAL.  Therefore, instead of
@@ -3038,11 +3047,20 @@ XLogFlush(XLogRecPtr record)
 		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
 		 * fewer than CommitSiblings other backends with active transactions.
+		 *
+		 * With commit_delay_adaptive, we sleep for half the time recent
+		 * flushes have taken, but no longer than commit_delay.  Sleeping
+		 * longer than that makes the followers wait longer than they would
+		 * for another flush, while a much shorter sleep gathers few of them.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
+		commitDelay = CommitDelay;
+		if (CommitDelayAdaptive)
+			commitDelay = Min(commitDelay, (int) (XLogCtl->avgFlushTime / 2));
+
+		if (commitDelay > 0 && enableFsync &&
 			MinimumActiveBackends(CommitSiblings))
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(commitDelay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -3061,7 +3079,23 @@ XLogFlush(XLogRecPtr record)
 		WriteRqst.Write = insertpos;
 		WriteRqst.Flush = insertpos;
 
-		XLogWrite(WriteRqst, false);
+		if (CommitDelayAdaptive)
+		{
+			instr_time	start;
+			instr_time	duration;
+
+			INSTR_TIME_SET_CURRENT(start);
+			XLogWrite(WriteRqst, false);
+			INSTR_TIME_SET_CURRENT(duration);
+			INSTR_TIME_SUBTRACT(duration, start);
+
+			/* keep a moving average of the time a flush takes */
+			XLogCtl->avgFlushTime +=
+				(INSTR_TIME_GET_MICROSEC(duration) - XLogCtl->avgFlushTime) *
+				FLUSH_TIME_WEIGHT;
+		}
+		else
+			XLogWrite(WriteRqst, false);
 
 		LWLockRelease(WALWriteLock);
 		/* done */
@@ -4991,6 +5025,57 @@ XLOGChooseNumBuffers(void)
 	return xbuffers;
 }
 
+/*
+ * Auto-tune the number of WAL insertion locks to the number of CPUs.
+ *
+ * More locks let more backends copy records into the WAL buffers at the same
+ * time, but every WAL flush has to look at all of them.  The historical fixed
+ * value of 8 serves up to 32 CPUs well; beyond that, we add one lock per four
+ * CPUs.
+ */
+static int
+XLOGChooseNumInsertLocks(void)
+{
+	int			nlocks = 8;
+
+#ifdef _SC_NPROCESSORS_ONLN
+	long		ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (ncpus / 4 > nlocks)
+		nlocks = (int) Min(ncpus / 4, MAX_XLOGINSERT_LOCKS);
+#endif
+
+	return nlocks;
+}
+
+/*
+ * GUC check_hook for wal_insert_locks
+ */
+bool
+check_wal_insert_locks(int *newval, void **extra, GucSource source)
+{
+	/* inserters pick a lock modulo the count, so there must be one */
+	if (*newval == 0)
+	{
+		GUC_check_errdetail("\"wal_insert_locks\" must be -1 or at least 1.");
+		return false;
+	}
+
+	/*
+	 * -1 indicates a request for auto-tune.  As with wal_buffers, the boot_val
+	 * is replaced when XLOGShmemSize is called.
+	 */
+	if (*newval == -1)
+	{
+		if (XLOGinsertLocks == -1)
+			return true;
+
+		*newval = XLOGChooseNumInsertLocks();
+	}
+
+	return true;
+}
+
 /*
  * GUC check_hook for wal_buffers
  */
@@ -5049,11 +5134,22 @@ XLOGShmemSize(void)
 	}
 	Assert(XLOGbuffers > 0);
 
+	/* Likewise for wal_insert_locks */
+	if (XLOGinsertLocks == -1)
+	{
+		char		buf[32];
+
+		snprintf(buf, sizeof(buf), "%d", XLOGChooseNumInsertLocks());
+		SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER,
+						PGC_S_OVERRIDE);
+	}
+	Assert(XLOGinsertLocks > 0);
+
 	/* XLogCtl */
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), XLOGinsertLocks + 1));
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(XLogRecPtr), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -5130,10 +5226,10 @@ XLOGShmemInit(void)
 		((uintptr_t) allocptr) % sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * XLOGinsertLocks;
 
 	LWLockRegisterTranche(LWTRANCHE_WAL_INSERT, "wal_insert");
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < XLOGinsertLocks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
 		pg_atomic_init_u64(&WALInsertLocks[i].l.insertingAt, InvalidXLogRecPtr);
@@ -7614,9 +7710,21 @@ StartupXLOG(void)
 		{
 			ErrorContextCallback errcallback;
 			TimestampTz xtime;
+			bool		parallelRedo;
+			XLogPrefetcher *prefetcher;
 
 			InRedo = true;
 
+			/* Prepare to read ahead of replay, to prefetch data blocks */
+			prefetcher = XLogPrefetcherAllocate(ThisTimeLineID);
+
+			/*
+			 * A standby may hand records to parallel redo workers once it
+			 * has reached consistency.
+			 */
+			parallelRedo = StandbyModeRequested && IsUnderPostmaster &&
+				parallel_redo_workers > 0;
+
 			ereport(LOG,
 					(errmsg("redo starts at %X/%X",
 							(uint32) (ReadRecPtr >> 32), (uint32) ReadRecPtr)));
@@ -7774,8 +7882,19 @@ StartupXLOG(void)
 					TransactionIdIsValid(record->xl_xid))
 					RecordKnownAssignedTransactionIds(record->xl_xid);
 
-				/* Now apply the WAL record itself */
-				RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+				/* Prefetch the blocks needed by upcoming records */
+				XLogPrefetcherReadAhead(prefetcher, EndRecPtr, ThisTimeLineID);
+
+				/*
+				 * Now apply the WAL record itself, unless a parallel redo
+				 * worker does it for us.
+				 */
+				if (!parallelRedo || !ParallelRedoDispatch(xlogreader))
+				{
+					RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+					if (parallelRedo)
+						ParallelRedoAfterReplay(xlogreader);
+				}
 
 				/*
 				 * After redo, check whether the backup pages associated with
@@ -7859,6 +7978,11 @@ StartupXLOG(void)
 			 * end of main redo apply loop
 			 */
 
+			/* Wait for the parallel redo workers to catch up, if any */
+			ParallelRedoShutdown();
+
+			XLogPrefetcherFree(prefetcher);
+
 			if (reachedStopPoint)
 			{
 				if (!reachedConsistency)
@@ -8894,7 +9018,7 @@ GetLastImportantRecPtr(void)
 	XLogRecPtr	res = InvalidXLogRecPtr;
 	int			i;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < XLOGinsertLocks; i++)
 	{
 		XLogRecPtr	last_important;
 
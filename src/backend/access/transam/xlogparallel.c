@@ -0,0 +1,591 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogparallel.c
+ *	  Parallel WAL redo on standby servers.
+ *
+ * Once a standby has reached a consistent state, the startup process may
+ * hand some WAL records to parallel redo workers instead of replaying them
+ * itself.  Each worker reads records from its own shm_mq and replays them
+ * with the ordinary rm_redo routines.  Records are routed by the relation
+ * they touch, so all changes to one relation, including its FSM and
+ * visibility map, are replayed by the same worker in WAL order, and
+ * concurrent redo never has to extend a relation from two processes.
+ *
+ * Only a small set of heap record types that modify a single page is
+ * handed off.  Every other record is a barrier: the startup process waits until
+ * the workers have replayed everything dispatched so far, and then replays
+ * the record itself.  In particular commit and abort records, and thus the
+ * csnlog updates they carry, are always replayed after all the changes of
+ * the transaction, and in the same order as on the primary.  Records that
+ * need a cleanup lock, and so may conflict with hot standby queries, are
+ * barriers too.
+ *
+ * Index insertions are barriers as well, even though they modify a single
+ * page.  An index entry routed to another worker than its heap tuple could
+ * be replayed first, and a hot standby index scan following it would then
+ * try to read a heap block that doesn't exist yet.  Replaying them in the
+ * startup process, after the workers have caught up, guarantees that every
+ * index entry points to a heap tuple that has been replayed.
+ *
+ * The startup process reports a record as replayed as soon as it has been
+ * dispatched.  That is harmless: a restartpoint is only created when a
+ * checkpoint record, which is a barrier, is replayed, and the tuples a
+ * handed off record creates are not visible to queries before the commit
+ * record of their transaction has been replayed.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/xlogparallel.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/heapam_xlog.h"
+#include "access/xact.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "access/xlogparallel.h"
+#include "access/xlogutils.h"
+#include "lib/stringinfo.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/startup.h"
+#include "storage/dsm.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/smgr.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+/* Magic number for parallel redo shared memory */
+#define PARALLEL_REDO_MAGIC			0x50524544
+
+/* Size of each worker's message queue */
+#define PARALLEL_REDO_QUEUE_SIZE	(1024 * 1024)
+
+/* GUC variable */
+int			parallel_redo_workers = 0;
+
+/*
+ * Shared state, followed by one message queue per worker.
+ *
+ * 'applied' counts the messages each worker has processed.  Only the worker
+ * itself advances its counter, and sets the startup process's latch after
+ * doing so.
+ */
+typedef struct ParallelRedoShared
+{
+	uint32		magic;
+	int			nworkers;
+	PGPROC	   *leader;			/* startup process */
+	bool		i_am_standby;
+	pg_atomic_uint64 applied[FLEXIBLE_ARRAY_MEMBER];
+} ParallelRedoShared;
+
+#define PARALLEL_REDO_QUEUE_OFFSET(nworkers) \
+	MAXALIGN(offsetof(ParallelRedoShared, applied) + \
+			 (nworkers) * sizeof(pg_atomic_uint64))
+
+#define ParallelRedoQueue(shared, i) \
+	((shm_mq *) ((char *) (shared) + \
+				 PARALLEL_REDO_QUEUE_OFFSET((shared)->nworkers) + \
+				 (i) * PARALLEL_REDO_QUEUE_SIZE))
+
+/* Message types */
+#define PARALLEL_REDO_RECORD		'r' /* replay the record that follows */
+#define PARALLEL_REDO_INVALIDATE	'i' /* close all cached smgr relations */
+
+/*
+ * Header of a message.  For a record, the XLogRecord follows the header.
+ * sizeof() of a struct with an 8-byte member keeps the record MAXALIGN'd.
+ */
+typedef struct ParallelRedoMessage
+{
+	XLogRecPtr	ReadRecPtr;
+	XLogRecPtr	EndRecPtr;
+	char		type;
+} ParallelRedoMessage;
+
+/* Startup process state */
+typedef struct ParallelRedoLeader
+{
+	dsm_segment *seg;
+	ParallelRedoShared *shared;
+	int			nworkers;
+	shm_mq_handle **mqh;
+	BackgroundWorkerHandle **handle;
+	uint64	   *dispatched;		/* messages sent to each worker */
+	bool		pending;		/* anything sent since the last barrier? */
+} ParallelRedoLeader;
+
+static ParallelRedoLeader *redo_leader = NULL;
+
+/* set if the workers could not be started; replay serially from then on */
+static bool parallel_redo_disabled = false;
+
+static bool ParallelRedoStart(void);
+static bool ParallelRedoCanDispatch(XLogReaderState *record);
+static bool ParallelRedoDropsFiles(XLogReaderState *record);
+static void ParallelRedoSend(int worker, char type, XLogReaderState *record);
+static void ParallelRedoWaitForWorkers(void);
+static void parallel_redo_error_callback(void *arg);
+
+/*
+ * Hand a WAL record to a parallel redo worker, if it can be replayed by one.
+ *
+ * Returns true if the record was dispatched.  Otherwise, the caller must
+ * replay the record itself, and then call ParallelRedoAfterReplay(); all
+ * records dispatched before have been replayed when we return false.
+ */
+bool
+ParallelRedoDispatch(XLogReaderState *record)
+{
+	RelFileNode rnode;
+
+	if (!ParallelRedoCanDispatch(record))
+	{
+		ParallelRedoWaitForWorkers();
+		return false;
+	}
+
+	if (redo_leader == NULL && !ParallelRedoStart())
+		return false;
+
+	XLogRecGetBlockTag(record, 0, &rnode, NULL, NULL);
+	ParallelRedoSend(tag_hash(&rnode, sizeof(RelFileNode)) % redo_leader->nworkers,
+					 PARALLEL_REDO_RECORD, record);
+
+	return true;
+}
+
+/*
+ * Called after the startup process has replayed a record itself.
+ *
+ * If the record removed or truncated relation files, make the workers close
+ * the files they have open, so that they don't keep writing to a dropped
+ * file if its relfilenode is reused.
+ */
+void
+ParallelRedoAfterReplay(XLogReaderState *record)
+{
+	int			i;
+
+	if (redo_leader == NULL || !ParallelRedoDropsFiles(record))
+		return;
+
+	for (i = 0; i < redo_leader->nworkers; i++)
+		ParallelRedoSend(i, PARALLEL_REDO_INVALIDATE, NULL);
+}
+
+/*
+ * Wait for the workers to replay everything dispatched to them, and let them
+ * exit.  Called at the end of redo.
+ */
+void
+ParallelRedoShutdown(void)
+{
+	if (redo_leader == NULL)
+		return;
+
+	ParallelRedoWaitForWorkers();
+
+	/* detaching from the queues makes the workers exit */
+	dsm_detach(redo_leader->seg);
+
+	pfree(redo_leader->mqh);
+	pfree(redo_leader->handle);
+	pfree(redo_leader->dispatched);
+	pfree(redo_leader);
+	redo_leader = NULL;
+}
+
+/*
+ * Set up the shared memory and launch the workers.
+ */
+static bool
+ParallelRedoStart(void)
+{
+	ParallelRedoLeader *leader;
+	ParallelRedoShared *shared;
+	dsm_segment *seg;
+	int			nworkers = parallel_redo_workers;
+	int			nlaunched = 0;
+	int			i;
+
+	if (parallel_redo_disabled)
+		return false;
+
+	seg = dsm_create(PARALLEL_REDO_QUEUE_OFFSET(nworkers) +
+					 (Size) nworkers * PARALLEL_REDO_QUEUE_SIZE, 0);
+	dsm_pin_mapping(seg);
+
+	shared = (ParallelRedoShared *) dsm_segment_address(seg);
+	shared->magic = PARALLEL_REDO_MAGIC;
+	shared->nworkers = nworkers;
+	shared->leader = MyProc;
+	shared->i_am_standby = i_am_standby;
+
+	leader = (ParallelRedoLeader *)
+		MemoryContextAllocZero(TopMemoryContext, sizeof(ParallelRedoLeader));
+	leader->seg = seg;
+	leader->shared = shared;
+	leader->mqh = (shm_mq_handle **)
+		MemoryContextAllocZero(TopMemoryContext,
+							   nworkers * sizeof(shm_mq_handle *));
+	leader->handle = (BackgroundWorkerHandle **)
+		MemoryContextAllocZero(TopMemoryContext,
+							   nworkers * sizeof(BackgroundWorkerHandle *));
+	leader->dispatched = (uint64 *)
+		MemoryContextAllocZero(TopMemoryContext, nworkers * sizeof(uint64));
+
+	for (i = 0; i < nworkers; i++)
+	{
+		BackgroundWorker worker;
+		shm_mq	   *mq;
+
+		pg_atomic_init_u64(&shared->applied[i], 0);
+
+		memset(&worker, 0, sizeof(worker));
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+		worker.bgw_restart_time = BGW_NEVER_RESTART;
+		snprintf(worker.bgw_library_name, BGW_MAXLEN, "postgres");
+		snprintf(worker.bgw_function_name, BGW_MAXLEN, "ParallelRedoWorkerMain");
+		snprintf(worker.bgw_name, BGW_MAXLEN, "parallel redo worker %d", i);
+		snprintf(worker.bgw_type, BGW_MAXLEN, "parallel redo worker");
+		worker.bgw_main_arg = UInt32GetDatum(dsm_segment_handle(seg));
+		worker.bgw_notify_pid = MyProcPid;
+		memcpy(worker.bgw_extra, &i, sizeof(int));
+
+		if (!RegisterDynamicBackgroundWorker(&worker, &leader->handle[i]))
+			break;
+
+		mq = shm_mq_create(ParallelRedoQueue(shared, i),
+						   PARALLEL_REDO_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+		leader->mqh[i] = shm_mq_attach(mq, seg, leader->handle[i]);
+		nlaunched++;
+	}
+
+	if (nlaunched == 0)
+	{
+		ereport(WARNING,
+				(errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
+				 errmsg("could not start parallel redo workers, replaying WAL serially"),
+				 errhint("You might need to increase max_worker_processes.")));
+		dsm_detach(seg);
+		pfree(leader->mqh);
+		pfree(leader->handle);
+		pfree(leader->dispatched);
+		pfree(leader);
+		parallel_redo_disabled = true;
+		return false;
+	}
+
+	/*
+	 * Workers that could not be registered have no queue attached and are
+	 * never sent anything.  The launched ones only look at their own queue,
+	 * so shrinking nworkers is enough.
+	 */
+	leader->nworkers = nlaunched;
+	redo_leader = leader;
+
+	ereport(LOG,
+			(errmsg("started %d parallel redo workers", nlaunched)));
+
+	return true;
+}
+
+/*
+ * Can this record be replayed by a parallel redo worker?
+ *
+ * We only hand off heap records that modify exactly one page and don't
+ * need a cleanup lock.  Index records are barriers, see the file header.
+ */
+static bool
+ParallelRedoCanDispatch(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	/* before consistency, a missing page is not an error */
+	if (!reachedConsistency || parallel_redo_disabled)
+		return false;
+
+	if (record->max_block_id != 0 ||
+		(XLogRecGetInfo(record) & XLR_CHECK_CONSISTENCY) != 0)
+		return false;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_HEAP_ID:
+			info &= XLOG_HEAP_OPMASK;
+
+			/* an update to another page references two blocks */
+			return info == XLOG_HEAP_INSERT ||
+				info == XLOG_HEAP_DELETE ||
+				info == XLOG_HEAP_UPDATE ||
+				info == XLOG_HEAP_HOT_UPDATE ||
+				info == XLOG_HEAP_LOCK;
+		case RM_HEAP2_ID:
+			info &= XLOG_HEAP_OPMASK;
+			return info == XLOG_HEAP2_MULTI_INSERT;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Does this record remove or truncate relation files?
+ */
+static bool
+ParallelRedoDropsFiles(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & XLOG_XACT_OPMASK;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_SMGR_ID:
+		case RM_DBASE_ID:
+		case RM_TBLSPC_ID:
+			return true;
+		case RM_XACT_ID:
+			if (info == XLOG_XACT_COMMIT || info == XLOG_XACT_COMMIT_PREPARED)
+			{
+				xl_xact_parsed_commit parsed;
+
+				ParseCommitRecord(XLogRecGetInfo(record),
+								  (xl_xact_commit *) XLogRecGetData(record),
+								  &parsed);
+				return parsed.nrels > 0;
+			}
+			if (info == XLOG_XACT_ABORT || info == XLOG_XACT_ABORT_PREPARED)
+			{
+				xl_xact_parsed_abort parsed;
+
+				ParseAbortRecord(XLogRecGetInfo(record),
+								 (xl_xact_abort *) XLogRecGetData(record),
+								 &parsed);
+				return parsed.nrels > 0;
+			}
+			return false;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Send a message to a worker.  This blocks while the worker's queue is full.
+ */
+static void
+ParallelRedoSend(int worker, char type, XLogReaderState *record)
+{
+	ParallelRedoMessage msg;
+	shm_mq_iovec iov[2];
+	int			iovcnt = 1;
+	shm_mq_result res;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = type;
+	iov[0].data = (const char *) &msg;
+	iov[0].len = sizeof(msg);
+
+	if (record != NULL)
+	{
+		msg.ReadRecPtr = record->ReadRecPtr;
+		msg.EndRecPtr = record->EndRecPtr;
+		iov[1].data = (const char *) record->decoded_record;
+		iov[1].len = XLogRecGetTotalLen(record);
+		iovcnt = 2;
+	}
+
+	/* flush at once, as we may be about to wait for the worker */
+	res = shm_mq_sendv(redo_leader->mqh[worker], iov, iovcnt, false, true);
+	if (res != SHM_MQ_SUCCESS)
+		ereport(FATAL,
+				(errmsg("parallel redo worker %d exited unexpectedly", worker)));
+
+	redo_leader->dispatched[worker]++;
+	redo_leader->pending = true;
+}
+
+/*
+ * Wait until the workers have processed all messages sent to them.
+ */
+static void
+ParallelRedoWaitForWorkers(void)
+{
+	if (redo_leader == NULL || !redo_leader->pending)
+		return;
+
+	for (;;)
+	{
+		bool		done = true;
+		int			i;
+
+		for (i = 0; i < redo_leader->nworkers; i++)
+		{
+			pid_t		pid;
+
+			if (pg_atomic_read_u64(&redo_leader->shared->applied[i]) ==
+				redo_leader->dispatched[i])
+				continue;
+
+			done = false;
+			if (GetBackgroundWorkerPid(redo_leader->handle[i], &pid) == BGWH_STOPPED)
+				ereport(FATAL,
+						(errmsg("parallel redo worker %d exited unexpectedly", i)));
+		}
+
+		if (done)
+			break;
+
+		/*
+		 * A worker sets our latch after each message.  Time out now and then
+		 * anyway, as nothing sets it when a worker dies.
+		 */
+		WaitLatch(MyLatch,
+				  WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+				  1000L, WAIT_EVENT_PARALLEL_REDO);
+		ResetLatch(MyLatch);
+
+		HandleStartupProcInterrupts();
+	}
+
+	redo_leader->pending = false;
+}
+
+/*
+ * Main entry point for parallel redo worker processes.
+ */
+void
+ParallelRedoWorkerMain(Datum main_arg)
+{
+	ParallelRedoShared *shared;
+	dsm_segment *seg;
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	XLogReaderState *reader;
+	MemoryContext redo_context;
+	int			worker;
+
+	memcpy(&worker, MyBgworkerEntry->bgw_extra, sizeof(int));
+
+	/* SIGTERM is handled by bgworker_die(), which is fine for us */
+	BackgroundWorkerUnblockSignals();
+
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "parallel redo worker");
+
+	seg = dsm_attach(DatumGetUInt32(main_arg));
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+	shared = (ParallelRedoShared *) dsm_segment_address(seg);
+	if (shared->magic != PARALLEL_REDO_MAGIC)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("invalid magic number in dynamic shared memory segment")));
+
+	mq = ParallelRedoQueue(shared, worker);
+	shm_mq_set_receiver(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+
+	/* Replay records the way the startup process would */
+	InRecovery = true;
+	reachedConsistency = true;
+	i_am_standby = shared->i_am_standby;
+
+	reader = XLogReaderAllocate(NULL, NULL);
+	if (reader == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+
+	redo_context = AllocSetContextCreate(TopMemoryContext,
+										 "parallel redo",
+										 ALLOCSET_DEFAULT_SIZES);
+
+	for (;;)
+	{
+		ParallelRedoMessage *msg;
+		shm_mq_result res;
+		Size		nbytes;
+		void	   *data;
+
+		CHECK_FOR_INTERRUPTS();
+
+		res = shm_mq_receive(mqh, &nbytes, &data, false);
+		if (res != SHM_MQ_SUCCESS)
+			break;				/* end of redo, or the startup process died */
+
+		msg = (ParallelRedoMessage *) data;
+		if (msg->type == PARALLEL_REDO_RECORD)
+		{
+			XLogRecord *record = (XLogRecord *) ((char *) data + sizeof(*msg));
+			ErrorContextCallback errcallback;
+			MemoryContext oldcontext;
+			char	   *errormsg;
+
+			/* the decoded block data lives in the reader, not per record */
+			reader->ReadRecPtr = msg->ReadRecPtr;
+			reader->EndRecPtr = msg->EndRecPtr;
+			if (!DecodeXLogRecord(reader, record, &errormsg))
+				ereport(ERROR,
+						(errmsg_internal("%s", errormsg)));
+
+			errcallback.callback = parallel_redo_error_callback;
+			errcallback.arg = (void *) reader;
+			errcallback.previous = error_context_stack;
+			error_context_stack = &errcallback;
+
+			oldcontext = MemoryContextSwitchTo(redo_context);
+			RmgrTable[record->xl_rmid].rm_redo(reader);
+			MemoryContextSwitchTo(oldcontext);
+			MemoryContextReset(redo_context);
+
+			error_context_stack = errcallback.previous;
+		}
+		else if (msg->type == PARALLEL_REDO_INVALIDATE)
+			smgrcloseall();
+		else
+			elog(ERROR, "unrecognized parallel redo message type: %d",
+				 msg->type);
+
+		pg_atomic_fetch_add_u64(&shared->applied[worker], 1);
+		SetLatch(&shared->leader->procLatch);
+	}
+
+	XLogReaderFree(reader);
+}
+
+/*
+ * Error context callback for errors occurring during redo in a worker.
+ */
+static void
+parallel_redo_error_callback(void *arg)
+{
+	XLogReaderState *record = (XLogReaderState *) arg;
+	RmgrId		rmid = XLogRecGetRmid(record);
+	StringInfoData buf;
+
+	initStringInfo(&buf);
+	appendStringInfoString(&buf, RmgrTable[rmid].rm_name);
+	appendStringInfoChar(&buf, '/');
+	RmgrTable[rmid].rm_desc(&buf, record);
+
+	/* translator: %s is a WAL record description */
+	errcontext("WAL redo at %X/%X for %s",
+			   (uint32) (record->ReadRecPtr >> 32),
+			   (uint32) record->ReadRecPtr,
+			   buf.data);
+
+	pfree(buf.data);
+}
@@ -0,0 +1,305 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogprefetch.c
+ *	  Prefetching of data blocks referenced by WAL during recovery.
+ *
+ * Redo reads every data block a WAL record references synchronously, so
+ * recovery on storage with high latency spends most of its time waiting for
+ * reads.  To avoid that, the startup process runs a second WAL reader a
+ * configurable distance ahead of replay, decodes the records it finds, and
+ * issues prefetch requests (posix_fadvise) for the referenced blocks that
+ * are not in shared buffers yet.  By the time redo reaches a record, its
+ * blocks are hopefully in the kernel's page cache.
+ *
+ * The read-ahead reader reads WAL segments in pg_wal directly.  It never
+ * waits for WAL: if the next record is not there yet, or is not complete or
+ * valid, it stops, and tries again once replay has caught up with it.  That
+ * also means WAL that is restored from the archive one segment at a time is
+ * not prefetched.  Everything the read-ahead reader does is merely a hint,
+ * so it doesn't matter if what it reads turns out not to be replayed.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/xlogprefetch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
+#include "access/xlogreader.h"
+#include "access/xlogrecord.h"
+#include "storage/bufmgr.h"
+#include "storage/fd.h"
+
+/* GUC variable, in kilobytes of WAL */
+int			recovery_prefetch_distance = 0;
+
+/* Number of recently prefetched blocks remembered, to skip repeats */
+#define XLOGPREFETCH_RECENT_BLOCKS	16
+
+typedef struct XLogPrefetchBlock
+{
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber blkno;
+} XLogPrefetchBlock;
+
+struct XLogPrefetcher
+{
+	XLogReaderState *reader;
+	TimeLineID	tli;			/* timeline to read WAL from */
+
+	/* currently open WAL segment */
+	int			readFile;
+	XLogSegNo	readSegNo;
+
+	/*
+	 * aheadPtr is the end of the last record read ahead.  If the reader
+	 * stalled, it is restarted at restartPtr once replay has caught up.
+	 */
+	XLogRecPtr	aheadPtr;
+	XLogRecPtr	restartPtr;
+	bool		stalled;
+
+	XLogPrefetchBlock recent[XLOGPREFETCH_RECENT_BLOCKS];
+	int			next_recent;
+
+	/* statistics, reported at the end of recovery */
+	uint64		records;
+	uint64		prefetch;		/* prefetches issued */
+	uint64		skip_hit;		/* already in shared buffers */
+	uint64		skip_new;		/* full page image, or page initialized */
+	uint64		skip_repeat;	/* prefetched recently */
+};
+
+static int XLogPrefetcherPageRead(XLogReaderState *reader,
+					   XLogRecPtr targetPagePtr, int reqLen,
+					   XLogRecPtr targetRecPtr, char *readBuf,
+					   TimeLineID *pageTLI);
+static void XLogPrefetcherScanBlocks(XLogPrefetcher *prefetcher);
+static void XLogPrefetcherCloseFile(XLogPrefetcher *prefetcher);
+
+/*
+ * Create a prefetcher.  It starts reading ahead at the replay position of
+ * the first XLogPrefetcherReadAhead() call.
+ */
+XLogPrefetcher *
+XLogPrefetcherAllocate(TimeLineID tli)
+{
+	XLogPrefetcher *prefetcher;
+
+	prefetcher = (XLogPrefetcher *) palloc0(sizeof(XLogPrefetcher));
+	prefetcher->reader = XLogReaderAllocate(&XLogPrefetcherPageRead,
+											prefetcher);
+	if (prefetcher->reader == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+	prefetcher->tli = tli;
+	prefetcher->readFile = -1;
+	prefetcher->aheadPtr = InvalidXLogRecPtr;
+	prefetcher->restartPtr = InvalidXLogRecPtr;
+	prefetcher->stalled = true;
+
+	return prefetcher;
+}
+
+/*
+ * Release a prefetcher, and report what it did.
+ */
+void
+XLogPrefetcherFree(XLogPrefetcher *prefetcher)
+{
+	if (prefetcher->records > 0)
+		ereport(LOG,
+				(errmsg("recovery prefetch read ahead " UINT64_FORMAT " records: " UINT64_FORMAT " blocks prefetched, " UINT64_FORMAT " already in buffers, " UINT64_FORMAT " not read by redo, " UINT64_FORMAT " repeated",
+						prefetcher->records, prefetcher->prefetch,
+						prefetcher->skip_hit, prefetcher->skip_new,
+						prefetcher->skip_repeat)));
+
+	XLogPrefetcherCloseFile(prefetcher);
+	XLogReaderFree(prefetcher->reader);
+	pfree(prefetcher);
+}
+
+/*
+ * Read ahead of replay up to recovery_prefetch_distance, and prefetch the
+ * blocks referenced by the records read.
+ *
+ * replayEndPtr is the end of the record about to be replayed, and tli the
+ * timeline it is on.
+ */
+void
+XLogPrefetcherReadAhead(XLogPrefetcher *prefetcher, XLogRecPtr replayEndPtr,
+						TimeLineID tli)
+{
+	uint64		distance = (uint64) recovery_prefetch_distance * 1024;
+
+	if (distance == 0)
+		return;
+
+	if (tli != prefetcher->tli)
+	{
+		XLogPrefetcherCloseFile(prefetcher);
+		prefetcher->tli = tli;
+		prefetcher->stalled = true;
+		prefetcher->aheadPtr = InvalidXLogRecPtr;
+	}
+
+	/*
+	 * If we have fallen behind replay, because we stalled or were just
+	 * enabled, start over from the replay position.  Forget the cached page,
+	 * it may have been incomplete when we read it.
+	 */
+	if (prefetcher->aheadPtr < replayEndPtr)
+	{
+		prefetcher->aheadPtr = replayEndPtr;
+		prefetcher->restartPtr = replayEndPtr;
+		prefetcher->stalled = true;
+	}
+	else if (prefetcher->stalled && prefetcher->aheadPtr > replayEndPtr)
+		return;					/* not caught up with the stall point yet */
+
+	while (prefetcher->aheadPtr - replayEndPtr < distance)
+	{
+		XLogRecord *record;
+		char	   *errormsg;
+
+		if (prefetcher->stalled)
+		{
+			XLogRecPtr	startPtr = prefetcher->restartPtr;
+
+			/* at a page boundary, the next record starts after the header */
+			if (startPtr % XLOG_BLCKSZ == 0)
+				startPtr += (startPtr % XLogSegSize == 0) ?
+					SizeOfXLogLongPHD : SizeOfXLogShortPHD;
+
+			XLogReaderInvalReadState(prefetcher->reader);
+			record = XLogReadRecord(prefetcher->reader, startPtr, &errormsg);
+		}
+		else
+			record = XLogReadRecord(prefetcher->reader, InvalidXLogRecPtr,
+									&errormsg);
+
+		if (record == NULL)
+		{
+			/* end of the WAL available so far; retry when replay gets here */
+			prefetcher->restartPtr = prefetcher->aheadPtr;
+			prefetcher->stalled = true;
+			break;
+		}
+
+		prefetcher->stalled = false;
+		prefetcher->aheadPtr = prefetcher->reader->EndRecPtr;
+		prefetcher->records++;
+
+		XLogPrefetcherScanBlocks(prefetcher);
+	}
+}
+
+/*
+ * Issue prefetches for the blocks referenced by the record just read.
+ */
+static void
+XLogPrefetcherScanBlocks(XLogPrefetcher *prefetcher)
+{
+	XLogReaderState *reader = prefetcher->reader;
+	int			block_id;
+
+	for (block_id = 0; block_id <= reader->max_block_id; block_id++)
+	{
+		DecodedBkpBlock *blk = &reader->blocks[block_id];
+		XLogPrefetchBlock *recent;
+		int			i;
+
+		if (!blk->in_use)
+			continue;
+
+		/* redo doesn't read a block that it restores or initializes */
+		if (blk->apply_image || (blk->flags & BKPBLOCK_WILL_INIT) != 0)
+		{
+			prefetcher->skip_new++;
+			continue;
+		}
+
+		for (i = 0; i < XLOGPREFETCH_RECENT_BLOCKS; i++)
+		{
+			recent = &prefetcher->recent[i];
+			if (recent->blkno == blk->blkno &&
+				recent->forknum == blk->forknum &&
+				RelFileNodeEquals(recent->rnode, blk->rnode))
+				break;
+		}
+		if (i < XLOGPREFETCH_RECENT_BLOCKS)
+		{
+			prefetcher->skip_repeat++;
+			continue;
+		}
+
+		recent = &prefetcher->recent[prefetcher->next_recent];
+		recent->rnode = blk->rnode;
+		recent->forknum = blk->forknum;
+		recent->blkno = blk->blkno;
+		prefetcher->next_recent =
+			(prefetcher->next_recent + 1) % XLOGPREFETCH_RECENT_BLOCKS;
+
+		if (PrefetchBufferWithoutRelcache(blk->rnode, blk->forknum, blk->blkno))
+			prefetcher->prefetch++;
+		else
+			prefetcher->skip_hit++;
+	}
+}
+
+/*
+ * Page read callback of the read-ahead reader.  Reads the page from the WAL
+ * segment in pg_wal, if it's there.
+ */
+static int
+XLogPrefetcherPageRead(XLogReaderState *reader, XLogRecPtr targetPagePtr,
+					   int reqLen, XLogRecPtr targetRecPtr, char *readBuf,
+					   TimeLineID *pageTLI)
+{
+	XLogPrefetcher *prefetcher = (XLogPrefetcher *) reader->private_data;
+	XLogSegNo	segno;
+
+	XLByteToSeg(targetPagePtr, segno);
+
+	if (prefetcher->readFile >= 0 && segno != prefetcher->readSegNo)
+		XLogPrefetcherCloseFile(prefetcher);
+
+	if (prefetcher->readFile < 0)
+	{
+		char		path[MAXPGPATH];
+
+		XLogFilePath(path, prefetcher->tli, segno);
+		prefetcher->readFile = BasicOpenFile(path, O_RDONLY | PG_BINARY);
+		if (prefetcher->readFile < 0)
+			return -1;			/* not there (yet) */
+		prefetcher->readSegNo = segno;
+	}
+
+	if (pg_pread(prefetcher->readFile, readBuf, XLOG_BLCKSZ,
+				 targetPagePtr % XLogSegSize) != XLOG_BLCKSZ)
+		return -1;
+
+	*pageTLI = prefetcher->tli;
+	return XLOG_BLCKSZ;
+}
+
+static void
+XLogPrefetcherCloseFile(XLogPrefetcher *prefetcher)
+{
+	if (prefetcher->readFile >= 0)
+	{
+		close(prefetcher->readFile);
+		prefetcher->readFile = -1;
+	}
+}
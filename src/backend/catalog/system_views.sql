@@ -807,6 +807,7 @@ CREATE VIEW pg_stat_replication AS
             W.write_lag,
             W.flush_lag,
             W.replay_lag,
+            W.replay_rate,
             W.sync_priority,
             W.sync_state
     FROM pg_stat_get_activity(NULL) AS S
@@ -106,6 +106,8 @@ static void show_scan_qual(List *qual, const char *qlabel,
 static void show_upper_qual(List *qual, const char *qlabel,
 				PlanState *planstate, List *ancestors,
 				ExplainState *es);
+static void show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es);
 static void show_sort_keys(SortState *sortstate, List *ancestors,
 			   ExplainState *es);
 static void show_simple_sort(PlanState *remotestate,
@@ -132,7 +134,11 @@ static void show_sortorder_options(StringInfo buf, Node *sortexpr,
 static void show_tablesample(TableSampleClause *tsc, PlanState *planstate,
 				 List *ancestors, ExplainState *es);
 static void show_sort_info(SortState *sortstate, ExplainState *es);
+static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
+static void show_memoize_info(MemoizeState *mstate, List *ancestors,
+				  ExplainState *es);
 static void show_hashagg_info(AggState *hashstate, ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
 					ExplainState *es);
@@ -1687,9 +1693,15 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Material:
 			pname = sname = "Materialize";
 			break;
+		case T_Memoize:
+			pname = sname = "Memoize";
+			break;
 		case T_Sort:
 			pname = sname = "Sort";
 			break;
+		case T_IncrementalSort:
+			pname = sname = "Incremental Sort";
+			break;
 		case T_Group:
 			pname = sname = "Group";
 			break;
@@ -2765,6 +2777,12 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			show_sort_keys(castNode(SortState, planstate), ancestors, es);
 			show_sort_info(castNode(SortState, planstate), es);
 			break;
+		case T_IncrementalSort:
+			show_incremental_sort_keys(castNode(IncrementalSortState, planstate),
+									   ancestors, es);
+			show_incremental_sort_info(castNode(IncrementalSortState, planstate),
+									   es);
+			break;
 		case T_MergeAppend:
 			show_merge_append_keys(castNode(MergeAppendState, planstate),
 								   ancestors, es);
@@ -2794,6 +2812,10 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Hash:
 			show_hash_info(castNode(HashState, planstate), es);
 			break;
+		case T_Memoize:
+			show_memoize_info(castNode(MemoizeState, planstate), ancestors,
+							  es);
+			break;
 		case T_MergeQualProj:
 			show_mergequalproj_info(castNode(MergeQualProjState, planstate), ancestors, es);
 			break;
@@ -3294,6 +3316,27 @@ show_sort_keys(SortState *sortstate, List *ancestors, ExplainState *es)
 						 ancestors, es);
 }
 
+/*
+ * Show the sort keys and the presorted keys for an IncrementalSort node.
+ */
+static void
+show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es)
+{
+	IncrementalSort *plan = (IncrementalSort *) incrsortstate->ss.ps.plan;
+
+	show_sort_group_keys((PlanState *) incrsortstate, "Sort Key",
+						 plan->sort.numCols, plan->sort.sortColIdx,
+						 plan->sort.sortOperators, plan->sort.collations,
+						 plan->sort.nullsFirst,
+						 ancestors, es);
+	show_sort_group_keys((PlanState *) incrsortstate, "Presorted Key",
+						 plan->nPresortedCols, plan->sort.sortColIdx,
+						 plan->sort.sortOperators, plan->sort.collations,
+						 plan->sort.nullsFirst,
+						 ancestors, es);
+}
+
 /*
  * Show the sort keys for a SimpleSort node.
  */
@@ -3823,6 +3866,72 @@ show_sort_info(SortState *sortstate, ExplainState *es)
 	}
 }
 
+/*
+ * If it's EXPLAIN ANALYZE, show the number of sort batches and the tuplesort
+ * methods and space used by an incremental sort node.
+ */
+static void
+show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es)
+{
+	IncrementalSortGroupInfo *info = &incrsortstate->incsort_info;
+	StringInfoData methods;
+	int			m;
+
+	/*
+	 * On the coordinator the node may not have run at all; the datanode
+	 * statistics are displayed with the remote instrumentation instead.
+	 */
+	if (!es->analyze || info->groupCount == 0)
+		return;
+
+	initStringInfo(&methods);
+	for (m = SORT_TYPE_TOP_N_HEAPSORT; m <= SORT_TYPE_HYBRID_SORT; m++)
+	{
+		if (info->sortMethods & (1 << m))
+		{
+			if (methods.len > 0)
+				appendStringInfoString(&methods, ", ");
+			appendStringInfoString(&methods,
+								   tuplesort_method_name((TuplesortMethod) m));
+		}
+	}
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainIndentText(es);
+		appendStringInfo(es->str,
+						 "Sort Groups: " INT64_FORMAT "  Sort Methods: %s",
+						 info->groupCount, methods.data);
+		if (info->maxMemorySpaceUsed > 0)
+			appendStringInfo(es->str,
+							 "  Average Memory: %ldkB  Peak Memory: %ldkB",
+							 (long) (info->totalMemorySpaceUsed / info->groupCount),
+							 info->maxMemorySpaceUsed);
+		if (info->maxDiskSpaceUsed > 0)
+			appendStringInfo(es->str,
+							 "  Average Disk: %ldkB  Peak Disk: %ldkB",
+							 (long) (info->totalDiskSpaceUsed / info->groupCount),
+							 info->maxDiskSpaceUsed);
+		appendStringInfoChar(es->str, '\n');
+	}
+	else
+	{
+		ExplainPropertyInteger("Sort Groups", NULL, info->groupCount, es);
+		ExplainPropertyText("Sort Methods", methods.data, es);
+		ExplainPropertyInteger("Average Sort Space Used", "kB",
+							   (info->totalMemorySpaceUsed +
+								info->totalDiskSpaceUsed) / info->groupCount,
+							   es);
+		ExplainPropertyInteger("Peak Sort Memory Used", "kB",
+							   info->maxMemorySpaceUsed, es);
+		ExplainPropertyInteger("Peak Sort Disk Used", "kB",
+							   info->maxDiskSpaceUsed, es);
+	}
+
+	pfree(methods.data);
+}
+
 /*
  * Show information on hash buckets/batches.
  */
@@ -3924,6 +4033,101 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 	}
 }
 
+/*
+ * Show information on memoize hits/misses/evictions and memory usage.
+ */
+static void
+show_memoize_info(MemoizeState *mstate, List *ancestors, ExplainState *es)
+{
+	Plan	   *plan = ((PlanState *) mstate)->plan;
+	ListCell   *lc;
+	List	   *context;
+	StringInfoData keystr;
+	char	   *separator = "";
+	bool		useprefix;
+	int64		memPeakKb;
+
+	if (remote_session)
+		return;
+
+	initStringInfo(&keystr);
+
+	/*
+	 * It's hard to imagine having a memoize node with fewer than 2 RTEs, but
+	 * let's just keep the same useprefix logic as elsewhere in this file.
+	 */
+	useprefix = list_length(es->rtable) > 1 || es->verbose;
+
+	/* Set up deparsing context */
+	context = set_deparse_context_planstate(es->deparse_cxt,
+											(Node *) mstate,
+											ancestors);
+
+	foreach(lc, ((Memoize *) plan)->param_exprs)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		appendStringInfoString(&keystr, separator);
+
+		appendStringInfoString(&keystr, deparse_expression(expr, context,
+														   useprefix, false));
+		separator = ", ";
+	}
+
+	ExplainPropertyText("Cache Key", keystr.data, es);
+
+	pfree(keystr.data);
+
+	if (!es->analyze)
+		return;
+
+	/*
+	 * mem_peak is only set when we freed memory, so we must use mem_used when
+	 * mem_peak is 0.
+	 */
+	if (mstate->stats.mem_peak > 0)
+		memPeakKb = (mstate->stats.mem_peak + 1023) / 1024;
+	else
+		memPeakKb = (mstate->mem_used + 1023) / 1024;
+
+	/*
+	 * On the coordinator the node may not have run at all; the datanode
+	 * counters are displayed with the remote instrumentation instead.
+	 */
+	if (mstate->stats.cache_misses > 0)
+	{
+		if (es->format != EXPLAIN_FORMAT_TEXT)
+		{
+			ExplainPropertyInteger("Cache Hits", NULL,
+								   mstate->stats.cache_hits, es);
+			ExplainPropertyInteger("Cache Misses", NULL,
+								   mstate->stats.cache_misses, es);
+			ExplainPropertyInteger("Cache Evictions", NULL,
+								   mstate->stats.cache_evictions, es);
+			ExplainPropertyInteger("Cache Overflows", NULL,
+								   mstate->stats.cache_overflows, es);
+			ExplainPropertyInteger("Peak Memory Usage", "kB", memPeakKb, es);
+		}
+		else
+		{
+			ExplainIndentText(es);
+			appendStringInfo(es->str,
+							 "Hits: " UINT64_FORMAT "  Misses: " UINT64_FORMAT
+							 "  Hit Ratio: %.2f  Evictions: " UINT64_FORMAT
+							 "  Overflows: " UINT64_FORMAT
+							 "  Memory Usage: " INT64_FORMAT "kB\n",
+							 mstate->stats.cache_hits,
+							 mstate->stats.cache_misses,
+							 (double) mstate->stats.cache_hits /
+							 (mstate->stats.cache_hits +
+							  mstate->stats.cache_misses),
+							 mstate->stats.cache_evictions,
+							 mstate->stats.cache_overflows,
+							 memPeakKb);
+		}
+	}
+}
+
 /*
  * Show information on hash aggregate memory usage and batches.
  */
@@ -4192,8 +4396,12 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 								usage->temp_blks_written > 0);
 		bool		has_timing = (!INSTR_TIME_IS_ZERO(usage->blk_read_time) ||
 								  !INSTR_TIME_IS_ZERO(usage->blk_write_time));
+		bool		has_temp_timing = (!INSTR_TIME_IS_ZERO(usage->temp_blk_read_time) ||
+									   !INSTR_TIME_IS_ZERO(usage->temp_blk_write_time));
+		bool		has_compression = (usage->temp_bytes_uncompressed > 0);
 		bool		show_planning = (planning && (has_shared ||
-												  has_local || has_temp || has_timing));
+												  has_local || has_temp || has_timing ||
+												  has_temp_timing || has_compression));
 
 		if (show_planning)
 		{
@@ -4258,7 +4466,7 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 		}
 
 		/* As above, show only positive counter values. */
-		if (has_timing)
+		if (has_timing || has_temp_timing)
 		{
 			ExplainIndentText(es);
 			appendStringInfoString(es->str, "I/O Timings:");
@@ -4268,9 +4476,32 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 			if (!INSTR_TIME_IS_ZERO(usage->blk_write_time))
 				appendStringInfo(es->str, " write=%0.3f",
 								 INSTR_TIME_GET_MILLISEC(usage->blk_write_time));
+			if (has_temp_timing)
+			{
+				if (has_timing)
+					appendStringInfoChar(es->str, ',');
+				appendStringInfoString(es->str, " temp");
+				if (!INSTR_TIME_IS_ZERO(usage->temp_blk_read_time))
+					appendStringInfo(es->str, " read=%0.3f",
+									 INSTR_TIME_GET_MILLISEC(usage->temp_blk_read_time));
+				if (!INSTR_TIME_IS_ZERO(usage->temp_blk_write_time))
+					appendStringInfo(es->str, " write=%0.3f",
+									 INSTR_TIME_GET_MILLISEC(usage->temp_blk_write_time));
+			}
 			appendStringInfoChar(es->str, '\n');
 		}
 
+		if (has_compression)
+		{
+			ExplainIndentText(es);
+			appendStringInfo(es->str,
+							 "Temp Compression: raw=%ldkB compressed=%ldkB ratio=%.2f\n",
+							 (usage->temp_bytes_uncompressed + 1023) / 1024,
+							 (usage->temp_bytes_compressed + 1023) / 1024,
+							 (double) usage->temp_bytes_uncompressed /
+							 Max(usage->temp_bytes_compressed, 1));
+		}
+
 		if (show_planning)
 			es->indent--;
 	}
@@ -4304,6 +4535,19 @@ show_buffer_usage(ExplainState *es, const BufferUsage *usage, bool planning)
 			ExplainPropertyFloat("I/O Write Time", "ms",
 								 INSTR_TIME_GET_MILLISEC(usage->blk_write_time),
 								 3, es);
+			ExplainPropertyFloat("Temp I/O Read Time", "ms",
+								 INSTR_TIME_GET_MILLISEC(usage->temp_blk_read_time),
+								 3, es);
+			ExplainPropertyFloat("Temp I/O Write Time", "ms",
+								 INSTR_TIME_GET_MILLISEC(usage->temp_blk_write_time),
+								 3, es);
+		}
+		if (usage->temp_bytes_uncompressed > 0)
+		{
+			ExplainPropertyInteger("Temp Uncompressed Bytes", NULL,
+								   usage->temp_bytes_uncompressed, es);
+			ExplainPropertyInteger("Temp Compressed Bytes", NULL,
+								   usage->temp_bytes_compressed, es);
 		}
 	}
 }
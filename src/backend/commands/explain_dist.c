@@ -104,6 +104,17 @@ typedef enum
 	HASHINSTR_VAL_NUM /* must be the last one */
 } HashInstrValues;
 
+/* According to RemoteMemoizeState and MemoizeInstrumentation */
+typedef enum
+{
+	MEMO_HITS,
+	MEMO_MISSES,
+	MEMO_EVICTIONS,
+	MEMO_OVERFLOWS,
+	MEMO_MEM_PEAK,
+	MEMOINSTR_VAL_NUM /* must be the last one */
+} MemoizeInstrValues;
+
 /* According to RemoteAggState and AggregateInstrumentation */
 typedef enum
 {
@@ -256,6 +267,12 @@ InstrOut(StringInfo buf, Plan *plan, Instrumentation *instr)
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.blk_read_time.tv_nsec);
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.blk_write_time.tv_sec);
 	appendStringInfo(buf, "%ld,", instr->bufusage_start.blk_write_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_blk_read_time.tv_sec);
+	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_blk_read_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_blk_write_time.tv_sec);
+	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_blk_write_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_bytes_uncompressed);
+	appendStringInfo(buf, "%ld,", instr->bufusage_start.temp_bytes_compressed);
 	/* double */
 	appendStringInfo(buf, "%.10f,", instr->startup);
 	appendStringInfo(buf, "%.10f,", instr->total);
@@ -281,7 +298,13 @@ InstrOut(StringInfo buf, Plan *plan, Instrumentation *instr)
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_read_time.tv_sec);
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_read_time.tv_nsec);
 	appendStringInfo(buf, "%ld,", instr->bufusage.blk_write_time.tv_sec);
-	appendStringInfo(buf, "%ld}", instr->bufusage.blk_write_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage.blk_write_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage.temp_blk_read_time.tv_sec);
+	appendStringInfo(buf, "%ld,", instr->bufusage.temp_blk_read_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage.temp_blk_write_time.tv_sec);
+	appendStringInfo(buf, "%ld,", instr->bufusage.temp_blk_write_time.tv_nsec);
+	appendStringInfo(buf, "%ld,", instr->bufusage.temp_bytes_uncompressed);
+	appendStringInfo(buf, "%ld}", instr->bufusage.temp_bytes_compressed);
 }
 
 /*
@@ -468,6 +491,43 @@ SpecInstrOut(StringInfo buf, PlanState *planstate)
 			}
 			break;
 
+		case T_IncrementalSort:
+			{
+				/* according to RemoteIncrementalSortState and show_incremental_sort_info */
+				IncrementalSortGroupInfo *info =
+					&castNode(IncrementalSortState, planstate)->incsort_info;
+
+				if (info->groupCount > 0)
+					appendStringInfo(buf, "1<" INT64_FORMAT ",%u,%ld,%ld,%ld,%ld>",
+						info->groupCount, info->sortMethods,
+						info->maxMemorySpaceUsed, info->totalMemorySpaceUsed,
+						info->maxDiskSpaceUsed, info->totalDiskSpaceUsed);
+				else
+					appendStringInfo(buf, "0>");
+			}
+			break;
+
+		case T_Memoize:
+			{
+				/* according to RemoteMemoizeState and show_memoize_info */
+				MemoizeState *mstate = castNode(MemoizeState, planstate);
+				uint64		mem_peak = mstate->stats.mem_peak;
+
+				if (mem_peak == 0)
+					mem_peak = mstate->mem_used;
+
+				if (mstate->stats.cache_misses > 0)
+					appendStringInfo(buf, "1<" UINT64_FORMAT "," UINT64_FORMAT
+						"," UINT64_FORMAT "," UINT64_FORMAT "," UINT64_FORMAT ">",
+						mstate->stats.cache_hits, mstate->stats.cache_misses,
+						mstate->stats.cache_evictions,
+						mstate->stats.cache_overflows,
+						(mem_peak + 1023) / 1024);
+				else
+					appendStringInfo(buf, "0>");
+			}
+			break;
+
 		case T_Agg:
 			{
 				/* according to show_hashagg_info */
@@ -714,6 +774,12 @@ InstrIn(StringInfo str, Plan *plan, Instrumentation *instr)
 	INSTR_READ_FIELD(bufusage_start.blk_read_time.tv_nsec);
 	INSTR_READ_FIELD(bufusage_start.blk_write_time.tv_sec);
 	INSTR_READ_FIELD(bufusage_start.blk_write_time.tv_nsec);
+	INSTR_READ_FIELD(bufusage_start.temp_blk_read_time.tv_sec);
+	INSTR_READ_FIELD(bufusage_start.temp_blk_read_time.tv_nsec);
+	INSTR_READ_FIELD(bufusage_start.temp_blk_write_time.tv_sec);
+	INSTR_READ_FIELD(bufusage_start.temp_blk_write_time.tv_nsec);
+	INSTR_READ_FIELD(bufusage_start.temp_bytes_uncompressed);
+	INSTR_READ_FIELD(bufusage_start.temp_bytes_compressed);
 
 	INSTR_READ_FIELD(startup);
 	INSTR_READ_FIELD(total);
@@ -740,6 +806,12 @@ InstrIn(StringInfo str, Plan *plan, Instrumentation *instr)
 	INSTR_READ_FIELD(bufusage.blk_read_time.tv_nsec);
 	INSTR_READ_FIELD(bufusage.blk_write_time.tv_sec);
 	INSTR_READ_FIELD(bufusage.blk_write_time.tv_nsec);
+	INSTR_READ_FIELD(bufusage.temp_blk_read_time.tv_sec);
+	INSTR_READ_FIELD(bufusage.temp_blk_read_time.tv_nsec);
+	INSTR_READ_FIELD(bufusage.temp_blk_write_time.tv_sec);
+	INSTR_READ_FIELD(bufusage.temp_blk_write_time.tv_nsec);
+	INSTR_READ_FIELD(bufusage.temp_bytes_uncompressed);
+	INSTR_READ_FIELD(bufusage.temp_bytes_compressed);
 
 	/* tmp_head points to next instrument's nodetype or '\0' already */
 	str->cursor = tmp_head - &str->data[0];
@@ -933,6 +1005,41 @@ SpecInstrIn(StringInfo str, Plan *plan, RemoteInstrumentation *remote_instr)
 			}
 			break;
 
+		case T_IncrementalSort:
+			{
+				RemoteIncrementalSortState *instr = (RemoteIncrementalSortState *)palloc0(
+													sizeof(RemoteIncrementalSortState));
+				INSTR_READ_FIELD(rs.isvalid);
+				if (instr->rs.isvalid)
+				{
+					INSTR_READ_FIELD(stat.groupCount);
+					INSTR_READ_FIELD(stat.sortMethods);
+					INSTR_READ_FIELD(stat.maxMemorySpaceUsed);
+					INSTR_READ_FIELD(stat.totalMemorySpaceUsed);
+					INSTR_READ_FIELD(stat.maxDiskSpaceUsed);
+					INSTR_READ_FIELD(stat.totalDiskSpaceUsed);
+				}
+				remote_instr->state = (RemoteState *) instr;
+			}
+			break;
+
+		case T_Memoize:
+			{
+				RemoteMemoizeState *instr = (RemoteMemoizeState *)palloc0(
+													sizeof(RemoteMemoizeState));
+				INSTR_READ_FIELD(rs.isvalid);
+				if (instr->rs.isvalid)
+				{
+					INSTR_READ_FIELD(stat.cache_hits);
+					INSTR_READ_FIELD(stat.cache_misses);
+					INSTR_READ_FIELD(stat.cache_evictions);
+					INSTR_READ_FIELD(stat.cache_overflows);
+					INSTR_READ_FIELD(stat.mem_peak);
+				}
+				remote_instr->state = (RemoteState *) instr;
+			}
+			break;
+
 		case T_Agg:
 			{
 				RemoteAggState *instr;
@@ -1457,6 +1564,201 @@ ExplainRemoteHashState(RemoteInstrumentation *instrs, ExplainState *es)
 	}
 }
 
+/*
+ * Format the tuplesort methods recorded in an IncrementalSortGroupInfo.
+ */
+static void
+incsort_methods_string(StringInfo buf, bits32 sortMethods)
+{
+	int m;
+
+	for (m = SORT_TYPE_TOP_N_HEAPSORT; m <= SORT_TYPE_HYBRID_SORT; m++)
+	{
+		if (sortMethods & (1 << m))
+		{
+			if (buf->len > 0)
+				appendStringInfoString(buf, ", ");
+			appendStringInfoString(buf, tuplesort_method_name((TuplesortMethod) m));
+		}
+	}
+}
+
+/*
+ * ExplainRemoteIncrementalSortState
+ *
+ * Display instrument info in IncrementalSortState of datanodes.  Sort groups
+ * are summed across datanodes, peak space is the maximum of them.
+ */
+static void
+ExplainRemoteIncrementalSortState(RemoteInstrumentation *instrs, ExplainState *es)
+{
+	int i;
+	IncrementalSortGroupInfo *stat;
+	StringInfoData methods;
+
+	for (i = 0; i < NumDataNodes; i++)
+	{
+		if (instrs[i].state == NULL)
+			continue;
+		if (instrs[i].state->isvalid)
+			break;
+	}
+
+	if (i == NumDataNodes)
+		return;
+
+	initStringInfo(&methods);
+
+	if (!es->verbose)
+	{
+		int64 groups = 0;
+		bits32 sortMethods = 0;
+		long max_mem = 0;
+		long max_disk = 0;
+
+		for (; i < NumDataNodes; i++)
+		{
+			if (instrs[i].state == NULL || !instrs[i].state->isvalid)
+				continue;
+
+			stat = &((RemoteIncrementalSortState *) instrs[i].state)->stat;
+			groups += stat->groupCount;
+			sortMethods |= stat->sortMethods;
+			max_mem = Max(max_mem, stat->maxMemorySpaceUsed);
+			max_disk = Max(max_disk, stat->maxDiskSpaceUsed);
+			es->query_mem += stat->maxMemorySpaceUsed;
+		}
+
+		incsort_methods_string(&methods, sortMethods);
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+			"Sort Groups: " INT64_FORMAT "  Sort Methods: %s  "
+			"Peak Memory: %ldkB  Peak Disk: %ldkB\n",
+			groups, methods.data, max_mem, max_disk);
+	}
+	else
+	{
+		StringInfoData buf;
+		initStringInfo(&buf);
+
+		for (; i < NumDataNodes; i++)
+		{
+			if (instrs[i].state == NULL || !instrs[i].state->isvalid)
+				continue;
+
+			stat = &((RemoteIncrementalSortState *) instrs[i].state)->stat;
+			es->query_mem += stat->maxMemorySpaceUsed;
+
+			resetStringInfo(&methods);
+			incsort_methods_string(&methods, stat->sortMethods);
+			appendStringInfoSpaces(&buf, es->indent * 2);
+			appendStringInfo(&buf,
+				"- %s Sort Groups: " INT64_FORMAT "  Sort Methods: %s  "
+				"Peak Memory: %ldkB  Peak Disk: %ldkB\n",
+				dn_names[i], stat->groupCount, methods.data,
+				stat->maxMemorySpaceUsed, stat->maxDiskSpaceUsed);
+		}
+
+		if (buf.len > 0)
+			appendStringInfo(es->str, "%s", buf.data);
+		pfree(buf.data);
+	}
+
+	pfree(methods.data);
+}
+
+/*
+ * ExplainRemoteMemoizeState
+ *
+ * Display instrument info in MemoizeState of datanodes.  Every datanode
+ * keeps a cache of its own, so the hit ratio is summed across them.
+ */
+static void
+ExplainRemoteMemoizeState(RemoteInstrumentation *instrs, ExplainState *es)
+{
+	int i;
+	MemoizeInstrumentation *stat;
+
+	for (i = 0; i < NumDataNodes; i++)
+	{
+		if (instrs[i].state == NULL)
+			continue;
+		if (instrs[i].state->isvalid)
+			break;
+	}
+
+	if (i == NumDataNodes)
+		return;
+
+	if (!es->verbose)
+	{
+		/* RemoteMemoizeState values vs. min max avg */
+		long values[MEMOINSTR_VAL_NUM][EXPLAIN_VAL_NUM];
+		uint64 hits = 0;
+		uint64 misses = 0;
+		int count = 0;
+
+		/* init */
+		MemSet(values, 0, sizeof(values));
+		values[MEMO_EVICTIONS][MIN_VAL] = values[MEMO_OVERFLOWS][MIN_VAL] = LONG_MAX;
+		values[MEMO_MEM_PEAK][MIN_VAL] = LONG_MAX;
+
+		for (; i < NumDataNodes; i++)
+		{
+			if (instrs[i].state == NULL || !instrs[i].state->isvalid)
+				continue;
+
+			stat = &((RemoteMemoizeState *) instrs[i].state)->stat;
+			count++;
+			hits += stat->cache_hits;
+			misses += stat->cache_misses;
+			SET_MIN_MAX_AVG(values[MEMO_EVICTIONS], (long) stat->cache_evictions);
+			SET_MIN_MAX_AVG(values[MEMO_OVERFLOWS], (long) stat->cache_overflows);
+			SET_MIN_MAX_AVG(values[MEMO_MEM_PEAK], (long) stat->mem_peak);
+			es->query_mem += stat->mem_peak;
+		}
+
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+			"Hits: " UINT64_FORMAT "  Misses: " UINT64_FORMAT "  Hit Ratio: %.2f  "
+			"Evictions: min %ld max %ld avg %ld  "
+			"Overflows: min %ld max %ld avg %ld  "
+			"Memory Usage: min %ldkB max %ldkB avg %ldkB\n",
+			hits, misses, (double) hits / (hits + misses),
+			values[MEMO_EVICTIONS][0], values[MEMO_EVICTIONS][1], values[MEMO_EVICTIONS][2],
+			values[MEMO_OVERFLOWS][0], values[MEMO_OVERFLOWS][1], values[MEMO_OVERFLOWS][2],
+			values[MEMO_MEM_PEAK][0], values[MEMO_MEM_PEAK][1], values[MEMO_MEM_PEAK][2]);
+	}
+	else
+	{
+		StringInfoData buf;
+		initStringInfo(&buf);
+
+		for (; i < NumDataNodes; i++)
+		{
+			if (instrs[i].state == NULL || !instrs[i].state->isvalid)
+				continue;
+
+			stat = &((RemoteMemoizeState *) instrs[i].state)->stat;
+			es->query_mem += stat->mem_peak;
+
+			appendStringInfoSpaces(&buf, es->indent * 2);
+			appendStringInfo(&buf,
+				"- %s Hits: " UINT64_FORMAT "  Misses: " UINT64_FORMAT
+				"  Hit Ratio: %.2f  Evictions: " UINT64_FORMAT
+				"  Overflows: " UINT64_FORMAT "  Memory Usage: " UINT64_FORMAT "kB\n",
+				dn_names[i], stat->cache_hits, stat->cache_misses,
+				(double) stat->cache_hits /
+				(stat->cache_hits + stat->cache_misses),
+				stat->cache_evictions, stat->cache_overflows, stat->mem_peak);
+		}
+
+		if (buf.len > 0)
+			appendStringInfo(es->str, "%s", buf.data);
+		pfree(buf.data);
+	}
+}
+
 /*
  * ExplainRemoteAggState
  *
@@ -1823,6 +2125,14 @@ ExplainSpecialRemoteInstr(RemoteInstrumentation *instrs, ExplainState *es,
 			/* display more info in HashState as show_hash_info */
 			ExplainRemoteHashState(instrs, es);
 			break;
+		case T_IncrementalSort:
+			/* display more info as show_incremental_sort_info */
+			ExplainRemoteIncrementalSortState(instrs, es);
+			break;
+		case T_Memoize:
+			/* display more info in MemoizeState as show_memoize_info */
+			ExplainRemoteMemoizeState(instrs, es);
+			break;
 		case T_Agg:
 			/* display more info in AggState as show_hashagg_info */
 			ExplainRemoteAggState(instrs, es);
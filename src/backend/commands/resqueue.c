@@ -964,7 +964,9 @@ IsMemoryIntensivePlan(Plan *node)
 		case T_FunctionScan:
 		case T_GatherMerge:
 		case T_Hash:
+		case T_IncrementalSort:
 		case T_Material:
+		case T_Memoize:
 		case T_MergeAppend:
 		case T_RecursiveUnion:
 		case T_RemoteSubplan:
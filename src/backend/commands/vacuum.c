@@ -88,6 +88,16 @@ int			vacuum_multixact_freeze_min_age;
 int			vacuum_multixact_freeze_table_age;
 int			vacuum_defer_freeze_min_age;
 
+/*
+ * Cost balance shared by the participants of a parallel index vacuum, and
+ * the number of them currently doing I/O.  NULL unless one is in progress.
+ * VacuumCostBalanceLocal is the part of the shared balance this process
+ * contributed since it last slept.
+ */
+pg_atomic_uint32 *VacuumSharedCostBalance = NULL;
+pg_atomic_uint32 *VacuumActiveNWorkers = NULL;
+int			VacuumCostBalanceLocal = 0;
+
 /* A few variables that don't seem worth passing around as parameters */
 static MemoryContext vac_context = NULL;
 static BufferAccessStrategy vac_strategy;
@@ -101,6 +111,7 @@ static void vac_truncate_clog(TransactionId frozenXID,
 				  MultiXactId lastSaneMinMulti);
 static bool vacuum_rel(Oid relid, RangeVar *relation, int options,
 		   VacuumParams *params, bool skip_privs);
+static int	compute_parallel_delay(void);
 
 /*
  * Primary entry point for manual VACUUM and ANALYZE commands
@@ -318,6 +329,9 @@ vacuum(int options, RangeVar *relation, Oid relid, VacuumParams *params,
 		VacuumPageHit = 0;
 		VacuumPageMiss = 0;
 		VacuumPageDirty = 0;
+		VacuumSharedCostBalance = NULL;
+		VacuumActiveNWorkers = NULL;
+		VacuumCostBalanceLocal = 0;
 
 		/*
 		 * Loop to process each selected relation.
@@ -1723,19 +1737,30 @@ vac_close_indexes(int nindexes, Relation *Irel, LOCKMODE lockmode)
 void
 vacuum_delay_point(void)
 {
+	int			msec = 0;
+
 	/* Always check for interrupts */
 	CHECK_FOR_INTERRUPTS();
 
-	/* Nap if appropriate */
-	if (VacuumCostActive && !InterruptPending &&
-		VacuumCostBalance >= VacuumCostLimit)
-	{
-		int			msec;
+	if (!VacuumCostActive || InterruptPending)
+		return;
 
+	/*
+	 * During a parallel index vacuum, all participants draw on one shared
+	 * balance, so that the cost limit holds for the operation as a whole.
+	 */
+	if (VacuumSharedCostBalance != NULL)
+		msec = compute_parallel_delay();
+	else if (VacuumCostBalance >= VacuumCostLimit)
+	{
 		msec = VacuumCostDelay * VacuumCostBalance / VacuumCostLimit;
 		if (msec > VacuumCostDelay * 4)
 			msec = VacuumCostDelay * 4;
+	}
 
+	/* Nap if appropriate */
+	if (msec > 0)
+	{
 		pg_usleep(msec * 1000L);
 
 		VacuumCostBalance = 0;
@@ -1748,6 +1773,48 @@ vacuum_delay_point(void)
 	}
 }
 
+/*
+ * compute_parallel_delay --- cost-based delay of one parallel vacuum
+ * participant.
+ *
+ * The local balance is added to the shared one.  Once the shared balance
+ * reaches the limit, a participant that has done more than its fair share
+ * of the I/O since it last slept sleeps in proportion to its own share, and
+ * takes it off the shared balance.  Returns the time to sleep in msec.
+ */
+static int
+compute_parallel_delay(void)
+{
+	int			msec = 0;
+	uint32		shared_balance;
+	int			nworkers;
+
+	nworkers = pg_atomic_read_u32(VacuumActiveNWorkers);
+
+	/* at least count this process */
+	Assert(nworkers >= 1);
+
+	shared_balance = pg_atomic_add_fetch_u32(VacuumSharedCostBalance,
+											 VacuumCostBalance);
+	VacuumCostBalanceLocal += VacuumCostBalance;
+
+	if (shared_balance >= VacuumCostLimit &&
+		VacuumCostBalanceLocal > 0.5 * ((double) VacuumCostLimit / nworkers))
+	{
+		msec = VacuumCostDelay * VacuumCostBalanceLocal / VacuumCostLimit;
+		if (msec > VacuumCostDelay * 4)
+			msec = VacuumCostDelay * 4;
+		pg_atomic_sub_fetch_u32(VacuumSharedCostBalance,
+								VacuumCostBalanceLocal);
+		VacuumCostBalanceLocal = 0;
+	}
+
+	/* the local balance now lives in the shared one */
+	VacuumCostBalance = 0;
+
+	return msec;
+}
+
 #ifdef XCP
 /*
  * For the data node query make up TargetEntry representing specified column
@@ -4,23 +4,32 @@
  *	  Concurrent ("lazy") vacuuming.
  *
  *
- * The major space usage for LAZY VACUUM is storage for the array of dead tuple
- * TIDs.  We want to ensure we can vacuum even the very largest relations with
+ * The major space usage for LAZY VACUUM is storage for the dead tuple TIDs.
+ * We want to ensure we can vacuum even the very largest relations with
  * finite memory space usage.  To do that, we set upper bounds on the number of
  * tuples we will keep track of at once.
  *
  * We are willing to use at most maintenance_work_mem (or perhaps
  * autovacuum_work_mem) memory space to keep track of dead tuples.  We
- * initially allocate an array of TIDs of that size, with an upper limit that
+ * initially allocate a TID store of that size, with an upper limit that
  * depends on table size (this limit ensures we don't allocate a huge area
- * uselessly for vacuuming small tables).  If the array threatens to overflow,
+ * uselessly for vacuuming small tables).  If the store threatens to overflow,
  * we suspend the heap scan phase and perform a pass of index cleanup and page
- * compaction, then resume the heap scan with an empty TID array.
+ * compaction, then resume the heap scan with an empty TID store.  The store
+ * keeps each heap block number only once, followed by the offsets of its dead
+ * tuples, so it holds about three times as many TIDs as a plain TID array
+ * when pages have several dead tuples each, and fewer index passes are needed.
  *
  * If we're processing a table with no indexes, we can just vacuum each page
  * as we go; there's no need to save up multiple tuples to minimize the number
  * of index scans performed.  So we don't use maintenance_work_mem memory for
- * the TID array, just enough to hold as many heap tuples as fit on one page.
+ * the TID store, just enough to hold as many heap tuples as fit on one page.
+ *
+ * If max_parallel_maintenance_workers allows it, each pass over the indexes
+ * is shared out to parallel workers, one index at a time, with the leader
+ * taking part.  The TID store then lives in a DSM segment, so that the
+ * workers can look up dead tuples without a copy of it.  The heap itself is
+ * still scanned and vacuumed by the leader alone.
  *
  *
  * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
@@ -43,23 +52,27 @@
 #include "access/heapam_xlog.h"
 #include "access/htup_details.h"
 #include "access/multixact.h"
+#include "access/parallel.h"
 #include "access/transam.h"
 #include "access/visibilitymap.h"
 #include "access/xlog.h"
 #include "access/xlogutils.h"
 #include "bootstrap/bootstrap.h"
 #include "catalog/catalog.h"
+#include "catalog/pg_am.h"
 #include "catalog/storage.h"
 #include "commands/dbcommands.h"
 #include "commands/progress.h"
 #include "commands/vacuum.h"
 #include "miscadmin.h"
+#include "optimizer/paths.h"
 #include "pgstat.h"
 #include "portability/instr_time.h"
 #include "postmaster/auditlogger.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/postmaster.h"
 #include "storage/bufmgr.h"
+#include "storage/dsm_impl.h"
 #include "storage/freespace.h"
 #include "storage/lmgr.h"
 #include "utils/lsyscache.h"
@@ -113,6 +126,104 @@
  */
 #define PREFETCH_SIZE			((BlockNumber) 32)
 
+/*
+ * Dead tuple TID store.
+ *
+ * The TIDs are kept grouped by heap block: an LVDeadBlock entry records the
+ * block number once, and the offset numbers of the block's dead tuples are
+ * kept in ascending order in offsets[].  Offsets fill the space from the
+ * front and block entries from the back, so the same amount of memory serves
+ * for any mix of sparse and dense pages.  Blocks are added in ascending
+ * order, so both arrays can be binary searched.
+ *
+ * The store is a single flat chunk, so that it can be placed in a DSM segment
+ * and be read by parallel vacuum workers.
+ */
+typedef struct LVDeadBlock
+{
+	BlockNumber blkno;
+	int			first;			/* index in offsets[] of its first tuple */
+} LVDeadBlock;
+
+typedef struct LVDeadTuples
+{
+	Size		max_bytes;		/* space for offsets and block entries */
+	int			num_tuples;		/* # offsets stored */
+	int			num_blocks;		/* # block entries stored */
+	OffsetNumber offsets[FLEXIBLE_ARRAY_MEMBER];
+} LVDeadTuples;
+
+#define SizeOfDeadTuples(bytes) (offsetof(LVDeadTuples, offsets) + (bytes))
+
+/* i'th block entry, counted from the end of the chunk */
+#define DeadTuplesBlock(dt, i) \
+	((LVDeadBlock *) ((char *) (dt)->offsets + (dt)->max_bytes) - ((i) + 1))
+
+#define DeadTuplesUsedBytes(dt) \
+	((dt)->num_tuples * sizeof(OffsetNumber) + \
+	 (dt)->num_blocks * sizeof(LVDeadBlock))
+
+/* Space needed to record the dead tuples of one more heap page */
+#define DEAD_TUPLES_PAGE_SPACE \
+	(sizeof(LVDeadBlock) + LAZY_ALLOC_TUPLES * sizeof(OffsetNumber))
+
+/*
+ * Number of dead tuples the store is sure to hold before an index vacuum
+ * cycle is needed.  That is when every page has a single dead tuple and so
+ * needs a block entry of its own; denser pages fit more.
+ */
+#define DeadTuplesMaxTuples(dt) \
+	(((dt)->max_bytes - DEAD_TUPLES_PAGE_SPACE) / \
+	 (sizeof(OffsetNumber) + sizeof(LVDeadBlock)) + 1)
+
+/*
+ * Magic numbers for parallel vacuum state in the DSM TOC.
+ */
+#define PARALLEL_VACUUM_KEY_SHARED			UINT64CONST(0xA000000000000001)
+
+/*
+ * Per-index state of a parallel pass over the indexes.  The bulk-delete
+ * results are handed between the leader and the workers through here.
+ */
+typedef struct LVSharedIndStats
+{
+	bool		parallel_safe;	/* may a worker process this index? */
+	bool		updated;		/* is stats valid? */
+	IndexBulkDeleteResult stats;
+} LVSharedIndStats;
+
+/*
+ * Shared state of a parallel pass over the indexes.  Participants claim
+ * indexes one at a time through nextidx.
+ */
+typedef struct LVShared
+{
+	Oid			relid;
+	int			elevel;
+	bool		for_cleanup;	/* index cleanup rather than bulk deletion */
+	bool		estimated_count;	/* is reltuples an estimate? */
+	double		reltuples;		/* num_heap_tuples for the index AMs */
+	dsm_handle	dead_tuples_handle; /* segment holding the TID store */
+
+	/* shared cost-based delay, see vacuum_delay_point() */
+	pg_atomic_uint32 cost_balance;
+	pg_atomic_uint32 active_nworkers;
+
+	pg_atomic_uint32 nextidx;
+	int			nindexes;
+	LVSharedIndStats indstats[FLEXIBLE_ARRAY_MEMBER];
+} LVShared;
+
+/*
+ * Leader's state for parallel index vacuuming, set up once per relation.
+ */
+typedef struct LVParallelState
+{
+	int			nworkers;		/* # workers to request per pass */
+	bool	   *can_parallel;	/* indexes the workers may process */
+	dsm_segment *dead_tuples_seg;	/* segment holding the TID store */
+} LVParallelState;
+
 typedef struct LVRelStats
 {
 	/* hasindex = true means two-pass strategy; false means one-pass */
@@ -131,14 +242,13 @@ typedef struct LVRelStats
 	BlockNumber pages_removed;
 	double		tuples_deleted;
 	BlockNumber nonempty_pages; /* actually, last nonempty page + 1 */
-	/* List of TIDs of tuples we intend to delete */
-	/* NB: this list is ordered by TID address */
-	int			num_dead_tuples;	/* current # of entries */
-	int			max_dead_tuples;	/* # slots allocated in array */
-	ItemPointer dead_tuples;	/* array of ItemPointerData */
+	/* TIDs of tuples we intend to delete, ordered by TID address */
+	LVDeadTuples *dead_tuples;
 	int			num_index_scans;
 	TransactionId latestRemovedXid;
 	bool		lock_waiter_detected;
+	/* NULL unless the indexes are vacuumed in parallel */
+	LVParallelState *lps;
 } LVRelStats;
 
 int	gts_maintain_option;
@@ -164,26 +274,42 @@ static void lazy_scan_heap(Relation onerel, int options,
 			   bool aggressive);
 static void lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats);
 static bool lazy_check_needs_freeze(Buffer buf, bool *hastup);
+static void lazy_vacuum_all_indexes(Relation onerel, Relation *Irel,
+						IndexBulkDeleteResult **indstats, int nindexes,
+						LVRelStats *vacrelstats);
+static void lazy_cleanup_all_indexes(Relation onerel, Relation *Irel,
+						 IndexBulkDeleteResult **indstats, int nindexes,
+						 LVRelStats *vacrelstats);
 static void lazy_vacuum_index(Relation indrel,
 				  IndexBulkDeleteResult **stats,
-				  LVRelStats *vacrelstats);
+				  LVDeadTuples *dead_tuples, double reltuples);
 void lazy_vacuum_global_index_table(Relation *rels, int nrel, int options, VacuumParams *params,
 				BufferAccessStrategy bstrategy);
 
 static void lazy_cleanup_index(Relation indrel,
-				   IndexBulkDeleteResult *stats,
-				   LVRelStats *vacrelstats);
+				   IndexBulkDeleteResult **stats,
+				   double reltuples, bool estimated_count);
+static void lazy_update_index_stats(Relation indrel,
+						IndexBulkDeleteResult *stats);
 static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
-				 int tupindex, LVRelStats *vacrelstats, Buffer *vmbuffer);
+				 int blkindex, LVRelStats *vacrelstats, Buffer *vmbuffer);
 static bool should_attempt_truncation(LVRelStats *vacrelstats);
 static void lazy_truncate_heap(Relation onerel, LVRelStats *vacrelstats);
 static BlockNumber count_nondeletable_pages(Relation onerel,
 						 LVRelStats *vacrelstats);
 static void lazy_space_alloc(LVRelStats *vacrelstats, BlockNumber relblocks);
+static void lazy_space_free(LVRelStats *vacrelstats);
+static bool lazy_dead_tuples_full(LVRelStats *vacrelstats);
 static void lazy_record_dead_tuple(LVRelStats *vacrelstats,
 					   ItemPointer itemptr);
 static bool lazy_tid_reaped(ItemPointer itemptr, void *state);
-static int	vac_cmp_itemptr(const void *left, const void *right);
+static LVParallelState *begin_parallel_vacuum(Relation onerel, Relation *Irel,
+					  int nindexes);
+static void lazy_parallel_vacuum_indexes(Relation onerel, Relation *Irel,
+							 IndexBulkDeleteResult **indstats, int nindexes,
+							 LVRelStats *vacrelstats, bool for_cleanup);
+static void parallel_vacuum_indexes(Relation *Irel, int nindexes,
+						LVShared *shared, LVDeadTuples *dead_tuples);
 static bool heap_page_is_all_visible(Relation rel, Buffer buf,
 						 TransactionId *visibility_cutoff_xid, bool *all_frozen);
 
@@ -540,13 +666,19 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 	vacrelstats->nonempty_pages = 0;
 	vacrelstats->latestRemovedXid = InvalidTransactionId;
 
+	/*
+	 * Decide whether the indexes are to be vacuumed in parallel; this decides
+	 * where the TID store is allocated.
+	 */
+	vacrelstats->lps = begin_parallel_vacuum(onerel, Irel, nindexes);
+
 	lazy_space_alloc(vacrelstats, nblocks);
 	frozen = palloc(sizeof(xl_heap_freeze_tuple) * MaxHeapTuplesPerPage);
 
 	/* Report that we're scanning the heap, advertising total # of blocks */
 	initprog_val[0] = PROGRESS_VACUUM_PHASE_SCAN_HEAP;
 	initprog_val[1] = nblocks;
-	initprog_val[2] = vacrelstats->max_dead_tuples;
+	initprog_val[2] = DeadTuplesMaxTuples(vacrelstats->dead_tuples);
 	pgstat_progress_update_multi_param(3, initprog_index, initprog_val);
 
 	/*
@@ -724,8 +856,8 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 		 * If we are close to overrunning the available space for dead-tuple
 		 * TIDs, pause and do a cycle of vacuuming before we tackle this page.
 		 */
-		if ((vacrelstats->max_dead_tuples - vacrelstats->num_dead_tuples) < MaxHeapTuplesPerPage &&
-			vacrelstats->num_dead_tuples > 0)
+		if (lazy_dead_tuples_full(vacrelstats) &&
+			vacrelstats->dead_tuples->num_tuples > 0)
 		{
 			const int	hvp_index[] = {
 				PROGRESS_VACUUM_PHASE,
@@ -753,10 +885,8 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 										 PROGRESS_VACUUM_PHASE_VACUUM_INDEX);
 
 			/* Remove index entries */
-			for (i = 0; i < nindexes; i++)
-				lazy_vacuum_index(Irel[i],
-								  &indstats[i],
-								  vacrelstats);
+			lazy_vacuum_all_indexes(onerel, Irel, indstats, nindexes,
+									vacrelstats);
 
 			/*
 			 * Report that we are now vacuuming the heap.  We also increase
@@ -776,7 +906,8 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 			 * not to reset latestRemovedXid since we want that value to be
 			 * valid.
 			 */
-			vacrelstats->num_dead_tuples = 0;
+			vacrelstats->dead_tuples->num_tuples = 0;
+			vacrelstats->dead_tuples->num_blocks = 0;
 			vacrelstats->num_index_scans++;
 
 			/* Report that we are once again scanning the heap */
@@ -977,7 +1108,7 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 		has_dead_tuples = false;
 		nfrozen = 0;
 		hastup = false;
-		prev_dead_count = vacrelstats->num_dead_tuples;
+		prev_dead_count = vacrelstats->dead_tuples->num_tuples;
 		maxoff = PageGetMaxOffsetNumber(page);
 
 		/*
@@ -1244,7 +1375,7 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 		 * instead of doing a second scan.
 		 */
 		if (nindexes == 0 &&
-			vacrelstats->num_dead_tuples > 0)
+			vacrelstats->dead_tuples->num_tuples > 0)
 		{
 			/* Remove tuples from heap */
 			lazy_vacuum_page(onerel, blkno, buf, 0, vacrelstats, &vmbuffer);
@@ -1255,7 +1386,8 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 			 * not to reset latestRemovedXid since we want that value to be
 			 * valid.
 			 */
-			vacrelstats->num_dead_tuples = 0;
+			vacrelstats->dead_tuples->num_tuples = 0;
+			vacrelstats->dead_tuples->num_blocks = 0;
 			vacuumed_pages++;
 		}
 
@@ -1379,7 +1511,7 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 		 * page, so remember its free space as-is.  (This path will always be
 		 * taken if there are no indexes.)
 		 */
-		if (vacrelstats->num_dead_tuples == prev_dead_count)
+		if (vacrelstats->dead_tuples->num_tuples == prev_dead_count)
 			RecordPageWithFreeSpace(onerel, blkno, freespace);
 	}
 
@@ -1416,7 +1548,7 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 
 	/* If any tuples need to be deleted, perform final vacuum cycle */
 	/* XXX put a threshold on min number of tuples here? */
-	if (vacrelstats->num_dead_tuples > 0)
+	if (vacrelstats->dead_tuples->num_tuples > 0)
 	{
 		const int	hvp_index[] = {
 			PROGRESS_VACUUM_PHASE,
@@ -1432,10 +1564,8 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 									 PROGRESS_VACUUM_PHASE_VACUUM_INDEX);
 
 		/* Remove index entries */
-		for (i = 0; i < nindexes; i++)
-			lazy_vacuum_index(Irel[i],
-							  &indstats[i],
-							  vacrelstats);
+		lazy_vacuum_all_indexes(onerel, Irel, indstats, nindexes,
+								vacrelstats);
 
 		/* Report that we are now vacuuming the heap */
 		hvp_val[0] = PROGRESS_VACUUM_PHASE_VACUUM_HEAP;
@@ -1454,9 +1584,23 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 	pgstat_progress_update_param(PROGRESS_VACUUM_PHASE,
 								 PROGRESS_VACUUM_PHASE_INDEX_CLEANUP);
 
-	/* Do post-vacuum cleanup and statistics update for each index */
+	/* Do post-vacuum cleanup for each index */
+	lazy_cleanup_all_indexes(onerel, Irel, indstats, nindexes, vacrelstats);
+
+	/* Done with the TID store, and with the parallel workers */
+	lazy_space_free(vacrelstats);
+
+	/*
+	 * Update index statistics.  This must not be done in parallel mode, so
+	 * it is left until all the workers are gone.
+	 */
 	for (i = 0; i < nindexes; i++)
-		lazy_cleanup_index(Irel[i], indstats[i], vacrelstats);
+	{
+		if (indstats[i] == NULL)
+			continue;
+		lazy_update_index_stats(Irel[i], indstats[i]);
+		pfree(indstats[i]);
+	}
 
 	/* If no indexes, make log report that lazy_vacuum_heap would've made */
 	if (vacuumed_pages)
@@ -1513,16 +1657,18 @@ lazy_scan_heap(Relation onerel, int options, LVRelStats *vacrelstats,
 static void
 lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats)
 {
-	int			tupindex;
+	LVDeadTuples *dead_tuples = vacrelstats->dead_tuples;
+	int			blkindex;
+	int			ntuples;
 	int			npages;
 	PGRUsage	ru0;
 	Buffer		vmbuffer = InvalidBuffer;
 
 	pg_rusage_init(&ru0);
 	npages = 0;
+	ntuples = 0;
 
-	tupindex = 0;
-	while (tupindex < vacrelstats->num_dead_tuples)
+	for (blkindex = 0; blkindex < dead_tuples->num_blocks; blkindex++)
 	{
 		BlockNumber tblk;
 		Buffer		buf;
@@ -1531,16 +1677,15 @@ lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats)
 
 		vacuum_delay_point();
 
-		tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
+		tblk = DeadTuplesBlock(dead_tuples, blkindex)->blkno;
 		buf = ReadBufferExtended(onerel, MAIN_FORKNUM, tblk, RBM_NORMAL,
 								 vac_strategy);
 		if (!ConditionalLockBufferForCleanup(buf))
 		{
 			ReleaseBuffer(buf);
-			++tupindex;
 			continue;
 		}
-		tupindex = lazy_vacuum_page(onerel, tblk, buf, tupindex, vacrelstats,
+		ntuples += lazy_vacuum_page(onerel, tblk, buf, blkindex, vacrelstats,
 									&vmbuffer);
 
 		/* Now that we've compacted the page, record its available space */
@@ -1561,7 +1706,7 @@ lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats)
 	ereport(elevel,
 			(errmsg("\"%s\": removed %d row versions in %d pages",
 					RelationGetRelationName(onerel),
-					tupindex, npages),
+					ntuples, npages),
 			 errdetail_internal("%s", pg_rusage_show(&ru0))));
 }
 
@@ -1572,34 +1717,40 @@ lazy_vacuum_heap(Relation onerel, LVRelStats *vacrelstats)
  *
  * Caller must hold pin and buffer cleanup lock on the buffer.
  *
- * tupindex is the index in vacrelstats->dead_tuples of the first dead
- * tuple for this page.  We assume the rest follow sequentially.
- * The return value is the first tupindex after the tuples of this page.
+ * blkindex is the index of the page's entry in vacrelstats->dead_tuples.
+ * The return value is the number of dead tuples removed from the page.
  */
 static int
 lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
-				 int tupindex, LVRelStats *vacrelstats, Buffer *vmbuffer)
+				 int blkindex, LVRelStats *vacrelstats, Buffer *vmbuffer)
 {
+	LVDeadTuples *dead_tuples = vacrelstats->dead_tuples;
 	Page		page = BufferGetPage(buffer);
 	OffsetNumber unused[MaxOffsetNumber];
 	int			uncnt = 0;
+	int			tupindex;
+	int			endindex;
 	TransactionId visibility_cutoff_xid;
 	bool		all_frozen;
 
+	Assert(DeadTuplesBlock(dead_tuples, blkindex)->blkno == blkno);
+
+	tupindex = DeadTuplesBlock(dead_tuples, blkindex)->first;
+	if (blkindex + 1 < dead_tuples->num_blocks)
+		endindex = DeadTuplesBlock(dead_tuples, blkindex + 1)->first;
+	else
+		endindex = dead_tuples->num_tuples;
+
 	pgstat_progress_update_param(PROGRESS_VACUUM_HEAP_BLKS_VACUUMED, blkno);
 
 	START_CRIT_SECTION();
 
-	for (; tupindex < vacrelstats->num_dead_tuples; tupindex++)
+	for (; tupindex < endindex; tupindex++)
 	{
-		BlockNumber tblk;
 		OffsetNumber toff;
 		ItemId		itemid;
 
-		tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
-		if (tblk != blkno)
-			break;				/* past end of tuples for this block */
-		toff = ItemPointerGetOffsetNumber(&vacrelstats->dead_tuples[tupindex]);
+		toff = dead_tuples->offsets[tupindex];
 		itemid = PageGetItemId(page, toff);
 		ItemIdSetUnused(itemid);
 		unused[uncnt++] = toff;
@@ -1672,7 +1823,7 @@ lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
 							  *vmbuffer, visibility_cutoff_xid, flags);
 	}
 
-	return tupindex;
+	return uncnt;
 }
 
 /*
@@ -1728,16 +1879,67 @@ lazy_check_needs_freeze(Buffer buf, bool *hastup)
 }
 
 
+/*
+ *	lazy_vacuum_all_indexes() -- remove the index entries of the dead tuples
+ *
+ *		Uses parallel workers if lazy_scan_heap set them up.
+ */
+static void
+lazy_vacuum_all_indexes(Relation onerel, Relation *Irel,
+						IndexBulkDeleteResult **indstats, int nindexes,
+						LVRelStats *vacrelstats)
+{
+	int			i;
+
+	if (vacrelstats->lps != NULL)
+	{
+		lazy_parallel_vacuum_indexes(onerel, Irel, indstats, nindexes,
+									 vacrelstats, false);
+		return;
+	}
+
+	for (i = 0; i < nindexes; i++)
+		lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats->dead_tuples,
+						  vacrelstats->old_live_tuples);
+}
+
+/*
+ *	lazy_cleanup_all_indexes() -- do post-vacuum cleanup for all indexes
+ *
+ *		The statistics are left in indstats[], for the caller to store once
+ *		it is out of parallel mode.
+ */
+static void
+lazy_cleanup_all_indexes(Relation onerel, Relation *Irel,
+						 IndexBulkDeleteResult **indstats, int nindexes,
+						 LVRelStats *vacrelstats)
+{
+	int			i;
+
+	if (vacrelstats->lps != NULL)
+	{
+		lazy_parallel_vacuum_indexes(onerel, Irel, indstats, nindexes,
+									 vacrelstats, true);
+		return;
+	}
+
+	for (i = 0; i < nindexes; i++)
+		lazy_cleanup_index(Irel[i], &indstats[i],
+						   vacrelstats->new_rel_tuples,
+						   vacrelstats->tupcount_pages < vacrelstats->rel_pages);
+}
+
 /*
  *	lazy_vacuum_index() -- vacuum one index relation.
  *
  *		Delete all the index entries pointing to tuples listed in
- *		vacrelstats->dead_tuples, and update running statistics.
+ *		dead_tuples, and update running statistics.  reltuples is the
+ *		approximate number of tuples in the heap.
  */
 static void
 lazy_vacuum_index(Relation indrel,
 				  IndexBulkDeleteResult **stats,
-				  LVRelStats *vacrelstats)
+				  LVDeadTuples *dead_tuples, double reltuples)
 {
 	IndexVacuumInfo ivinfo;
 	PGRUsage	ru0;
@@ -1750,27 +1952,30 @@ lazy_vacuum_index(Relation indrel,
 	ivinfo.estimated_count = true;
 	ivinfo.message_level = elevel;
 	/* We can only provide an approximate value of num_heap_tuples here */
-	ivinfo.num_heap_tuples = vacrelstats->old_live_tuples;
+	ivinfo.num_heap_tuples = reltuples;
 	ivinfo.strategy = vac_strategy;
 
 	/* Do bulk deletion */
 	*stats = index_bulk_delete(&ivinfo, *stats,
-							   lazy_tid_reaped, (void *) vacrelstats);
+							   lazy_tid_reaped, (void *) dead_tuples);
 
 	ereport(elevel,
 			(errmsg("scanned index \"%s\" to remove %d row versions",
 					RelationGetRelationName(indrel),
-					vacrelstats->num_dead_tuples),
+					dead_tuples->num_tuples),
 			 errdetail_internal("%s", pg_rusage_show(&ru0))));
 }
 
 /*
  *	lazy_cleanup_index() -- do post-vacuum cleanup for one index relation.
+ *
+ *		reltuples is the number of surviving heap tuples; estimated_count
+ *		tells whether it is only an estimate.
  */
 static void
 lazy_cleanup_index(Relation indrel,
-				   IndexBulkDeleteResult *stats,
-				   LVRelStats *vacrelstats)
+				   IndexBulkDeleteResult **stats,
+				   double reltuples, bool estimated_count)
 {
 	IndexVacuumInfo ivinfo;
 	PGRUsage	ru0;
@@ -1780,7 +1985,7 @@ lazy_cleanup_index(Relation indrel,
 
 	ivinfo.index = indrel;
 	ivinfo.analyze_only = false;
-	ivinfo.estimated_count = (vacrelstats->tupcount_pages < vacrelstats->rel_pages);
+	ivinfo.estimated_count = estimated_count;
 	ivinfo.message_level = elevel;
 
 	/*
@@ -1788,17 +1993,36 @@ lazy_cleanup_index(Relation indrel,
 	 * tuples (we assume indexes are more interested in that than in the
 	 * number of nominally live tuples).
 	 */
-	ivinfo.num_heap_tuples = vacrelstats->new_rel_tuples;
+	ivinfo.num_heap_tuples = reltuples;
 	ivinfo.strategy = vac_strategy;
 
-	stats = index_vacuum_cleanup(&ivinfo, stats);
+	*stats = index_vacuum_cleanup(&ivinfo, *stats);
 
-	if (!stats)
+	if (!*stats)
 		return;
 
+	ereport(elevel,
+			(errmsg("index \"%s\" now contains %.0f row versions in %u pages",
+					RelationGetRelationName(indrel),
+					(*stats)->num_index_tuples,
+					(*stats)->num_pages),
+			 errdetail("%.0f index row versions were removed.\n"
+					   "%u index pages have been deleted, %u are currently reusable.\n"
+					   "%s.",
+					   (*stats)->tuples_removed,
+					   (*stats)->pages_deleted, (*stats)->pages_free,
+					   pg_rusage_show(&ru0))));
+}
+
+/*
+ *	lazy_update_index_stats() -- store the result of index cleanup in pg_class
+ */
+static void
+lazy_update_index_stats(Relation indrel, IndexBulkDeleteResult *stats)
+{
 	/*
-	 * Now update statistics in pg_class, but only if the index says the count
-	 * is accurate.
+	 * Update statistics in pg_class, but only if the index says the count is
+	 * accurate.
 	 */
 	if (!stats->estimated_count)
 		vac_update_relstats(indrel,
@@ -1809,20 +2033,6 @@ lazy_cleanup_index(Relation indrel,
 							InvalidTransactionId,
 							InvalidMultiXactId,
 							false);
-
-	ereport(elevel,
-			(errmsg("index \"%s\" now contains %.0f row versions in %u pages",
-					RelationGetRelationName(indrel),
-					stats->num_index_tuples,
-					stats->num_pages),
-			 errdetail("%.0f index row versions were removed.\n"
-					   "%u index pages have been deleted, %u are currently reusable.\n"
-					   "%s.",
-					   stats->tuples_removed,
-					   stats->pages_deleted, stats->pages_free,
-					   pg_rusage_show(&ru0))));
-
-	pfree(stats);
 }
 
 /*
@@ -2142,53 +2352,133 @@ count_nondeletable_pages(Relation onerel, LVRelStats *vacrelstats)
 static void
 lazy_space_alloc(LVRelStats *vacrelstats, BlockNumber relblocks)
 {
-	long		maxtuples;
+	LVParallelState *lps = vacrelstats->lps;
+	LVDeadTuples *dead_tuples = NULL;
+	Size		maxbytes;
 	int			vac_work_mem = IsAutoVacuumWorkerProcess() &&
 	autovacuum_work_mem != -1 ?
 	autovacuum_work_mem : maintenance_work_mem;
 
 	if (vacrelstats->hasindex)
 	{
-		maxtuples = (vac_work_mem * 1024L) / sizeof(ItemPointerData);
-		maxtuples = Min(maxtuples, INT_MAX);
-		maxtuples = Min(maxtuples, MaxAllocSize / sizeof(ItemPointerData));
+		maxbytes = vac_work_mem * 1024L;
+		maxbytes = Min(maxbytes, MaxAllocSize - SizeOfDeadTuples(0));
 
 		/* curious coding here to ensure the multiplication can't overflow */
-		if ((BlockNumber) (maxtuples / LAZY_ALLOC_TUPLES) > relblocks)
-			maxtuples = relblocks * LAZY_ALLOC_TUPLES;
+		if ((BlockNumber) (maxbytes / DEAD_TUPLES_PAGE_SPACE) > relblocks)
+			maxbytes = relblocks * DEAD_TUPLES_PAGE_SPACE;
+
+		/* block entries are stored at the end, so keep them aligned */
+		maxbytes = TYPEALIGN_DOWN(sizeof(LVDeadBlock), maxbytes);
 
 		/* stay sane if small maintenance_work_mem */
-		maxtuples = Max(maxtuples, MaxHeapTuplesPerPage);
+		maxbytes = Max(maxbytes,
+					   TYPEALIGN(sizeof(LVDeadBlock), DEAD_TUPLES_PAGE_SPACE));
 	}
 	else
 	{
-		maxtuples = MaxHeapTuplesPerPage;
+		maxbytes = TYPEALIGN(sizeof(LVDeadBlock), DEAD_TUPLES_PAGE_SPACE);
+	}
+
+	if (lps != NULL)
+	{
+		lps->dead_tuples_seg = dsm_create(SizeOfDeadTuples(maxbytes),
+										  DSM_CREATE_NULL_IF_MAXSEGMENTS);
+		if (lps->dead_tuples_seg != NULL)
+			dead_tuples = (LVDeadTuples *)
+				dsm_segment_address(lps->dead_tuples_seg);
+		else
+		{
+			/* out of DSM segments, vacuum the indexes serially */
+			pfree(lps->can_parallel);
+			pfree(lps);
+			vacrelstats->lps = NULL;
+		}
+	}
+	if (dead_tuples == NULL)
+		dead_tuples = (LVDeadTuples *) palloc(SizeOfDeadTuples(maxbytes));
+
+	dead_tuples->max_bytes = maxbytes;
+	dead_tuples->num_tuples = 0;
+	dead_tuples->num_blocks = 0;
+	vacrelstats->dead_tuples = dead_tuples;
+}
+
+/*
+ * lazy_space_free - release the TID store and the parallel vacuum state
+ */
+static void
+lazy_space_free(LVRelStats *vacrelstats)
+{
+	LVParallelState *lps = vacrelstats->lps;
+
+	if (lps != NULL)
+	{
+		dsm_detach(lps->dead_tuples_seg);
+		pfree(lps->can_parallel);
+		pfree(lps);
+		vacrelstats->lps = NULL;
 	}
+	else
+		pfree(vacrelstats->dead_tuples);
+	vacrelstats->dead_tuples = NULL;
+}
 
-	vacrelstats->num_dead_tuples = 0;
-	vacrelstats->max_dead_tuples = (int) maxtuples;
-	vacrelstats->dead_tuples = (ItemPointer)
-		palloc(maxtuples * sizeof(ItemPointerData));
+/*
+ * lazy_dead_tuples_full - is there too little room left in the TID store
+ * for the dead tuples of another heap page?
+ */
+static bool
+lazy_dead_tuples_full(LVRelStats *vacrelstats)
+{
+	LVDeadTuples *dead_tuples = vacrelstats->dead_tuples;
+
+	return dead_tuples->max_bytes - DeadTuplesUsedBytes(dead_tuples) <
+		DEAD_TUPLES_PAGE_SPACE;
 }
 
 /*
  * lazy_record_dead_tuple - remember one deletable tuple
+ *
+ * Tuples must be recorded in TID order.
  */
 static void
 lazy_record_dead_tuple(LVRelStats *vacrelstats,
 					   ItemPointer itemptr)
 {
+	LVDeadTuples *dead_tuples = vacrelstats->dead_tuples;
+	BlockNumber blkno = ItemPointerGetBlockNumber(itemptr);
+	bool		newblock;
+	Size		needed;
+
+	newblock = (dead_tuples->num_blocks == 0 ||
+				DeadTuplesBlock(dead_tuples,
+								dead_tuples->num_blocks - 1)->blkno != blkno);
+	needed = sizeof(OffsetNumber);
+	if (newblock)
+		needed += sizeof(LVDeadBlock);
+
 	/*
-	 * The array shouldn't overflow under normal behavior, but perhaps it
+	 * The store shouldn't overflow under normal behavior, but perhaps it
 	 * could if we are given a really small maintenance_work_mem. In that
 	 * case, just forget the last few tuples (we'll get 'em next time).
 	 */
-	if (vacrelstats->num_dead_tuples < vacrelstats->max_dead_tuples)
+	if (DeadTuplesUsedBytes(dead_tuples) + needed <= dead_tuples->max_bytes)
 	{
-		vacrelstats->dead_tuples[vacrelstats->num_dead_tuples] = *itemptr;
-		vacrelstats->num_dead_tuples++;
+		if (newblock)
+		{
+			LVDeadBlock *block = DeadTuplesBlock(dead_tuples,
+												 dead_tuples->num_blocks);
+
+			block->blkno = blkno;
+			block->first = dead_tuples->num_tuples;
+			dead_tuples->num_blocks++;
+		}
+		dead_tuples->offsets[dead_tuples->num_tuples] =
+			ItemPointerGetOffsetNumber(itemptr);
+		dead_tuples->num_tuples++;
 		pgstat_progress_update_param(PROGRESS_VACUUM_NUM_DEAD_TUPLES,
-									 vacrelstats->num_dead_tuples);
+									 dead_tuples->num_tuples);
 	}
 }
 
@@ -2196,52 +2486,388 @@ lazy_record_dead_tuple(LVRelStats *vacrelstats,
  *	lazy_tid_reaped() -- is a particular tid deletable?
  *
  *		This has the right signature to be an IndexBulkDeleteCallback.
- *
- *		Assumes dead_tuples array is in sorted order.
+ *		state is the LVDeadTuples to look in.
  */
 static bool
 lazy_tid_reaped(ItemPointer itemptr, void *state)
 {
-	LVRelStats *vacrelstats = (LVRelStats *) state;
-	ItemPointer res;
+	LVDeadTuples *dead_tuples = (LVDeadTuples *) state;
+	BlockNumber blkno = ItemPointerGetBlockNumber(itemptr);
+	OffsetNumber offnum = ItemPointerGetOffsetNumber(itemptr);
+	int			low,
+				high;
+	int			blkindex;
+
+	if (dead_tuples->num_blocks == 0)
+		return false;
+
+	/* quick exit for TIDs outside the range of dead tuples */
+	if (blkno < DeadTuplesBlock(dead_tuples, 0)->blkno ||
+		blkno > DeadTuplesBlock(dead_tuples, dead_tuples->num_blocks - 1)->blkno)
+		return false;
+
+	/* binary search for the block */
+	low = 0;
+	high = dead_tuples->num_blocks - 1;
+	blkindex = -1;
+	while (low <= high)
+	{
+		int			mid = low + (high - low) / 2;
+		BlockNumber midblk = DeadTuplesBlock(dead_tuples, mid)->blkno;
+
+		if (midblk == blkno)
+		{
+			blkindex = mid;
+			break;
+		}
+		if (midblk < blkno)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+	if (blkindex < 0)
+		return false;
 
-	res = (ItemPointer) bsearch((void *) itemptr,
-								(void *) vacrelstats->dead_tuples,
-								vacrelstats->num_dead_tuples,
-								sizeof(ItemPointerData),
-								vac_cmp_itemptr);
+	/* then for the offset, among the offsets of that block */
+	low = DeadTuplesBlock(dead_tuples, blkindex)->first;
+	if (blkindex + 1 < dead_tuples->num_blocks)
+		high = DeadTuplesBlock(dead_tuples, blkindex + 1)->first - 1;
+	else
+		high = dead_tuples->num_tuples - 1;
+	while (low <= high)
+	{
+		int			mid = low + (high - low) / 2;
+		OffsetNumber midoff = dead_tuples->offsets[mid];
+
+		if (midoff == offnum)
+			return true;
+		if (midoff < offnum)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
 
-	return (res != NULL);
+	return false;
 }
 
 /*
- * Comparator routines for use with qsort() and bsearch().
+ * Is the index AM known to cope with bulk deletion and cleanup in a parallel
+ * worker?  Indexes of other AMs are vacuumed by the leader.
  */
-static int
-vac_cmp_itemptr(const void *left, const void *right)
+static bool
+index_am_parallel_vacuum_safe(Oid relam)
 {
-	BlockNumber lblk,
-				rblk;
-	OffsetNumber loff,
-				roff;
+	switch (relam)
+	{
+		case BTREE_AM_OID:
+		case HASH_AM_OID:
+		case GIST_AM_OID:
+		case GIN_AM_OID:
+		case SPGIST_AM_OID:
+		case BRIN_AM_OID:
+			return true;
+		default:
+			return false;
+	}
+}
 
-	lblk = ItemPointerGetBlockNumber((ItemPointer) left);
-	rblk = ItemPointerGetBlockNumber((ItemPointer) right);
+/*
+ * begin_parallel_vacuum - decide whether to vacuum the indexes in parallel
+ *
+ * Only indexes of at least min_parallel_index_scan_size are worth giving to
+ * a worker.  The leader takes part, so we ask for one worker fewer than the
+ * number of such indexes.  Returns NULL if no workers are to be used.
+ */
+static LVParallelState *
+begin_parallel_vacuum(Relation onerel, Relation *Irel, int nindexes)
+{
+	LVParallelState *lps;
+	bool	   *can_parallel;
+	int			nindexes_parallel = 0;
+	int			nworkers;
+	int			i;
 
-	if (lblk < rblk)
-		return -1;
-	if (lblk > rblk)
-		return 1;
+	/*
+	 * Autovacuum is meant to be unobtrusive, and the workers cannot see the
+	 * leader's temporary tables.
+	 */
+	if (max_parallel_maintenance_workers == 0 || nindexes < 2 ||
+		IsAutoVacuumWorkerProcess() || RELATION_IS_TEMP(onerel) ||
+		IsInParallelMode() ||
+		dynamic_shared_memory_type == DSM_IMPL_NONE)
+		return NULL;
 
-	loff = ItemPointerGetOffsetNumber((ItemPointer) left);
-	roff = ItemPointerGetOffsetNumber((ItemPointer) right);
+	can_parallel = (bool *) palloc0(nindexes * sizeof(bool));
+	for (i = 0; i < nindexes; i++)
+	{
+		Relation	indrel = Irel[i];
 
-	if (loff < roff)
-		return -1;
-	if (loff > roff)
-		return 1;
+		if (RelationIsCrossNodeIndex(indrel->rd_rel) ||
+			!index_am_parallel_vacuum_safe(indrel->rd_rel->relam) ||
+			RelationGetNumberOfBlocks(indrel) < min_parallel_index_scan_size)
+			continue;
 
-	return 0;
+		can_parallel[i] = true;
+		nindexes_parallel++;
+	}
+
+	nworkers = Min(nindexes_parallel - 1, max_parallel_maintenance_workers);
+	if (nworkers <= 0)
+	{
+		pfree(can_parallel);
+		return NULL;
+	}
+
+	lps = (LVParallelState *) palloc0(sizeof(LVParallelState));
+	lps->nworkers = nworkers;
+	lps->can_parallel = can_parallel;
+
+	return lps;
+}
+
+/*
+ * lazy_parallel_vacuum_indexes - one parallel pass over the indexes
+ *
+ * Bulk-deletes, or if for_cleanup cleans up, all the indexes with the help
+ * of parallel workers.  The workers are launched afresh for every pass, so
+ * that the heap is scanned and vacuumed outside of parallel mode.  Indexes
+ * the workers may not process are done by the leader.
+ */
+static void
+lazy_parallel_vacuum_indexes(Relation onerel, Relation *Irel,
+							 IndexBulkDeleteResult **indstats, int nindexes,
+							 LVRelStats *vacrelstats, bool for_cleanup)
+{
+	LVParallelState *lps = vacrelstats->lps;
+	ParallelContext *pcxt;
+	LVShared   *shared;
+	Size		est_shared;
+	int			i;
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("postgres", "parallel_vacuum_main",
+								 lps->nworkers);
+
+	est_shared = add_size(offsetof(LVShared, indstats),
+						  mul_size(sizeof(LVSharedIndStats), nindexes));
+	shm_toc_estimate_chunk(&pcxt->estimator, est_shared);
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	InitializeParallelDSM(pcxt);
+
+	shared = (LVShared *) shm_toc_allocate(pcxt->toc, est_shared);
+	MemSet(shared, 0, est_shared);
+	shared->relid = RelationGetRelid(onerel);
+	shared->elevel = elevel;
+	shared->for_cleanup = for_cleanup;
+	if (for_cleanup)
+	{
+		shared->reltuples = vacrelstats->new_rel_tuples;
+		shared->estimated_count =
+			(vacrelstats->tupcount_pages < vacrelstats->rel_pages);
+	}
+	else
+	{
+		shared->reltuples = vacrelstats->old_live_tuples;
+		shared->estimated_count = true;
+	}
+	shared->dead_tuples_handle = dsm_segment_handle(lps->dead_tuples_seg);
+	pg_atomic_init_u32(&shared->cost_balance, VacuumCostBalance);
+	pg_atomic_init_u32(&shared->active_nworkers, 0);
+	pg_atomic_init_u32(&shared->nextidx, 0);
+	shared->nindexes = nindexes;
+	for (i = 0; i < nindexes; i++)
+	{
+		LVSharedIndStats *sstats = &shared->indstats[i];
+
+		sstats->parallel_safe = lps->can_parallel[i];
+		if (sstats->parallel_safe && indstats[i] != NULL)
+		{
+			memcpy(&sstats->stats, indstats[i], sizeof(IndexBulkDeleteResult));
+			sstats->updated = true;
+		}
+	}
+	shm_toc_insert(pcxt->toc, PARALLEL_VACUUM_KEY_SHARED, shared);
+
+	LaunchParallelWorkers(pcxt, false);
+
+	ereport(elevel,
+			(errmsg(for_cleanup ?
+					"launched %d parallel vacuum workers for index cleanup (planned: %d)" :
+					"launched %d parallel vacuum workers for index vacuuming (planned: %d)",
+					pcxt->nworkers_launched, pcxt->nworkers)));
+
+	/* From now on, our cost-based delay balance is shared with the workers */
+	if (pcxt->nworkers_launched > 0)
+	{
+		VacuumSharedCostBalance = &shared->cost_balance;
+		VacuumActiveNWorkers = &shared->active_nworkers;
+		VacuumCostBalance = 0;
+		VacuumCostBalanceLocal = 0;
+	}
+
+	/* Take part in the work, then do the indexes the workers can't do */
+	parallel_vacuum_indexes(Irel, nindexes, shared, vacrelstats->dead_tuples);
+	for (i = 0; i < nindexes; i++)
+	{
+		if (lps->can_parallel[i])
+			continue;
+
+		/* Count ourselves in while we share the cost balance */
+		if (VacuumActiveNWorkers != NULL)
+			pg_atomic_add_fetch_u32(VacuumActiveNWorkers, 1);
+
+		if (for_cleanup)
+			lazy_cleanup_index(Irel[i], &indstats[i], shared->reltuples,
+							   shared->estimated_count);
+		else
+			lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats->dead_tuples,
+							  shared->reltuples);
+
+		if (VacuumActiveNWorkers != NULL)
+			pg_atomic_sub_fetch_u32(VacuumActiveNWorkers, 1);
+	}
+
+	WaitForParallelWorkersToFinish(pcxt);
+
+	if (VacuumSharedCostBalance != NULL)
+	{
+		VacuumCostBalance = pg_atomic_read_u32(VacuumSharedCostBalance);
+		VacuumSharedCostBalance = NULL;
+		VacuumActiveNWorkers = NULL;
+		VacuumCostBalanceLocal = 0;
+	}
+
+	/* Bring the results of the parallel indexes back into local memory */
+	for (i = 0; i < nindexes; i++)
+	{
+		LVSharedIndStats *sstats = &shared->indstats[i];
+
+		if (!sstats->parallel_safe)
+			continue;
+
+		if (!sstats->updated)
+		{
+			if (indstats[i] != NULL)
+				pfree(indstats[i]);
+			indstats[i] = NULL;
+			continue;
+		}
+		if (indstats[i] == NULL)
+			indstats[i] = (IndexBulkDeleteResult *)
+				palloc(sizeof(IndexBulkDeleteResult));
+		memcpy(indstats[i], &sstats->stats, sizeof(IndexBulkDeleteResult));
+	}
+
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+}
+
+/*
+ * parallel_vacuum_indexes - process indexes until there are none left
+ *
+ * Called by the leader and by each worker.  Indexes are claimed one at a
+ * time; their results are kept in the shared state.
+ */
+static void
+parallel_vacuum_indexes(Relation *Irel, int nindexes,
+						LVShared *shared, LVDeadTuples *dead_tuples)
+{
+	for (;;)
+	{
+		int			idx;
+		LVSharedIndStats *sstats;
+		IndexBulkDeleteResult *stats;
+
+		idx = pg_atomic_fetch_add_u32(&shared->nextidx, 1);
+		if (idx >= nindexes)
+			break;
+
+		sstats = &shared->indstats[idx];
+		if (!sstats->parallel_safe)
+			continue;
+
+		stats = sstats->updated ? &sstats->stats : NULL;
+
+		if (VacuumActiveNWorkers != NULL)
+			pg_atomic_add_fetch_u32(VacuumActiveNWorkers, 1);
+
+		if (shared->for_cleanup)
+			lazy_cleanup_index(Irel[idx], &stats, shared->reltuples,
+							   shared->estimated_count);
+		else
+			lazy_vacuum_index(Irel[idx], &stats, dead_tuples,
+							  shared->reltuples);
+
+		if (VacuumActiveNWorkers != NULL)
+			pg_atomic_sub_fetch_u32(VacuumActiveNWorkers, 1);
+
+		/*
+		 * The AM may have updated the shared result in place, or returned a
+		 * new one in local memory.
+		 */
+		if (stats == NULL)
+			sstats->updated = false;
+		else if (stats != &sstats->stats)
+		{
+			memcpy(&sstats->stats, stats, sizeof(IndexBulkDeleteResult));
+			sstats->updated = true;
+			pfree(stats);
+		}
+	}
+}
+
+/*
+ * parallel_vacuum_main - entry point of a parallel vacuum worker
+ *
+ * The worker opens the relation and its indexes with the same lock modes as
+ * the leader; the lock group makes them compatible.
+ */
+void
+parallel_vacuum_main(dsm_segment *seg, shm_toc *toc)
+{
+	LVShared   *shared;
+	dsm_segment *dead_tuples_seg;
+	LVDeadTuples *dead_tuples;
+	Relation	onerel;
+	Relation   *Irel;
+	int			nindexes;
+
+	shared = (LVShared *) shm_toc_lookup(toc, PARALLEL_VACUUM_KEY_SHARED,
+										 false);
+	elevel = shared->elevel;
+
+	onerel = heap_open(shared->relid, ShareUpdateExclusiveLock);
+	vac_open_indexes(onerel, RowExclusiveLock, &nindexes, &Irel);
+	if (nindexes != shared->nindexes)
+		elog(ERROR, "parallel vacuum found %d indexes on relation \"%s\", expected %d",
+			 nindexes, RelationGetRelationName(onerel), shared->nindexes);
+
+	dead_tuples_seg = dsm_attach(shared->dead_tuples_handle);
+	if (dead_tuples_seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+	dead_tuples = (LVDeadTuples *) dsm_segment_address(dead_tuples_seg);
+
+	/* Join the leader's cost-based delay */
+	VacuumCostActive = (VacuumCostDelay > 0);
+	VacuumCostBalance = 0;
+	VacuumSharedCostBalance = &shared->cost_balance;
+	VacuumActiveNWorkers = &shared->active_nworkers;
+
+	vac_strategy = GetAccessStrategy(BAS_VACUUM);
+
+	parallel_vacuum_indexes(Irel, nindexes, shared, dead_tuples);
+
+	VacuumSharedCostBalance = NULL;
+	VacuumActiveNWorkers = NULL;
+
+	FreeAccessStrategy(vac_strategy);
+	vac_strategy = NULL;
+	dsm_detach(dead_tuples_seg);
+	vac_close_indexes(nindexes, Irel, RowExclusiveLock);
+	heap_close(onerel, ShareUpdateExclusiveLock);
 }
 
 /*
@@ -2437,19 +3063,23 @@ truncate_extent_tuples(Relation onerel,
 	for(blkno = from_blk; blkno < to_blk; blkno++)
 	{
 
-		if(vacrelstats->dead_tuples > 0 && 
-			(vacrelstats->max_dead_tuples - vacrelstats->num_dead_tuples) < MaxHeapTuplesPerPage)
+		if(vacrelstats->dead_tuples->num_tuples > 0 && 
+			lazy_dead_tuples_full(vacrelstats))
 		{
 			/* Remove index entries */
 			int i=0;
 
 			if(deleted_tuples)
-				*deleted_tuples += vacrelstats->num_dead_tuples;
+				*deleted_tuples += vacrelstats->dead_tuples->num_tuples;
 			
 			for (i = 0; i < nindexes; i++)
 				lazy_vacuum_index(Irel[i],
 								  &indstats[i],
-								  vacrelstats);
+								  vacrelstats->dead_tuples,
+								  vacrelstats->old_live_tuples);
+
+			vacrelstats->dead_tuples->num_tuples = 0;
+			vacrelstats->dead_tuples->num_blocks = 0;
 		}
 		
 		buf = ReadBufferExtended(onerel, MAIN_FORKNUM, blkno,
@@ -2499,18 +3129,19 @@ truncate_extent_tuples(Relation onerel,
 	/*
 	 * remove last iterator
 	 */
-	if(vacrelstats->dead_tuples > 0)
+	if(vacrelstats->dead_tuples->num_tuples > 0)
 	{
 		/* Remove index entries */
 		int i=0;
 		
 		if(deleted_tuples)
-			*deleted_tuples += vacrelstats->num_dead_tuples;
+			*deleted_tuples += vacrelstats->dead_tuples->num_tuples;
 
 		for (i = 0; i < nindexes; i++)
 			lazy_vacuum_index(Irel[i],
 							  &indstats[i],
-							  vacrelstats);
+							  vacrelstats->dead_tuples,
+							  vacrelstats->old_live_tuples);
 	}
 
 	/* clean page */
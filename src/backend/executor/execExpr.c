@@ -1342,6 +1342,25 @@ ExecInitExprRec(Expr *node, ExprState *state,
 				 */
 				ExecInitExprRec(arrayarg, state, resv, resnull);
 
+				/*
+				 * If hashfuncid is set, we create a EEOP_HASHED_SCALARARRAYOP
+				 * step instead of a EEOP_SCALARARRAYOP.  This provides much
+				 * faster lookup performance than the normal linear search
+				 * when the number of items in the array is anything but very
+				 * small.  The hash table itself is built on first use.
+				 */
+				if (OidIsValid(opexpr->hashfuncid))
+				{
+					scratch.opcode = EEOP_HASHED_SCALARARRAYOP;
+					scratch.d.hashedscalararrayop.has_nulls = false;
+					scratch.d.hashedscalararrayop.elements_tab = NULL;
+					scratch.d.hashedscalararrayop.finfo = finfo;
+					scratch.d.hashedscalararrayop.fcinfo_data = fcinfo;
+					scratch.d.hashedscalararrayop.saop = opexpr;
+					ExprEvalPushStep(state, &scratch);
+					break;
+				}
+
 				/* And perform the operation */
 				scratch.opcode = EEOP_SCALARARRAYOP;
 				scratch.d.scalararrayop.element_type = InvalidOid;
@@ -407,6 +407,7 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 		&&CASE_EEOP_DOMAIN_CHECK,
 		&&CASE_EEOP_CONVERT_ROWTYPE,
 		&&CASE_EEOP_SCALARARRAYOP,
+		&&CASE_EEOP_HASHED_SCALARARRAYOP,
 		&&CASE_EEOP_XMLEXPR,
 		&&CASE_EEOP_AGGREF,
 		&&CASE_EEOP_GROUPING_FUNC,
@@ -1553,6 +1554,14 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 			EEO_NEXT();
 		}
 
+		EEO_CASE(EEOP_HASHED_SCALARARRAYOP)
+		{
+			/* too complex for an inline implementation */
+			ExecEvalHashedScalarArrayOp(state, op, econtext);
+
+			EEO_NEXT();
+		}
+
 		EEO_CASE(EEOP_DOMAIN_NOTNULL)
 		{
 			/* too complex for an inline implementation */
@@ -3817,6 +3826,306 @@ ExecEvalScalarArrayOp(ExprState *state, ExprEvalStep *op)
 	*op->resnull = resultnull;
 }
 
+/*
+ * Hashing for ScalarArrayOpExpr
+ */
+typedef struct ScalarArrayOpExprHashEntry
+{
+	Datum		key;
+	uint32		status;			/* hash status */
+	uint32		hash;			/* hash value (cached) */
+} ScalarArrayOpExprHashEntry;
+
+/*
+ * ScalarArrayOpExprHashTable
+ *		Hash table for EEOP_HASHED_SCALARARRAYOP
+ */
+typedef struct ScalarArrayOpExprHashTable
+{
+	struct saophash_hash *hashtab;	/* underlying hash table */
+	struct ExprEvalStep *op;
+	ArrayType  *source;			/* copy of a Param array, NULL for a Const */
+	ParamListInfo params;		/* parameter list source was taken from */
+	Datum		value;			/* datum source was taken from */
+	FmgrInfo	hash_finfo;		/* function's lookup data */
+	FunctionCallInfoData hash_fcinfo_data;	/* arguments etc */
+} ScalarArrayOpExprHashTable;
+
+static uint32 saop_element_hash(struct saophash_hash *tb, Datum key);
+static bool saop_hash_element_match(struct saophash_hash *tb, Datum key1,
+						Datum key2);
+
+/* Define parameters for ScalarArrayOpExpr hash table code generation. */
+#define SH_PREFIX saophash
+#define SH_ELEMENT_TYPE ScalarArrayOpExprHashEntry
+#define SH_KEY_TYPE Datum
+#define SH_KEY key
+#define SH_HASH_KEY(tb, key) saop_element_hash(tb, key)
+#define SH_EQUAL(tb, a, b) saop_hash_element_match(tb, a, b)
+#define SH_SCOPE static inline
+#define SH_STORE_HASH
+#define SH_GET_HASH(tb, a) a->hash
+#define SH_DECLARE
+#define SH_DEFINE
+#include "lib/simplehash.h"
+
+static uint32
+saop_element_hash(struct saophash_hash *tb, Datum key)
+{
+	ScalarArrayOpExprHashTable *elements_tab = (ScalarArrayOpExprHashTable *) tb->private_data;
+	FunctionCallInfo fcinfo = &elements_tab->hash_fcinfo_data;
+	Datum		hash;
+
+	fcinfo->arg[0] = key;
+	fcinfo->argnull[0] = false;
+	fcinfo->isnull = false;
+
+	hash = elements_tab->hash_finfo.fn_addr(fcinfo);
+
+	return DatumGetUInt32(hash);
+}
+
+/*
+ * saop_hash_element_match
+ *		Compare 2 elements with the equality function of the
+ *		ScalarArrayOpExpr.
+ */
+static bool
+saop_hash_element_match(struct saophash_hash *tb, Datum key1, Datum key2)
+{
+	Datum		result;
+	ScalarArrayOpExprHashTable *elements_tab = (ScalarArrayOpExprHashTable *) tb->private_data;
+	FunctionCallInfo fcinfo = elements_tab->op->d.hashedscalararrayop.fcinfo_data;
+
+	fcinfo->arg[0] = key1;
+	fcinfo->argnull[0] = false;
+	fcinfo->arg[1] = key2;
+	fcinfo->argnull[1] = false;
+	fcinfo->isnull = false;
+
+	result = elements_tab->op->d.hashedscalararrayop.finfo->fn_addr(fcinfo);
+
+	return DatumGetBool(result);
+}
+
+/*
+ * Evaluate "scalar op ANY (array)" with a hash table lookup instead of
+ * the linear search done by ExecEvalScalarArrayOp.
+ *
+ * Source array is in our result area, scalar arg is already evaluated into
+ * fcinfo->arg[0]/argnull[0].
+ *
+ * The hash table is built on the first call, from the array's non-NULL
+ * elements, and lives in per-query memory.  The planner only sets up a
+ * hashed ScalarArrayOpExpr for a Const or an external Param array; the
+ * latter may be re-bound while this ExprState is kept (plpgsql simple
+ * expressions), so for it we keep a copy of the array and rebuild the table
+ * whenever the value we are handed differs.  Comparing the arrays is only
+ * needed when the parameter list or the datum changed, or when the list has
+ * a fetch hook and so may hand out new values under the same pointer.
+ */
+void
+ExecEvalHashedScalarArrayOp(ExprState *state, ExprEvalStep *op,
+							ExprContext *econtext)
+{
+	ScalarArrayOpExprHashTable *elements_tab = op->d.hashedscalararrayop.elements_tab;
+	FunctionCallInfo fcinfo = op->d.hashedscalararrayop.fcinfo_data;
+	bool		strictfunc = op->d.hashedscalararrayop.finfo->fn_strict;
+	Datum		scalar = fcinfo->arg[0];
+	bool		scalar_isnull = fcinfo->argnull[0];
+	Datum		result;
+	bool		resultnull;
+	bool		hashfound;
+
+	/* If the array is NULL then we return NULL */
+	if (*op->resnull)
+		return;
+
+	/*
+	 * If the scalar is NULL, and the function is strict, return NULL; no
+	 * point in executing the search.
+	 */
+	if (scalar_isnull && strictfunc)
+	{
+		*op->resnull = true;
+		return;
+	}
+
+	/* Throw away a table built from an earlier value of a Param array */
+	if (elements_tab != NULL && elements_tab->source != NULL &&
+		(econtext->ecxt_param_list_info == NULL ||
+		 econtext->ecxt_param_list_info != elements_tab->params ||
+		 econtext->ecxt_param_list_info->paramFetch != NULL ||
+		 *op->resvalue != elements_tab->value))
+	{
+		ArrayType  *arr = DatumGetArrayTypeP(*op->resvalue);
+
+		if (VARSIZE(arr) != VARSIZE(elements_tab->source) ||
+			memcmp(arr, elements_tab->source, VARSIZE(arr)) != 0)
+		{
+			saophash_destroy(elements_tab->hashtab);
+			pfree(elements_tab->source);
+			pfree(elements_tab);
+			elements_tab = NULL;
+			op->d.hashedscalararrayop.elements_tab = NULL;
+		}
+		else
+		{
+			elements_tab->params = econtext->ecxt_param_list_info;
+			elements_tab->value = *op->resvalue;
+		}
+	}
+
+	/* Build the hash table on first evaluation */
+	if (elements_tab == NULL)
+	{
+		ScalarArrayOpExpr *saop = op->d.hashedscalararrayop.saop;
+		int16		typlen;
+		bool		typbyval;
+		char		typalign;
+		int			nitems;
+		int			i;
+		bool		has_nulls = false;
+		char	   *s;
+		bits8	   *bitmap;
+		int			bitmask;
+		MemoryContext oldcontext;
+		ArrayType  *arr;
+
+		/* The elements must outlive the current tuple, so detoast here too */
+		oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_query_memory);
+
+		if (IsA(lsecond(saop->args), Const))
+			arr = DatumGetArrayTypeP(*op->resvalue);
+		else
+			arr = DatumGetArrayTypePCopy(*op->resvalue);
+		nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+
+		get_typlenbyvalalign(ARR_ELEMTYPE(arr),
+							 &typlen,
+							 &typbyval,
+							 &typalign);
+
+		elements_tab = (ScalarArrayOpExprHashTable *)
+			palloc0(sizeof(ScalarArrayOpExprHashTable));
+		op->d.hashedscalararrayop.elements_tab = elements_tab;
+		elements_tab->op = op;
+		if (!IsA(lsecond(saop->args), Const))
+		{
+			elements_tab->source = arr;
+			elements_tab->params = econtext->ecxt_param_list_info;
+			elements_tab->value = *op->resvalue;
+		}
+
+		fmgr_info(saop->hashfuncid, &elements_tab->hash_finfo);
+		fmgr_info_set_expr((Node *) saop, &elements_tab->hash_finfo);
+
+		InitFunctionCallInfoData(elements_tab->hash_fcinfo_data,
+								 &elements_tab->hash_finfo,
+								 1,
+								 saop->inputcollid,
+								 NULL,
+								 NULL);
+
+		/*
+		 * Create the hash table sizing it according to the number of
+		 * elements in the array.  This does assume that the array has no
+		 * duplicates.  If the array happens to contain many duplicate values
+		 * then it'll just mean that we sized the table a bit on the large
+		 * side.
+		 */
+		elements_tab->hashtab = saophash_create(CurrentMemoryContext, nitems,
+												elements_tab);
+
+		MemoryContextSwitchTo(oldcontext);
+
+		s = (char *) ARR_DATA_PTR(arr);
+		bitmap = ARR_NULLBITMAP(arr);
+		bitmask = 1;
+		for (i = 0; i < nitems; i++)
+		{
+			/* Get array element, checking for NULL. */
+			if (bitmap && (*bitmap & bitmask) == 0)
+			{
+				has_nulls = true;
+			}
+			else
+			{
+				Datum		element;
+
+				element = fetch_att(s, typbyval, typlen);
+				s = att_addlength_pointer(s, typlen, s);
+				s = (char *) att_align_nominal(s, typalign);
+
+				saophash_insert(elements_tab->hashtab, element, &hashfound);
+			}
+
+			/* Advance bitmap pointer if any. */
+			if (bitmap)
+			{
+				bitmask <<= 1;
+				if (bitmask == 0x100)
+				{
+					bitmap++;
+					bitmask = 1;
+				}
+			}
+		}
+
+		/*
+		 * Remember if we had any nulls so that we know if we need to execute
+		 * non-strict functions with a null lhs value if no match is found.
+		 */
+		op->d.hashedscalararrayop.has_nulls = has_nulls;
+	}
+
+	/* Check the hash to see if we have a match. */
+	hashfound = NULL != saophash_lookup(elements_tab->hashtab, scalar);
+
+	result = BoolGetDatum(hashfound);
+	resultnull = false;
+
+	/*
+	 * If we didn't find a match in the array, we still might need to handle
+	 * the possibility of null values.  We didn't put any NULLs into the
+	 * hashtable, but instead marked if we found any when building the table
+	 * in has_nulls.
+	 */
+	if (!hashfound && op->d.hashedscalararrayop.has_nulls)
+	{
+		if (strictfunc)
+		{
+			/*
+			 * We have nulls in the array so a non-null lhs and no match must
+			 * yield NULL.
+			 */
+			result = (Datum) 0;
+			resultnull = true;
+		}
+		else
+		{
+			/*
+			 * Execute function will null rhs just once.
+			 *
+			 * The hash lookup path will have scribbled on the lhs argument so
+			 * we need to set it up also (even though we entered this function
+			 * with it already set).
+			 */
+			fcinfo->arg[0] = scalar;
+			fcinfo->argnull[0] = scalar_isnull;
+			fcinfo->arg[1] = (Datum) 0;
+			fcinfo->argnull[1] = true;
+			fcinfo->isnull = false;
+
+			result = op->d.hashedscalararrayop.finfo->fn_addr(fcinfo);
+			resultnull = fcinfo->isnull;
+		}
+	}
+
+	*op->resvalue = result;
+	*op->resnull = resultnull;
+}
+
 
 /*
  * Evaluate a NOT NULL domain constraint.
@@ -54,6 +54,7 @@
 #include "pgxc/execRemote.h"
 #include "storage/lmgr.h"
 #include "utils/builtins.h"
+#include "utils/memgrant.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/typcache.h"
@@ -187,6 +188,7 @@ CreateExecutorState(void)
 	estate->es_rc_total_memory = 0;
 	estate->es_rc_hash_table = NULL;
 	estate->es_rc_explained = false;
+	estate->es_memgrant_pool = NULL;
 	INSTR_TIME_SET_CURRENT(estate->executor_starttime);
 #ifdef __OPENTENBASE_C__
 	estate->es_leader_handle = NULL;
@@ -467,6 +469,35 @@ ExecAssignExprContext(EState *estate, PlanState *planstate)
 	planstate->ps_ExprContext = CreateExprContext(estate);
 }
 
+/* ----------------
+ *		ExecRegisterMemGrant
+ *
+ *		Register a memory intensive node with 'nominal' bytes of budget in
+ *		the query's memory grant pool.  Returns NULL if run-time memory
+ *		rebalancing is disabled, in which case the node just sticks to its
+ *		static budget.
+ * ----------------
+ */
+MemGrant *
+ExecRegisterMemGrant(PlanState *planstate, int64 nominal)
+{
+	EState	   *estate = planstate->state;
+	MemoryContext oldcontext;
+	MemGrant   *grant;
+
+	if (!enable_memory_rebalance)
+		return NULL;
+
+	oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+	if (estate->es_memgrant_pool == NULL)
+		estate->es_memgrant_pool = MemGrantPoolCreate();
+	grant = MemGrantRegister(estate->es_memgrant_pool,
+							 planstate->plan->plan_node_id, nominal);
+	MemoryContextSwitchTo(oldcontext);
+
+	return grant;
+}
+
 /* ----------------
  *		ExecGetResultType
  * ----------------
@@ -252,6 +252,10 @@ BufferUsageAdd(BufferUsage *dst, const BufferUsage *add)
 	dst->temp_blks_written += add->temp_blks_written;
 	INSTR_TIME_ADD(dst->blk_read_time, add->blk_read_time);
 	INSTR_TIME_ADD(dst->blk_write_time, add->blk_write_time);
+	INSTR_TIME_ADD(dst->temp_blk_read_time, add->temp_blk_read_time);
+	INSTR_TIME_ADD(dst->temp_blk_write_time, add->temp_blk_write_time);
+	dst->temp_bytes_uncompressed += add->temp_bytes_uncompressed;
+	dst->temp_bytes_compressed += add->temp_bytes_compressed;
 }
 
 /* dst += add - sub */
@@ -274,4 +278,12 @@ BufferUsageAccumDiff(BufferUsage *dst,
 						  add->blk_read_time, sub->blk_read_time);
 	INSTR_TIME_ACCUM_DIFF(dst->blk_write_time,
 						  add->blk_write_time, sub->blk_write_time);
+	INSTR_TIME_ACCUM_DIFF(dst->temp_blk_read_time,
+						  add->temp_blk_read_time, sub->temp_blk_read_time);
+	INSTR_TIME_ACCUM_DIFF(dst->temp_blk_write_time,
+						  add->temp_blk_write_time, sub->temp_blk_write_time);
+	dst->temp_bytes_uncompressed +=
+		add->temp_bytes_uncompressed - sub->temp_bytes_uncompressed;
+	dst->temp_bytes_compressed +=
+		add->temp_bytes_compressed - sub->temp_bytes_compressed;
 }
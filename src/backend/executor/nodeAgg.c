@@ -264,6 +264,7 @@
 #include "utils/dynahash.h"
 #include "utils/logtape.h"
 #include "utils/lsyscache.h"
+#include "utils/memgrant.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
 #include "utils/tuplesort.h"
@@ -446,6 +447,8 @@ static bool agg_refill_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table_in_memory(AggState *aggstate);
 static void hash_agg_check_limits(AggState *aggstate);
+static void hash_agg_start_memgrant(AggState *aggstate);
+static bool hash_agg_expand_memgrant(AggState *aggstate, Size used);
 static void hash_agg_enter_spill_mode(AggState *aggstate);
 static void hash_agg_update_metrics(AggState *aggstate, bool from_tape,
 									int npartitions);
@@ -1921,12 +1924,72 @@ hash_agg_check_limits(AggState *aggstate)
 	 */
 	if (aggstate->hash_ngroups_current > 0 &&
 		(meta_mem + hashkey_mem > aggstate->hash_mem_limit ||
-		 ngroups > aggstate->hash_ngroups_limit))
+		 ngroups > aggstate->hash_ngroups_limit) &&
+		!hash_agg_expand_memgrant(aggstate, meta_mem + hashkey_mem))
 	{
 		hash_agg_enter_spill_mode(aggstate);
 	}
 }
 
+/*
+ * hash_agg_start_memgrant
+ *
+ * Take up the run-time memory grant before filling the hash tables, and
+ * shift the limits by whatever the grant differs from hash_mem.
+ */
+static void
+hash_agg_start_memgrant(AggState *aggstate)
+{
+	MemGrant   *grant = aggstate->hash_memgrant;
+	int64		granted = MemGrantStart(grant);
+	int64		limit;
+	uint64		totalGroups = 0;
+	int			i;
+
+	for (i = 0; i < aggstate->num_hashes; i++)
+		totalGroups += aggstate->perhash[i].aggnode->numGroups;
+
+	hash_agg_set_limits(aggstate->hashentrysize, totalGroups, 0,
+						&aggstate->hash_mem_limit,
+						&aggstate->hash_ngroups_limit, NULL);
+
+	limit = (int64) aggstate->hash_mem_limit + granted - grant->nominal;
+	aggstate->hash_mem_limit = Max(limit, MEMGRANT_MIN_BYTES);
+	if (aggstate->hash_mem_limit > aggstate->hashentrysize)
+		aggstate->hash_ngroups_limit =
+			aggstate->hash_mem_limit / aggstate->hashentrysize;
+	else
+		aggstate->hash_ngroups_limit = 1;
+}
+
+/*
+ * hash_agg_expand_memgrant
+ *
+ * Before entering spill mode, ask the memory grant whether other operators
+ * of the query leave us more memory.  Returns true if we can go on without
+ * spilling.
+ */
+static bool
+hash_agg_expand_memgrant(AggState *aggstate, Size used)
+{
+	int64		extra;
+
+	if (aggstate->hash_memgrant == NULL)
+		return false;
+
+	extra = MemGrantExpand(aggstate->hash_memgrant, used,
+						   aggstate->hash_mem_limit);
+	if (extra == 0)
+		return false;
+
+	aggstate->hash_mem_limit += extra;
+	aggstate->hash_ngroups_limit =
+		aggstate->hash_mem_limit / aggstate->hashentrysize;
+
+	return used <= aggstate->hash_mem_limit &&
+		aggstate->hash_ngroups_current <= aggstate->hash_ngroups_limit;
+}
+
 /*
  * Enter "spill mode", meaning that no new groups are added to any of the hash
  * tables. Tuples that would create a new group are instead spilled, and
@@ -2218,6 +2281,11 @@ ExecAgg(PlanState *pstate)
 
 	if (!node->agg_done)
 	{
+		/* Take up the memory grant before the hash tables get filled */
+		if (node->hash_memgrant &&
+			node->hash_memgrant->status == MEMGRANT_IDLE)
+			hash_agg_start_memgrant(node);
+
 		/* Dispatch based on strategy */
 		switch (node->phase->aggstrategy)
 		{
@@ -3221,6 +3289,10 @@ hashagg_finish_initial_spills(AggState *aggstate)
 
 	hash_agg_update_metrics(aggstate, false, total_npartitions);
 	aggstate->hash_spill_mode = false;
+
+	/* the hash tables stop growing, give the rest of the grant back */
+	if (aggstate->hash_memgrant)
+		MemGrantSettle(aggstate->hash_memgrant, aggstate->hash_mem_peak);
 }
 
 /*
@@ -3753,6 +3825,10 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 							&aggstate->hash_planned_partitions);
 		find_hash_columns(aggstate);
 
+		/* hash_mem may be rebalanced with other operators at run time */
+		aggstate->hash_memgrant = ExecRegisterMemGrant(&aggstate->ss.ps,
+													   get_hash_mem() * 1024L);
+
 		/* Skip massive memory allocation if we are just doing EXPLAIN */
 		if (!(eflags & EXEC_FLAG_EXPLAIN_ONLY))
 			build_hash_tables(aggstate);
@@ -4695,6 +4771,10 @@ cleanup_aggregates(AggState *node)
 		node->hash_metacxt = NULL;
 	}
 
+	/* Hand our memory back to the other operators of the query */
+	if (node->hash_memgrant)
+		MemGrantRelease(node->hash_memgrant);
+
 	if (node->dist_optcxt)
 	{
 		MemoryContextDelete(node->dist_optcxt);
@@ -4861,6 +4941,8 @@ ExecReScanAgg(AggState *node)
 		/* Rebuild an empty hash table */
 		build_hash_tables(node);
 		node->table_filled = false;
+		if (node->hash_memgrant)
+			hash_agg_start_memgrant(node);
 		/* iterator will be reset when the table is filled */
 
 		hashagg_recompile_expressions(node, false, false);
@@ -43,6 +43,7 @@
 #include "utils/dynahash.h"
 #include "utils/guc.h"
 #include "utils/lsyscache.h"
+#include "utils/memgrant.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
 
@@ -61,6 +62,7 @@ bool 	enable_hashjoin_bloom = true;
 bool		enable_newhash = true;
 
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
+static bool ExecHashExpandMemGrant(HashJoinTable hashtable, Size needed);
 static void ExecHashIncreaseNumBuckets(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBuckets(HashJoinTable hashtable);
@@ -238,6 +240,13 @@ MultiExecPrivateHash(HashState *node)
 	if (hashtable->spaceUsed > hashtable->spacePeak)
 		hashtable->spacePeak = hashtable->spaceUsed;
 
+	/*
+	 * A single batch is complete now; later batches still need the whole
+	 * budget when they are loaded.
+	 */
+	if (hashtable->memgrant && hashtable->nbatch == 1)
+		MemGrantSettle(hashtable->memgrant, hashtable->spaceUsed);
+
 	hashtable->partialTuples = hashtable->totalTuples;
 }
 
@@ -464,6 +473,10 @@ ExecInitHash(Hash *node, EState *estate, int eflags)
 	hashstate->hashkeys =
 			ExecInitExprList(node->hashkeys, (PlanState *) hashstate);
 
+	/* hash_mem may be rebalanced with other operators at run time */
+	hashstate->memgrant = ExecRegisterMemGrant(&hashstate->ps,
+											   get_hash_mem() * 1024L);
+
 	return hashstate;
 }
 
@@ -579,7 +592,9 @@ ExecHashTableCreate(HashState *state, List *hashOperators,
 	Hash	   *node;
 	HashJoinTable hashtable;
 	Plan	   *outerNode;
+	MemGrant   *memgrant = NULL;
 	size_t		space_allowed;
+	int			hash_mem = get_hash_mem();
 	int			nbuckets;
 	int			nbatch;
 	double		rows;
@@ -605,11 +620,29 @@ ExecHashTableCreate(HashState *state, List *hashOperators,
 	 */
 	rows = node->plan.parallel_aware ? node->rows_total : outerNode->plan_rows;
 
+	/*
+	 * A private hash table takes its budget from the memory grant, which may
+	 * have shrunk or may grow later; size the batches for what is granted
+	 * now.  A shared table is sized for all participants; just keep its
+	 * budget out of reach of other operators.
+	 */
+	if (state->memgrant != NULL)
+	{
+		if (state->parallel_state == NULL)
+		{
+			memgrant = state->memgrant;
+			hash_mem = (int) (MemGrantStart(memgrant) / 1024L);
+		}
+		else
+			MemGrantSettle(state->memgrant, state->memgrant->nominal);
+	}
+
 	ExecChooseHashTableSize(rows, outerNode->plan_width,
 							OidIsValid(node->skewTable),
 							state->parallel_state != NULL,
 							state->parallel_state != NULL ?
 							state->parallel_state->nparticipants - 1 : 0,
+							hash_mem,
 							&space_allowed,
 							&nbuckets, &nbatch, &num_skew_mcvs);
 
@@ -658,6 +691,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators,
 	hashtable->parallel_state = state->parallel_state;
 	hashtable->area = state->ps.state->es_query_dsa;
 	hashtable->batches = NULL;
+	hashtable->memgrant = memgrant;
 
 #ifdef HJDEBUG
 	printf("Hashjoin %p: initial nbatch = %d, nbuckets = %d\n",
@@ -852,7 +886,8 @@ ExecHashTableCreate(HashState *state, List *hashOperators,
 
 /*
  * Compute appropriate size for hashtable given the estimated size of the
- * relation to be hashed (number of rows and average row width).
+ * relation to be hashed (number of rows and average row width), and the
+ * per-process memory budget hash_mem, in kilobytes.
  *
  * This is exported so that the planner's costsize.c can use it.
  */
@@ -864,6 +899,7 @@ void
 ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 						bool try_combined_hash_mem,
 						int parallel_workers,
+						int hash_mem,
 						size_t *space_allowed,
 						int *numbuckets,
 						int *numbatches,
@@ -879,8 +915,6 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 	int			nbatch = 1;
 	int			nbuckets;
 	double		dbuckets;
-	int			hash_mem = get_hash_mem();
-
 
 	/* Force a plausible relation size if no info */
 	if (ntuples <= 0.0)
@@ -996,6 +1030,7 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 		{
 			ExecChooseHashTableSize(ntuples, tupwidth, useskew,
 									false, parallel_workers,
+									hash_mem,
 									space_allowed,
 									numbuckets,
 									numbatches,
@@ -1073,10 +1108,40 @@ ExecHashTableDestroy(HashJoinTable hashtable)
 	/* Release working memory (batchCxt is a child, so it goes away too) */
 	MemoryContextDelete(hashtable->hashCxt);
 
+	/* Hand our memory back to the other operators of the query */
+	if (hashtable->memgrant)
+		MemGrantRelease(hashtable->memgrant);
+
 	/* And drop the control block */
 	pfree(hashtable);
 }
 
+/*
+ * ExecHashExpandMemGrant
+ *		before adding batches, ask the memory grant whether other operators
+ *		of the query leave enough memory to keep 'needed' bytes in memory
+ */
+static bool
+ExecHashExpandMemGrant(HashJoinTable hashtable, Size needed)
+{
+	int64		extra;
+
+	if (hashtable->memgrant == NULL)
+		return false;
+
+	extra = MemGrantExpand(hashtable->memgrant, hashtable->spaceUsed,
+						   Max(needed - hashtable->spaceAllowed,
+							   hashtable->spaceAllowed));
+	if (extra == 0)
+		return false;
+
+	hashtable->spaceAllowed += extra;
+	hashtable->spaceAllowedSkew =
+		hashtable->spaceAllowed * SKEW_HASH_MEM_PERCENT / 100;
+
+	return needed <= hashtable->spaceAllowed;
+}
+
 /*
  * ExecHashIncreaseNumBatches
  *		increase the original number of batches in order to reduce
@@ -1223,7 +1288,8 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 				Assert(batchno > curbatch);
 				ExecHashJoinSaveTuple(HJTUPLE_MINTUPLE(hashTuple),
 									  hashTuple->hashvalue,
-									  &hashtable->innerBatchFile[batchno]);
+									  &hashtable->innerBatchFile[batchno],
+									  hashtable);
 
 				hashtable->spaceUsed -= hashTupleSize;
 				nfreed++;
@@ -1891,7 +1957,9 @@ ExecHashTableInsert(HashJoinTable hashtable,
 			hashtable->spacePeak = hashtable->spaceUsed;
 		if (hashtable->spaceUsed +
 			hashtable->nbuckets_optimal * sizeof(HashJoinTuple)
-			> hashtable->spaceAllowed)
+			> hashtable->spaceAllowed &&
+			!ExecHashExpandMemGrant(hashtable, hashtable->spaceUsed +
+									hashtable->nbuckets_optimal * sizeof(HashJoinTuple)))
 			ExecHashIncreaseNumBatches(hashtable);
 	}
 	else
@@ -1902,7 +1970,8 @@ ExecHashTableInsert(HashJoinTable hashtable,
 		Assert(batchno > hashtable->curbatch);
 		ExecHashJoinSaveTuple(tuple,
 							  hashvalue,
-							  &hashtable->innerBatchFile[batchno]);
+							  &hashtable->innerBatchFile[batchno],
+							  hashtable);
 	}
 
 	if (shouldFree)
@@ -2714,7 +2783,8 @@ ExecHashSkewTableInsert(HashJoinTable hashtable,
 		ExecHashRemoveNextSkewBucket(hashtable);
 
 	/* Check we are not over the total spaceAllowed, either */
-	if (hashtable->spaceUsed > hashtable->spaceAllowed)
+	if (hashtable->spaceUsed > hashtable->spaceAllowed &&
+		!ExecHashExpandMemGrant(hashtable, hashtable->spaceUsed))
 		ExecHashIncreaseNumBatches(hashtable);
 
 	if (shouldFree)
@@ -2791,7 +2861,8 @@ ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
 			/* Put the tuple into a temp file for later batches */
 			Assert(batchno > hashtable->curbatch);
 			ExecHashJoinSaveTuple(tuple, hashvalue,
-								  &hashtable->innerBatchFile[batchno]);
+								  &hashtable->innerBatchFile[batchno],
+								  hashtable);
 			pfree(hashTuple);
 			hashtable->spaceUsed -= tupleSize;
 			hashtable->spaceUsedSkew -= tupleSize;
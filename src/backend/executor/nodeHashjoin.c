@@ -512,7 +512,8 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 					Assert(parallel_state == NULL);
 					Assert(batchno > hashtable->curbatch);
 					ExecHashJoinSaveTuple(mintuple, hashvalue,
-										  &hashtable->outerBatchFile[batchno]);
+										  &hashtable->outerBatchFile[batchno],
+										  hashtable);
 
 					if (shouldFree)
 						heap_free_minimal_tuple(mintuple);
@@ -1454,13 +1455,18 @@ ExecParallelHashJoinNewBatch(HashJoinState *hjstate)
  * The data recorded in the file for each tuple is its hash value,
  * then the tuple in MinimalTuple format.
  *
+ * Batch files are written and read back strictly sequentially, so they are
+ * opened in sequential mode.  Their chunk size is chosen so that the buffers
+ * of all inner and outer batch files together stay within the hash table's
+ * memory budget.
+ *
  * Note: it is important always to call this in the regular executor
  * context, not in a shorter-lived context; else the temp file buffers
  * will get messed up.
  */
 void
 ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
-					  BufFile **fileptr)
+					  BufFile **fileptr, HashJoinTable hashtable)
 {
 	BufFile    *file = *fileptr;
 	size_t		written;
@@ -1469,6 +1475,10 @@ ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
 	{
 		/* First write to this batch file, so open it. */
 		file = BufFileCreateTemp("HashJoin", false);
+		BufFilePledgeSequential(file,
+								(int) Min(hashtable->spaceAllowed /
+										  (2 * hashtable->nbatch),
+										  BUFFILE_MAX_CHUNK_SIZE));
 		*fileptr = file;
 	}
 
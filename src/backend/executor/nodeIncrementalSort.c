@@ -0,0 +1,378 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.c
+ *	  Routines to handle incremental sorting of relations.
+ *
+ * An incremental sort is used when the input is already sorted by a prefix
+ * of the requested sort keys, e.g. an index scan on (a) below
+ * ORDER BY a, b.  Instead of reading and sorting the whole input, we cut it
+ * into batches of tuples that are equal on the presorted columns and sort
+ * each batch on its own.  The first tuples are returned as soon as the first
+ * batch is sorted, and each sort needs only as much memory as one batch, so
+ * ORDER BY ... LIMIT over a large presorted input stops reading early and
+ * stays in memory.
+ *
+ * Sorting a batch has a fixed overhead, so with many tiny groups we don't
+ * start a new batch at every change of the presorted columns.  A batch takes
+ * at least DEFAULT_MIN_GROUP_SIZE tuples (or as many as are still needed to
+ * satisfy a bound) and then continues until the presorted columns change.
+ * The batch is sorted on all sort columns, which gives the right order no
+ * matter how many groups it spans.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeIncrementalSort.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "executor/execdebug.h"
+#include "executor/nodeIncrementalSort.h"
+#include "miscadmin.h"
+#include "utils/lsyscache.h"
+#include "utils/tuplesort.h"
+
+/* smallest number of tuples we put into one sort batch */
+#define DEFAULT_MIN_GROUP_SIZE 32
+
+static void incsort_sort_batch(IncrementalSortState *node);
+static void incsort_update_stats(IncrementalSortState *node,
+					 Tuplesortstate *tuplesortstate);
+
+/* ----------------------------------------------------------------
+ *		ExecIncrementalSort
+ *
+ *		Returns the tuples of the current sorted batch.  When it runs out,
+ *		reads and sorts the next batch from the outer plan.
+ *
+ *		Conditions:
+ *		  -- the outer plan returns tuples sorted by the first
+ *			 nPresortedCols sort columns.
+ *
+ *		Initial States:
+ *		  -- the outer child is prepared to return the first tuple.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecIncrementalSort(PlanState *pstate)
+{
+	IncrementalSortState *node = castNode(IncrementalSortState, pstate);
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+
+	CHECK_FOR_INTERRUPTS();
+
+	if (node->sort_Done)
+	{
+		if (tuplesort_gettupleslot((Tuplesortstate *) node->tuplesortstate,
+								   true, false, slot, NULL))
+			return slot;
+
+		/* current batch is exhausted */
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+		node->tuplesortstate = NULL;
+		node->sort_Done = false;
+	}
+
+	if (node->outerNodeDone)
+		return ExecClearTuple(slot);
+
+	incsort_sort_batch(node);
+
+	(void) tuplesort_gettupleslot((Tuplesortstate *) node->tuplesortstate,
+								  true, false, slot, NULL);
+
+	return slot;
+}
+
+/*
+ * Read the next batch from the outer plan and sort it.
+ */
+static void
+incsort_sort_batch(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	EState	   *estate = node->ss.ps.state;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	PlanState  *outerNode = outerPlanState(node);
+	ScanDirection dir = estate->es_direction;
+	Tuplesortstate *tuplesortstate;
+	int64		minGroupSize = DEFAULT_MIN_GROUP_SIZE;
+	int64		nTuples = 0;
+	TupleTableSlot *slot;
+
+	SO1_printf("ExecIncrementalSort: %s\n",
+			   "sorting next batch");
+
+	/* no point in making the batch larger than what is still needed */
+	if (node->bounded && node->bound > node->bound_Done)
+		minGroupSize = Min(minGroupSize, node->bound - node->bound_Done);
+
+	tuplesortstate = tuplesort_begin_heap(ExecGetResultType(outerNode),
+										  plannode->sort.numCols,
+										  plannode->sort.sortColIdx,
+										  plannode->sort.sortOperators,
+										  plannode->sort.collations,
+										  plannode->sort.nullsFirst,
+										  work_mem,
+										  false);
+	if (node->bounded && node->bound > node->bound_Done)
+		tuplesort_set_bound(tuplesortstate, node->bound - node->bound_Done);
+	node->tuplesortstate = (void *) tuplesortstate;
+
+	ExecClearTuple(node->group_pivot);
+
+	/* the previous batch may already have read our first tuple */
+	if (!TupIsNull(node->transfer_tuple))
+	{
+		tuplesort_puttupleslot(tuplesortstate, node->transfer_tuple);
+		nTuples++;
+		if (nTuples == minGroupSize)
+			ExecCopySlot(node->group_pivot, node->transfer_tuple);
+		ExecClearTuple(node->transfer_tuple);
+	}
+
+	/* Want to scan subplan in the forward direction */
+	estate->es_direction = ForwardScanDirection;
+
+	for (;;)
+	{
+		slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			node->outerNodeDone = true;
+			break;
+		}
+
+		/*
+		 * Once the batch is large enough, it ends where the presorted
+		 * columns change.  Keep the tuple for the next batch.
+		 */
+		if (nTuples >= minGroupSize)
+		{
+			econtext->ecxt_innertuple = node->group_pivot;
+			econtext->ecxt_outertuple = slot;
+			if (!ExecQualAndReset(node->presorted_eq, econtext))
+			{
+				ExecCopySlot(node->transfer_tuple, slot);
+				break;
+			}
+		}
+
+		tuplesort_puttupleslot(tuplesortstate, slot);
+		nTuples++;
+		if (nTuples == minGroupSize)
+			ExecCopySlot(node->group_pivot, slot);
+	}
+
+	estate->es_direction = dir;
+
+	tuplesort_performsort(tuplesortstate);
+
+	if (node->ss.ps.instrument != NULL)
+		incsort_update_stats(node, tuplesortstate);
+
+	if (node->bounded)
+		node->bound_Done = Min(node->bound, node->bound_Done + nTuples);
+
+	node->sort_Done = true;
+
+	SO1_printf("ExecIncrementalSort: %s\n", "batch sorted");
+}
+
+/*
+ * Accumulate the tuplesort statistics of a sorted batch for EXPLAIN ANALYZE.
+ */
+static void
+incsort_update_stats(IncrementalSortState *node,
+					 Tuplesortstate *tuplesortstate)
+{
+	IncrementalSortGroupInfo *info = &node->incsort_info;
+	TuplesortInstrumentation stats;
+
+	tuplesort_get_stats(tuplesortstate, &stats);
+
+	info->groupCount++;
+	info->sortMethods |= 1 << stats.sortMethod;
+
+	if (stats.spaceType == SORT_SPACE_TYPE_DISK)
+	{
+		info->totalDiskSpaceUsed += stats.spaceUsed;
+		info->maxDiskSpaceUsed = Max(info->maxDiskSpaceUsed, stats.spaceUsed);
+	}
+	else
+	{
+		info->totalMemorySpaceUsed += stats.spaceUsed;
+		info->maxMemorySpaceUsed = Max(info->maxMemorySpaceUsed,
+									   stats.spaceUsed);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitIncrementalSort
+ *
+ *		Creates the run-time state information for the incremental sort
+ *		node produced by the planner and initializes its outer subtree.
+ * ----------------------------------------------------------------
+ */
+IncrementalSortState *
+ExecInitIncrementalSort(IncrementalSort *node, EState *estate, int eflags)
+{
+	IncrementalSortState *incrsortstate;
+	TupleDesc	outerTupDesc;
+	Oid		   *eqOperators;
+	int			i;
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "initializing incremental sort node");
+
+	/*
+	 * Only one batch is kept at a time, so backward scans and mark/restore
+	 * are not supported.
+	 */
+	Assert((eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)) == 0);
+
+	/*
+	 * create state structure
+	 */
+	incrsortstate = makeNode(IncrementalSortState);
+	incrsortstate->ss.ps.plan = (Plan *) node;
+	incrsortstate->ss.ps.state = estate;
+	incrsortstate->ss.ps.ExecProcNode = ExecIncrementalSort;
+
+	incrsortstate->bounded = false;
+	incrsortstate->bound_Done = 0;
+	incrsortstate->sort_Done = false;
+	incrsortstate->outerNodeDone = false;
+	incrsortstate->tuplesortstate = NULL;
+	memset(&incrsortstate->incsort_info, 0,
+		   sizeof(IncrementalSortGroupInfo));
+
+	/*
+	 * create expression context, used to compare the presorted columns
+	 */
+	ExecAssignExprContext(estate, &incrsortstate->ss.ps);
+
+	/*
+	 * initialize child nodes
+	 *
+	 * A rewind re-reads the input, so the child has to support it as well.
+	 */
+	outerPlanState(incrsortstate) = ExecInitNode(outerPlan(node), estate,
+												 eflags);
+
+	/*
+	 * Initialize scan slot and type.
+	 */
+	ExecCreateScanSlotFromOuterPlan(estate, &incrsortstate->ss);
+
+	/*
+	 * Initialize return slot and type. No need to initialize projection info
+	 * because this node doesn't do projections.
+	 */
+	ExecInitResultTupleSlotTL(&incrsortstate->ss.ps);
+	incrsortstate->ss.ps.ps_ProjInfo = NULL;
+
+	outerTupDesc = ExecGetResultType(outerPlanState(incrsortstate));
+	incrsortstate->group_pivot = ExecInitExtraTupleSlot(estate, outerTupDesc);
+	incrsortstate->transfer_tuple = ExecInitExtraTupleSlot(estate,
+														   outerTupDesc);
+
+	/*
+	 * Precompute the equality test on the presorted columns, using the
+	 * equality operators that belong to the sort operators.
+	 */
+	eqOperators = (Oid *) palloc(node->nPresortedCols * sizeof(Oid));
+	for (i = 0; i < node->nPresortedCols; i++)
+	{
+		eqOperators[i] =
+			get_equality_op_for_ordering_op(node->sort.sortOperators[i],
+											NULL);
+		if (!OidIsValid(eqOperators[i]))
+			elog(ERROR, "could not find equality operator for ordering operator %u",
+				 node->sort.sortOperators[i]);
+	}
+
+	incrsortstate->presorted_eq =
+		execTuplesMatchPrepare(outerTupDesc,
+							   node->nPresortedCols,
+							   node->sort.sortColIdx,
+							   eqOperators,
+							   &incrsortstate->ss.ps);
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "incremental sort node initialized");
+
+	return incrsortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndIncrementalSort(node)
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndIncrementalSort(IncrementalSortState *node)
+{
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "shutting down incremental sort node");
+
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->transfer_tuple);
+
+	/*
+	 * Release tuplesort resources
+	 */
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "incremental sort node shutdown");
+}
+
+void
+ExecReScanIncrementalSort(IncrementalSortState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/*
+	 * Only the current batch is kept, so we always have to re-read the
+	 * subplan.
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->transfer_tuple);
+
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	node->sort_Done = false;
+	node->outerNodeDone = false;
+	node->bound_Done = 0;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
@@ -126,6 +126,8 @@ IndexNext(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		scandesc->xs_tuples_needed = node->iss_TuplesNeeded;
+		scandesc->xs_filtered = (node->ss.ps.qual != NULL);
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -237,6 +239,8 @@ IndexNextWithReorder(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		scandesc->xs_tuples_needed = node->iss_TuplesNeeded;
+		scandesc->xs_filtered = (node->ss.ps.qual != NULL);
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -988,6 +992,7 @@ ExecInitIndexScan(IndexScan *node, EState *estate, int eflags)
 	indexstate->ss.curPartIdx = -1;
 	indexstate->ss.partScanDirection = node->scan.partScanDirection;
 	indexstate->ss.ps.ExecProcNode = ExecIndexScan;
+	indexstate->iss_TuplesNeeded = -1;
 
 	/*
 	 * Miscellaneous initialization
@@ -113,6 +113,8 @@ ExecSort(PlanState *pstate)
 												  node->randomAccess);
 		if (node->bounded)
 			tuplesort_set_bound(tuplesortstate, node->bound);
+		if (node->memgrant)
+			tuplesort_attach_memgrant(tuplesortstate, node->memgrant);
 		node->tuplesortstate = (void *) tuplesortstate;
 
 		/*
@@ -277,6 +279,10 @@ ExecInitSort(Sort *node, EState *estate, int eflags)
 	else
 		sortstate->datumSort = false;
 
+	/* work_mem may be rebalanced with other operators at run time */
+	sortstate->memgrant = ExecRegisterMemGrant(&sortstate->ss.ps,
+											   work_mem * 1024L);
+
 	SO1_printf("ExecInitSort: %s\n",
 			   "sort node initialized");
 
@@ -4610,6 +4610,11 @@ plan_tree_walker(Plan *plan, bool (*walker) (), void *context)
 									   walker, context))
 				return true;
 			break;
+		case T_Memoize:
+			if (expression_tree_walker((Node *) ((Memoize *)plan)->param_exprs,
+									   walker, context))
+				return true;
+			break;
 		/* no special expressions */
 		case T_PartIterator:
 		case T_ProjectSet:
@@ -4624,6 +4629,7 @@ plan_tree_walker(Plan *plan, bool (*walker) (), void *context)
 		case T_WorkTableScan:
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Group:
 		case T_Agg:
 		case T_Unique:
@@ -4769,6 +4775,15 @@ path_tree_walker(Path *path, bool (*walker) (), void *context)
 
 			break;
 		}
+		case T_MemoizePath:
+		{
+			MemoizePath	*mpath = (MemoizePath *) path;
+
+			if (walker(mpath->subpath, context))
+				return true;
+
+			break;
+		}
 		case T_UniquePath:
 		{
 			UniquePath	*upath = (UniquePath *) path;
@@ -4806,6 +4821,7 @@ path_tree_walker(Path *path, bool (*walker) (), void *context)
 			break;
 		}
 		case T_SortPath:
+		case T_IncrementalSortPath:
 		{
 			SortPath	*spath = (SortPath *) path;
 
@@ -5180,6 +5196,10 @@ plan_tree_mutator(Plan *plan, Node *(*mutator)(), void *context)
 		expression_tree_mutator_internal((Node *)((Limit *)plan)->limitOffset,
 										 mutator, context, false);
 		break;
+	case T_Memoize:
+		expression_tree_mutator_internal((Node *)((Memoize *)plan)->param_exprs,
+										 mutator, context, false);
+		break;
 	/* no special expressions */
 	case T_PartIterator:
 	case T_ProjectSet:
@@ -5193,6 +5213,7 @@ plan_tree_mutator(Plan *plan, Node *(*mutator)(), void *context)
 	case T_WorkTableScan:
 	case T_Material:
 	case T_Sort:
+	case T_IncrementalSort:
 	case T_Group:
 	case T_Agg:
 	case T_Unique:
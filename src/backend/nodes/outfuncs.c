@@ -1594,15 +1594,80 @@ _outMaterial(StringInfo str, const Material *node)
 	_outPlanInfo(str, (const Plan *) node);
 }
 
+static void
+_outMemoize(StringInfo str, const Memoize *node)
+{
+	int			i;
+
+	WRITE_NODE_TYPE("MEMOIZE");
+
+	_outPlanInfo(str, (const Plan *) node);
+
+	WRITE_INT_FIELD(numKeys);
+
+	appendStringInfoString(str, " :hashOperators");
+	for (i = 0; i < node->numKeys; i++)
+#ifdef XCP
+		if (portable_output)
+		{
+			Oid oper = node->hashOperators[i];
+			Oid oprleft, oprright;
+			/* Hash operator is always valid */
+			Assert(OidIsValid(oper));
+			appendStringInfoChar(str, ' ');
+			outToken(str, NSP_NAME(get_opnamespace(oper)));
+			appendStringInfoChar(str, ' ');
+			outToken(str, get_opname(oper));
+			appendStringInfoChar(str, ' ');
+			op_input_types(oper, &oprleft, &oprright);
+			outToken(str, OidIsValid(oprleft) ?
+					NSP_NAME(get_typ_namespace(oprleft)) : NULL);
+			appendStringInfoChar(str, ' ');
+			outToken(str, OidIsValid(oprleft) ? get_typ_name(oprleft) : NULL);
+			appendStringInfoChar(str, ' ');
+			outToken(str, OidIsValid(oprright) ?
+					NSP_NAME(get_typ_namespace(oprright)) : NULL);
+			appendStringInfoChar(str, ' ');
+			outToken(str, OidIsValid(oprright) ? get_typ_name(oprright) : NULL);
+		}
+		else
+#endif
+		appendStringInfo(str, " %u", node->hashOperators[i]);
+
+	appendStringInfoString(str, " :collations");
+	for (i = 0; i < node->numKeys; i++)
+#ifdef XCP
+		if (portable_output)
+		{
+			Oid coll = node->collations[i];
+			if (OidIsValid(coll))
+			{
+				appendStringInfoChar(str, ' ');
+				outToken(str, NSP_NAME(get_collation_namespace(coll)));
+				appendStringInfoChar(str, ' ');
+				outToken(str, get_collation_name(coll));
+				appendStringInfo(str, " %d", get_collation_encoding(coll));
+			}
+			else
+				appendStringInfo(str, " <> <> -1");
+		}
+		else
+#endif
+		appendStringInfo(str, " %u", node->collations[i]);
+
+	WRITE_NODE_FIELD(param_exprs);
+	WRITE_BOOL_FIELD(singlerow);
+	WRITE_UINT_FIELD(est_entries);
+	WRITE_BITMAPSET_FIELD(keyparamids);
+}
+
 
 
 static void
-_outSort(StringInfo str, const Sort *node)
+_outSortInfo(StringInfo str, const Sort *node)
 {
 	int			i;
 
-	WRITE_NODE_TYPE("SORT");
-
 	_outPlanInfo(str, (const Plan *) node);
 
 	WRITE_INT_FIELD(numCols);
@@ -1662,6 +1727,24 @@ _outSort(StringInfo str, const Sort *node)
 	WRITE_BOOL_ARRAY(nullsFirst, node->numCols);
 }
 
+static void
+_outSort(StringInfo str, const Sort *node)
+{
+	WRITE_NODE_TYPE("SORT");
+
+	_outSortInfo(str, node);
+}
+
+static void
+_outIncrementalSort(StringInfo str, const IncrementalSort *node)
+{
+	WRITE_NODE_TYPE("INCREMENTALSORT");
+
+	_outSortInfo(str, (const Sort *) node);
+
+	WRITE_INT_FIELD(nPresortedCols);
+}
+
 static void
 _outUnique(StringInfo str, const Unique *node)
 {
@@ -2619,6 +2702,12 @@ _outScalarArrayOpExpr(StringInfo str, const ScalarArrayOpExpr *node)
 	else
 #endif
 	WRITE_OID_FIELD(opfuncid);
+#ifdef XCP
+	if (portable_output)
+		WRITE_FUNCID_FIELD(hashfuncid);
+	else
+#endif
+	WRITE_OID_FIELD(hashfuncid);
 	WRITE_BOOL_FIELD(useOr);
 #ifdef XCP
 	if (portable_output)
@@ -3494,6 +3583,21 @@ _outMaterialPath(StringInfo str, const MaterialPath *node)
 	WRITE_NODE_FIELD(subpath);
 }
 
+static void
+_outMemoizePath(StringInfo str, const MemoizePath *node)
+{
+	WRITE_NODE_TYPE("MEMOIZEPATH");
+
+	_outPathInfo(str, (const Path *) node);
+
+	WRITE_NODE_FIELD(subpath);
+	WRITE_NODE_FIELD(hash_operators);
+	WRITE_NODE_FIELD(param_exprs);
+	WRITE_BOOL_FIELD(singlerow);
+	WRITE_FLOAT_FIELD(calls, "%.0f");
+	WRITE_UINT_FIELD(est_entries);
+}
+
 static void
 _outUniquePath(StringInfo str, const UniquePath *node)
 {
@@ -3564,6 +3668,17 @@ _outSortPath(StringInfo str, const SortPath *node)
 #endif
 }
 
+static void
+_outIncrementalSortPath(StringInfo str, const IncrementalSortPath *node)
+{
+	WRITE_NODE_TYPE("INCREMENTALSORTPATH");
+
+	_outPathInfo(str, (const Path *) node);
+
+	WRITE_NODE_FIELD(spath.subpath);
+	WRITE_INT_FIELD(nPresortedCols);
+}
+
 static void
 _outGroupPath(StringInfo str, const GroupPath *node)
 {
@@ -5917,9 +6032,15 @@ outNode(StringInfo str, const void *obj)
 			case T_Material:
 				_outMaterial(str, obj);
 				break;
+			case T_Memoize:
+				_outMemoize(str, obj);
+				break;
 			case T_Sort:
 				_outSort(str, obj);
 				break;
+			case T_IncrementalSort:
+				_outIncrementalSort(str, obj);
+				break;
 			case T_Unique:
 				_outUnique(str, obj);
 				break;
@@ -6165,6 +6286,9 @@ outNode(StringInfo str, const void *obj)
 			case T_MaterialPath:
 				_outMaterialPath(str, obj);
 				break;
+			case T_MemoizePath:
+				_outMemoizePath(str, obj);
+				break;
 			case T_UniquePath:
 				_outUniquePath(str, obj);
 				break;
@@ -6183,6 +6307,9 @@ outNode(StringInfo str, const void *obj)
 			case T_SortPath:
 				_outSortPath(str, obj);
 				break;
+			case T_IncrementalSortPath:
+				_outIncrementalSortPath(str, obj);
+				break;
 			case T_GroupPath:
 				_outGroupPath(str, obj);
 				break;
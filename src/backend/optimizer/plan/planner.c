@@ -55,6 +55,7 @@
 #include "optimizer/tlist.h"
 #include "optimizer/var.h"
 #include "optimizer/spm.h"
+#include "optimizer/spm_cache.h"
 #include "parser/analyze.h"
 #include "parser/parse_clause.h"
 #include "parser/parsetree.h"
@@ -355,17 +356,30 @@ extern float8 GetlimitCount(Datum val, bool float8_datum, bool percent);
  * Note to plugin authors: standard_planner() scribbles on its Query input,
  * so you'd better copy that data structure if you want to plan more than once.
  *
+ * Without a hook, generic plans of SPM-managed statements are shared with
+ * the other sessions of the coordinator through the SPM shared plan cache.
+ *
  *****************************************************************************/
 PlannedStmt *
 planner(Query *parse, int cursorOptions, ParamListInfo boundParams, 
 		int cached_param_num, bool explain)
 {
 	PlannedStmt *result;
+	SPMSharedPlanProbe spm_probe;
 
 	planning_dml_sql = false;
 	if (is_parallel_allowed_for_modify(parse))
 		planning_dml_sql = true;
-	
+
+	spm_probe.cacheable = false;
+	if (!planner_hook)
+	{
+		result = SPMSharedPlanCacheLookup(parse, cursorOptions, boundParams,
+										  explain, &spm_probe);
+		if (result)
+			return result;
+	}
+
 	if (planner_hook)
 		result = (*planner_hook) (parse, cursorOptions, boundParams, 
 									cached_param_num, explain);
@@ -381,6 +395,9 @@ planner(Query *parse, int cursorOptions, ParamListInfo boundParams,
 		else
 #endif
 			result = standard_planner(parse, cursorOptions, boundParams);
+
+	if (spm_probe.cacheable)
+		SPMSharedPlanCacheStore(&spm_probe, result);
 	return result;
 }
 
@@ -2521,6 +2538,14 @@ preprocess_expression(PlannerInfo *root, Node *expr, int kind)
 	if (root->query_level > 1)
 		expr = SS_replace_correlation_vars(root, expr);
 
+	/*
+	 * Check for ANY ScalarArrayOpExpr with Const arrays and set the
+	 * hashfuncid of any that might execute more quickly by using hash lookups
+	 * instead of a linear search.
+	 */
+	if (kind == EXPRKIND_QUAL || kind == EXPRKIND_TARGET)
+		convert_saop_to_hashed_saop(expr);
+
 	/*
 	 * If it's a qual or havingQual, convert it to implicit-AND format. (We
 	 * don't want to do this before eval_const_expressions, since the latter
@@ -7089,9 +7114,41 @@ create_ordered_paths(PlannerInfo *root,
 	{
 		Path	   *path = (Path *) lfirst(lc);
 		bool		is_sorted;
+		int			presorted_keys;
+
+		is_sorted = pathkeys_count_contained_in(root->sort_pathkeys,
+												path->pathkeys,
+												&presorted_keys);
+
+		/*
+		 * If the path is sorted by a prefix of the ORDER BY keys, consider an
+		 * incremental sort on top of it.  It only has to sort groups of rows
+		 * sharing the prefix, which is cheap on startup and needs little
+		 * memory.  On a datanode the path stays below the RemoteSubplan, so
+		 * each datanode streams its ordered rows into the merge.  With user
+		 * defined functions the order of sort and projection matters (see
+		 * below), so stick to the plain sort then.
+		 */
+		if (enable_incremental_sort && !is_sorted && presorted_keys > 0 &&
+			!root->hasUserDefinedFun)
+		{
+			Path	   *sorted_path;
+
+			sorted_path = (Path *) create_incremental_sort_path(root,
+																ordered_rel,
+																path,
+																root->sort_pathkeys,
+																presorted_keys,
+																limit_tuples);
+
+			/* Add projection step if needed */
+			if (sorted_path->pathtarget != target)
+				sorted_path = apply_projection_to_path(root, ordered_rel,
+													   sorted_path, target);
+
+			add_path(ordered_rel, sorted_path);
+		}
 
-		is_sorted = pathkeys_contained_in(root->sort_pathkeys,
-										  path->pathkeys);
 		if (path == cheapest_input_path || is_sorted)
 		{
 			if (!is_sorted)
@@ -7249,6 +7306,50 @@ create_ordered_paths(PlannerInfo *root,
 
 			add_path(ordered_rel, path);
 		}
+
+		/*
+		 * Partial paths that are already sorted by a prefix of the required
+		 * ordering can be sorted incrementally below the Gather Merge.
+		 */
+		if (enable_incremental_sort)
+		{
+			foreach(lc, input_rel->partial_pathlist)
+			{
+				Path	   *partial_path = (Path *) lfirst(lc);
+				Path	   *path;
+				int			presorted_keys;
+				double		total_groups;
+
+				if (pathkeys_count_contained_in(root->sort_pathkeys,
+												partial_path->pathkeys,
+												&presorted_keys) ||
+					presorted_keys == 0)
+					continue;
+
+				path = (Path *) create_incremental_sort_path(root,
+															 ordered_rel,
+															 partial_path,
+															 root->sort_pathkeys,
+															 presorted_keys,
+															 limit_tuples);
+
+				total_groups = partial_path->rows *
+					partial_path->parallel_workers;
+				path = (Path *)
+					create_gather_merge_path(root, ordered_rel,
+											 path,
+											 path->pathtarget,
+											 root->sort_pathkeys, NULL,
+											 &total_groups);
+
+				/* Add projection step if needed */
+				if (path->pathtarget != target)
+					path = apply_projection_to_path(root, ordered_rel,
+													path, target);
+
+				add_path(ordered_rel, path);
+			}
+		}
 	}
 
 	/*
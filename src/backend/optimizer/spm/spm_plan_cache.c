@@ -0,0 +1,786 @@
+/*------------------------------------------------------------------------
+ *
+ * spm_plan_cache.c
+ *	  Shared cache of generic plans for SPM-managed statements.
+ *
+ * Every session of a coordinator runs the full distributed planner for
+ * statements that are not prepared, even when SPM already pins the plan
+ * shape with a baseline.  This cache keeps the generic PlannedStmt of such
+ * statements in shared memory, serialized with nodeToString, so that a
+ * statement planned by one session can be reused by all the others.
+ *
+ * Entries are keyed by the SPM sql_id together with everything else that
+ * can change the plan for the same sql_id: the analyzed query tree (which
+ * carries the parameter types and constants), the source text (hints), the
+ * search_path, the modified planner GUCs and the applied baseline.  They
+ * are dropped on relcache invalidation of any relation they depend on, on
+ * catalog changes that can affect plans and on shard map changes.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/backend/optimizer/spm/spm_plan_cache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "catalog/namespace.h"
+#include "funcapi.h"
+#include "optimizer/planner.h"
+#include "optimizer/spm.h"
+#include "optimizer/spm_cache.h"
+#include "pgxc/pgxc.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "tcop/tcopprot.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/guc_tables.h"
+#include "utils/hashutils.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/syscache.h"
+
+#define SPM_SHARED_PLAN_MAX_LEN			(64 * 1024)
+#define SPM_SHARED_PLAN_MAX_RELS		32
+#define SPM_SHARED_PLAN_MAX_FUNCS		32
+#define SPM_SHARED_PLAN_MAX_USAGE_COUNT	5
+
+typedef struct SPMSharedPlanEntry
+{
+	SPMSharedPlanTag	tag;
+	int					slot;
+} SPMSharedPlanEntry;
+
+/*
+ * Plans that depend on a relation are chained through their slots, so that a
+ * relcache invalidation finds them without scanning the cache.  A link names
+ * the position of the relation in the relids array of a slot, see
+ * SPM_SHARED_PLAN_REL_LINK.
+ */
+typedef struct SPMSharedPlanRelEntry
+{
+	Oid					relid;
+	int					head;		/* first link of the chain */
+} SPMSharedPlanRelEntry;
+
+typedef struct SPMSharedPlanSlot
+{
+	SPMSharedPlanTag	tag;
+	int					id;
+	bool				valid;
+	bool				spm_applyed;
+	int64				plan_id;
+	pg_atomic_uint32	usecount;
+	int					nrelids;
+	Oid					relids[SPM_SHARED_PLAN_MAX_RELS];
+	int					rel_prev[SPM_SHARED_PLAN_MAX_RELS];
+	int					rel_next[SPM_SHARED_PLAN_MAX_RELS];
+	int					nfuncs;
+	uint32				func_hashes[SPM_SHARED_PLAN_MAX_FUNCS];	/* PROCOID hash values */
+	int					len;
+	char				data[FLEXIBLE_ARRAY_MEMBER];
+} SPMSharedPlanSlot;
+
+typedef struct SPMSharedPlanCtl
+{
+	LWLock				lock;
+	pg_atomic_uint64	generation;	/* bumped by every invalidation */
+	int					next_victim;
+	pg_atomic_uint64	hits;
+	pg_atomic_uint64	stores;
+	pg_atomic_uint64	invalidations;	/* plans dropped by invalidation */
+} SPMSharedPlanCtl;
+
+int		spm_plan_cache_size = 0;
+bool	enable_spm_plan_cache = true;
+
+static HTAB *g_SPMSharedPlanHashTab;
+static HTAB *g_SPMSharedPlanRelHashTab;
+static SPMSharedPlanCtl *g_SPMSharedPlanCtl;
+static char *g_SPMSharedPlanSlots;
+
+#define SPM_SHARED_PLAN_SLOT_SIZE \
+	MAXALIGN(offsetof(SPMSharedPlanSlot, data) + SPM_SHARED_PLAN_MAX_LEN)
+
+#define GET_SPM_SHARED_PLAN_SLOT(idx) \
+	((SPMSharedPlanSlot *) (g_SPMSharedPlanSlots + \
+							(Size) (idx) * SPM_SHARED_PLAN_SLOT_SIZE))
+
+#define SPM_SHARED_PLAN_REL_LINK(slot_id, j) \
+	((slot_id) * SPM_SHARED_PLAN_MAX_RELS + (j))
+#define SPM_SHARED_PLAN_LINK_SLOT(link) \
+	GET_SPM_SHARED_PLAN_SLOT((link) / SPM_SHARED_PLAN_MAX_RELS)
+#define SPM_SHARED_PLAN_LINK_POS(link) \
+	((link) % SPM_SHARED_PLAN_MAX_RELS)
+
+static int64 SPMSharedPlanBaseline(uint32 sql_id);
+static void SPMSharedPlanShapeHash(Query *parse, SPMSharedPlanTag *tag);
+static void SPMSharedPlanLinkRels(SPMSharedPlanSlot *slot);
+static void SPMSharedPlanUnlinkRels(SPMSharedPlanSlot *slot);
+static void SPMSharedPlanEvict(SPMSharedPlanSlot *slot);
+static int	SPMSharedPlanGetVictim(void);
+static void SPMSharedPlanInvalidate(Oid relid);
+static void SPMSharedPlanInvalidateFunc(uint32 hashvalue);
+static void SPMSharedPlanRelCallback(Datum arg, Oid relid);
+static void SPMSharedPlanFuncCallback(Datum arg, int cacheid, uint32 hashvalue);
+static void SPMSharedPlanSysCallback(Datum arg, int cacheid, uint32 hashvalue);
+
+Size
+SPMSharedPlanShmemSize(void)
+{
+	Size sz = 0;
+
+	if (spm_plan_cache_size <= 0)
+		return 0;
+
+	sz = hash_estimate_size(spm_plan_cache_size, sizeof(SPMSharedPlanEntry));
+	sz = add_size(sz, hash_estimate_size(mul_size(spm_plan_cache_size,
+												  SPM_SHARED_PLAN_MAX_RELS),
+										 sizeof(SPMSharedPlanRelEntry)));
+	sz = add_size(sz, MAXALIGN(sizeof(SPMSharedPlanCtl)));
+	sz = add_size(sz, mul_size(spm_plan_cache_size, SPM_SHARED_PLAN_SLOT_SIZE));
+
+	return sz;
+}
+
+void
+SPMSharedPlanShmemInit(void)
+{
+	HASHCTL		info;
+	bool		foundCtl;
+	bool		foundSlots;
+	int			i;
+
+	if (spm_plan_cache_size <= 0)
+		return;
+
+	info.keysize = sizeof(SPMSharedPlanTag);
+	info.entrysize = sizeof(SPMSharedPlanEntry);
+	g_SPMSharedPlanHashTab = ShmemInitHash("SPM shared plan hash table",
+										   spm_plan_cache_size,
+										   spm_plan_cache_size,
+										   &info,
+										   HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
+	if (!g_SPMSharedPlanHashTab)
+	{
+		elog(FATAL, "[SPM] invalid shmem status when creating SPM shared plan hash table");
+	}
+
+	info.keysize = sizeof(Oid);
+	info.entrysize = sizeof(SPMSharedPlanRelEntry);
+	g_SPMSharedPlanRelHashTab = ShmemInitHash("SPM shared plan relation hash table",
+											  spm_plan_cache_size * SPM_SHARED_PLAN_MAX_RELS,
+											  spm_plan_cache_size * SPM_SHARED_PLAN_MAX_RELS,
+											  &info,
+											  HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
+	if (!g_SPMSharedPlanRelHashTab)
+	{
+		elog(FATAL, "[SPM] invalid shmem status when creating SPM shared plan relation hash table");
+	}
+
+	g_SPMSharedPlanCtl = (SPMSharedPlanCtl *)
+						ShmemInitStruct("SPM shared plan control",
+						sizeof(SPMSharedPlanCtl),
+						&foundCtl);
+
+	g_SPMSharedPlanSlots = (char *)
+						ShmemInitStruct("SPM shared plan slots",
+						mul_size(spm_plan_cache_size, SPM_SHARED_PLAN_SLOT_SIZE),
+						&foundSlots);
+
+	LWLockRegisterTranche(LWTRANCHE_SPM_SHARED_PLAN, "spm_shared_plan");
+
+	if (!foundCtl)
+	{
+		LWLockInitialize(&g_SPMSharedPlanCtl->lock, LWTRANCHE_SPM_SHARED_PLAN);
+		pg_atomic_init_u64(&g_SPMSharedPlanCtl->generation, 0);
+		g_SPMSharedPlanCtl->next_victim = 0;
+		pg_atomic_init_u64(&g_SPMSharedPlanCtl->hits, 0);
+		pg_atomic_init_u64(&g_SPMSharedPlanCtl->stores, 0);
+		pg_atomic_init_u64(&g_SPMSharedPlanCtl->invalidations, 0);
+	}
+
+	if (!foundSlots)
+	{
+		for (i = 0; i < spm_plan_cache_size; i++)
+		{
+			SPMSharedPlanSlot *slot = GET_SPM_SHARED_PLAN_SLOT(i);
+
+			slot->id = i;
+			slot->valid = false;
+			pg_atomic_init_u32(&slot->usecount, 0);
+		}
+	}
+}
+
+/*
+ * Register the invalidation callbacks.  This must run in every backend of a
+ * coordinator, not only those that use the cache: an invalidation is seen
+ * only by the backends that are alive when it is sent, so a backend started
+ * later could otherwise pick up a plan that nobody has dropped yet.
+ */
+void
+SPMSharedPlanCacheRegisterCallbacks(void)
+{
+	if (spm_plan_cache_size <= 0)
+		return;
+
+	CacheRegisterRelcacheCallback(SPMSharedPlanRelCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(PROCOID, SPMSharedPlanFuncCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(NAMESPACEOID, SPMSharedPlanSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(OPEROID, SPMSharedPlanSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(AMOPOPID, SPMSharedPlanSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(FOREIGNSERVEROID, SPMSharedPlanSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(FOREIGNDATAWRAPPEROID, SPMSharedPlanSysCallback, (Datum) 0);
+#ifdef PGXC
+	CacheRegisterSyscacheCallback(PGXCCLASSRELID, SPMSharedPlanSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(PGXCGROUPOID, SPMSharedPlanSysCallback, (Datum) 0);
+	CacheRegisterSyscacheCallback(PGXCNODEOID, SPMSharedPlanSysCallback, (Datum) 0);
+#endif
+}
+
+/*
+ * Look up the plan of the given query in the shared plan cache.
+ *
+ * Returns a private copy of the cached plan, or NULL.  In the latter case
+ * probe tells the caller whether the plan it is about to build may be
+ * stored with SPMSharedPlanCacheStore().  Only generic plans of plain
+ * SELECTs are shared; a caller that supplies parameter values wants a
+ * custom plan, which is left to the local plan cache.
+ */
+PlannedStmt *
+SPMSharedPlanCacheLookup(Query *parse, int cursorOptions,
+						 ParamListInfo boundParams, bool explain,
+						 SPMSharedPlanProbe *probe)
+{
+	SPMSharedPlanEntry *entry;
+	SPMSharedPlanSlot  *slot;
+	PlannedStmt *stmt;
+	char	   *data = NULL;
+	int64		plan_id = 0;
+	bool		spm_applyed = false;
+	Oid			tempNamespaceId;
+	Oid			tempToastNamespaceId;
+	int			level = (debug_print_spm) ? LOG : DEBUG5;
+
+	probe->cacheable = false;
+
+	if (spm_plan_cache_size <= 0 || !enable_spm_plan_cache || !SPM_ENABLED ||
+		!IS_PGXC_LOCAL_COORDINATOR || CAP_SPMPLAN_ABNORMAL || CAP_SPM_MANUAL)
+		return NULL;
+
+	if (explain || boundParams != NULL || parse->queryId <= 1 ||
+		parse->commandType != CMD_SELECT || parse->utilityStmt != NULL ||
+		parse->rowMarks != NIL || parse->hasModifyingCTE)
+		return NULL;
+
+	/* Temporary objects resolve differently in every session */
+	GetTempNamespaceState(&tempNamespaceId, &tempToastNamespaceId);
+	if (OidIsValid(tempNamespaceId))
+		return NULL;
+
+	memset(&probe->tag, 0, sizeof(SPMSharedPlanTag));
+	probe->tag.dboid = MyDatabaseId;
+	probe->tag.userid = GetUserId();
+	probe->tag.sql_id = parse->queryId;
+	probe->tag.cursor_options = cursorOptions;
+	probe->tag.baseline_id = SPMSharedPlanBaseline(parse->queryId);
+	SPMSharedPlanShapeHash(parse, &probe->tag);
+
+	probe->generation = pg_atomic_read_u64(&g_SPMSharedPlanCtl->generation);
+	probe->cacheable = true;
+
+	LWLockAcquire(&g_SPMSharedPlanCtl->lock, LW_SHARED);
+	entry = (SPMSharedPlanEntry *) hash_search(g_SPMSharedPlanHashTab,
+											   &probe->tag, HASH_FIND, NULL);
+	if (entry != NULL)
+	{
+		slot = GET_SPM_SHARED_PLAN_SLOT(entry->slot);
+		Assert(slot->valid);
+
+		data = palloc(slot->len + 1);
+		memcpy(data, slot->data, slot->len + 1);
+		plan_id = slot->plan_id;
+		spm_applyed = slot->spm_applyed;
+
+		if (pg_atomic_read_u32(&slot->usecount) < SPM_SHARED_PLAN_MAX_USAGE_COUNT)
+			pg_atomic_fetch_add_u32(&slot->usecount, 1);
+	}
+	LWLockRelease(&g_SPMSharedPlanCtl->lock);
+
+	if (data == NULL)
+		return NULL;
+
+	stmt = (PlannedStmt *) stringToNode(data);
+	pfree(data);
+	Assert(IsA(stmt, PlannedStmt));
+
+	/* The cached plan may come from a different multi-statement string */
+	stmt->stmt_location = parse->stmt_location;
+	stmt->stmt_len = parse->stmt_len;
+
+	pg_atomic_fetch_add_u64(&g_SPMSharedPlanCtl->hits, 1);
+
+	/*
+	 * As for a generic plan reused from the local plan cache, there is
+	 * nothing left for SPM to capture or validate.
+	 */
+	SetSkipSPMProcess();
+	SPMFillApplyedInfoExtended((int64) probe->tag.sql_id, plan_id, spm_applyed);
+
+	elog(level, "[SPM] shared plan cache hit sql_id[%u], plan_id[%ld]",
+		 probe->tag.sql_id, plan_id);
+
+	probe->cacheable = false;
+	return stmt;
+}
+
+/*
+ * Store a plan built after a failed SPMSharedPlanCacheLookup().
+ *
+ * The plan is dropped silently if it cannot be shared or if an invalidation
+ * arrived while it was being built, since it may then depend on catalog
+ * state that no longer exists.
+ */
+void
+SPMSharedPlanCacheStore(SPMSharedPlanProbe *probe, PlannedStmt *stmt)
+{
+	SPMSharedPlanEntry *entry;
+	SPMSharedPlanSlot  *slot;
+	ListCell   *lc;
+	char	   *data;
+	int			len;
+	int			i;
+	int			j;
+	bool		found;
+
+	if (!probe->cacheable)
+		return;
+	probe->cacheable = false;
+
+	/*
+	 * Plans SPM does not manage (fast query shipping, EXPLAIN SPM and the
+	 * like) carry state that does not survive serialization.
+	 */
+	if (CAP_SPMPLAN_ABNORMAL || stmt->commandType != CMD_SELECT ||
+		stmt->transientPlan || stmt->dependsOnRole ||
+		stmt->fqs_rte_list != NIL || stmt->guc_str != NULL ||
+		stmt->remoteparams != NULL ||
+		list_length(stmt->relationOids) > SPM_SHARED_PLAN_MAX_RELS ||
+		list_length(stmt->invalItems) > SPM_SHARED_PLAN_MAX_FUNCS)
+		return;
+
+	/* A baseline loaded while planning means the key is out of date */
+	if (SPMSharedPlanBaseline(probe->tag.sql_id) != probe->tag.baseline_id)
+		return;
+
+	data = nodeToString(stmt);
+	len = strlen(data);
+	if (len >= SPM_SHARED_PLAN_MAX_LEN)
+	{
+		pfree(data);
+		return;
+	}
+
+	LWLockAcquire(&g_SPMSharedPlanCtl->lock, LW_EXCLUSIVE);
+
+	if (pg_atomic_read_u64(&g_SPMSharedPlanCtl->generation) != probe->generation)
+	{
+		LWLockRelease(&g_SPMSharedPlanCtl->lock);
+		pfree(data);
+		return;
+	}
+
+	entry = (SPMSharedPlanEntry *) hash_search(g_SPMSharedPlanHashTab,
+											   &probe->tag, HASH_FIND, &found);
+	if (found)
+	{
+		/* Another session got there first */
+		LWLockRelease(&g_SPMSharedPlanCtl->lock);
+		pfree(data);
+		return;
+	}
+
+	i = SPMSharedPlanGetVictim();
+	slot = GET_SPM_SHARED_PLAN_SLOT(i);
+	if (slot->valid)
+		SPMSharedPlanEvict(slot);
+
+	entry = (SPMSharedPlanEntry *) hash_search(g_SPMSharedPlanHashTab,
+											   &probe->tag, HASH_ENTER, &found);
+	Assert(!found);
+	entry->slot = i;
+
+	slot->tag = probe->tag;
+	slot->plan_id = pre_spmplan->plan_id;
+	slot->spm_applyed = (save_spmplan_state & SAVE_SPMPLAN_APPLYED) != 0;
+	slot->nrelids = 0;
+	foreach(lc, stmt->relationOids)
+	{
+		Oid			relid = lfirst_oid(lc);
+
+		for (j = 0; j < slot->nrelids; j++)
+		{
+			if (slot->relids[j] == relid)
+				break;
+		}
+		if (j == slot->nrelids)
+			slot->relids[slot->nrelids++] = relid;
+	}
+	SPMSharedPlanLinkRels(slot);
+	slot->nfuncs = 0;
+	foreach(lc, stmt->invalItems)
+	{
+		PlanInvalItem *item = (PlanInvalItem *) lfirst(lc);
+
+		Assert(item->cacheId == PROCOID);
+		slot->func_hashes[slot->nfuncs++] = item->hashValue;
+	}
+	slot->len = len;
+	memcpy(slot->data, data, len + 1);
+	pg_atomic_write_u32(&slot->usecount, 1);
+	slot->valid = true;
+
+	LWLockRelease(&g_SPMSharedPlanCtl->lock);
+	pfree(data);
+
+	pg_atomic_fetch_add_u64(&g_SPMSharedPlanCtl->stores, 1);
+}
+
+/*
+ * Drop every cached plan, e.g. after the shard map has changed.
+ */
+void
+SPMSharedPlanCacheReset(void)
+{
+	if (spm_plan_cache_size <= 0 || g_SPMSharedPlanCtl == NULL)
+		return;
+
+	SPMSharedPlanInvalidate(InvalidOid);
+}
+
+/*
+ * Return the id of the fixed baseline SPM would apply to sql_id, or 0.
+ */
+static int64
+SPMSharedPlanBaseline(uint32 sql_id)
+{
+	int64		plan_id = 0;
+
+	if (!optimizer_use_sql_plan_baselines)
+		return 0;
+
+	if (GetSPMBindHint((int64) sql_id, &plan_id, NULL) != SPM_PLAN_CACHE_FIXED)
+		return 0;
+
+	return plan_id;
+}
+
+/*
+ * Hash everything besides the sql_id that decides the plan of the query.
+ * sql_id only covers the normalized statement, so the analyzed tree is
+ * hashed as well; it also records the types of any parameters.
+ */
+static void
+SPMSharedPlanShapeHash(Query *parse, SPMSharedPlanTag *tag)
+{
+	StringInfoData buf;
+	struct config_generic **gucs;
+	char	   *tree;
+	int			num;
+	int			i;
+
+	initStringInfo(&buf);
+
+	tree = nodeToString(parse);
+	appendStringInfoString(&buf, tree);
+	pfree(tree);
+
+	/* Hints in the source text */
+	appendStringInfoChar(&buf, '\0');
+	if (debug_query_string)
+		appendStringInfoString(&buf, debug_query_string);
+
+	/* Functions inlined by the planner resolve names in search_path */
+	appendStringInfoChar(&buf, '\0');
+	appendStringInfoString(&buf, namespace_search_path);
+
+	gucs = get_explain_guc_options(&num);
+	for (i = 0; i < num; i++)
+	{
+		char	   *value = GetConfigOptionByName(gucs[i]->name, NULL, true);
+
+		appendStringInfo(&buf, "%c%s=%s", '\0', gucs[i]->name,
+						 value ? value : "");
+	}
+	pfree(gucs);
+
+	tag->shape_len = buf.len;
+	tag->shape_hash = DatumGetUInt64(hash_any_extended((unsigned char *) buf.data,
+													   buf.len, 0));
+	pfree(buf.data);
+}
+
+/*
+ * Add a slot to the chains of the relations its plan depends on.  Caller
+ * holds the lock exclusively.
+ */
+static void
+SPMSharedPlanLinkRels(SPMSharedPlanSlot *slot)
+{
+	SPMSharedPlanRelEntry *entry;
+	bool		found;
+	int			j;
+
+	for (j = 0; j < slot->nrelids; j++)
+	{
+		int			link = SPM_SHARED_PLAN_REL_LINK(slot->id, j);
+
+		entry = (SPMSharedPlanRelEntry *) hash_search(g_SPMSharedPlanRelHashTab,
+													  &slot->relids[j],
+													  HASH_ENTER, &found);
+		if (!found)
+			entry->head = -1;
+
+		slot->rel_prev[j] = -1;
+		slot->rel_next[j] = entry->head;
+		if (entry->head >= 0)
+			SPM_SHARED_PLAN_LINK_SLOT(entry->head)->rel_prev[SPM_SHARED_PLAN_LINK_POS(entry->head)] = link;
+		entry->head = link;
+	}
+}
+
+/*
+ * Remove a slot from the chains of its relations, dropping the chains that
+ * become empty.  Caller holds the lock exclusively.
+ */
+static void
+SPMSharedPlanUnlinkRels(SPMSharedPlanSlot *slot)
+{
+	SPMSharedPlanRelEntry *entry;
+	int			j;
+
+	for (j = 0; j < slot->nrelids; j++)
+	{
+		int			prev = slot->rel_prev[j];
+		int			next = slot->rel_next[j];
+
+		if (prev >= 0)
+			SPM_SHARED_PLAN_LINK_SLOT(prev)->rel_next[SPM_SHARED_PLAN_LINK_POS(prev)] = next;
+		else
+		{
+			entry = (SPMSharedPlanRelEntry *) hash_search(g_SPMSharedPlanRelHashTab,
+														  &slot->relids[j],
+														  HASH_FIND, NULL);
+			Assert(entry != NULL);
+			if (next >= 0)
+				entry->head = next;
+			else
+				hash_search(g_SPMSharedPlanRelHashTab, &slot->relids[j],
+							HASH_REMOVE, NULL);
+		}
+
+		if (next >= 0)
+			SPM_SHARED_PLAN_LINK_SLOT(next)->rel_prev[SPM_SHARED_PLAN_LINK_POS(next)] = prev;
+	}
+	slot->nrelids = 0;
+}
+
+/*
+ * Remove the hash table entries of a slot.  Caller holds the lock
+ * exclusively.
+ */
+static void
+SPMSharedPlanEvict(SPMSharedPlanSlot *slot)
+{
+	bool		found;
+
+	SPMSharedPlanUnlinkRels(slot);
+	hash_search(g_SPMSharedPlanHashTab, &slot->tag, HASH_REMOVE, &found);
+	Assert(found);
+	slot->valid = false;
+}
+
+/*
+ * Pick the slot for a new plan with a clock sweep over the slots.  Caller
+ * holds the lock exclusively.
+ */
+static int
+SPMSharedPlanGetVictim(void)
+{
+	for (;;)
+	{
+		int			victim = g_SPMSharedPlanCtl->next_victim;
+		SPMSharedPlanSlot *slot = GET_SPM_SHARED_PLAN_SLOT(victim);
+
+		g_SPMSharedPlanCtl->next_victim = (victim + 1) % spm_plan_cache_size;
+
+		if (!slot->valid || pg_atomic_read_u32(&slot->usecount) == 0)
+			return victim;
+
+		pg_atomic_fetch_sub_u32(&slot->usecount, 1);
+	}
+}
+
+/*
+ * Drop the plans that depend on relid, or all plans if relid is InvalidOid.
+ *
+ * Every backend runs this for every relcache invalidation, and most of them
+ * concern relations no cached plan uses, so the relation is looked up under
+ * a shared lock first.  Bumping the generation beforehand is enough to keep
+ * out a plan that is being built concurrently: its store either sees the
+ * new generation or finishes before the lookup below and is found by it.
+ */
+static void
+SPMSharedPlanInvalidate(Oid relid)
+{
+	SPMSharedPlanRelEntry *entry;
+	uint64		ndropped = 0;
+	int			i;
+
+	pg_atomic_fetch_add_u64(&g_SPMSharedPlanCtl->generation, 1);
+
+	if (OidIsValid(relid))
+	{
+		LWLockAcquire(&g_SPMSharedPlanCtl->lock, LW_SHARED);
+		entry = (SPMSharedPlanRelEntry *) hash_search(g_SPMSharedPlanRelHashTab,
+													  &relid, HASH_FIND, NULL);
+		LWLockRelease(&g_SPMSharedPlanCtl->lock);
+
+		if (entry == NULL)
+			return;
+	}
+
+	LWLockAcquire(&g_SPMSharedPlanCtl->lock, LW_EXCLUSIVE);
+
+	if (OidIsValid(relid))
+	{
+		/* Evicting the last plan of the chain removes the entry */
+		while ((entry = (SPMSharedPlanRelEntry *)
+				hash_search(g_SPMSharedPlanRelHashTab, &relid,
+							HASH_FIND, NULL)) != NULL)
+		{
+			SPMSharedPlanEvict(SPM_SHARED_PLAN_LINK_SLOT(entry->head));
+			ndropped++;
+		}
+	}
+	else
+	{
+		for (i = 0; i < spm_plan_cache_size; i++)
+		{
+			SPMSharedPlanSlot *slot = GET_SPM_SHARED_PLAN_SLOT(i);
+
+			if (slot->valid)
+			{
+				SPMSharedPlanEvict(slot);
+				ndropped++;
+			}
+		}
+	}
+
+	LWLockRelease(&g_SPMSharedPlanCtl->lock);
+
+	if (ndropped > 0)
+		pg_atomic_fetch_add_u64(&g_SPMSharedPlanCtl->invalidations, ndropped);
+}
+
+/*
+ * Drop the plans that depend on the function with the given PROCOID hash
+ * value, or all plans that depend on any function if hashvalue is 0.
+ */
+static void
+SPMSharedPlanInvalidateFunc(uint32 hashvalue)
+{
+	int			i;
+	int			j;
+	uint64		ndropped = 0;
+
+	LWLockAcquire(&g_SPMSharedPlanCtl->lock, LW_EXCLUSIVE);
+	pg_atomic_fetch_add_u64(&g_SPMSharedPlanCtl->generation, 1);
+
+	for (i = 0; i < spm_plan_cache_size; i++)
+	{
+		SPMSharedPlanSlot *slot = GET_SPM_SHARED_PLAN_SLOT(i);
+
+		if (!slot->valid)
+			continue;
+
+		for (j = 0; j < slot->nfuncs; j++)
+		{
+			if (hashvalue == 0 || slot->func_hashes[j] == hashvalue)
+			{
+				SPMSharedPlanEvict(slot);
+				ndropped++;
+				break;
+			}
+		}
+	}
+
+	LWLockRelease(&g_SPMSharedPlanCtl->lock);
+
+	if (ndropped > 0)
+		pg_atomic_fetch_add_u64(&g_SPMSharedPlanCtl->invalidations, ndropped);
+}
+
+static void
+SPMSharedPlanRelCallback(Datum arg, Oid relid)
+{
+	SPMSharedPlanInvalidate(relid);
+}
+
+static void
+SPMSharedPlanFuncCallback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	SPMSharedPlanInvalidateFunc(hashvalue);
+}
+
+static void
+SPMSharedPlanSysCallback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	SPMSharedPlanInvalidate(InvalidOid);
+}
+
+/*
+ * Report the number of plans in the shared plan cache and how often plans
+ * were reused, stored and dropped by invalidations since startup.
+ */
+Datum
+pg_spm_shared_plan_cache_stats(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	Datum		values[4];
+	bool		nulls[4];
+	long		entries = 0;
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	memset(values, 0, sizeof(values));
+	memset(nulls, 0, sizeof(nulls));
+
+	if (spm_plan_cache_size > 0 && g_SPMSharedPlanCtl != NULL)
+	{
+		LWLockAcquire(&g_SPMSharedPlanCtl->lock, LW_SHARED);
+		entries = hash_get_num_entries(g_SPMSharedPlanHashTab);
+		LWLockRelease(&g_SPMSharedPlanCtl->lock);
+
+		values[1] = Int64GetDatum((int64) pg_atomic_read_u64(&g_SPMSharedPlanCtl->hits));
+		values[2] = Int64GetDatum((int64) pg_atomic_read_u64(&g_SPMSharedPlanCtl->stores));
+		values[3] = Int64GetDatum((int64) pg_atomic_read_u64(&g_SPMSharedPlanCtl->invalidations));
+	}
+	else
+	{
+		values[1] = Int64GetDatum(0);
+		values[2] = Int64GetDatum(0);
+		values[3] = Int64GetDatum(0);
+	}
+	values[0] = Int32GetDatum((int32) entries);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -243,9 +243,11 @@ PlanTreeMemWalker(Node *node, PlanMemWalkerContext *ctx)
 		/* memory intensive node */
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 			calc_tuplestore_mem((Plan *)node, ctx);
 			break;
 		case T_Hash:
+		case T_Memoize:
 			calc_hashtable_mem((Plan *)node, ctx);
 			break;
 		case T_SetOp:
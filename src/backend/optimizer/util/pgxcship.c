@@ -1084,6 +1084,120 @@ create_dis_col_eval(Node *quals, AttrNumber discol)
 	return result;
 }
 
+/*
+ * create_dis_col_array_eval
+ * Find a top-level "discol = ANY ($n)" qual whose array is an external Param
+ * of the distribution column's array type and return that Param, so the
+ * Datanodes can be chosen from the listed keys at execution time.
+ */
+static Param *
+create_dis_col_array_eval(Node *quals, AttrNumber discol, Oid distype)
+{
+	if (!quals)
+		return NULL;
+
+	if (IsA(quals, ScalarArrayOpExpr))
+	{
+		ScalarArrayOpExpr *saop = (ScalarArrayOpExpr *) quals;
+		Expr	   *lexpr;
+		Expr	   *rexpr;
+
+		if (!saop->useOr || list_length(saop->args) != 2)
+			return NULL;
+
+		lexpr = linitial(saop->args);
+		rexpr = lsecond(saop->args);
+
+		if (IsA(lexpr, RelabelType))
+			lexpr = ((RelabelType *) lexpr)->arg;
+
+		if (!IsA(lexpr, Var) || ((Var *) lexpr)->varattno != discol ||
+			((Var *) lexpr)->varlevelsup != 0 ||
+			exprType((Node *) lexpr) != distype)
+			return NULL;
+
+		if (!IsA(rexpr, Param) || ((Param *) rexpr)->paramkind != PARAM_EXTERN)
+			return NULL;
+
+		/*
+		 * Keys are hashed with the distribution column type, so the array
+		 * elements must already be of that type.
+		 */
+		if (exprType((Node *) rexpr) != get_array_type(distype))
+			return NULL;
+
+		/* must be '=' */
+		if (!op_mergejoinable(saop->opno, distype) &&
+			!op_hashjoinable(saop->opno, distype))
+			return NULL;
+
+		return (Param *) copyObject(rexpr);
+	}
+	else if (IsA(quals, BoolExpr) && ((BoolExpr *) quals)->boolop == AND_EXPR)
+	{
+		ListCell   *lc;
+
+		foreach(lc, ((BoolExpr *) quals)->args)
+		{
+			Param	   *result;
+
+			result = create_dis_col_array_eval((Node *) lfirst(lc), discol,
+											   distype);
+			if (result)
+				return result;
+		}
+	}
+
+	return NULL;
+}
+
+typedef struct
+{
+	int			paramid;
+	int			count;
+} param_refs_context;
+
+static bool
+count_param_refs_walker(Node *node, param_refs_context *context)
+{
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+
+		if (param->paramkind == PARAM_EXTERN &&
+			param->paramid == context->paramid)
+			context->count++;
+		return false;
+	}
+
+	if (IsA(node, Query))
+		return query_tree_walker((Query *) node, count_param_refs_walker,
+								 (void *) context, 0);
+
+	return expression_tree_walker(node, count_param_refs_walker,
+								  (void *) context);
+}
+
+/*
+ * pgxc_query_param_refs
+ * Count how many times the external parameter paramid is referenced in query.
+ */
+static int
+pgxc_query_param_refs(Query *query, int paramid)
+{
+	param_refs_context context;
+
+	context.paramid = paramid;
+	context.count = 0;
+	(void) query_tree_walker(query, count_param_refs_walker,
+							 (void *) &context, 0);
+
+	return context.count;
+}
+
 /*
  * pgxc_FQS_get_relation_nodes
  * Return ExecNodes structure so as to decide which node the query should
@@ -1327,6 +1441,30 @@ retry_pools:
 
 						rel_exec_nodes->dis_exprs[i] = dis_expr;
 					}
+
+					/*
+					 * For "discol = ANY ($n)", the Datanodes owning the listed
+					 * keys are picked at execution time. If $n is used by this
+					 * qual only, each Datanode can also be sent just its own
+					 * keys.
+					 */
+					if (rel_loc_info->nDisAttrs == 1 &&
+						!rel_exec_nodes->dis_exprs[0])
+					{
+						Param  *param;
+
+						param = create_dis_col_array_eval(quals,
+														  rel_loc_info->disAttrNums[0],
+														  rel_loc_info->disAttrTypes[0]);
+						if (param)
+						{
+							rel_exec_nodes->dis_exprs[0] = (Expr *) param;
+							rel_exec_nodes->dis_is_array = true;
+							if (!query->hasSubLinks &&
+								pgxc_query_param_refs(query, param->paramid) == 1)
+								rel_exec_nodes->dis_split_paramid = param->paramid;
+						}
+					}
 				}
 			}
 		}
@@ -2411,6 +2549,10 @@ has_all_dis_exprs(ExecNodes *exec_nodes)
 	if (exec_nodes == NULL)
 		return false;
 
+	/* A list of keys may still span several Datanodes */
+	if (exec_nodes->dis_is_array)
+		return false;
+
 	for (i = 0; i < exec_nodes->nExprs; i++)
 	{
 		if (exec_nodes->dis_exprs[i] == NULL)
@@ -31,6 +31,7 @@
 #include "catalog/pg_type.h"
 #include "nodes/pg_list.h"
 #include "nodes/nodeFuncs.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/catcache.h"
 #include "utils/fmgroids.h"
@@ -159,6 +160,12 @@ static int locate_modulo_select(Locator *self,
 
 static Expr *get_attr_expression(Oid reloid, Index varno, Node *quals, List *rtable,
                                  AttrNumber attrNum, ParamListInfo boundParams);
+static Expr *pgxc_find_distcol_array_expr(Index varno, AttrNumber attrNum,
+                                          Node *quals, List *rtable);
+static ExecNodes *GetRelationNodesByValueList(RelationLocInfo *rel_loc_info,
+                                              Index varno, Node *quals, List *rtable,
+                                              RelationAccessType accessType,
+                                              ParamListInfo boundParams);
 #endif
 
 static bool DatanodeInGroup(Oid* nodeoids, int nodenums, Oid nodeoid);
@@ -2191,6 +2198,65 @@ GetRelationNodes(RelationLocInfo *rel_loc_info,
 	return exec_nodes;
 }
 
+/*
+ * GetRelationNodesOfValues
+ * For a table distributed by a single column, return a palloc'd array giving
+ * for each of the nvalues distribution column values the index of the
+ * Datanode holding it, or -1 if the value is NULL or not bound to a single
+ * Datanode.
+ */
+int *
+GetRelationNodesOfValues(RelationLocInfo *rel_loc_info,
+						 Datum *values, bool *nulls, int nvalues,
+						 RelationAccessType accessType)
+{
+	int		   *result;
+	int		   *nodenums;
+	int			i, count;
+	Locator	   *locator;
+
+	Assert(rel_loc_info->nDisAttrs == 1);
+
+	result = (int *) palloc(sizeof(int) * nvalues);
+
+#ifdef  _MIGRATE_
+	locator = createLocator(rel_loc_info->locatorType,
+							accessType,
+							LOCATOR_LIST_LIST,
+							0,
+							(void *)rel_loc_info->rl_nodeList,
+							(void **)&nodenums,
+							false,
+							rel_loc_info->groupId,
+							rel_loc_info->disAttrTypes,
+							rel_loc_info->disAttrNums,
+							rel_loc_info->nDisAttrs, NULL);
+#else
+	locator = createLocator(rel_loc_info->locatorType,
+							accessType,
+							typeOfValueForDistCol,
+							LOCATOR_LIST_LIST,
+							0,
+							(void *)rel_loc_info->rl_nodeList,
+							(void **)&nodenums,
+							false, NULL);
+#endif
+	for (i = 0; i < nvalues; i++)
+	{
+		if (nulls[i])
+		{
+			result[i] = -1;
+			continue;
+		}
+
+		count = GET_NODES(locator, &values[i], &nulls[i], 1, NULL);
+		result[i] = (count == 1) ? nodenums[0] : -1;
+	}
+	freeLocator(locator);
+
+	return result;
+}
+
 /*
  * GetRelationNodesForExplain
  * This is just for explain statement, just pick one datanode.
@@ -2228,6 +2294,18 @@ GetSimpleNodesByQuals(RelationLocInfo *rel_loc_info, Index varno,
 	{
 		int             i = 0;
 
+		/* distcol IN (...) restricts us to the nodes owning the listed keys */
+		if (rel_loc_info->nDisAttrs == 1 &&
+			!pgxc_find_distcol_expr(varno, rel_loc_info->disAttrNums[0],
+									quals, rtable))
+		{
+			exec_nodes = GetRelationNodesByValueList(rel_loc_info, varno,
+													 quals, rtable, relaccess,
+													 boundParams);
+			if (exec_nodes)
+				return exec_nodes;
+		}
+
 		/* for multi-distribution-columns */
 		disvalues = (Datum *) palloc(sizeof(Datum) * rel_loc_info->nDisAttrs);
 		disisnulls = (bool *) palloc(sizeof(bool) * rel_loc_info->nDisAttrs);
@@ -2246,8 +2324,6 @@ GetSimpleNodesByQuals(RelationLocInfo *rel_loc_info, Index varno,
 			 * the distribution column type, try casting it. This is same as what
 			 * will happen in case of inserting that type of expression value as the
 			 * distribution column value.
-			 * 
-			 * XXX: Not consider ArrayExpr now, may be fix later.
 			 */
 			if (distcol_expr)
 			{
@@ -2380,6 +2456,21 @@ GetRelationNodesByQuals(Oid reloid,
 			ndiscols = 1;
 			disvalues[0] = (Datum) 0;
 			disisnulls[0] = true;
+
+			/* distcol IN (...) restricts us to the nodes owning the listed keys */
+			if (!RelationOidIsCrossNodeIndex(reloid))
+			{
+				exec_nodes = GetRelationNodesByValueList(rel_loc_info, varno,
+														 quals, rtable,
+														 relaccess,
+														 boundParams);
+				if (exec_nodes)
+				{
+					pfree(disvalues);
+					pfree(disisnulls);
+					return exec_nodes;
+				}
+			}
 		}
 	}
 
@@ -2556,6 +2647,174 @@ pgxc_find_distcol_expr(Index varno, AttrNumber attrNum,
 	return NULL;
 }
 
+/*
+ * pgxc_find_distcol_array_expr
+ * Like pgxc_find_distcol_expr, but look for a qual of the form
+ * <distribution_col> = ANY (<array expr>), which is what an IN list of
+ * constants turns into. Return the array expression if found.
+ */
+static Expr *
+pgxc_find_distcol_array_expr(Index varno, AttrNumber attrNum,
+							 Node *quals, List *rtable)
+{
+	List *lquals;
+	ListCell *qual_cell;
+
+	if (!quals)
+		return NULL;
+
+	if (!IsA(quals, List))
+		lquals = make_ands_implicit((Expr *)quals);
+	else
+		lquals = (List *)quals;
+
+	foreach(qual_cell, lquals)
+	{
+		Expr *qual_expr = (Expr *)lfirst(qual_cell);
+		ScalarArrayOpExpr *saop;
+		Expr *lexpr;
+		Var *var_expr;
+
+		if (!IsA(qual_expr, ScalarArrayOpExpr))
+			continue;
+		saop = (ScalarArrayOpExpr *)qual_expr;
+		/* Only "= ANY" selects a set of distribution values */
+		if (!saop->useOr || list_length(saop->args) != 2)
+			continue;
+
+		lexpr = linitial(saop->args);
+		if (IsA(lexpr, RelabelType))
+			lexpr = ((RelabelType *)lexpr)->arg;
+		if (!IsA(lexpr, Var))
+			continue;
+		var_expr = (Var *)lexpr;
+
+		/* outer reference variable, skip */
+		if (var_expr->varlevelsup != 0)
+			continue;
+
+		if (var_expr->varno != varno || var_expr->varattno != attrNum)
+		{
+			RangeTblEntry *rte;
+			Var *var;
+
+			if (rtable == NULL)
+				continue;
+			rte = rt_fetch(var_expr->varno, rtable);
+			if (rte->rtekind != RTE_JOIN)
+				continue;
+			var = (Var *) list_nth(rte->joinaliasvars, var_expr->varattno - 1);
+			if (var == NULL || !IsA(var, Var) ||
+				var->varno != varno || var->varattno != attrNum)
+				continue;
+		}
+
+		/* See pgxc_find_distcol_expr for why this identifies equality */
+		if (!op_mergejoinable(saop->opno, exprType((Node *)lexpr)) &&
+			!op_hashjoinable(saop->opno, exprType((Node *)lexpr)))
+			continue;
+
+		return (Expr *) lsecond(saop->args);
+	}
+
+	return NULL;
+}
+
+/*
+ * GetRelationNodesByValueList
+ * For a table distributed by a single column, compute the Datanodes holding
+ * rows that satisfy "distcol IN (const, ...)" as the union of the nodes of
+ * each listed value, so a long IN list is only shipped to the nodes that can
+ * produce a match. Returns NULL if the quals do not allow such a reduction.
+ */
+static ExecNodes *
+GetRelationNodesByValueList(RelationLocInfo *rel_loc_info,
+							Index varno, Node *quals, List *rtable,
+							RelationAccessType accessType,
+							ParamListInfo boundParams)
+{
+	Oid			disttype = rel_loc_info->disAttrTypes[0];
+	int32		disttypmod = rel_loc_info->disAttrTypMods[0];
+	Oid			arraytype;
+	Expr	   *array_expr;
+	ArrayType  *arr;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elems;
+	bool	   *elemnulls;
+	int			nelems;
+	int		   *elemnodes;
+	int			i;
+	ExecNodes  *exec_nodes;
+
+	array_expr = pgxc_find_distcol_array_expr(varno,
+											  rel_loc_info->disAttrNums[0],
+											  quals, rtable);
+	if (array_expr == NULL)
+		return NULL;
+
+	arraytype = get_array_type(disttype);
+	if (!OidIsValid(arraytype))
+		return NULL;
+
+	/* Cast the list to the distribution column type, as for a single value */
+	array_expr = (Expr *) coerce_to_target_type(NULL,
+												(Node *) array_expr,
+												exprType((Node *) array_expr),
+												arraytype, disttypmod,
+												COERCION_ASSIGNMENT,
+												COERCE_IMPLICIT_CAST, -1);
+	if (array_expr == NULL)
+		return NULL;
+	array_expr = (Expr *) eval_const_expressions_with_params(boundParams,
+															 (Node *) array_expr);
+	if (!IsA(array_expr, Const) || ((Const *) array_expr)->constisnull)
+		return NULL;
+
+	arr = DatumGetArrayTypeP(((Const *) array_expr)->constvalue);
+	get_typlenbyvalalign(ARR_ELEMTYPE(arr), &typlen, &typbyval, &typalign);
+	deconstruct_array(arr, ARR_ELEMTYPE(arr), typlen, typbyval, typalign,
+					  &elems, &elemnulls, &nelems);
+
+	exec_nodes = makeNode(ExecNodes);
+	exec_nodes->baselocatortype = rel_loc_info->locatorType;
+	exec_nodes->accesstype = accessType;
+	exec_nodes->g_index_table_name = NULL;
+
+	elemnodes = GetRelationNodesOfValues(rel_loc_info, elems, elemnulls,
+										 nelems, accessType);
+	for (i = 0; i < nelems; i++)
+	{
+		/* NULL never matches "=", so it needs no node */
+		if (elemnulls[i])
+			continue;
+
+		/* The value is not bound to a single node, go everywhere */
+		if (elemnodes[i] < 0)
+		{
+			list_free(exec_nodes->nodeList);
+			exec_nodes->nodeList = NIL;
+			break;
+		}
+
+		exec_nodes->nodeList = list_append_unique_int(exec_nodes->nodeList,
+													  elemnodes[i]);
+	}
+
+	pfree(elemnodes);
+	pfree(elems);
+	pfree(elemnulls);
+
+	if (exec_nodes->nodeList == NIL)
+	{
+		pfree(exec_nodes);
+		return NULL;
+	}
+
+	return exec_nodes;
+}
+
 static Expr *
 get_attr_expression(Oid reloid, Index varno, Node *quals, List *rtable,
 					AttrNumber attrNum, ParamListInfo boundParams)
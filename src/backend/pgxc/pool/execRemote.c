@@ -55,6 +55,7 @@
 #include "utils/pg_rusage.h"
 #include "utils/tuplesort.h"
 #include "utils/snapmgr.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "pgxc/locator.h"
 #include "pgxc/pgxc.h"
@@ -171,6 +172,7 @@ static void pgxc_node_remote_abort(TranscationType txn_type, bool need_release_h
 static int getStatsLen(AnalyzeRelStats *analyzeStats);
 static int pgxc_node_send_stat(PGXCNodeHandle * handle, AnalyzeRelStats *analyzeStats);
 static ExecNodes *paramGetExecNodes(ExecNodes *origin, PlanState *planstate);
+static ExecNodes *paramGetExecNodesForArray(ExecNodes *origin, PlanState *planstate);
 static int handle_reply_msg_on_proxy(PGXCNodeHandle *conn);
 static int pgxc_node_send_spm_plan(PGXCNodeHandle * handle,
 									LocalSPMPlanInfo *spmplan);
@@ -6811,6 +6813,20 @@ pgxc_start_command_on_connection(PGXCNodeHandle *connection,
 	{
 		/* need to use Extended Query Protocol */
 		int	fetch = 0;
+		char   *paramval_data = remotestate->paramval_data;
+		int		paramval_len = remotestate->paramval_len;
+		int		i;
+
+		/* This node may only need part of an IN-list parameter */
+		for (i = 0; i < remotestate->rqs_split_count; i++)
+		{
+			if (remotestate->rqs_split_nodes[i] == connection->nodeidx)
+			{
+				paramval_data = remotestate->rqs_split_paramval_data[i];
+				paramval_len = remotestate->rqs_split_paramval_len[i];
+				break;
+			}
+		}
 
 		/*
 		 * execute and fetch rows only if they will be consumed
@@ -6842,8 +6858,8 @@ pgxc_start_command_on_connection(PGXCNodeHandle *connection,
 							step->cursor,
 							remotestate->rqs_num_params,
 							remotestate->rqs_param_types,
-							remotestate->paramval_len,
-							remotestate->paramval_data,
+							paramval_len,
+							paramval_data,
 							remotestate->rqs_param_formats,
 							remotestate->rqs_num_params,
 							step->has_row_marks ? true : step->read_only,
@@ -9892,6 +9908,13 @@ determine_param_types(Plan *plan,  struct find_params_context *context)
 				return true;
 			break;
 
+		case T_Memoize:
+			if (expression_tree_walker((Node *) ((Memoize *) plan)->param_exprs,
+									   determine_param_types_walker,
+									   (void *) context))
+				return true;
+			break;
+
 		case T_RecursiveUnion:
 			break;
 
@@ -9912,6 +9935,7 @@ determine_param_types(Plan *plan,  struct find_params_context *context)
 		case T_Agg:
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_Group:
@@ -12244,6 +12268,9 @@ paramGetExecNodes(ExecNodes *origin, PlanState *planstate)
 	MemoryContext	 oldcontext;
 	RelationLocInfo *rel_loc_info;
 
+	if (origin->dis_is_array)
+		return paramGetExecNodesForArray(origin, planstate);
+
 	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
 
 	rel_loc_info = GetRelationLocInfo(origin->en_relid);
@@ -12340,6 +12367,229 @@ paramGetExecNodes(ExecNodes *origin, PlanState *planstate)
 }
 
 
+/*
+ * Copy the parameter data row of rqstate, replacing the value of parameter
+ * paramid with the given text.
+ */
+static void
+replace_paramval(RemoteQueryState *rqstate, int paramid,
+				 const char *value, int valuelen,
+				 char **data, int *len)
+{
+	StringInfoData buf;
+	const char *p = rqstate->paramval_data;
+	uint16		n16;
+	int			nparams;
+	int			i;
+
+	initStringInfo(&buf);
+
+	memcpy(&n16, p, 2);
+	nparams = pg_ntoh16(n16);
+	appendBinaryStringInfo(&buf, p, 2);
+	p += 2;
+
+	for (i = 0; i < nparams; i++)
+	{
+		uint32		n32;
+		int32		plen;
+
+		memcpy(&n32, p, 4);
+		plen = (int32) pg_ntoh32(n32);
+		p += 4;
+
+		if (i == paramid - 1)
+		{
+			n32 = pg_hton32(valuelen);
+			appendBinaryStringInfo(&buf, (char *) &n32, 4);
+			appendBinaryStringInfo(&buf, value, valuelen);
+		}
+		else
+		{
+			appendBinaryStringInfo(&buf, (char *) &n32, 4);
+			if (plen > 0)
+				appendBinaryStringInfo(&buf, p, plen);
+		}
+
+		if (plen > 0)
+			p += plen;
+	}
+
+	*data = buf.data;
+	*len = buf.len;
+}
+
+/*
+ * paramGetExecNodesForArray
+ * Execution time determining of target Datanodes for "distcol = ANY ($n)":
+ * the union of the nodes owning the listed keys. If the planner found that
+ * $n may be split (dis_split_paramid), also prepare for every target node a
+ * copy of the parameters where $n only holds the keys stored on that node;
+ * pgxc_start_command_on_connection picks them up.
+ */
+static ExecNodes *
+paramGetExecNodesForArray(ExecNodes *origin, PlanState *planstate)
+{
+	ExprContext *econtext = planstate->ps_ExprContext;
+	EState	   *estate = planstate->state;
+	RemoteQueryState *rqstate = NULL;
+	RelationLocInfo *rel_loc_info;
+	ExecNodes  *nodes = NULL;
+	MemoryContext oldcontext;
+	Expr	   *expr;
+	ExprState  *exprstate;
+	Datum		arraydatum = (Datum) 0;
+	bool		arrayisnull = true;
+
+	if (IsA(planstate, RemoteQueryState))
+	{
+		rqstate = (RemoteQueryState *) planstate;
+		rqstate->rqs_split_count = 0;
+	}
+
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	rel_loc_info = GetRelationLocInfo(origin->en_relid);
+	Assert(rel_loc_info->nDisAttrs == 1);
+
+	expr = (Expr *) eval_const_expressions_with_params(estate->es_param_list_info,
+													   (Node *) origin->dis_exprs[0]);
+	fix_opfuncids((Node *) expr);
+	exprstate = ExecInitExpr(expr, planstate);
+	if (!(estate->es_top_eflags & EXEC_FLAG_EXPLAIN_ONLY))
+		arraydatum = ExecEvalExpr(exprstate, econtext, &arrayisnull);
+
+	if (estate->es_top_eflags & EXEC_FLAG_EXPLAIN_ONLY)
+		nodes = GetRelationNodesForExplain(rel_loc_info, origin->accesstype);
+	else if (!arrayisnull)
+	{
+		ArrayType  *arr = DatumGetArrayTypeP(arraydatum);
+		Oid			elemtype = ARR_ELEMTYPE(arr);
+		int16		typlen;
+		bool		typbyval;
+		char		typalign;
+		Datum	   *elems;
+		bool	   *elemnulls;
+		int		   *elemnodes;
+		int			nelems;
+		int			i;
+
+		get_typlenbyvalalign(elemtype, &typlen, &typbyval, &typalign);
+		deconstruct_array(arr, elemtype, typlen, typbyval, typalign,
+						  &elems, &elemnulls, &nelems);
+		elemnodes = GetRelationNodesOfValues(rel_loc_info, elems, elemnulls,
+											 nelems, origin->accesstype);
+
+		nodes = makeNode(ExecNodes);
+		nodes->baselocatortype = rel_loc_info->locatorType;
+		nodes->accesstype = origin->accesstype;
+		for (i = 0; i < nelems; i++)
+		{
+			/* NULL never matches "=", so it needs no node */
+			if (elemnulls[i])
+				continue;
+			/* The value is not bound to a single node, go everywhere */
+			if (elemnodes[i] < 0)
+			{
+				pfree(nodes);
+				nodes = NULL;
+				break;
+			}
+			nodes->nodeList = list_append_unique_int(nodes->nodeList,
+													 elemnodes[i]);
+		}
+
+		if (nodes && nodes->nodeList == NIL)
+		{
+			pfree(nodes);
+			nodes = NULL;
+		}
+
+		/*
+		 * Send each node only its own keys. The qual is a top-level AND
+		 * condition and $n appears nowhere else, so dropping keys owned by
+		 * other nodes (and NULLs, which never match) cannot change the rows
+		 * a node returns.
+		 */
+		if (nodes && rqstate && origin->dis_split_paramid > 0 &&
+			rqstate->paramval_data &&
+			origin->dis_split_paramid <= rqstate->rqs_num_params &&
+			((RemoteQuery *) planstate->plan)->exec_type == EXEC_ON_DATANODES)
+		{
+			int			paramid = origin->dis_split_paramid;
+			Datum	   *subset = (Datum *) palloc(sizeof(Datum) * nelems);
+			Oid			typoutput;
+			bool		typisvarlena;
+			ListCell   *lc;
+			int			n = 0;
+
+			getTypeOutputInfo(rqstate->rqs_param_types[paramid - 1],
+							  &typoutput, &typisvarlena);
+
+			/*
+			 * The per-node arrays are sized for every Datanode once, the
+			 * parameter copies live in a context reset on each execution.
+			 */
+			Assert(list_length(nodes->nodeList) <= NumDataNodes);
+			if (rqstate->rqs_split_context == NULL)
+			{
+				rqstate->rqs_split_context =
+					AllocSetContextCreate(estate->es_query_cxt,
+										  "RemoteQuery split parameters",
+										  ALLOCSET_SMALL_SIZES);
+				rqstate->rqs_split_nodes = (int *)
+					MemoryContextAlloc(estate->es_query_cxt,
+									   sizeof(int) * NumDataNodes);
+				rqstate->rqs_split_paramval_data = (char **)
+					MemoryContextAlloc(estate->es_query_cxt,
+									   sizeof(char *) * NumDataNodes);
+				rqstate->rqs_split_paramval_len = (int *)
+					MemoryContextAlloc(estate->es_query_cxt,
+									   sizeof(int) * NumDataNodes);
+			}
+			else
+				MemoryContextReset(rqstate->rqs_split_context);
+
+			foreach(lc, nodes->nodeList)
+			{
+				int			nodeidx = lfirst_int(lc);
+				int			nsubset = 0;
+				ArrayType  *subarr;
+				char	   *value;
+
+				for (i = 0; i < nelems; i++)
+				{
+					if (!elemnulls[i] && elemnodes[i] == nodeidx)
+						subset[nsubset++] = elems[i];
+				}
+				subarr = construct_array(subset, nsubset, elemtype,
+										 typlen, typbyval, typalign);
+				value = OidOutputFunctionCall(typoutput,
+											  PointerGetDatum(subarr));
+
+				MemoryContextSwitchTo(rqstate->rqs_split_context);
+				rqstate->rqs_split_nodes[n] = nodeidx;
+				replace_paramval(rqstate, paramid, value, strlen(value),
+								 &rqstate->rqs_split_paramval_data[n],
+								 &rqstate->rqs_split_paramval_len[n]);
+				MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+				n++;
+			}
+			rqstate->rqs_split_count = n;
+		}
+	}
+
+	/* NULL array or keys we could not place, go to all nodes */
+	if (nodes == NULL)
+		nodes = GetRelationNodes(rel_loc_info, NULL, NULL, 0,
+								 origin->accesstype);
+
+	FreeRelationLocInfo(rel_loc_info);
+	MemoryContextSwitchTo(oldcontext);
+
+	return nodes;
+}
+
 /*
  * Reveive dn message on proxy.
  * Forward the dn message to client and forward the client reply message to dn.
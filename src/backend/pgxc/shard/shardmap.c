@@ -36,6 +36,7 @@
 #include "catalog/heap.h"
 #include "catalog/storage_xlog.h"
 #include "nodes/makefuncs.h"
+#include "optimizer/spm_cache.h"
 #include "commands/tablecmds.h"
 #include "commands/vacuum.h"
 #include "postmaster/bgwriter.h"
@@ -238,6 +239,9 @@ void InvalidateShmemShardMap(bool iscommit)
 				LWLockRelease(ShardMapLock);
 				/* reset flag */
 				g_GroupShardingMgr->needLock = false;
+
+				/* shared plans may route to the old shard layout */
+				SPMSharedPlanCacheReset();
 			}
 			if (IS_PGXC_DATANODE)
 			{
@@ -91,6 +91,10 @@ static void DecodeAbort(LogicalDecodingContext *ctx, XLogRecordBuffer *buf,
 /* common function to decode tuples */
 static void DecodeXLogTuple(char *data, Size len, ReorderBufferTupleBuf *tup);
 #ifdef __STORAGE_SCALABLE__
+static bool FilterByShard(LogicalDecodingContext *ctx, RelFileNode *rnode,
+			  bool has_shard, ShardID shardid, Oid *relid);
+static Oid	DecodeGetRelid(RelFileNode *rnode, Oid *relid);
+static bool ShardIsTargetOfAnyPub(ShardID shardid);
 static bool RelationShardIsTarget(Oid relid, int32 shardid);
 static void SetSkipSpecConfirm(TransactionId xid);
 static bool SkipSpecConfirm(TransactionId xid);
@@ -756,29 +760,27 @@ DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 		return;
 
 #ifdef __STORAGE_SCALABLE__
-	Assert(MyReplicationSlot);
-
 	if (xlrec->flags & XLH_INSERT_IS_SPECULATIVE)
 	{
 		SkipSpecConfirm(XLogRecGetXid(r));
 	}
-	
+
 	/* filter the tuple if not interested in */
-	if (OidIsValid(MyReplicationSlot->relid))
 	{
-		Size		datalen;
-		char	   *data;
+		bool		has_shard = (xlrec->flags & XLH_INSERT_CONTAINS_NEW_TUPLE) != 0;
 		xl_heap_header xlhdr;
-		Oid relationId;
-		
-		StartTransactionCommand();
-		
-		relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
+		Oid			relid = InvalidOid;
 
-		AbortCurrentTransaction();
+		if (has_shard)
+		{
+			Size		datalen;
+			char	   *data = XLogRecGetBlockData(r, 0, &datalen);
 
-		/* not our target relation */
-		if (relationId != MyReplicationSlot->relid)
+			memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
+		}
+
+		if (FilterByShard(ctx, &target_node, has_shard,
+						  has_shard ? xlhdr.t_shardid : InvalidShardID, &relid))
 		{
 			if (xlrec->flags & XLH_INSERT_IS_SPECULATIVE)
 			{
@@ -787,58 +789,6 @@ DecodeInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 			}
 			return;
 		}
-
-		data = XLogRecGetBlockData(r, 0, &datalen);
-		memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
-
-		if (MyReplicationSlot->shards)
-		{
-			/* not our target shard */
-			if (!bms_is_member(xlhdr.t_shardid, MyReplicationSlot->shards))
-			{
-				if (xlrec->flags & XLH_INSERT_IS_SPECULATIVE)
-				{
-					TransactionId xid = XLogRecGetXid(r);
-					SetSkipSpecConfirm(xid);
-				}
-				return;
-			}
-		}
-
-		//MyReplicationSlot->ntups_insert++;
-	}
-	else if (MyReplicationSlot->npubs)
-	{
-		bool        found;
-		Size		datalen;
-		char	   *data;
-		xl_heap_header xlhdr;
-		Oid relationId;
-
-		if (xlrec->flags & XLH_INSERT_CONTAINS_NEW_TUPLE)
-		{
-
-			StartTransactionCommand();
-			
-			relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-			AbortCurrentTransaction();
-
-			data = XLogRecGetBlockData(r, 0, &datalen);
-			memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
-
-			found = RelationShardIsTarget(relationId, xlhdr.t_shardid);
-
-			if (!found)
-			{
-				if (xlrec->flags & XLH_INSERT_IS_SPECULATIVE)
-				{
-					TransactionId xid = XLogRecGetXid(r);
-					SetSkipSpecConfirm(xid);
-				}
-				return;
-			}
-		}
 	}
 #endif
 
@@ -906,83 +856,14 @@ DecodeUpdate(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 	if (FilterByOrigin(ctx, XLogRecGetOrigin(r)))
 		return;
 
-	change = ReorderBufferGetChange(ctx->reorder);
-	change->action = REORDER_BUFFER_CHANGE_UPDATE;
-	change->origin_id = XLogRecGetOrigin(r);
-	memcpy(&change->data.tp.relnode, &target_node, sizeof(RelFileNode));
-
 #ifdef __STORAGE_SCALABLE__
-	Assert(MyReplicationSlot);
-
 	/* filter the tuple if not interested in */
-	if (OidIsValid(MyReplicationSlot->relid))
 	{
+		bool		has_shard = true;
 		Size		datalen;
-		char	   *data;
 		xl_heap_header xlhdr;
-		Oid relationId;
-
-		StartTransactionCommand();
-		
-		relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-		AbortCurrentTransaction();
-		
-		/* not our target relation */
-		if (relationId != MyReplicationSlot->relid)
-		{
-			return;
-		}
+		Oid			relid = InvalidOid;
 
-		memset(&xlhdr, 0, sizeof(xl_heap_header));
-		
-		if (xlrec->flags & XLH_UPDATE_CONTAINS_NEW_TUPLE)
-		{
-			data = XLogRecGetBlockData(r, 0, &datalen);
-			memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
-		}
-		else if (xlrec->flags & XLH_UPDATE_CONTAINS_OLD)
-		{
-			data = XLogRecGetData(r) + SizeOfHeapUpdate;
-			memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
-		}
-
-		if (MyReplicationSlot->shards)
-		{
-			/* not our target shard */
-			if (!bms_is_member(xlhdr.t_shardid, MyReplicationSlot->shards))
-			{
-				return;
-			}
-		}
-#if 0
-		if (xlrec->flags & XLH_UPDATE_CONTAINS_NEW_TUPLE)
-		{
-			MyReplicationSlot->ntups_insert++;
-		}
-
-		if (xlrec->flags & XLH_UPDATE_CONTAINS_OLD)
-		{
-			MyReplicationSlot->ntups_delete++;
-		}
-#endif
-	}
-	else if (MyReplicationSlot->npubs)
-	{
-		bool        found;
-		Size		datalen;
-		char	   *data;
-		xl_heap_header xlhdr;
-		Oid relationId;
-
-		StartTransactionCommand();
-		
-		relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-		AbortCurrentTransaction();
-		
-		memset(&xlhdr, 0, sizeof(xl_heap_header));
-		
 		if (xlrec->flags & XLH_UPDATE_CONTAINS_NEW_TUPLE)
 		{
 			data = XLogRecGetBlockData(r, 0, &datalen);
@@ -994,19 +875,19 @@ DecodeUpdate(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 			memcpy((char *) &xlhdr, data, SizeOfHeapHeader);
 		}
 		else
-		{
-			xlhdr.t_shardid = InvalidShardID;
-		}
-
-		found = RelationShardIsTarget(relationId, xlhdr.t_shardid);
+			has_shard = false;
 
-		if (!found)
-		{
+		if (FilterByShard(ctx, &target_node, has_shard,
+						  has_shard ? xlhdr.t_shardid : InvalidShardID, &relid))
 			return;
-		}
 	}
 #endif
 
+	change = ReorderBufferGetChange(ctx->reorder);
+	change->action = REORDER_BUFFER_CHANGE_UPDATE;
+	change->origin_id = XLogRecGetOrigin(r);
+	memcpy(&change->data.tp.relnode, &target_node, sizeof(RelFileNode));
+
 	if (xlrec->flags & XLH_UPDATE_CONTAINS_NEW_TUPLE)
 	{
 		Size		datalen;
@@ -1087,67 +968,18 @@ DecodeDelete(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 		return;
 
 #ifdef __STORAGE_SCALABLE__
-	Assert(MyReplicationSlot);
-
 	/* filter the tuple if not interested in */
-	if (OidIsValid(MyReplicationSlot->relid))
 	{
+		bool		has_shard = (xlrec->flags & XLH_DELETE_CONTAINS_OLD) != 0;
 		xl_heap_header xlhdr;
-		Oid relationId;
-
-		StartTransactionCommand();
-		
-		relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-		AbortCurrentTransaction();
-
-		/* not our target relation */
-		if (relationId != MyReplicationSlot->relid)
-		{
-			return;
-		}
+		Oid			relid = InvalidOid;
 
-		if (xlrec->flags & XLH_DELETE_CONTAINS_OLD)
-		{
+		if (has_shard)
 			memcpy((char *) &xlhdr, (char *) xlrec + SizeOfHeapDelete, SizeOfHeapHeader);
 
-			if (MyReplicationSlot->shards)
-			{
-				/* not our target shard */
-				if (!bms_is_member(xlhdr.t_shardid, MyReplicationSlot->shards))
-				{
-					return;
-				}
-			}
-
-			//MyReplicationSlot->ntups_delete++;
-		}
-	}
-	else if (MyReplicationSlot->npubs)
-	{
-		bool        found;
-		xl_heap_header xlhdr;
-		Oid relationId;
-
-		if (xlrec->flags & XLH_DELETE_CONTAINS_OLD)
-		{
-
-			StartTransactionCommand();
-			
-		    relationId = RelidByRelfilenode(target_node.spcNode, target_node.relNode);
-
-			AbortCurrentTransaction();
-
-
-			memcpy((char *) &xlhdr, (char *) xlrec + SizeOfHeapDelete, SizeOfHeapHeader);
-
-			found = RelationShardIsTarget(relationId, xlhdr.t_shardid);
-
-			if (!found)
-			{
-				return;
-			}
-		}
+		if (FilterByShard(ctx, &target_node, has_shard,
+						  has_shard ? xlhdr.t_shardid : InvalidShardID, &relid))
+			return;
 	}
 #endif
 
@@ -1192,6 +1024,9 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 	char	   *tupledata;
 	Size		tuplelen;
 	RelFileNode rnode;
+#ifdef __STORAGE_SCALABLE__
+	Oid			relid = InvalidOid;
+#endif
 
 	xlrec = (xl_heap_multi_insert *) XLogRecGetData(r);
 
@@ -1236,59 +1071,12 @@ DecodeMultiInsert(LogicalDecodingContext *ctx, XLogRecordBuffer *buf)
 			datalen = xlhdr->datalen;
 
 #ifdef __STORAGE_SCALABLE__
-			Assert(MyReplicationSlot);
-		
 			/* filter the tuple if not interested in */
-			if (OidIsValid(MyReplicationSlot->relid))
-			{
-				Oid relationId;
-				
-				StartTransactionCommand();
-				
-				relationId = RelidByRelfilenode(rnode.spcNode, rnode.relNode);
-
-				AbortCurrentTransaction();
-		
-				/* not our target relation */
-				if (relationId != MyReplicationSlot->relid)
-				{
-					data += datalen;
-					ReorderBufferReturnChange(ctx->reorder, change);
-					continue;
-				}
-		
-				if (MyReplicationSlot->shards)
-				{
-					/* not our target shard */
-					if (!bms_is_member(xlhdr->t_shardid, MyReplicationSlot->shards))
-					{
-						data += datalen;
-						ReorderBufferReturnChange(ctx->reorder, change);
-						continue;
-					}
-				}
-		
-				//MyReplicationSlot->ntups_insert++;
-			}
-			else if (MyReplicationSlot->npubs)
+			if (FilterByShard(ctx, &rnode, true, xlhdr->t_shardid, &relid))
 			{
-				bool found;
-				Oid relationId;
-
-				StartTransactionCommand();
-				
-				relationId = RelidByRelfilenode(rnode.spcNode, rnode.relNode);
-
-				AbortCurrentTransaction();
-
-				found = RelationShardIsTarget(relationId, xlhdr->t_shardid);
-
-				if (!found)
-				{
-					data += datalen;
-					ReorderBufferReturnChange(ctx->reorder, change);
-					continue;
-				}
+				data += datalen;
+				ReorderBufferReturnChange(ctx->reorder, change);
+				continue;
 			}
 #endif
 			
@@ -1429,6 +1217,84 @@ DecodeXLogTuple(char *data, Size len, ReorderBufferTupleBuf *tuple)
 	header->t_hoff = xlhdr.t_hoff;
 }
 #ifdef __STORAGE_SCALABLE__
+/*
+ * FilterByShard -- is a heap change of no interest to this slot?
+ *
+ * shardid is the shard of the tuple in the record, if has_shard is set;
+ * changes without a tuple header can only be filtered by relation.  The
+ * checks that need only the shard id come first, so that changes to shards
+ * nobody asked for are skipped without looking up the relation, which
+ * takes a transaction, and before their tuples are reassembled and queued
+ * in the reorder buffer.  So the cost of decoding goes down with the
+ * fraction of shards wanted.
+ *
+ * *relid caches the relation looked up for rnode, for callers that filter
+ * several tuples of the same record; it must be InvalidOid initially.
+ */
+static bool
+FilterByShard(LogicalDecodingContext *ctx, RelFileNode *rnode,
+			  bool has_shard, ShardID shardid, Oid *relid)
+{
+	Assert(MyReplicationSlot);
+
+	/* output plugin doesn't look for this shard */
+	if (has_shard && ctx->callbacks.filter_by_shard_cb != NULL &&
+		filter_by_shard_cb_wrapper(ctx, shardid))
+		return true;
+
+	if (OidIsValid(MyReplicationSlot->relid))
+	{
+		/* not our target shard */
+		if (has_shard && MyReplicationSlot->shards &&
+			!bms_is_member(shardid, MyReplicationSlot->shards))
+			return true;
+
+		/* not our target relation */
+		if (DecodeGetRelid(rnode, relid) != MyReplicationSlot->relid)
+			return true;
+	}
+	else if (MyReplicationSlot->npubs && has_shard)
+	{
+		/* no publication wants this shard, whatever the relation */
+		if (!ShardIsTargetOfAnyPub(shardid))
+			return true;
+
+		if (!RelationShardIsTarget(DecodeGetRelid(rnode, relid), shardid))
+			return true;
+	}
+
+	return false;
+}
+
+static Oid
+DecodeGetRelid(RelFileNode *rnode, Oid *relid)
+{
+	if (!OidIsValid(*relid))
+	{
+		StartTransactionCommand();
+
+		*relid = RelidByRelfilenode(rnode->spcNode, rnode->relNode);
+
+		AbortCurrentTransaction();
+	}
+
+	return *relid;
+}
+
+static bool
+ShardIsTargetOfAnyPub(ShardID shardid)
+{
+	int i;
+
+	for (i = 0; i < MyReplicationSlot->npubs; i++)
+	{
+		if (!MyReplicationSlot->pubshards[i] || bms_is_member(shardid, MyReplicationSlot->pubshards[i]))
+			return true;
+	}
+
+	return false;
+}
+
 static bool
 RelationShardIsTarget(Oid relid, int32 shardid)
 {
@@ -17,6 +17,8 @@
 #include "storage/lwlock.h"
 #include "catalog/pg_type.h"
 #include "utils/builtins.h"
+#include "utils/pg_lsn.h"
+#include "utils/timestamp.h"
 #include "access/htup_details.h"
 
 /*
@@ -101,6 +103,32 @@ static bool *subStatCount;
 /* if we need to record checksum of tuples */
 static bool *subStatChecksum;
 
+/*
+ * Progress of the apply worker of a subscription, to tell how far it lags
+ * behind the publisher and how busy it is.  The worker's time is split into
+ * busy time, spent processing the changes it received, and the rest, spent
+ * waiting for the publisher.  A worker that is busy all the time cannot
+ * keep up with the publisher.
+ */
+typedef struct
+{
+	int64		xacts_applied;		/* number of transactions applied */
+	XLogRecPtr	last_commit_lsn;	/* end of last applied transaction */
+	TimestampTz last_commit_time;	/* its commit time on the publisher */
+	TimestampTz last_apply_time;	/* its commit time here */
+	int64		busy_time;			/* time spent applying changes, in us */
+	int64		total_time;			/* time since worker start, in us */
+} ApplyStatisticData;
+
+typedef struct
+{
+	StatTag		key;
+	ApplyStatisticData data;
+} ApplyStatEnt;
+
+/* used for apply workers, protected by SubStatLock too */
+static HTAB *SubApplyStatHash;
+
 
 /*
  * Estimate space needed for publication statistic hashtable 
@@ -282,6 +310,7 @@ SubStatDataShmemSize(int ssize, int tsize)
 	space += sizeof(bool);
 	space += hash_estimate_size(ssize, sizeof(StatEnt));
 	space += hash_estimate_size(tsize, sizeof(TableStatEnt));
+	space += hash_estimate_size(ssize, sizeof(ApplyStatEnt));
 	
 	return space;
 }
@@ -323,6 +352,16 @@ InitSubStatData(int ssize, int tsize)
 								  &info,
 								  HASH_ELEM | HASH_BLOBS);
 
+	memset(&info, 0, sizeof(HASHCTL));
+	info.keysize = sizeof(StatTag);
+	info.entrysize = sizeof(ApplyStatEnt);
+	info.match = substat_compare;
+
+	SubApplyStatHash = ShmemInitHash("Subscription Apply Statistic Data",
+								  ssize, ssize,
+								  &info,
+								  HASH_ELEM | HASH_COMPARE);
+
 
     subStatCount = (bool *)ShmemInitStruct("Subscription Stat Count",
                                              sizeof(bool),
@@ -482,6 +521,51 @@ RemoveSubStatistics(char *subname)
 	LWLockAcquire(SubStatLock, LW_EXCLUSIVE);
 
 	hash_search(SubStatHash, &key, HASH_REMOVE, NULL);
+	hash_search(SubApplyStatHash, &key, HASH_REMOVE, NULL);
+
+	LWLockRelease(SubStatLock);
+}
+
+/*
+ * update apply progress of a subscription
+ *
+ * xacts is the number of transactions applied since the last update, of
+ * which the last one ended at commit_lsn; busy_time and total_time are the
+ * microseconds the worker spent applying changes, and in total, since then.
+ */
+void
+UpdateSubApplyStatistics(char *subname, int64 xacts, XLogRecPtr commit_lsn,
+						 TimestampTz commit_time, TimestampTz apply_time,
+						 int64 busy_time, int64 total_time, bool init)
+{
+	bool found;
+	StatTag key;
+	ApplyStatEnt *ent;
+
+	snprintf(key.subname, NAMEDATALEN, "%s", subname);
+
+	LWLockAcquire(SubStatLock, LW_EXCLUSIVE);
+
+	ent = hash_search(SubApplyStatHash, &key, HASH_ENTER_NULL, &found);
+	if (ent == NULL)
+	{
+		/* out of shared memory, just don't record anything */
+		LWLockRelease(SubStatLock);
+		return;
+	}
+
+	if (!found || init)
+		memset(&ent->data, 0, sizeof(ApplyStatisticData));
+
+	ent->data.xacts_applied += xacts;
+	if (xacts > 0)
+	{
+		ent->data.last_commit_lsn = commit_lsn;
+		ent->data.last_commit_time = commit_time;
+		ent->data.last_apply_time = apply_time;
+	}
+	ent->data.busy_time += busy_time;
+	ent->data.total_time += total_time;
 
 	LWLockRelease(SubStatLock);
 }
@@ -1117,6 +1201,103 @@ Datum opentenbase_get_all_subtable_stat(PG_FUNCTION_ARGS)
 	}
 }
 
+/* show apply progress of all subscriptions */
+Datum opentenbase_get_all_sub_apply_stat(PG_FUNCTION_ARGS)
+{
+#define APPLY_NCOLUMNS 6
+	FuncCallContext 	*funcctx;
+	ApplyStatEnt 		*ent;
+	StatInfo			*info;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	  tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(APPLY_NCOLUMNS, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "subscription_name",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "xacts_applied",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "last_commit_lsn",
+						   LSNOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "last_commit_time",
+						   TIMESTAMPTZOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "apply_lag",
+						   INTERVALOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "utilization",
+						   FLOAT8OID, -1, 0);
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		funcctx->user_fctx = palloc0(sizeof(StatInfo));
+		info = (StatInfo*)funcctx->user_fctx;
+
+		LWLockAcquire(SubStatLock, LW_SHARED);
+		hash_seq_init(&info->status, SubApplyStatHash);
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	/* stuff done on every call of the function */
+	funcctx = SRF_PERCALL_SETUP();
+	info = (StatInfo*)funcctx->user_fctx;
+	if (((ent = (ApplyStatEnt *) hash_seq_search(&info->status)) != NULL))
+	{
+		/* for each row */
+		Datum		values[APPLY_NCOLUMNS];
+		bool		nulls[APPLY_NCOLUMNS];
+		HeapTuple	tuple;
+
+		MemSet(values, 0, sizeof(values));
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = PointerGetDatum(cstring_to_text(ent->key.subname));
+
+		values[1] = Int64GetDatum(ent->data.xacts_applied);
+
+		if (ent->data.xacts_applied > 0)
+		{
+			Interval   *lag = (Interval *) palloc0(sizeof(Interval));
+
+			/*
+			 * The lag is how long after its commit on the publisher the last
+			 * transaction was committed here, so it is only as accurate as
+			 * the clocks of the two servers are in sync.
+			 */
+			lag->time = Max(ent->data.last_apply_time - ent->data.last_commit_time, 0);
+
+			values[2] = LSNGetDatum(ent->data.last_commit_lsn);
+			values[3] = TimestampTzGetDatum(ent->data.last_commit_time);
+			values[4] = IntervalPGetDatum(lag);
+		}
+		else
+		{
+			nulls[2] = true;
+			nulls[3] = true;
+			nulls[4] = true;
+		}
+
+		if (ent->data.total_time > 0)
+			values[5] = Float8GetDatum((double) ent->data.busy_time /
+									   (double) ent->data.total_time);
+		else
+			nulls[5] = true;
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+	else
+	{
+		/* nothing left */
+		LWLockRelease(SubStatLock);
+		SRF_RETURN_DONE(funcctx);
+	}
+}
+
 Datum opentenbase_set_pub_stat_check(PG_FUNCTION_ARGS)
 {
 	bool pubstatcount = PG_GETARG_BOOL(0);
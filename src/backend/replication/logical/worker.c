@@ -142,6 +142,19 @@ static int logical_apply_batch_size = 0;
 static bool in_batch_process_mode = false;
 static bool cache_single_txn_ing = false;
 
+#ifdef __STORAGE_SCALABLE__
+/* apply progress not yet reported to the subscription statistics */
+static int64 apply_stat_xacts = 0;
+static XLogRecPtr apply_stat_commit_lsn = InvalidXLogRecPtr;
+static TimestampTz apply_stat_commit_time = 0;
+static TimestampTz apply_stat_apply_time = 0;
+static int64 apply_stat_busy_time = 0;
+static TimestampTz apply_stat_last_report = 0;
+
+static void apply_stat_count_commit(LogicalRepCommitData *commit_data);
+static void apply_stat_report(bool init);
+#endif
+
 static void send_feedback(XLogRecPtr recvpos, bool force, bool requestReply);
 
 static void store_flush_position(XLogRecPtr remote_lsn);
@@ -837,6 +850,10 @@ apply_handle_commit(StringInfo s)
 
 	in_remote_transaction = false;
 
+#ifdef __STORAGE_SCALABLE__
+	apply_stat_count_commit(&commit_data);
+#endif
+
 	/* Process any tables that are being synchronized in parallel. */
 	process_syncing_tables(commit_data.end_lsn);
 
@@ -2315,6 +2332,11 @@ apply_cache_commit(StringInfo s)
 	}
 	
 	cache_single_txn_ing = false;
+
+#ifdef __STORAGE_SCALABLE__
+	/* counted when cached, the changes may be sent to datanodes later */
+	apply_stat_count_commit(&commit_data);
+#endif
 }
 
 /*
@@ -2453,6 +2475,49 @@ store_flush_position(XLogRecPtr remote_lsn)
 }
 
 
+#ifdef __STORAGE_SCALABLE__
+/*
+ * Count a remote transaction as applied, for the apply statistics.
+ */
+static void
+apply_stat_count_commit(LogicalRepCommitData *commit_data)
+{
+	if (am_tablesync_worker())
+		return;
+
+	apply_stat_xacts++;
+	apply_stat_commit_lsn = commit_data->end_lsn;
+	apply_stat_commit_time = commit_data->committime;
+	apply_stat_apply_time = GetCurrentTimestamp();
+}
+
+/*
+ * Report the apply progress since the last report to the subscription
+ * statistics, see UpdateSubApplyStatistics.  With init, start over.
+ */
+static void
+apply_stat_report(bool init)
+{
+	TimestampTz now = GetCurrentTimestamp();
+
+	if (init)
+	{
+		apply_stat_xacts = 0;
+		apply_stat_busy_time = 0;
+		apply_stat_last_report = now;
+	}
+
+	UpdateSubApplyStatistics(MySubscription->name, apply_stat_xacts,
+							 apply_stat_commit_lsn, apply_stat_commit_time,
+							 apply_stat_apply_time, apply_stat_busy_time,
+							 Max(now - apply_stat_last_report, 0), init);
+
+	apply_stat_xacts = 0;
+	apply_stat_busy_time = 0;
+	apply_stat_last_report = now;
+}
+#endif
+
 /* Update statistics of the worker. */
 static void
 UpdateWorkerStats(XLogRecPtr last_lsn, TimestampTz send_time, bool reply)
@@ -2486,6 +2551,12 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
 
 	last_merge_time = GetCurrentTimestamp();
 	logical_apply_batch_size = 0;
+
+#ifdef __STORAGE_SCALABLE__
+	if (!am_tablesync_worker())
+		apply_stat_report(true);
+#endif
+
 	for (;;)
 	{
 		pgsocket	fd = PGINVALID_SOCKET;
@@ -2505,6 +2576,10 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
 
 		if (len != 0)
 		{
+#ifdef __STORAGE_SCALABLE__
+			TimestampTz busy_start = GetCurrentTimestamp();
+#endif
+
 			/* Process the data */
 			for (;;)
 			{
@@ -2596,6 +2671,10 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
 
 				len = walrcv_receive(wrconn, &buf, &fd);
 			}
+
+#ifdef __STORAGE_SCALABLE__
+			apply_stat_busy_time += Max(GetCurrentTimestamp() - busy_start, 0);
+#endif
 		}
 
 #ifdef __STORAGE_SCALABLE__
@@ -2603,6 +2682,7 @@ LogicalRepApplyLoop(XLogRecPtr last_received)
 		if (!am_tablesync_worker())
 		{
 			logicalrep_statistic_update_for_apply(MySubscription->oid, MySubscription->name);
+			apply_stat_report(false);
 		}
 #endif
 
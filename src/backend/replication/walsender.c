@@ -223,6 +223,10 @@ static struct
 	WalTimeSample last_read[NUM_SYNC_REP_WAIT_MODE];
 }			LagTracker;
 
+/* How often to sample the standby's replay rate, and how much to smooth it */
+#define REPLAY_RATE_INTERVAL	1000	/* ms */
+#define REPLAY_RATE_WEIGHT		0.25
+
 /* Signal handlers */
 static void WalSndLastCycleHandler(SIGNAL_ARGS);
 
@@ -2108,12 +2112,15 @@ ProcessStandbyReplyMessage(void)
 				applyLag;
 	bool		clearLagTimes;
 	TimestampTz now;
+	double		replayRate;
 
 #ifdef __SUBSCRIPTION__
 	bool		isAllActived = false;
 #endif
 
 	static bool fullyAppliedLastTime = false;
+	static XLogRecPtr lastApplyPtr = InvalidXLogRecPtr;
+	static TimestampTz lastApplyTime = 0;
 
 	/* the caller already consumed the msgtype byte */
 	writePtr = pq_getmsgint64(&reply_message);
@@ -2156,6 +2163,33 @@ ProcessStandbyReplyMessage(void)
 	else
 		fullyAppliedLastTime = false;
 
+	/*
+	 * Estimate how fast the standby replays WAL.  Replies can arrive in quick
+	 * succession, so sample at most once per REPLAY_RATE_INTERVAL and smooth
+	 * the samples with an exponential moving average.
+	 */
+	replayRate = MyWalSnd->replayRate;
+	if (XLogRecPtrIsInvalid(applyPtr) || XLogRecPtrIsInvalid(lastApplyPtr) ||
+		applyPtr < lastApplyPtr)
+	{
+		lastApplyPtr = applyPtr;
+		lastApplyTime = now;
+	}
+	else if (TimestampDifferenceExceeds(lastApplyTime, now, REPLAY_RATE_INTERVAL))
+	{
+		double		rate;
+
+		rate = (double) (applyPtr - lastApplyPtr) * USECS_PER_SEC /
+			(double) (now - lastApplyTime);
+		if (replayRate < 0)
+			replayRate = rate;
+		else
+			replayRate += REPLAY_RATE_WEIGHT * (rate - replayRate);
+
+		lastApplyPtr = applyPtr;
+		lastApplyTime = now;
+	}
+
 	/* Send a reply if the standby requested one. */
 	if (replyRequested)
 		WalSndKeepalive(false);
@@ -2177,6 +2211,7 @@ ProcessStandbyReplyMessage(void)
 			walsnd->flushLag = flushLag;
 		if (applyLag != -1 || clearLagTimes)
 			walsnd->applyLag = applyLag;
+		walsnd->replayRate = replayRate;
 		SpinLockRelease(&walsnd->mutex);
 	}
 
@@ -2635,6 +2670,7 @@ InitWalSenderSlot(void)
 			walsnd->writeLag = -1;
 			walsnd->flushLag = -1;
 			walsnd->applyLag = -1;
+			walsnd->replayRate = -1;
 			walsnd->sync_standby_priority = 0;
 			walsnd->latch = &MyProc->procLatch;
 			SpinLockRelease(&walsnd->mutex);
@@ -3540,7 +3576,7 @@ offset_to_interval(TimeOffset offset)
 Datum
 pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 {
-#define PG_STAT_GET_WAL_SENDERS_COLS	11
+#define PG_STAT_GET_WAL_SENDERS_COLS	12
 	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
 	TupleDesc	tupdesc;
 	Tuplestorestate *tupstore;
@@ -3591,6 +3627,7 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 		TimeOffset	writeLag;
 		TimeOffset	flushLag;
 		TimeOffset	applyLag;
+		double		replayRate;
 		int			priority;
 		int			pid;
 		WalSndState state;
@@ -3615,6 +3652,7 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 		writeLag = walsnd->writeLag;
 		flushLag = walsnd->flushLag;
 		applyLag = walsnd->applyLag;
+		replayRate = walsnd->replayRate;
 		priority = walsnd->sync_standby_priority;
 		SpinLockRelease(&walsnd->mutex);
 
@@ -3707,6 +3745,11 @@ pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 					CStringGetTextDatum("sync") : CStringGetTextDatum("quorum");
 			else
 				values[10] = CStringGetTextDatum("potential");
+
+			if (replayRate < 0)
+				nulls[11] = true;
+			else
+				values[11] = Float8GetDatum(replayRate);
 		}
 
 		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
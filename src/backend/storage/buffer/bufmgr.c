@@ -541,30 +541,21 @@ ComputeIoConcurrency(int io_concurrency, double *target)
 }
 
 /*
- * PrefetchBuffer -- initiate asynchronous read of a block of a relation
- *
- * This is named by analogy to ReadBuffer but doesn't actually allocate a
- * buffer.  Instead it tries to ensure that a future ReadBuffer for the given
- * block will not be delayed by the I/O.  Prefetching is optional.
- * No-op if prefetching isn't compiled in.
+ * SharedBufferIsCached -- is a block in shared buffers already?
  */
-void
-PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
+static bool
+SharedBufferIsCached(SMgrRelation smgr_reln, ForkNumber forkNum,
+					 BlockNumber blockNum)
 {
-
 	BufferTag	newTag;				/* identity of requested block */
 	uint32		newHash;			/* hash value for newTag */
 	LWLock		*newPartitionLock;	/* buffer partition lock for it */
 	int			buf_id;
 
-#ifdef USE_PREFETCH
-	Assert(RelationIsValid(reln));
 	Assert(BlockNumberIsValid(blockNum));
 
-	/* Open it at the smgr level if not already done */
-	RelationOpenSmgr(reln);
 	/* create a tag so we can lookup the buffer */
-	INIT_BUFFERTAG(newTag, reln->rd_smgr->smgr_rnode.node,
+	INIT_BUFFERTAG(newTag, smgr_reln->smgr_rnode.node,
 				   forkNum, blockNum);
 
 	/* determine its hash code and partition lock ID */
@@ -576,22 +567,120 @@ PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 	buf_id = BufTableLookup(&newTag, newHash);
 	LWLockRelease(newPartitionLock);
 
+	return buf_id >= 0;
+}
+
+/*
+ * PrefetchSharedBuffer -- initiate asynchronous read of a block, unless it is
+ *		already in shared buffers.  Returns true if a prefetch was issued.
+ */
+static bool
+PrefetchSharedBuffer(SMgrRelation smgr_reln, ForkNumber forkNum,
+					 BlockNumber blockNum)
+{
+#ifdef USE_PREFETCH
 	/* If not in buffers, initiate prefetch */
-	if (buf_id < 0)
-		smgrprefetch(reln->rd_smgr, forkNum, blockNum);
+	if (!SharedBufferIsCached(smgr_reln, forkNum, blockNum))
+	{
+		smgrprefetch(smgr_reln, forkNum, blockNum, 1);
+		return true;
+	}
 
-		/*
-		 * If the block *is* in buffers, we do nothing.  This is not really
-		 * ideal: the block might be just about to be evicted, which would be
-		 * stupid since we know we are going to need it soon.  But the only
-		 * easy answer is to bump the usage_count, which does not seem like a
-		 * great solution: when the caller does ultimately touch the block,
-		 * usage_count would get bumped again, resulting in too much
-		 * favoritism for blocks that are involved in a prefetch sequence. A
-		 * real fix would involve some additional per-buffer state, and it's
-		 * not clear that there's enough of a problem to justify that.
-		 */
-#endif /* USE_PREFETCH */
+	/*
+	 * If the block *is* in buffers, we do nothing.  This is not really
+	 * ideal: the block might be just about to be evicted, which would be
+	 * stupid since we know we are going to need it soon.  But the only easy
+	 * answer is to bump the usage_count, which does not seem like a great
+	 * solution: when the caller does ultimately touch the block, usage_count
+	 * would get bumped again, resulting in too much favoritism for blocks
+	 * that are involved in a prefetch sequence. A real fix would involve some
+	 * additional per-buffer state, and it's not clear that there's enough of
+	 * a problem to justify that.
+	 */
+#endif							/* USE_PREFETCH */
+	return false;
+}
+
+/*
+ * PrefetchBuffer -- initiate asynchronous read of a block of a relation
+ *
+ * This is named by analogy to ReadBuffer but doesn't actually allocate a
+ * buffer.  Instead it tries to ensure that a future ReadBuffer for the given
+ * block will not be delayed by the I/O.  Prefetching is optional.
+ * No-op if prefetching isn't compiled in.
+ */
+void
+PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
+{
+#ifdef USE_PREFETCH
+	Assert(RelationIsValid(reln));
+
+	/* Open it at the smgr level if not already done */
+	RelationOpenSmgr(reln);
+
+	(void) PrefetchSharedBuffer(reln->rd_smgr, forkNum, blockNum);
+#endif							/* USE_PREFETCH */
+}
+
+/*
+ * PrefetchBufferRange -- initiate asynchronous read of a range of blocks
+ *
+ * Like calling PrefetchBuffer for each of the nblocks blocks starting at
+ * firstBlock, except that each run of consecutive blocks not in shared
+ * buffers is requested from the kernel at once, so that it can be read with
+ * a few large I/Os instead of many small ones.
+ */
+void
+PrefetchBufferRange(Relation reln, ForkNumber forkNum, BlockNumber firstBlock,
+					BlockNumber nblocks)
+{
+#ifdef USE_PREFETCH
+	BlockNumber runStart = InvalidBlockNumber;
+	BlockNumber blockNum;
+
+	Assert(RelationIsValid(reln));
+
+	/* temp tables are scanned by one backend only, not worth reading ahead */
+	if (RelationUsesLocalBuffers(reln))
+		return;
+
+	/* Open it at the smgr level if not already done */
+	RelationOpenSmgr(reln);
+
+	for (blockNum = firstBlock; blockNum < firstBlock + nblocks; blockNum++)
+	{
+		if (!SharedBufferIsCached(reln->rd_smgr, forkNum, blockNum))
+		{
+			if (!BlockNumberIsValid(runStart))
+				runStart = blockNum;
+		}
+		else if (BlockNumberIsValid(runStart))
+		{
+			smgrprefetch(reln->rd_smgr, forkNum, runStart, blockNum - runStart);
+			runStart = InvalidBlockNumber;
+		}
+	}
+	if (BlockNumberIsValid(runStart))
+		smgrprefetch(reln->rd_smgr, forkNum, runStart, blockNum - runStart);
+#endif							/* USE_PREFETCH */
+}
+
+/*
+ * PrefetchBufferWithoutRelcache -- like PrefetchBuffer, but doesn't require
+ *		a relcache entry for the relation.
+ *
+ * Used to read ahead of WAL replay, so the relation may not exist yet or may
+ * be dropped by then.  Returns true if a prefetch was issued.
+ */
+bool
+PrefetchBufferWithoutRelcache(RelFileNode rnode, ForkNumber forkNum,
+							  BlockNumber blockNum)
+{
+	SMgrRelation smgr = smgropen(rnode, InvalidBackendId);
+
+	Assert(InRecovery);
+
+	return PrefetchSharedBuffer(smgr, forkNum, blockNum);
 }
 
 
@@ -85,7 +85,7 @@ LocalPrefetchBuffer(SMgrRelation smgr, ForkNumber forkNum,
 	}
 
 	/* Not in buffers, so initiate prefetch */
-	smgrprefetch(smgr, forkNum, blockNum);
+	smgrprefetch(smgr, forkNum, blockNum, 1);
 #endif							/* USE_PREFETCH */
 }
 
@@ -36,11 +36,19 @@
  * other backends, as infrastructure for parallel execution.  Such files need
  * to be created as a member of a SharedFileSet that all participants are
  * attached to.
+ *
+ * A BufFile that is only ever written front to back, rewound once and read
+ * front to back again (hash join batch files, for instance) can be switched
+ * to sequential mode with BufFilePledgeSequential.  Such a file is written in
+ * chunks much larger than BLCKSZ, each optionally LZ4-compressed, and the
+ * next chunk is prefetched while the current one is being consumed.
  *-------------------------------------------------------------------------
  */
 
 #include "postgres.h"
 
+#include <lz4.h>
+
 #include "commands/tablespace.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
@@ -48,6 +56,7 @@
 #include "storage/fd.h"
 #include "storage/buffile.h"
 #include "storage/buf_internals.h"
+#include "utils/memutils.h"
 #include "utils/resowner.h"
 
 #ifdef __OPENTENBASE_C__
@@ -66,6 +75,30 @@
 #endif
 #define BUFFILE_SEG_SIZE		(MAX_PHYSICAL_FILESIZE / BLCKSZ)
 
+/*
+ * In sequential mode the file is a series of chunks, each made of a header
+ * followed by the chunk data, stored either as is or LZ4-compressed.
+ */
+typedef struct BufFileChunkHeader
+{
+	uint32		rawlen;			/* # of bytes of data in the chunk */
+	uint32		storedlen;		/* # of bytes on disk; == rawlen if raw */
+} BufFileChunkHeader;
+
+#define BUFFILE_CHUNK_HDRSZ		MAXALIGN(sizeof(BufFileChunkHeader))
+
+typedef struct BufFileChunk
+{
+	bool		compress;		/* LZ4-compress chunks when writing? */
+	bool		reading;		/* has the file been rewound for reading? */
+	int			size;			/* max # of data bytes per chunk */
+	int			pos;			/* next read/write position in data */
+	int			nbytes;			/* total # of valid bytes in data */
+	char	   *buffer;			/* header followed by chunk data */
+} BufFileChunk;
+
+#define BufFileChunkData(chunk)	((chunk)->buffer + BUFFILE_CHUNK_HDRSZ)
+
 /*
  * This data structure represents a buffered file that consists of one or
  * more physical files (each accessed through a virtual file descriptor
@@ -114,15 +147,31 @@ struct BufFile
 	off_t		curOffset;		/* offset part of current pos */
 	int			pos;			/* next read/write position in buffer */
 	int			nbytes;			/* total # of valid bytes in buffer */
+
+	/*
+	 * In sequential mode, data goes through 'chunk' rather than 'buffer' and
+	 * (curFile, curOffset) is the physical position of the next chunk.
+	 */
+	BufFileChunk *chunk;		/* NULL unless in sequential mode */
+
 	char		buffer[BLCKSZ];
 };
 
+/* scratch space for compressed chunks, shared by all BufFiles */
+static char *chunk_scratch = NULL;
+static int	chunk_scratch_size = 0;
+
 static BufFile *makeBufFile(File firstfile);
 static void extendBufFile(BufFile *file);
 static void BufFileLoadBuffer(BufFile *file);
 static void BufFileDumpBuffer(BufFile *file);
 static int	BufFileFlush(BufFile *file);
 static File MakeNewSharedSegment(BufFile *file, int segment);
+static void BufFileWritePhysical(BufFile *file, char *data, int len);
+static int	BufFileReadPhysical(BufFile *file, char *data, int len);
+static void BufFileDumpChunk(BufFile *file);
+static bool BufFileLoadChunk(BufFile *file);
+static char *BufFileChunkScratch(int size);
 
 
 /*
@@ -149,6 +198,8 @@ makeBufFile(File firstfile)
 	file->readOnly = false;
 	file->fileset = NULL;
 	file->name = NULL;
+	file->work_set = NULL;
+	file->chunk = NULL;
 
 	return file;
 }
@@ -328,6 +379,8 @@ BufFileCreateShared(SharedFileSet *fileset, const char *name, workfile_set *work
 	file->nbytes = 0;
 	file->readOnly = false;
 	file->name = pstrdup(name);
+	file->work_set = NULL;
+	file->chunk = NULL;
 
 	/*
 	 * Register the file as a "work file", so that the Greenplum workfile
@@ -407,6 +460,8 @@ BufFileOpenShared(SharedFileSet *fileset, const char *name)
 	file->readOnly = true;		/* Can't write to files opened this way */
 	file->fileset = fileset;
 	file->name = pstrdup(name);
+	file->work_set = NULL;
+	file->chunk = NULL;
 
 	return file;
 }
@@ -429,6 +484,11 @@ BufFileClose(BufFile *file)
 	/* release the buffer space */
 	pfree(file->files);
 	pfree(file->offsets);
+	if (file->chunk)
+	{
+		pfree(file->chunk->buffer);
+		pfree(file->chunk);
+	}
 	pfree(file);
 }
 
@@ -443,6 +503,8 @@ static void
 BufFileLoadBuffer(BufFile *file)
 {
 	File		thisfile;
+	instr_time	io_start;
+	instr_time	io_time;
 
 	/*
 	 * Advance to next component file if necessary and possible.
@@ -465,6 +527,9 @@ BufFileLoadBuffer(BufFile *file)
 		file->offsets[file->curFile] = file->curOffset;
 	}
 
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(io_start);
+
 	/*
 	 * Read whatever we can get, up to a full bufferload.
 	 */
@@ -474,6 +539,13 @@ BufFileLoadBuffer(BufFile *file)
 							WAIT_EVENT_BUFFILE_READ);
 	if (file->nbytes < 0)
 		file->nbytes = 0;
+
+	if (track_io_timing)
+	{
+		INSTR_TIME_SET_CURRENT(io_time);
+		INSTR_TIME_SUBTRACT(io_time, io_start);
+		INSTR_TIME_ADD(pgBufferUsage.temp_blk_read_time, io_time);
+	}
 	file->offsets[file->curFile] += file->nbytes;
 	/* we choose not to advance curOffset here */
 
@@ -494,6 +566,8 @@ BufFileDumpBuffer(BufFile *file)
 	int			wpos = 0;
 	int			bytestowrite;
 	File		thisfile;
+	instr_time	io_start;
+	instr_time	io_time;
 
 	/*
 	 * Unlike BufFileLoadBuffer, we must dump the whole buffer even if it
@@ -533,10 +607,22 @@ BufFileDumpBuffer(BufFile *file)
 				return;			/* seek failed, give up */
 			file->offsets[file->curFile] = file->curOffset;
 		}
+
+		if (track_io_timing)
+			INSTR_TIME_SET_CURRENT(io_start);
+
 		bytestowrite = FileWrite(thisfile,
 								 file->buffer + wpos,
 								 bytestowrite,
 								 WAIT_EVENT_BUFFILE_WRITE);
+
+		if (track_io_timing)
+		{
+			INSTR_TIME_SET_CURRENT(io_time);
+			INSTR_TIME_SUBTRACT(io_time, io_start);
+			INSTR_TIME_ADD(pgBufferUsage.temp_blk_write_time, io_time);
+		}
+
 		if (bytestowrite <= 0)
 			return;				/* failed to write */
 		file->offsets[file->curFile] += bytestowrite;
@@ -579,6 +665,33 @@ BufFileRead(BufFile *file, void *ptr, size_t size)
 	size_t		nread = 0;
 	size_t		nthistime;
 
+	if (file->chunk)
+	{
+		BufFileChunk *chunk = file->chunk;
+
+		if (!chunk->reading)
+			elog(ERROR, "sequential BufFile must be rewound before reading");
+
+		while (size > 0)
+		{
+			if (chunk->pos >= chunk->nbytes && !BufFileLoadChunk(file))
+				break;			/* no more data available */
+
+			nthistime = chunk->nbytes - chunk->pos;
+			if (nthistime > size)
+				nthistime = size;
+
+			memcpy(ptr, BufFileChunkData(chunk) + chunk->pos, nthistime);
+
+			chunk->pos += nthistime;
+			ptr = (void *) ((char *) ptr + nthistime);
+			size -= nthistime;
+			nread += nthistime;
+		}
+
+		return nread;
+	}
+
 	if (file->dirty)
 	{
 		if (BufFileFlush(file) != 0)
@@ -628,6 +741,33 @@ BufFileWrite(BufFile *file, void *ptr, size_t size)
 
 	Assert(!file->readOnly);
 
+	if (file->chunk)
+	{
+		BufFileChunk *chunk = file->chunk;
+
+		if (chunk->reading)
+			elog(ERROR, "cannot write to sequential BufFile after rewinding it");
+
+		while (size > 0)
+		{
+			if (chunk->nbytes >= chunk->size)
+				BufFileDumpChunk(file);
+
+			nthistime = chunk->size - chunk->nbytes;
+			if (nthistime > size)
+				nthistime = size;
+
+			memcpy(BufFileChunkData(chunk) + chunk->nbytes, ptr, nthistime);
+
+			chunk->nbytes += nthistime;
+			ptr = (void *) ((char *) ptr + nthistime);
+			size -= nthistime;
+			nwritten += nthistime;
+		}
+
+		return nwritten;
+	}
+
 	while (size > 0)
 	{
 		if (file->pos >= BLCKSZ)
@@ -675,6 +815,13 @@ BufFileWrite(BufFile *file, void *ptr, size_t size)
 static int
 BufFileFlush(BufFile *file)
 {
+	if (file->chunk)
+	{
+		if (!file->chunk->reading && file->chunk->nbytes > 0)
+			BufFileDumpChunk(file);
+		return 0;
+	}
+
 	if (file->dirty)
 	{
 		BufFileDumpBuffer(file);
@@ -701,6 +848,26 @@ BufFileSeek(BufFile *file, int fileno, off_t offset, int whence)
 	int			newFile;
 	off_t		newOffset;
 
+	if (file->chunk)
+	{
+		/* the only seek a sequential file supports is a rewind */
+		if (whence != SEEK_SET || fileno != 0 || offset != 0)
+			elog(ERROR, "sequential BufFile can only be rewound");
+
+		BufFileFlush(file);
+		file->chunk->reading = true;
+		file->chunk->pos = 0;
+		file->chunk->nbytes = 0;
+		file->curFile = 0;
+		file->curOffset = 0L;
+
+		if (pg_workfile_prefetch)
+			(void) FilePrefetch(file->files[0], 0,
+								BUFFILE_CHUNK_HDRSZ + file->chunk->size,
+								WAIT_EVENT_BUFFILE_READ);
+		return 0;
+	}
+
 	switch (whence)
 	{
 		case SEEK_SET:
@@ -777,6 +944,9 @@ BufFileSeek(BufFile *file, int fileno, off_t offset, int whence)
 void
 BufFileTell(BufFile *file, int *fileno, off_t *offset)
 {
+	if (file->chunk)
+		elog(ERROR, "cannot tell position of sequential BufFile");
+
 	*fileno = file->curFile;
 	*offset = file->curOffset + file->pos;
 }
@@ -801,6 +971,321 @@ BufFileSeekBlock(BufFile *file, long blknum)
 					   SEEK_SET);
 }
 
+/*
+ * BufFilePrefetchBlock --- hint that blocks will be read soon
+ *
+ * Asks the kernel to start reading 'nblocks' BLCKSZ-sized blocks beginning
+ * at block 'blknum', so that a later BufFileRead finds them in cache.  The
+ * prefetch does not extend past the end of the segment file holding blknum.
+ */
+void
+BufFilePrefetchBlock(BufFile *file, long blknum, int nblocks)
+{
+	int			fileno = (int) (blknum / BUFFILE_SEG_SIZE);
+	off_t		offset = (off_t) (blknum % BUFFILE_SEG_SIZE) * BLCKSZ;
+
+	if (!pg_workfile_prefetch || nblocks <= 0 || fileno >= file->numFiles)
+		return;
+
+	nblocks = Min(nblocks, BUFFILE_SEG_SIZE - blknum % BUFFILE_SEG_SIZE);
+	(void) FilePrefetch(file->files[fileno], offset, nblocks * BLCKSZ,
+						WAIT_EVENT_BUFFILE_READ);
+}
+
+/*
+ * BufFilePledgeSequential
+ *
+ * The caller promises to write the file front to back, rewind it with
+ * BufFileSeek(file, 0, 0, SEEK_SET) and then read it front to back.  The
+ * file is switched to sequential mode: data is written in chunks of up to
+ * 'chunk_size' bytes (LZ4-compressed if pg_workfile_compression is on) and
+ * each chunk is prefetched while the previous one is read.
+ *
+ * Must be called on a freshly created, non-shared file.  The chunk buffer is
+ * allocated in the BufFile's memory context; since it is held until the file
+ * is closed, callers with many open files should pass a modest chunk_size.
+ */
+void
+BufFilePledgeSequential(BufFile *file, int chunk_size)
+{
+	MemoryContext cxt = GetMemoryChunkContext(file);
+	BufFileChunk *chunk;
+
+	Assert(file->fileset == NULL && !file->readOnly);
+	Assert(file->chunk == NULL && !file->dirty && file->nbytes == 0);
+	Assert(file->curFile == 0 && file->curOffset == 0);
+
+	chunk_size = Max(chunk_size, BLCKSZ);
+	chunk_size = Min(chunk_size, BUFFILE_MAX_CHUNK_SIZE);
+
+	/* nothing to gain over plain buffering */
+	if (!pg_workfile_compression && chunk_size == BLCKSZ)
+		return;
+
+	chunk = (BufFileChunk *) MemoryContextAlloc(cxt, sizeof(BufFileChunk));
+	chunk->compress = pg_workfile_compression;
+	chunk->reading = false;
+	chunk->size = chunk_size;
+	chunk->pos = 0;
+	chunk->nbytes = 0;
+	chunk->buffer = MemoryContextAlloc(cxt, BUFFILE_CHUNK_HDRSZ + chunk_size);
+
+	file->chunk = chunk;
+}
+
+/*
+ * Write 'len' bytes at the current physical position, extending the file by
+ * new segments as needed, and advance the position.
+ */
+static void
+BufFileWritePhysical(BufFile *file, char *data, int len)
+{
+	instr_time	io_start;
+	instr_time	io_time;
+
+	pgBufferUsage.temp_blks_written += (len + BLCKSZ - 1) / BLCKSZ;
+
+	while (len > 0)
+	{
+		File		thisfile;
+		int			bytestowrite;
+		int			written;
+
+		if (file->curOffset >= MAX_PHYSICAL_FILESIZE)
+		{
+			while (file->curFile + 1 >= file->numFiles)
+				extendBufFile(file);
+			file->curFile++;
+			file->curOffset = 0L;
+		}
+
+		bytestowrite = (int) Min((off_t) len,
+								 MAX_PHYSICAL_FILESIZE - file->curOffset);
+
+		thisfile = file->files[file->curFile];
+		if (file->curOffset != file->offsets[file->curFile])
+		{
+			if (FileSeek(thisfile, file->curOffset, SEEK_SET) != file->curOffset)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not seek in temporary file: %m")));
+			file->offsets[file->curFile] = file->curOffset;
+		}
+
+		if (track_io_timing)
+			INSTR_TIME_SET_CURRENT(io_start);
+
+		written = FileWrite(thisfile, data, bytestowrite,
+							WAIT_EVENT_BUFFILE_WRITE);
+
+		if (track_io_timing)
+		{
+			INSTR_TIME_SET_CURRENT(io_time);
+			INSTR_TIME_SUBTRACT(io_time, io_start);
+			INSTR_TIME_ADD(pgBufferUsage.temp_blk_write_time, io_time);
+		}
+
+		if (written <= 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to temporary file: %m")));
+
+		file->offsets[file->curFile] += written;
+		file->curOffset += written;
+		data += written;
+		len -= written;
+	}
+}
+
+/*
+ * Read up to 'len' bytes from the current physical position and advance it.
+ * Returns the number of bytes read, less than 'len' only at end of file.
+ */
+static int
+BufFileReadPhysical(BufFile *file, char *data, int len)
+{
+	int			nread = 0;
+	instr_time	io_start;
+	instr_time	io_time;
+
+	while (len > 0)
+	{
+		File		thisfile;
+		int			bytestoread;
+		int			got;
+
+		if (file->curOffset >= MAX_PHYSICAL_FILESIZE)
+		{
+			if (file->curFile + 1 >= file->numFiles)
+				break;
+			file->curFile++;
+			file->curOffset = 0L;
+		}
+
+		bytestoread = (int) Min((off_t) len,
+								MAX_PHYSICAL_FILESIZE - file->curOffset);
+
+		thisfile = file->files[file->curFile];
+		if (file->curOffset != file->offsets[file->curFile])
+		{
+			if (FileSeek(thisfile, file->curOffset, SEEK_SET) != file->curOffset)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not seek in temporary file: %m")));
+			file->offsets[file->curFile] = file->curOffset;
+		}
+
+		if (track_io_timing)
+			INSTR_TIME_SET_CURRENT(io_start);
+
+		got = FileRead(thisfile, data, bytestoread, WAIT_EVENT_BUFFILE_READ);
+
+		if (track_io_timing)
+		{
+			INSTR_TIME_SET_CURRENT(io_time);
+			INSTR_TIME_SUBTRACT(io_time, io_start);
+			INSTR_TIME_ADD(pgBufferUsage.temp_blk_read_time, io_time);
+		}
+
+		if (got < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read from temporary file: %m")));
+		if (got == 0)
+			break;
+
+		file->offsets[file->curFile] += got;
+		file->curOffset += got;
+		data += got;
+		len -= got;
+		nread += got;
+	}
+
+	pgBufferUsage.temp_blks_read += (nread + BLCKSZ - 1) / BLCKSZ;
+
+	return nread;
+}
+
+/*
+ * Return scratch space of at least 'size' bytes for a compressed chunk.
+ */
+static char *
+BufFileChunkScratch(int size)
+{
+	if (chunk_scratch_size < size)
+	{
+		if (chunk_scratch)
+			pfree(chunk_scratch);
+		chunk_scratch = MemoryContextAlloc(TopMemoryContext, size);
+		chunk_scratch_size = size;
+	}
+
+	return chunk_scratch;
+}
+
+/*
+ * Write out the current chunk of a sequential file and empty it.
+ */
+static void
+BufFileDumpChunk(BufFile *file)
+{
+	BufFileChunk *chunk = file->chunk;
+	BufFileChunkHeader *hdr = (BufFileChunkHeader *) chunk->buffer;
+	char	   *out = chunk->buffer;
+
+	hdr->rawlen = chunk->nbytes;
+	hdr->storedlen = chunk->nbytes;
+
+	if (chunk->compress)
+	{
+		int			bound = LZ4_compressBound(chunk->nbytes);
+		char	   *zbuf = BufFileChunkScratch(BUFFILE_CHUNK_HDRSZ + bound);
+		int			zlen;
+
+		zlen = LZ4_compress_default(BufFileChunkData(chunk),
+									zbuf + BUFFILE_CHUNK_HDRSZ,
+									chunk->nbytes, bound);
+
+		/* store the chunk raw if it does not shrink */
+		if (zlen > 0 && zlen < chunk->nbytes)
+		{
+			hdr = (BufFileChunkHeader *) zbuf;
+			hdr->rawlen = chunk->nbytes;
+			hdr->storedlen = zlen;
+			out = zbuf;
+		}
+
+		pgBufferUsage.temp_bytes_uncompressed += hdr->rawlen;
+		pgBufferUsage.temp_bytes_compressed += hdr->storedlen;
+	}
+
+	BufFileWritePhysical(file, out, BUFFILE_CHUNK_HDRSZ + hdr->storedlen);
+
+	chunk->pos = 0;
+	chunk->nbytes = 0;
+}
+
+/*
+ * Load the next chunk of a sequential file, and start prefetching the one
+ * after it.  Returns false at end of file.
+ */
+static bool
+BufFileLoadChunk(BufFile *file)
+{
+	BufFileChunk *chunk = file->chunk;
+	BufFileChunkHeader hdr;
+	int			nread;
+
+	chunk->pos = 0;
+	chunk->nbytes = 0;
+
+	nread = BufFileReadPhysical(file, chunk->buffer, BUFFILE_CHUNK_HDRSZ);
+	if (nread == 0)
+		return false;
+
+	memcpy(&hdr, chunk->buffer, sizeof(hdr));
+	if (nread != BUFFILE_CHUNK_HDRSZ ||
+		hdr.rawlen > chunk->size || hdr.storedlen > hdr.rawlen)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("invalid chunk header in temporary file")));
+
+	if (hdr.storedlen == hdr.rawlen)
+	{
+		nread = BufFileReadPhysical(file, BufFileChunkData(chunk), hdr.rawlen);
+		if (nread != hdr.rawlen)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read from temporary file: %m")));
+	}
+	else
+	{
+		char	   *zbuf = BufFileChunkScratch(hdr.storedlen);
+
+		nread = BufFileReadPhysical(file, zbuf, hdr.storedlen);
+		if (nread != hdr.storedlen)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read from temporary file: %m")));
+
+		if (LZ4_decompress_safe(zbuf, BufFileChunkData(chunk),
+								hdr.storedlen, hdr.rawlen) != hdr.rawlen)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg("could not decompress chunk of temporary file")));
+	}
+
+	chunk->nbytes = hdr.rawlen;
+
+	/* the next chunk starts right here; get the kernel reading it */
+	if (pg_workfile_prefetch && file->curOffset < MAX_PHYSICAL_FILESIZE)
+		(void) FilePrefetch(file->files[file->curFile], file->curOffset,
+							BUFFILE_CHUNK_HDRSZ + chunk->size,
+							WAIT_EVENT_BUFFILE_READ);
+
+	return true;
+}
+
 #ifdef __OPENTENBASE_C__
 int
 FlushBufFile(BufFile *file)
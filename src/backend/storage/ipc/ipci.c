@@ -299,6 +299,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 
 		size = add_size(size, SPMPlanShmemSize());
 		size = add_size(size, SPMHistoryShmemSize());
+		size = add_size(size, SPMSharedPlanShmemSize());
 
 		/*
 		 * Create the shmem segment
@@ -511,6 +512,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 
 	SPMPlanShmemInit();
 	SPMHistoryShmemInit();
+	SPMSharedPlanShmemInit();
 #ifdef EXEC_BACKEND
 
 	/*
@@ -763,22 +763,45 @@ mdclose(SMgrRelation reln, ForkNumber forknum)
 }
 
 /*
- *	mdprefetch() -- Initiate asynchronous read of the specified block of a relation
+ *	mdprefetch() -- Initiate asynchronous read of the specified blocks of a relation
  */
 void
-mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
+mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+		   BlockNumber nblocks)
 {
 #ifdef USE_PREFETCH
-	off_t		seekpos;
-	MdfdVec    *v;
+	/*
+	 * Issue as few requests as possible; have to split at segment boundaries
+	 * though, since those are actually separate files.
+	 */
+	while (nblocks > 0)
+	{
+		BlockNumber nfetch = nblocks;
+		off_t		seekpos;
+		MdfdVec    *v;
+
+		/*
+		 * During recovery we prefetch ahead of replay, when the file may not
+		 * have been created yet, or may have been dropped already.
+		 */
+		v = _mdfd_getseg(reln, forknum, blocknum, false,
+						 InRecovery ? EXTENSION_RETURN_NULL : EXTENSION_FAIL);
+		if (v == NULL)
+			return;
 
-	v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_FAIL);
+		if (blocknum / RELSEG_SIZE != (blocknum + nblocks - 1) / RELSEG_SIZE)
+			nfetch = RELSEG_SIZE - (blocknum % ((BlockNumber) RELSEG_SIZE));
 
-	seekpos = (off_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
+		seekpos = (off_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
 
-	Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
+		Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
 
-	(void) FilePrefetch(v->mdfd_vfd, seekpos, BLCKSZ, WAIT_EVENT_DATA_FILE_PREFETCH);
+		(void) FilePrefetch(v->mdfd_vfd, seekpos, BLCKSZ * nfetch,
+							WAIT_EVENT_DATA_FILE_PREFETCH);
+
+		nblocks -= nfetch;
+		blocknum += nfetch;
+	}
 #endif							/* USE_PREFETCH */
 }
 
@@ -60,6 +60,7 @@
 #include "optimizer/planmain.h"
 #include "optimizer/prep.h"
 #include "optimizer/spm.h"
+#include "optimizer/spm_cache.h"
 #include "parser/analyze.h"
 #include "parser/parsetree.h"
 #include "parser/parse_relation.h"
@@ -140,6 +141,9 @@ InitPlanCache(void)
 	CacheRegisterSyscacheCallback(AMOPOPID, PlanCacheSysCallback, (Datum) 0);
 	CacheRegisterSyscacheCallback(FOREIGNSERVEROID, PlanCacheSysCallback, (Datum) 0);
 	CacheRegisterSyscacheCallback(FOREIGNDATAWRAPPEROID, PlanCacheSysCallback, (Datum) 0);
+
+	/* The SPM shared plan cache relies on every backend to drop stale plans */
+	SPMSharedPlanCacheRegisterCallbacks();
 }
 
 /*
@@ -39,6 +39,8 @@
 #include "access/twophase.h"
 #include "access/xact.h"
 #include "access/xlog_internal.h"
+#include "access/xlogparallel.h"
+#include "access/xlogprefetch.h"
 #include "access/heapam_xlog.h"
 #include "catalog/inplace_upgrade.h"
 #include "catalog/namespace.h"
@@ -113,6 +115,7 @@
 #include "utils/builtins.h"
 #include "utils/bytea.h"
 #include "utils/guc_tables.h"
+#include "utils/memgrant.h"
 #include "utils/memutils.h"
 #include "utils/numeric.h"
 #include "utils/orcl_datetime_formatting.h"
@@ -200,11 +203,13 @@
 extern bool Log_disconnections;
 extern int	CommitDelay;
 extern int	CommitSiblings;
+extern bool CommitDelayAdaptive;
 extern char *default_tablespace;
 extern char *temp_tablespaces;
 extern bool ignore_checksum_failure;
 extern bool ignore_invalid_pages;
 extern bool synchronize_seqscans;
+extern int	seqscan_prefetch_pages;
 bool enable_skip_send_read_commited;
 #ifdef TRACE_SYNCSCAN
 extern bool trace_syncscan;
@@ -1492,6 +1497,16 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_incremental_sort", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of incremental sort steps."),
+			NULL,
+			GUC_EXPLAIN
+		},
+		&enable_incremental_sort,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_hashagg", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of hashed aggregation plans."),
@@ -1591,6 +1606,45 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_memoize", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of memoization."),
+			NULL,
+			GUC_EXPLAIN
+		},
+		&enable_memoize,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"enable_memory_rebalance", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Enables redistributing memory between the memory intensive operators of a query at run time."),
+			gettext_noop("An operator about to spill to disk may take budget that other operators "
+						 "of the same query left unused.")
+		},
+		&enable_memory_rebalance,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"pg_workfile_compression", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Compresses workfiles of spilling operators with LZ4."),
+			gettext_noop("Applies to workfiles that are written and read back sequentially, "
+						 "such as hash join batch files.")
+		},
+		&pg_workfile_compression,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"pg_workfile_prefetch", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Prefetches workfile data ahead of reading it."),
+			NULL
+		},
+		&pg_workfile_prefetch,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_nestloop", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of nested-loop join plans."),
@@ -2000,6 +2054,16 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"commit_delay_adaptive", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Derives the commit delay from recent WAL flush times."),
+			gettext_noop("The delay is at most commit_delay.")
+		},
+		&CommitDelayAdaptive,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"log_checkpoints", PGC_SIGHUP, LOGGING_WHAT,
 			gettext_noop("Logs each checkpoint."),
@@ -2155,6 +2219,15 @@ static struct config_bool ConfigureNamesBool[] =
 #endif
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_spm_plan_cache", PGC_USERSET, QUERY_TUNING,
+			gettext_noop("Enables reuse of plans from the SQL Plan Manager shared plan cache."),
+			NULL
+		},
+		&enable_spm_plan_cache,
+		true,
+		NULL, NULL, NULL
+	},
 #endif
 	{
 		{"debug_pretty_print", PGC_USERSET, LOGGING_WHAT,
@@ -4361,6 +4434,16 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"parallel_redo_workers", PGC_POSTMASTER, REPLICATION_STANDBY,
+			gettext_noop("Sets the number of worker processes that replay WAL in parallel on a standby server."),
+			gettext_noop("Zero replays all WAL in the startup process.")
+		},
+		&parallel_redo_workers,
+		0, 0, MAX_PARALLEL_WORKER_LIMIT,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_receiver_status_interval", PGC_SIGHUP, REPLICATION_STANDBY,
 			gettext_noop("Sets the maximum interval between WAL receiver status reports to the primary."),
@@ -4484,6 +4567,15 @@ static struct config_int ConfigureNamesInt[] =
 		80, -1, 100,
 		NULL, NULL, NULL
 	},
+	{
+		{"spm_plan_cache_size", PGC_POSTMASTER, QUERY_TUNING,
+			gettext_noop("Sets the number of generic plans of SPM-managed statements shared by all sessions."),
+			gettext_noop("Each entry reserves 64kB of shared memory. Zero disables the shared plan cache.")
+		},
+		&spm_plan_cache_size,
+		0, 0, 1024 * 1024,
+		NULL, NULL, NULL
+	},
 	{
 		{"plan_retention_weeks", PGC_USERSET, QUERY_TUNING,
 			gettext_noop("Used to set the percentage threshold for the upper limit of allowing the creation of baselines in "
@@ -5120,6 +5212,16 @@ static struct config_int ConfigureNamesInt[] =
 		check_wal_buffers, NULL, NULL
 	},
 
+	{
+		{"wal_insert_locks", PGC_POSTMASTER, WAL_SETTINGS,
+			gettext_noop("Sets the number of locks that allow concurrent insertion into the WAL buffers."),
+			gettext_noop("-1 sets the number based on the number of CPUs.")
+		},
+		&XLOGinsertLocks,
+		-1, -1, MAX_XLOGINSERT_LOCKS,
+		check_wal_insert_locks, NULL, NULL
+	},
+
 	{
 		{"wal_writer_delay", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Time between WAL flushes performed in the WAL writer."),
@@ -5154,6 +5256,17 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"recovery_prefetch_distance", PGC_SIGHUP, WAL_SETTINGS,
+			gettext_noop("Sets how far ahead of replay recovery reads WAL to prefetch data blocks."),
+			gettext_noop("Zero disables prefetching during recovery."),
+			GUC_UNIT_KB
+		},
+		&recovery_prefetch_distance,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	{
 		/* see max_connections */
 		{"max_wal_senders", PGC_POSTMASTER, REPLICATION_SENDING,
@@ -5305,6 +5418,22 @@ static struct config_int ConfigureNamesInt[] =
 		check_effective_io_concurrency, assign_effective_io_concurrency, NULL
 	},
 
+	{
+		{"seqscan_prefetch_pages",
+			PGC_USERSET,
+			RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Number of pages a sequential scan prefetches ahead of the page it reads."),
+			gettext_noop("Zero leaves read-ahead to the operating system.")
+		},
+		&seqscan_prefetch_pages,
+#ifdef USE_PREFETCH
+		0, 0, MAX_IO_CONCURRENCY,
+#else
+		0, 0, 0,
+#endif
+		NULL, NULL, NULL
+	},
+
 	{
 		{"backend_flush_after", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
 			gettext_noop("Number of pages after which previously performed writes are flushed to disk."),
@@ -5708,6 +5837,16 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"max_parallel_maintenance_workers", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Sets the maximum number of parallel processes per maintenance operation."),
+			gettext_noop("Currently only VACUUM uses them, to process the indexes of a table in parallel.")
+		},
+		&max_parallel_maintenance_workers,
+		0, 0, MAX_PARALLEL_WORKERS,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"max_parallel_workers", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
 			gettext_noop("Sets the maximum number of parallel workers that can be active at one time."),
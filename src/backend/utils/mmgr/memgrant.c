@@ -0,0 +1,226 @@
+/*-------------------------------------------------------------------------
+ *
+ * memgrant.c
+ *	  Run-time redistribution of a query's operator memory budget.
+ *
+ * The planner (see optimizer/util/memctl.c) splits query_mem statically:
+ * every memory intensive operator of a fragment gets work_mem or hash_mem.
+ * When the row estimates are wrong this wastes memory, e.g. a hash join
+ * spills to disk while a sibling sort never uses the memory it was given.
+ *
+ * A MemGrantPool collects the budgets of all memory intensive operators of
+ * one executor instance.  The pool total is the sum of those budgets, so it
+ * never exceeds what query_mem or the resource group allowed at plan time.
+ * Each operator holds a MemGrant and follows a simple protocol:
+ *
+ *	MemGrantStart	the operator begins to fill its memory; the grant may be
+ *					smaller than nominal if memory was revoked meanwhile, in
+ *					which case the operator spills earlier.
+ *	MemGrantExpand	the operator is about to spill; ask the pool for more.
+ *					The pool hands out unused budget and, if that is not
+ *					enough, revokes headroom from operators that have not
+ *					started yet.
+ *	MemGrantSettle	the operator stopped growing; headroom beyond what it
+ *					still holds goes back to the pool.
+ *	MemGrantRelease the operator freed its memory.
+ *
+ * Memory is never revoked from an operator that is filling, so operators do
+ * not need to be interrupted and there is no ping-pong between them.
+ *
+ * Copyright (c) 2022-Present OpenTenBase development team, Tencent
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/utils/mmgr/memgrant.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "utils/memgrant.h"
+
+bool		enable_memory_rebalance = false;
+
+static int64 memgrant_reclaim(MemGrantPool *pool, MemGrant *requester,
+				 int64 wanted);
+
+/*
+ * Create an empty pool in the current memory context.
+ */
+MemGrantPool *
+MemGrantPoolCreate(void)
+{
+	MemGrantPool *pool = (MemGrantPool *) palloc0(sizeof(MemGrantPool));
+
+	return pool;
+}
+
+/*
+ * Register an operator with 'nominal' bytes of budget.  The pool grows by the
+ * same amount, so registering never takes memory from anybody else.
+ */
+MemGrant *
+MemGrantRegister(MemGrantPool *pool, int plan_node_id, int64 nominal)
+{
+	MemGrant   *grant = (MemGrant *) palloc0(sizeof(MemGrant));
+
+	nominal = Max(nominal, MEMGRANT_MIN_BYTES);
+
+	grant->pool = pool;
+	grant->plan_node_id = plan_node_id;
+	grant->status = MEMGRANT_IDLE;
+	grant->nominal = nominal;
+	grant->granted = nominal;
+	grant->peak = nominal;
+
+	pool->total += nominal;
+	pool->granted += nominal;
+	pool->grants = lappend(pool->grants, grant);
+
+	return grant;
+}
+
+/*
+ * The operator starts to fill its memory.  Returns the number of bytes it
+ * may use.
+ *
+ * An operator restarting after MemGrantSettle/MemGrantRelease (e.g. on a
+ * rescan) gets back up to its nominal budget from what is free, but nothing
+ * is revoked from others for that.
+ */
+int64
+MemGrantStart(MemGrant *grant)
+{
+	MemGrantPool *pool = grant->pool;
+
+	if (grant->status == MEMGRANT_SETTLED && grant->granted < grant->nominal)
+	{
+		int64		avail = pool->total - pool->granted;
+		int64		take = Min(grant->nominal - grant->granted, Max(avail, 0));
+
+		grant->granted += take;
+		pool->granted += take;
+	}
+
+	/* always leave the operator something to work with */
+	if (grant->granted < MEMGRANT_MIN_BYTES)
+	{
+		pool->granted += MEMGRANT_MIN_BYTES - grant->granted;
+		grant->granted = MEMGRANT_MIN_BYTES;
+	}
+
+	grant->status = MEMGRANT_ACTIVE;
+	grant->used = 0;
+
+	return grant->granted;
+}
+
+/*
+ * The operator currently uses 'used' bytes and would have to spill unless it
+ * gets 'request' more.  Returns the number of bytes added to its grant, 0 if
+ * the operator should spill.
+ */
+int64
+MemGrantExpand(MemGrant *grant, int64 used, int64 request)
+{
+	MemGrantPool *pool = grant->pool;
+	int64		avail;
+	int64		give;
+
+	grant->used = used;
+
+	if (grant->status != MEMGRANT_ACTIVE || request <= 0)
+		return 0;
+
+	avail = pool->total - pool->granted;
+	if (avail < request)
+		avail += memgrant_reclaim(pool, grant, request - avail);
+
+	give = Min(avail, request);
+
+	/* a tiny increment only postpones the spill; don't bother */
+	if (give < MEMGRANT_MIN_BYTES)
+		return 0;
+
+	grant->granted += give;
+	pool->granted += give;
+	grant->peak = Max(grant->peak, grant->granted);
+	grant->nexpand++;
+
+	elog(DEBUG2, "memory grant of plan node %d expanded by " INT64_FORMAT
+		 " to " INT64_FORMAT " bytes",
+		 grant->plan_node_id, give, grant->granted);
+
+	return give;
+}
+
+/*
+ * The operator stopped growing and holds 'used' bytes; give the rest back.
+ */
+void
+MemGrantSettle(MemGrant *grant, int64 used)
+{
+	MemGrantPool *pool = grant->pool;
+	int64		keep = Max(used, MEMGRANT_MIN_BYTES);
+
+	grant->status = MEMGRANT_SETTLED;
+	grant->used = used;
+
+	if (grant->granted > keep)
+	{
+		pool->granted -= grant->granted - keep;
+		grant->granted = keep;
+	}
+}
+
+/*
+ * The operator freed all of its memory.
+ */
+void
+MemGrantRelease(MemGrant *grant)
+{
+	MemGrantPool *pool = grant->pool;
+
+	grant->status = MEMGRANT_SETTLED;
+	grant->used = 0;
+	pool->granted -= grant->granted;
+	grant->granted = 0;
+}
+
+/*
+ * Revoke up to 'wanted' bytes of headroom from operators that have not
+ * started yet.  They will notice the smaller grant in MemGrantStart.
+ */
+static int64
+memgrant_reclaim(MemGrantPool *pool, MemGrant *requester, int64 wanted)
+{
+	int64		reclaimed = 0;
+	ListCell   *lc;
+
+	foreach(lc, pool->grants)
+	{
+		MemGrant   *grant = (MemGrant *) lfirst(lc);
+		int64		spare;
+		int64		take;
+
+		if (reclaimed >= wanted)
+			break;
+		if (grant == requester || grant->status != MEMGRANT_IDLE)
+			continue;
+
+		spare = grant->granted - MEMGRANT_MIN_BYTES;
+		if (spare <= 0)
+			continue;
+
+		take = Min(spare, wanted - reclaimed);
+		grant->granted -= take;
+		grant->nrevoked++;
+		pool->granted -= take;
+		reclaimed += take;
+
+		elog(DEBUG2, "revoked " INT64_FORMAT " bytes from memory grant of plan node %d",
+			 take, grant->plan_node_id);
+	}
+
+	return reclaimed;
+}
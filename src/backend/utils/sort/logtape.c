@@ -304,6 +304,14 @@ ltsReadFillBuffer(LogicalTapeSet *lts, LogicalTape *lt)
 		/* Advance to next block, if we have buffer space left */
 	} while (lt->buffer_size - lt->nbytes > BLCKSZ);
 
+	/*
+	 * Blocks of a tape are mostly allocated in ascending order, so start the
+	 * kernel reading the next bufferload while this one is being consumed.
+	 */
+	if (lt->nextBlockNumber != -1L)
+		BufFilePrefetchBlock(lts->pfile, lt->nextBlockNumber,
+							 lt->buffer_size / BLCKSZ);
+
 	return (lt->nbytes > 0);
 }
 
@@ -105,6 +105,7 @@
 #include "utils/datum.h"
 #include "utils/logtape.h"
 #include "utils/lsyscache.h"
+#include "utils/memgrant.h"
 #include "utils/memutils.h"
 #include "utils/pg_rusage.h"
 #include "utils/rel.h"
@@ -247,6 +248,7 @@ struct Tuplesortstate
 	bool		tuples;			/* Can SortTuple.tuple ever be set? */
 	int64		availMem;		/* remaining memory available, in bytes */
 	int64		allowedMem;		/* total memory allowed, in bytes */
+	struct MemGrant *memgrant;	/* lets allowedMem grow at run time */
 	int			maxTapes;		/* number of tapes (Knuth's T) */
 	int			tapeRange;		/* maxTapes-1 (Knuth's P) */
 	MemoryContext sortcontext;	/* memory context holding most sort data */
@@ -1502,6 +1504,29 @@ tuplesort_set_bound(Tuplesortstate *state, int64 bound)
 	state->sortKeys->abbrev_full_comparator = NULL;
 }
 
+/*
+ * tuplesort_attach_memgrant
+ *
+ *	Take the memory budget from a run-time memory grant instead of workMem.
+ *	The grant may have been shrunk by other operators before we start, and
+ *	may be enlarged later instead of switching to tapes.
+ *
+ * Must be called before inserting any tuples.
+ */
+void
+tuplesort_attach_memgrant(Tuplesortstate *state, MemGrant *grant)
+{
+	int64		allowed;
+
+	Assert(state->status == TSS_INITIAL);
+	Assert(state->memtupcount == 0);
+
+	state->memgrant = grant;
+	allowed = MemGrantStart(grant);
+	state->availMem += allowed - state->allowedMem;
+	state->allowedMem = allowed;
+}
+
 /*
  * tuplesort_end
  *
@@ -1570,6 +1595,10 @@ tuplesort_end(Tuplesortstate *state)
 		FreeExecutorState(state->estate);
 	}
 
+	/* Hand our memory back to the other operators of the query */
+	if (state->memgrant)
+		MemGrantRelease(state->memgrant);
+
 	MemoryContextSwitchTo(oldcontext);
 
 	/*
@@ -1708,6 +1737,36 @@ noalloc:
 	return false;
 }
 
+/*
+ * Ask the memory grant for more memory before switching to tape-based
+ * operation.  Returns true if the sort can go on in memory.
+ */
+static bool
+expand_memgrant(Tuplesortstate *state)
+{
+	int64		extra;
+
+	/* a bounded sort keeps its heap within the original budget */
+	if (state->memgrant == NULL || state->bounded)
+		return false;
+
+	/* try to double our budget, as grow_memtuples does with the array */
+	extra = MemGrantExpand(state->memgrant,
+						   state->allowedMem - state->availMem,
+						   state->allowedMem);
+	if (extra == 0)
+		return false;
+
+	state->allowedMem += extra;
+	state->availMem += extra;
+	state->growmemtuples = true;
+
+	if (state->memtupcount >= state->memtupsize - 1)
+		(void) grow_memtuples(state);
+
+	return state->memtupcount < state->memtupsize && !LACKMEM(state);
+}
+
 /*
  * Accept one tuple while collecting input data for sort.
  *
@@ -1969,6 +2028,12 @@ puttuple_common(Tuplesortstate *state, SortTuple *tuple)
 			if (state->memtupcount < state->memtupsize && !LACKMEM(state))
 				return;
 
+			/*
+			 * Perhaps other operators of the query leave us more memory.
+			 */
+			if (expand_memgrant(state))
+				return;
+
 			/*
 			 * Nope; time to switch to tape-based operation.
 			 */
@@ -2132,6 +2197,15 @@ tuplesort_performsort(Tuplesortstate *state)
 			break;
 	}
 
+	/*
+	 * No more input: an in-memory sort only needs what it holds now, give
+	 * the rest of the grant back.  Merging uses the whole budget.
+	 */
+	if (state->memgrant)
+		MemGrantSettle(state->memgrant,
+					   state->status == TSS_SORTEDINMEM ?
+					   state->allowedMem - state->availMem : state->allowedMem);
+
 #ifdef TRACE_SORT
 	if (trace_sort)
 	{
@@ -107,6 +107,12 @@ int			pg_workfile_limit_per_query = 0;
 /* Maximum number of workfiles to be created by a query */
 int			pg_workfile_limit_files_per_query = 0;
 
+/* LZ4-compress workfiles that are accessed sequentially */
+bool		pg_workfile_compression = false;
+
+/* Prefetch workfile data ahead of reading it */
+bool		pg_workfile_prefetch = true;
+
 #define SizeOfWorkFileUsagePerQueryKey (2 * sizeof(int32));
 
 typedef struct workfile_set WorkFileSetSharedEntry;
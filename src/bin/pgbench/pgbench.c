@@ -452,6 +452,19 @@ static const BuiltinScript builtin_script[] =
 		"SELECT abalance FROM pgbench_accounts WHERE aid = :aid;\n",
 		false
 	},
+	{
+		"wal-heavy",
+		"<builtin: WAL heavy>",
+		"\\set aid random(1, " CppAsString2(naccounts) " * :scale)\n"
+		"\\set bid random(1, " CppAsString2(nbranches) " * :scale)\n"
+		"\\set tid random(1, " CppAsString2(ntellers) " * :scale)\n"
+		"\\set delta random(-5000, 5000)\n"
+		"BEGIN;\n"
+		"UPDATE pgbench_accounts SET abalance = abalance + :delta WHERE aid = :aid;\n"
+		"INSERT INTO pgbench_history (tid, bid, aid, delta, mtime, filler) SELECT :tid, :bid, :aid, :delta, CURRENT_TIMESTAMP, repeat('x', 22) FROM generate_series(1, 16);\n"
+		"END;\n",
+		false
+	},
 	{
 		"tpcb-like",
 		"<builtin: TPC-B (sort of)>",
@@ -489,6 +502,19 @@ static const BuiltinScript builtin_script[] =
 		"\\set bid random(1, " CppAsString2(nbranches) " * :scale)\n"
 		"SELECT abalance FROM pgbench_accounts WHERE aid = :aid AND bid = :bid;\n",
 		true
+	},
+	{
+		"wal-heavy",
+		"<builtin: WAL heavy bid>",
+		"\\set aid random(1, " CppAsString2(naccounts) " * :scale)\n"
+		"\\set bid random(1, " CppAsString2(nbranches) " * :scale)\n"
+		"\\set tid random(1, " CppAsString2(ntellers) " * :scale)\n"
+		"\\set delta random(-5000, 5000)\n"
+		"BEGIN;\n"
+		"UPDATE pgbench_accounts SET abalance = abalance + :delta WHERE aid = :aid AND bid = :bid;\n"
+		"INSERT INTO pgbench_history (tid, bid, aid, delta, mtime, filler) SELECT :tid, :bid, :aid, :delta, CURRENT_TIMESTAMP, repeat('x', 22) FROM generate_series(1, 16);\n"
+		"END;\n",
+		true
 	}
 };
 
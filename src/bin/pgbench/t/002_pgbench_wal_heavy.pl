@@ -0,0 +1,43 @@
+use strict;
+use warnings;
+
+use PostgresNode;
+use TestLib;
+use Test::More tests => 5;
+
+# Run the WAL-heavy builtin script with several clients, so that they
+# contend for the WAL insertion locks and the group commit.
+my $node = get_new_node('main', 'datanode');
+$node->init(extra => ['--master_gtm_nodename', 'no_gtm',
+                      '--master_gtm_ip', '127.0.0.1',
+                      '--master_gtm_port', '25001']);
+$node->append_conf('postgresql.conf', qq[
+allow_dml_on_datanode = on
+is_centralized_mode = on
+wal_insert_locks = 2
+commit_delay = 1000
+commit_siblings = 1
+commit_delay_adaptive = on
+]);
+$node->start;
+
+is($node->safe_psql('postgres', 'SHOW wal_insert_locks'), '2',
+	'wal_insert_locks is set');
+
+$node->command_ok([qw(pgbench --initialize --scale=1)], 'pgbench initialization');
+
+$node->command_like(
+	[   qw(pgbench --no-vacuum --builtin=wal-heavy --client=4
+		  --transactions=25) ],
+	qr{processed: 100/100},
+	'WAL-heavy builtin script');
+
+is($node->safe_psql('postgres', 'SELECT count(*) FROM pgbench_history'),
+	'1600', 'every transaction inserted its history rows');
+
+# Inserters pick a lock modulo the count, so zero locks must be refused
+$node->stop;
+command_fails(
+	[ 'postgres', '-D', $node->data_dir, '-c', 'wal_insert_locks=0',
+	  '-C', 'wal_insert_locks' ],
+	'wal_insert_locks = 0 is rejected');
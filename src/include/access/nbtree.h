@@ -121,6 +121,50 @@ typedef struct BTMetaPageData
 				   MAXALIGN(SizeOfPageHeaderData + 3*sizeof(ItemIdData)) - \
 				   MAXALIGN(sizeof(BTPageOpaqueData))) / 3)
 
+/*
+ * Posting list tuples.
+ *
+ * When deduplication is enabled for a non-unique index, a run of leaf tuples
+ * with bitwise equal keys may be merged into a single "posting list" tuple
+ * that stores all of their heap TIDs.  Such a tuple has INDEX_ALT_TID_MASK
+ * set in t_info, and its t_tid does not point to the heap: the block number
+ * holds the offset of the posting list within the tuple and the offset
+ * number holds the number of heap TIDs.  The posting list is an array of
+ * ItemPointerData in ascending order, starting at the MAXALIGN'd end of the
+ * key attributes.  Posting list tuples only appear as data items on leaf
+ * pages; high keys and downlinks never carry a posting list.
+ *
+ * A posting list tuple is limited to half of BTMaxItemSize so that a page
+ * holding one can always be split.  MaxTIDsPerBTreePage bounds the number of
+ * heap TIDs a leaf page can reference, posting lists included.
+ */
+#define BTreeTupleIsPosting(itup) \
+	(((itup)->t_info & INDEX_ALT_TID_MASK) != 0)
+#define BTreeTupleGetNPosting(itup) \
+	( \
+		AssertMacro(BTreeTupleIsPosting(itup)), \
+		ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) \
+	)
+#define BTreeTupleGetPostingOffset(itup) \
+	( \
+		AssertMacro(BTreeTupleIsPosting(itup)), \
+		ItemPointerGetBlockNumberNoCheck(&(itup)->t_tid) \
+	)
+#define BTreeTupleGetPosting(itup) \
+	((ItemPointer) ((char *) (itup) + BTreeTupleGetPostingOffset(itup)))
+#define BTreeTupleGetPostingN(itup, n) \
+	(BTreeTupleGetPosting(itup) + (n))
+#define BTreeTupleGetHeapTID(itup) \
+	(BTreeTupleIsPosting(itup) ? BTreeTupleGetPosting(itup) : &(itup)->t_tid)
+#define BTreeTupleGetNHeapTIDs(itup) \
+	(BTreeTupleIsPosting(itup) ? BTreeTupleGetNPosting(itup) : 1)
+
+#define BTMaxPostingSize(page) \
+	Min(MAXALIGN_DOWN(BTMaxItemSize(page) / 2), INDEX_SIZE_MASK)
+#define MaxTIDsPerBTreePage \
+	(int) ((BLCKSZ - SizeOfPageHeaderData - sizeof(BTPageOpaqueData)) / \
+		   sizeof(ItemPointerData))
+
 /*
  * The leaf-page fillfactor defaults to 90% but is user-adjustable.
  * For pages above the leaf level, we use a fixed 70% fillfactor.
@@ -330,7 +374,7 @@ typedef struct BTScanPosData
 	int			lastItem;		/* last valid index in items[] */
 	int			itemIndex;		/* current index in items[] */
 
-	BTScanPosItem items[MaxIndexTuplesPerPage]; /* MUST BE LAST */
+	BTScanPosItem items[MaxTIDsPerBTreePage];	/* MUST BE LAST */
 } BTScanPosData;
 
 typedef BTScanPosData *BTScanPos;
@@ -432,6 +476,33 @@ typedef BTScanOpaqueData *BTScanOpaque;
 #define SK_BT_DESC			(INDOPTION_DESC << SK_BT_INDOPTION_SHIFT)
 #define SK_BT_NULLS_FIRST	(INDOPTION_NULLS_FIRST << SK_BT_INDOPTION_SHIFT)
 
+/*
+ * Working state for merging a run of equal leaf tuples into a posting list
+ * tuple, shared by the deduplication pass and the bulk loader.
+ */
+typedef struct BTDedupStateData
+{
+	Size		maxpostingsize; /* limit on size of the final tuple */
+	IndexTuple	base;			/* first tuple of the pending run */
+	Size		basekeysz;		/* size of base's key image */
+	ItemPointer htids;			/* heap TIDs of the pending run */
+	int			nhtids;			/* number of heap TIDs in htids */
+	int			nitems;			/* number of tuples merged into the run */
+} BTDedupStateData;
+
+typedef BTDedupStateData *BTDedupState;
+
+/*
+ * Deduplication is used only for non-unique indexes that ask for it.
+ * Unique indexes would rarely benefit, and _bt_check_unique expects one
+ * heap TID per tuple.
+ */
+#define BTGetDeduplicateItems(relation) \
+	((relation)->rd_options ? \
+	 ((StdRdOptions *) (relation)->rd_options)->deduplicate_items : false)
+#define BTDeduplicationEnabled(relation) \
+	(!(relation)->rd_index->indisunique && BTGetDeduplicateItems(relation))
+
 typedef struct BTCheckElement {
     Buffer buffer;
     BTStack btStack;
@@ -485,6 +556,18 @@ extern bool _bt_doinsert(Relation rel, IndexTuple itup,
 extern Buffer _bt_getstackbuf(Relation rel, BTStack stack, int access);
 extern void _bt_finish_split(Relation rel, Buffer bbuf, BTStack stack);
 
+/*
+ * prototypes for functions in nbtdedup.c
+ */
+extern void _bt_dedup_init(BTDedupState state, Size maxpostingsize);
+extern bool _bt_dedup_keyequal(IndexTuple itup1, IndexTuple itup2);
+extern void _bt_dedup_start_pending(BTDedupState state, IndexTuple base);
+extern bool _bt_dedup_save_htid(BTDedupState state, IndexTuple itup);
+extern IndexTuple _bt_dedup_finish_pending(BTDedupState state);
+extern bool _bt_dedup_pass(Relation rel, Buffer buf);
+extern IndexTuple _bt_form_posting(IndexTuple base, ItemPointer htids,
+				 int nhtids);
+
 /*
  * prototypes for functions in nbtpage.c
  */
@@ -503,7 +586,8 @@ extern void _bt_delitems_delete(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems, Relation heapRel);
 extern void _bt_delitems_vacuum(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems,
-					BlockNumber lastBlockVacuumed);
+					OffsetNumber *updatedoffsets, IndexTuple *updated,
+					int nupdated, BlockNumber lastBlockVacuumed);
 extern int	_bt_pagedel(Relation rel, Buffer buf);
 
 /*
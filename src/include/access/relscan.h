@@ -86,6 +86,8 @@ typedef struct HeapScanDescData
 	BlockNumber rs_cblock;		/* current block # in scan, if any */
 	Buffer		rs_cbuf;		/* current buffer in scan, if any */
 	/* NB: if rs_cbuf is not InvalidBuffer, we hold a pin on that buffer */
+	int			rs_prefetch_target; /* current prefetch distance, in pages */
+	BlockNumber rs_prefetch_next;	/* scan position of next page to prefetch */
 	ParallelHeapScanDesc rs_parallel;	/* parallel scan information */
 	/*
 	 * For parallel scans to store page allocation data.  NULL when not
@@ -165,6 +167,19 @@ typedef struct IndexScanDescData
 	/* state data for traversing HOT chains in index_getnext */
 	bool		xs_continue_hot;	/* T if must keep walking HOT chain */
 
+	/*
+	 * Upper bound on the number of tuples the caller will fetch, or -1 if
+	 * unknown.  Set by the executor from a parent LIMIT; ordering AMs may use
+	 * it to size their candidate lists when they don't set xs_recheck.
+	 */
+	int64		xs_tuples_needed;
+
+	/*
+	 * True if the executor applies further quals to the returned tuples, so
+	 * an ordering AM may have to produce more candidates than requested.
+	 */
+	bool		xs_filtered;
+
 	
 #ifdef __SUPPORT_DISTRIBUTED_TRANSACTION__
 	/* statistic account */
@@ -127,11 +127,18 @@ extern PGDLLIMPORT XLogRecPtr XactLastCommitEnd;
 
 extern bool reachedConsistency;
 
+/*
+ * Upper limit for wal_insert_locks.  WALInsertLockAcquireExclusive() holds
+ * all of them at once, so this must stay well below MAX_SIMUL_LWLOCKS.
+ */
+#define MAX_XLOGINSERT_LOCKS	128
+
 /* these variables are GUC parameters related to XLOG */
 extern int	min_wal_size_mb;
 extern int	max_wal_size_mb;
 extern int	wal_keep_segments;
 extern int	XLOGbuffers;
+extern int	XLOGinsertLocks;
 extern int	XLogArchiveTimeout;
 extern int	wal_retrieve_retry_interval;
 extern char *XLogArchiveCommand;
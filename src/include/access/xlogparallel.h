@@ -0,0 +1,27 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogparallel.h
+ *	  Parallel WAL redo on standby servers.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/xlogparallel.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef XLOGPARALLEL_H
+#define XLOGPARALLEL_H
+
+#include "access/xlogreader.h"
+
+/* GUC variable */
+extern int	parallel_redo_workers;
+
+extern bool ParallelRedoDispatch(XLogReaderState *record);
+extern void ParallelRedoAfterReplay(XLogReaderState *record);
+extern void ParallelRedoShutdown(void);
+
+extern void ParallelRedoWorkerMain(Datum main_arg);
+
+#endif							/* XLOGPARALLEL_H */
@@ -3083,7 +3083,7 @@ DATA(insert OID = 6150 (  pg_stat_get_cluster_activity          PGNSP PGUID 12 1
 DESCR("statistics: information about currently cluster active backends");
 DATA(insert OID = 3318 (  pg_stat_get_progress_info           PGNSP PGUID 12 1 100 0 0 f f f t t s r 1 0 2249 "25" "{25,23,26,26,20,20,20,20,20,20,20,20,20,20}" "{i,o,o,o,o,o,o,o,o,o,o,o,o,o}" "{cmdtype,pid,datid,relid,param1,param2,param3,param4,param5,param6,param7,param8,param9,param10}" _null_ _null_ pg_stat_get_progress_info _null_ _null_ _null_ ));
 DESCR("statistics: information about progress of backends running maintenance command");
-DATA(insert OID = 3099 (  pg_stat_get_wal_senders   PGNSP PGUID 12 1 10 0 0 f f f f t s r 0 0 2249 "" "{23,25,3220,3220,3220,3220,1186,1186,1186,23,25}" "{o,o,o,o,o,o,o,o,o,o,o}" "{pid,state,sent_lsn,write_lsn,flush_lsn,replay_lsn,write_lag,flush_lag,replay_lag,sync_priority,sync_state}" _null_ _null_ pg_stat_get_wal_senders _null_ _null_ _null_ ));
+DATA(insert OID = 3099 (  pg_stat_get_wal_senders   PGNSP PGUID 12 1 10 0 0 f f f f t s r 0 0 2249 "" "{23,25,3220,3220,3220,3220,1186,1186,1186,23,25,701}" "{o,o,o,o,o,o,o,o,o,o,o,o}" "{pid,state,sent_lsn,write_lsn,flush_lsn,replay_lsn,write_lag,flush_lag,replay_lag,sync_priority,sync_state,replay_rate}" _null_ _null_ pg_stat_get_wal_senders _null_ _null_ _null_ ));
 DESCR("statistics: information about currently active replication");
 DATA(insert OID = 3317 (  pg_stat_get_wal_receiver  PGNSP PGUID 12 1 0 0 0 f f f f f s r 0 0 2249 "" "{23,25,3220,23,3220,23,1184,1184,3220,1184,25,25}" "{o,o,o,o,o,o,o,o,o,o,o,o}" "{pid,status,receive_start_lsn,receive_start_tli,received_lsn,received_tli,last_msg_send_time,last_msg_receipt_time,latest_end_lsn,latest_end_time,slot_name,conninfo}" _null_ _null_ pg_stat_get_wal_receiver _null_ _null_ _null_ ));
 DESCR("statistics: information about WAL receiver");
@@ -6148,6 +6148,8 @@ DATA(insert OID = 8086 (  opentenbase_remove_sub_stat PGNSP PGUID 12 1 0 0 0 f f
 DESCR("remove subscription statistic entry in hashtable");
 DATA(insert OID = 8087 (  opentenbase_remove_subtable_stat PGNSP PGUID 12 1 0 0 0 f f f t f v r 1 0 16 "26" _null_ _null_ _null_ _null_ _null_ opentenbase_remove_subtable_stat _null_ _null_ _null_ ));
 DESCR("remove subscription table statistic entry in hashtable");
+DATA(insert OID = 8014 (  opentenbase_get_all_sub_apply_stat PGNSP PGUID 12 1 0 0 0 f f f t t v r 0 0 2249 "" "{25,20,3220,1184,1186,701}" "{o,o,o,o,o,o}" "{subscription_name,xacts_applied,last_commit_lsn,last_commit_time,apply_lag,utilization}" _null_ _null_ opentenbase_get_all_sub_apply_stat _null_ _null_ _null_ ));
+DESCR("get apply progress of all subscriptions");
 DATA(insert OID = 8088 (  vacuum_hidden_shards	PGNSP PGUID 12 1 0 0 0 f f f t f s r 1 0 20 "25" _null_ _null_ _null_ _null_ _null_ vacuum_hidden_shards _null_ _null_ _null_ ));
 DESCR("vacuum hidden shards");
 DATA(insert OID = 8089 (  opentenbase_shard_statistic PGNSP PGUID 12 1 0 0 0 f f f t t v r 0 0 2249 "" "{25,25,23,20,20,20,20,20,20}" "{o,o,o,o,o,o,o,o,o}" "{group_name,node_name,shard_id,ntups_select,ntups_insert,ntups_update,ntups_delete,size,ntups}" _null_ _null_ opentenbase_shard_statistic _null_ _null_ _null_ ));
@@ -6832,6 +6834,8 @@ DATA(insert OID = 8721 ( pg_spm_reload_sql_plan_cache      PGNSP PGUID 12 1 0 0
 DESCR("Rebuild spm plan cache in shared memory.");
 DATA(insert OID = 8722 ( sql_identity      PGNSP PGUID 12 1 0 0 0 f f f t f s s 3 0 23 "25 16 16" _null_ _null_ _null_ _null_ _null_ sql_identity _null_ _null_ _null_ ));
 DESCR("get sql identity");
+DATA(insert OID = 8725 ( pg_spm_shared_plan_cache_stats      PGNSP PGUID 12 1 0 0 0 f f f t f v r 0 0 2249 "" "{23,20,20,20}" "{o,o,o,o}" "{entries,hits,stores,invalidations}" _null_ _null_ pg_spm_shared_plan_cache_stats _null_ _null_ _null_ ));
+DESCR("statistics of the SPM shared plan cache");
 
 #ifdef __OPENTENBASE_C__
 DATA(insert OID = 8094 (  distinct_accum		PGNSP PGUID 12 1 0 0 0 f f f f f i s 2 0 2281 "2281 2276" _null_ _null_ _null_ _null_ _null_ distinct_accum _null_ _null_ _null_ ));
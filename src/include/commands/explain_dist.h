@@ -39,6 +39,20 @@ typedef struct
     HashInstrumentation stat;
 } RemoteHashState;
 
+typedef struct
+{
+    RemoteState rs;
+    /* values used in explain analyze from MemoizeState, mem_peak in kB */
+    MemoizeInstrumentation stat;
+} RemoteMemoizeState;
+
+typedef struct
+{
+    RemoteState rs;
+    /* values used in explain analyze from IncrementalSortState */
+    IncrementalSortGroupInfo stat;
+} RemoteIncrementalSortState;
+
 typedef struct
 {
     RemoteState rs;
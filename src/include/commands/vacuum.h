@@ -21,9 +21,12 @@
 #include "executor/tuptable.h"
 #include "executor/executor.h"
 #include "nodes/parsenodes.h"
+#include "port/atomics.h"
 #include "storage/buf.h"
+#include "storage/dsm.h"
 #include "storage/lock.h"
 #include "storage/relfilenode.h"
+#include "storage/shm_toc.h"
 #include "utils/relcache.h"
 
 
@@ -216,6 +219,11 @@ extern int	vacuum_freeze_table_age;
 extern int	vacuum_multixact_freeze_min_age;
 extern int	vacuum_multixact_freeze_table_age;
 
+/* Variables for cost-based parallel vacuum */
+extern pg_atomic_uint32 *VacuumSharedCostBalance;
+extern pg_atomic_uint32 *VacuumActiveNWorkers;
+extern int	VacuumCostBalanceLocal;
+
 #ifdef __OPENTENBASE__
 typedef struct 
 {
@@ -267,6 +275,7 @@ TargetEntry *make_relation_tle(Oid reloid, const char *relname, const char *colu
 
 extern void lazy_vacuum_rel(Relation onerel, int options,
 				VacuumParams *params, BufferAccessStrategy bstrategy);
+extern void parallel_vacuum_main(dsm_segment *seg, shm_toc *toc);
 #ifdef _SHARDING_
 extern void truncate_extent_tuples(Relation onerel, 
 							BlockNumber	 from_blk, 
@@ -360,6 +360,7 @@ typedef struct HashJoinTableData
 	Size		spacePeak;		/* peak space used */
 	Size		spaceUsedSkew;	/* skew hash table's current space usage */
 	Size		spaceAllowedSkew;	/* upper limit for skew hashtable */
+	struct MemGrant *memgrant;	/* run-time memory grant, or NULL */
 
 	MemoryContext hashCxt;		/* context for whole-hash-join storage */
 	MemoryContext batchCxt;		/* context for this-batch-only storage */
@@ -30,6 +30,10 @@ typedef struct BufferUsage
 	long		temp_blks_written;	/* # of temp blocks written */
 	instr_time	blk_read_time;	/* time spent reading */
 	instr_time	blk_write_time; /* time spent writing */
+	instr_time	temp_blk_read_time;	/* time spent reading temp blocks */
+	instr_time	temp_blk_write_time;	/* time spent writing temp blocks */
+	long		temp_bytes_uncompressed;	/* # of temp bytes given to compression */
+	long		temp_bytes_compressed;	/* # of temp bytes after compression */
 } BufferUsage;
 
 /* Flag bits included in InstrAlloc's instrument_options bitmask */
@@ -64,6 +64,7 @@ extern void ExecHashTableResetMatchFlags(HashJoinTable hashtable);
 extern void ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 									bool try_combined_hash_mem,
 									int parallel_workers,
+									int hash_mem,
 									size_t *space_allowed,
 									int *numbuckets,
 									int *numbatches,
@@ -30,7 +30,7 @@ extern void ExecHashJoinInitializeWorker(HashJoinState *state,
 							 ParallelWorkerContext *pwcxt);
 
 extern void ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
-					  BufFile **fileptr);
+					  BufFile **fileptr, HashJoinTable hashtable);
 
 #ifdef __OPENTENBASE_C__
 extern void ExecEagerFreeHashJoin(PlanState *pstate);
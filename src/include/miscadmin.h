@@ -205,6 +205,7 @@ extern PGDLLIMPORT int MaxBackends;
 extern PGDLLIMPORT int MaxConnections;
 extern PGDLLIMPORT int max_worker_processes;
 extern PGDLLIMPORT int max_parallel_workers;
+extern PGDLLIMPORT int max_parallel_maintenance_workers;
 extern int pg_workfile_max_entries;
 
 extern PGDLLIMPORT int FnNBuffers;
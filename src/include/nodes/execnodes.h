@@ -19,6 +19,7 @@
 #include "access/heapam.h"
 #include "access/tupconvert.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -627,6 +628,9 @@ typedef struct EState
 	uint64		es_rc_total_memory;	/* memory used for result cache keys and values */
 	bool		es_rc_explained;
 
+	/* operator memory budgets shared at run time, see utils/memgrant.h */
+	struct MemGrantPool *es_memgrant_pool;
+
 	/*
 	 * this ExprContext is for per-output-tuple operations, such as constraint
 	 * checks and index-value computations.  It will be reset for each output
@@ -1528,6 +1532,7 @@ typedef struct
  *		OrderByTypByVals   is the datatype of order by expression pass-by-value?
  *		OrderByTypLens	   typlens of the datatypes of order by expressions
  *		pscan_len		   size of parallel index scan descriptor
+ *		TuplesNeeded	   tuple bound passed down from a parent LIMIT, or -1
  * ----------------
  */
 typedef struct IndexScanState
@@ -1558,6 +1563,7 @@ typedef struct IndexScanState
 	int16	   *iss_OrderByTypLens;
 	Size		iss_PscanLen;
 	List       *partition_index_leaf_rels;
+	int64		iss_TuplesNeeded;
 } IndexScanState;
 
 /* ----------------
@@ -2150,6 +2156,63 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+struct MemoizeEntry;
+struct MemoizeTuple;
+struct MemoizeKey;
+
+typedef struct MemoizeInstrumentation
+{
+	uint64		cache_hits;		/* number of rescans where we've found the
+								 * scan parameter values to be cached */
+	uint64		cache_misses;	/* number of rescans where we've not found the
+								 * scan parameter values to be cached. */
+	uint64		cache_evictions;	/* number of cache entries removed due to
+									 * the need to free memory */
+	uint64		cache_overflows;	/* number of times we've had to bypass the
+									 * cache when filling it due to not being
+									 * able to free enough space to store the
+									 * current scan's tuples. */
+	uint64		mem_peak;		/* peak memory usage in bytes */
+} MemoizeInstrumentation;
+
+/* ----------------
+ *	 MemoizeState information
+ *
+ *		memoize nodes are used to cache recent and commonly seen results from
+ *		a parameterized scan.
+ * ----------------
+ */
+typedef struct MemoizeState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			mstatus;		/* value of ExecMemoize state machine */
+	int			nkeys;			/* number of cache keys */
+	struct memoize_hash *hashtable; /* hash table for cache entries */
+	TupleDesc	hashkeydesc;	/* tuple descriptor for cache keys */
+	TupleTableSlot *tableslot;	/* min tuple slot for existing cache entries */
+	TupleTableSlot *probeslot;	/* virtual slot used for hash lookups */
+	ExprState  *cache_eq_expr;	/* Compare exec params to hash key */
+	ExprState **param_exprs;	/* exprs containing the parameters to this
+								 * node */
+	FmgrInfo   *hashfunctions;	/* lookup data for hash funcs nkeys in size */
+	Oid		   *collations;		/* collation for comparisons nkeys in size */
+	uint64		mem_used;		/* bytes of memory used by cache */
+	uint64		mem_limit;		/* memory limit in bytes for the cache */
+	MemoryContext tableContext; /* memory context to store cache data */
+	dlist_head	lru_list;		/* least recently used entry list */
+	struct MemoizeTuple *last_tuple;	/* Used to point to the last tuple
+										 * returned during a cache hit and the
+										 * tuple we last stored when
+										 * populating the cache. */
+	struct MemoizeEntry *entry; /* the entry that 'last_tuple' belongs to or
+								 * NULL if 'last_tuple' is NULL. */
+	bool		singlerow;		/* true if the cache entry is to be marked as
+								 * complete after caching the first tuple. */
+	Bitmapset  *keyparamids;	/* Param->paramids of expressions belonging to
+								 * param_exprs */
+	MemoizeInstrumentation stats;	/* execution statistics */
+} MemoizeState;
+
 /* ----------------
  *	 Shared memory container for per-worker sort information
  * ----------------
@@ -2177,8 +2240,50 @@ typedef struct SortState
 	bool		am_worker;		/* are we a worker? */
 	bool		datumSort;		/* Datum sort instead of tuple sort? */
 	SharedSortInfo *shared_info;	/* one entry per worker */
+	struct MemGrant *memgrant;	/* run-time memory grant, or NULL */
 } SortState;
 
+/* ----------------
+ *	 Instrumentation information for IncrementalSort
+ *
+ *	 sortMethods is a bitmask of (1 << TuplesortMethod) values.
+ * ----------------
+ */
+typedef struct IncrementalSortGroupInfo
+{
+	int64		groupCount;		/* number of sort batches */
+	long		maxDiskSpaceUsed;	/* in kB */
+	long		totalDiskSpaceUsed; /* in kB */
+	long		maxMemorySpaceUsed; /* in kB */
+	long		totalMemorySpaceUsed;	/* in kB */
+	bits32		sortMethods;	/* methods used by the batch sorts */
+} IncrementalSortGroupInfo;
+
+/* ----------------
+ *	 IncrementalSortState information
+ *
+ *		The input is cut into batches that end at a change of the presorted
+ *		key columns, and each batch is sorted separately.  group_pivot holds
+ *		the last tuple added to the current batch, whose presorted keys
+ *		decide where the batch ends; transfer_tuple holds the first tuple of
+ *		the next batch, which was already read from the outer plan.
+ * ----------------
+ */
+typedef struct IncrementalSortState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	bool		bounded;		/* is the result set bounded? */
+	int64		bound;			/* if bounded, how many tuples are needed */
+	int64		bound_Done;		/* tuples already returned from batches */
+	bool		sort_Done;		/* current batch sorted and being returned? */
+	bool		outerNodeDone;	/* finished reading the outer plan? */
+	ExprState  *presorted_eq;	/* equality of the presorted columns */
+	TupleTableSlot *group_pivot;	/* last tuple added to the current batch */
+	TupleTableSlot *transfer_tuple; /* first tuple of the next batch */
+	void	   *tuplesortstate; /* private state of tuplesort.c */
+	IncrementalSortGroupInfo incsort_info;	/* execution statistics */
+} IncrementalSortState;
+
 /* ---------------------
  *	GroupState information
  * ---------------------
@@ -2317,6 +2422,8 @@ typedef struct AggState
 	MemoryContext	dist_optcxt;	/* memory for distinct optimization */
 	bool			agg_Eagerfree;
 #endif
+	struct MemGrant *hash_memgrant;	/* run-time memory grant of the hash
+									 * tables, or NULL */
 } AggState;
 
 /* ----------------
@@ -2526,6 +2633,8 @@ typedef struct HashState
 
 	/* Parallel hash state. */
 	struct ParallelHashJoinState *parallel_state;
+
+	struct MemGrant *memgrant;	/* run-time memory grant, or NULL */
 } HashState;
 
 /* ----------------
@@ -114,10 +114,13 @@ extern bool contain_opentenbaseLO_functions(Node *clause);
 extern bool contain_opentenbaseLO_functions_checker(Oid func_id, void *context, Node *node);
 
 extern int	NumRelids(Node *clause);
+extern Bitmapset *pull_paramids(Expr *expr);
 
 extern void CommuteOpExpr(OpExpr *clause);
 extern void CommuteRowCompareExpr(RowCompareExpr *clause);
 
+extern void convert_saop_to_hashed_saop(Node *node);
+
 extern Node *eval_const_expressions(PlannerInfo *root, Node *node);
 extern Node *eval_const_expressions_with_params(ParamListInfo boundParams, Node *node);
 extern Node *estimate_const_expressions_with_params(ParamListInfo boundParams, Node *node);
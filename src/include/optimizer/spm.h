@@ -163,6 +163,8 @@ extern int                 space_budget_limit;
 extern int                 space_budget_percent;
 extern int                 plan_retention_weeks;
 extern bool                enable_experiment_spm;
+extern int                 spm_plan_cache_size;
+extern bool                enable_spm_plan_cache;
 extern MemoryContext       spm_context;
 extern char               *optimizer_capture_sql_plan_baselines_rules;
 extern SPMPlanCaptureRules spm_capture_rules;
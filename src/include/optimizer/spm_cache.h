@@ -2,6 +2,8 @@
 #define SPM_CACHE_H
 
 #include "c.h"
+#include "nodes/params.h"
+#include "nodes/plannodes.h"
 #include "optimizer/spm.h"
 
 
@@ -194,5 +196,38 @@ extern void SPMHistoryRelaseBySqlId(Oid dboid, int64 sql_id, int64 plan_id);
 extern int SPMHistoryRelaseCrushed(int trycount);
 extern void SPMCacheShowHintRatio(TupleDesc tupdesc, Tuplestorestate *tupstore);
 
+/*
+ * Shared plan cache: generic plans of SPM-managed statements, serialized
+ * with nodeToString and shared by all sessions of a coordinator.
+ */
+typedef struct SPMSharedPlanTag
+{
+	Oid			dboid;
+	Oid			userid;
+	uint32		sql_id;
+	int			cursor_options;
+	int64		baseline_id;	/* fixed SPM baseline applied, or 0 */
+	uint32		shape_len;
+	uint64		shape_hash;
+} SPMSharedPlanTag;
+
+typedef struct SPMSharedPlanProbe
+{
+	bool				cacheable;
+	SPMSharedPlanTag	tag;
+	uint64				generation;
+} SPMSharedPlanProbe;
+
+extern Size SPMSharedPlanShmemSize(void);
+extern void SPMSharedPlanShmemInit(void);
+extern void SPMSharedPlanCacheRegisterCallbacks(void);
+extern PlannedStmt *SPMSharedPlanCacheLookup(Query *parse, int cursorOptions,
+											 ParamListInfo boundParams,
+											 bool explain,
+											 SPMSharedPlanProbe *probe);
+extern void SPMSharedPlanCacheStore(SPMSharedPlanProbe *probe,
+									PlannedStmt *stmt);
+extern void SPMSharedPlanCacheReset(void);
+
 
 #endif /* SPM_CACHE_H */
\ No newline at end of file
@@ -224,6 +224,13 @@ typedef struct RemoteQueryState
 	int			rqs_num_params;
 	int16	   *rqs_param_formats;	/* a format code for each param */
 
+	/* parameter data per Datanode, when an IN-list parameter is split */
+	int			rqs_split_count;
+	int		   *rqs_split_nodes;	/* Datanode index of each entry */
+	char	  **rqs_split_paramval_data;
+	int		   *rqs_split_paramval_len;
+	MemoryContext rqs_split_context;	/* holds rqs_split_paramval_data */
+
 	int			eflags;			/* capability flags to pass to tuplestore */
 #ifdef __OPENTENBASE__
 	ParallelWorkerStatus *parallel_status; /*Shared storage for parallel worker .*/
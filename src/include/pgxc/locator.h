@@ -116,6 +116,8 @@ typedef struct
 #ifdef __OPENTENBASE_C__
 	int         nExprs;
 	Expr        **dis_exprs;    /* Elements in the array are allowed to be null. */
+	bool		dis_is_array;	/* dis_exprs[0] is the array of "distcol = ANY" */
+	int			dis_split_paramid;	/* extern Param array to split by node, or 0 */
 #endif
 	Oid			en_relid;			/* Relation to determine execution nodes */
 	RelationAccessType accesstype;	/* Access type to determine execution nodes */
@@ -253,6 +255,9 @@ extern ExecNodes *GetRelationNodesByQuals(Oid reloid,
 										  RelationAccessType relaccess,
 										  Node **dis_qual,
 										  ParamListInfo boundParams);
+extern int *GetRelationNodesOfValues(RelationLocInfo *rel_loc_info,
+									Datum *values, bool *nulls, int nvalues,
+									RelationAccessType accessType);
 extern ExecNodes *GetSimpleNodesByQuals(RelationLocInfo *rel_loc_info, 
 										Index varno, Node *quals, List *rtable, 
 										RelationAccessType relaccess,
@@ -14,6 +14,8 @@
 
 #include "postgres.h"
 #include "fmgr.h"
+#include "access/xlogdefs.h"
+#include "datatype/timestamp.h"
 
 
 
@@ -55,6 +57,9 @@ extern void UpdateSubStatistics(char *subname, uint64 ntups_copy, uint64 ntups_i
 extern void UpdateSubTableStatistics(Oid subid, Oid relid, uint64 ntups_copy, uint64 ntups_insert, uint64 ntups_delete,
                                         uint64 checksum_insert, uint64 checksum_delete, char state, bool init);
 extern void RemoveSubStatistics(char *subname);
+extern void UpdateSubApplyStatistics(char *subname, int64 xacts, XLogRecPtr commit_lsn,
+									 TimestampTz commit_time, TimestampTz apply_time,
+									 int64 busy_time, int64 total_time, bool init);
 
 extern void SetSubStatCheck(bool substatcount, bool substatchecksum);
 
@@ -68,6 +73,7 @@ extern Datum opentenbase_get_pubtable_stat(PG_FUNCTION_ARGS);
 extern Datum opentenbase_get_all_pubtable_stat(PG_FUNCTION_ARGS);
 extern Datum opentenbase_get_subtable_stat(PG_FUNCTION_ARGS);
 extern Datum opentenbase_get_all_subtable_stat(PG_FUNCTION_ARGS);
+extern Datum opentenbase_get_all_sub_apply_stat(PG_FUNCTION_ARGS);
 extern Datum opentenbase_set_pub_stat_check(PG_FUNCTION_ARGS);
 extern Datum opentenbase_set_sub_stat_check(PG_FUNCTION_ARGS);
 extern Datum opentenbase_get_pub_stat_check(PG_FUNCTION_ARGS);
@@ -84,6 +84,12 @@ typedef void (*LogicalDecodeMessageCB) (struct LogicalDecodingContext *ctx,
 typedef bool (*LogicalDecodeFilterByOriginCB) (struct LogicalDecodingContext *ctx,
 											   RepOriginId origin_id);
 
+/*
+ * Filter changes by the shard of the tuple, before the change is decoded.
+ */
+typedef bool (*LogicalDecodeFilterByShardCB) (struct LogicalDecodingContext *ctx,
+											  ShardID shardid);
+
 /*
  * Called to shutdown an output plugin.
  */
@@ -100,6 +106,7 @@ typedef struct OutputPluginCallbacks
 	LogicalDecodeCommitCB commit_cb;
 	LogicalDecodeMessageCB message_cb;
 	LogicalDecodeFilterByOriginCB filter_by_origin_cb;
+	LogicalDecodeFilterByShardCB filter_by_shard_cb;
 	LogicalDecodeShutdownCB shutdown_cb;
 } OutputPluginCallbacks;
 
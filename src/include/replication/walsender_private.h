@@ -59,6 +59,9 @@ typedef struct WalSnd
 	TimeOffset	flushLag;
 	TimeOffset	applyLag;
 
+	/* Smoothed WAL replay rate in bytes per second, or -1 if unknown. */
+	double		replayRate;
+
 	/* Protects shared variables shown above (and sync_standby_priority). */
 	slock_t		mutex;
 
@@ -34,6 +34,9 @@
 
 /* BufFile is an opaque type whose details are not known outside buffile.c. */
 
+/* largest chunk size accepted by BufFilePledgeSequential */
+#define BUFFILE_MAX_CHUNK_SIZE	(256 * 1024)
+
 typedef struct BufFile BufFile;
 
 /*
@@ -48,6 +51,8 @@ extern size_t BufFileWrite(BufFile *file, void *ptr, size_t size);
 extern int	BufFileSeek(BufFile *file, int fileno, off_t offset, int whence);
 extern void BufFileTell(BufFile *file, int *fileno, off_t *offset);
 extern int	BufFileSeekBlock(BufFile *file, long blknum);
+extern void BufFilePrefetchBlock(BufFile *file, long blknum, int nblocks);
+extern void BufFilePledgeSequential(BufFile *file, int chunk_size);
 
 extern BufFile *BufFileCreateShared(SharedFileSet *fileset, const char *name, workfile_set *work_set);
 extern BufFile *BufFileOpenShared(SharedFileSet *fileset, const char *name);
@@ -181,6 +181,10 @@ extern PGDLLIMPORT int32 *LocalRefCount;
 extern bool ComputeIoConcurrency(int io_concurrency, double *target);
 extern void PrefetchBuffer(Relation reln, ForkNumber forkNum,
 			   BlockNumber blockNum);
+extern void PrefetchBufferRange(Relation reln, ForkNumber forkNum,
+					BlockNumber firstBlock, BlockNumber nblocks);
+extern bool PrefetchBufferWithoutRelcache(RelFileNode rnode, ForkNumber forkNum,
+							  BlockNumber blockNum);
 extern Buffer ReadBuffer(Relation reln, BlockNumber blockNum);
 
 extern Buffer ReadBufferExtended(Relation reln, ForkNumber forkNum,
@@ -313,6 +313,7 @@ typedef enum BuiltinTrancheIds
 	LWTRANCHE_SPMHISTORY_HTAB,
 	LWTRANCHE_SPM_INVALID_HISTORY_HTAB,
 	LWTRANCHE_SPM_HISTORY_ENTRY,
+	LWTRANCHE_SPM_SHARED_PLAN,
 	LWTRANCHE_FIRST_USER_DEFINED
 }			BuiltinTrancheIds;
 
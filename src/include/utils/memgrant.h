@@ -0,0 +1,63 @@
+/*-------------------------------------------------------------------------
+ *
+ * memgrant.h
+ *	  Run-time redistribution of a query's operator memory budget.
+ *
+ * Copyright (c) 2022-Present OpenTenBase development team, Tencent
+ *
+ *
+ * IDENTIFICATION
+ *	  src/include/utils/memgrant.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef MEMGRANT_H
+#define MEMGRANT_H
+
+#include "nodes/pg_list.h"
+
+/* smallest grant an operator is ever left with (64kB, as MIN_WORK_MEM) */
+#define MEMGRANT_MIN_BYTES	(64 * 1024L)
+
+typedef enum MemGrantStatus
+{
+	MEMGRANT_IDLE,				/* registered, consumer not started yet */
+	MEMGRANT_ACTIVE,			/* consumer is filling its memory */
+	MEMGRANT_SETTLED			/* consumer stopped growing, or released */
+} MemGrantStatus;
+
+typedef struct MemGrantPool MemGrantPool;
+
+typedef struct MemGrant
+{
+	MemGrantPool *pool;			/* pool this grant belongs to */
+	int			plan_node_id;	/* owning plan node, for debugging */
+	MemGrantStatus status;
+	int64		nominal;		/* bytes the plan assigned to the operator */
+	int64		granted;		/* bytes the operator may use right now */
+	int64		used;			/* bytes the operator last reported */
+
+	/* statistics */
+	int64		peak;			/* largest granted value seen */
+	int			nexpand;		/* number of successful expansions */
+	int			nrevoked;		/* number of times memory was taken away */
+} MemGrant;
+
+struct MemGrantPool
+{
+	int64		total;			/* sum of nominal grants */
+	int64		granted;		/* sum of current grants */
+	List	   *grants;			/* all registered MemGrants */
+};
+
+extern bool enable_memory_rebalance;
+
+extern MemGrantPool *MemGrantPoolCreate(void);
+extern MemGrant *MemGrantRegister(MemGrantPool *pool, int plan_node_id,
+				 int64 nominal);
+extern int64 MemGrantStart(MemGrant *grant);
+extern int64 MemGrantExpand(MemGrant *grant, int64 used, int64 request);
+extern void MemGrantSettle(MemGrant *grant, int64 used);
+extern void MemGrantRelease(MemGrant *grant);
+
+#endif							/* MEMGRANT_H */
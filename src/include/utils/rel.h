@@ -307,6 +307,8 @@ typedef struct StdRdOptions
 	int			online_gathering_threshold;	/* online gathering for bulk loads */
 	char       *rel_parallel_dml;
 	bool        checksum;	/* enable checksum for table */
+	bool		deduplicate_items;	/* btree: merge duplicates into posting
+									 * lists */
 } StdRdOptions;
 
 #define StdRdOptionsGetStringData(_basePtr, _memberName, _defaultVal)                    \
@@ -627,6 +629,13 @@ typedef struct ViewOptions
  */
 #define RelationNeedsWAL(relation) \
 	((relation)->rd_rel->relpersistence == RELPERSISTENCE_PERMANENT)
+
+/*
+ * RelationUsesLocalBuffers
+ *		True if relation's pages are private to one backend.
+ */
+#define RelationUsesLocalBuffers(relation) \
+	((relation)->rd_rel->relpersistence == RELPERSISTENCE_TEMP)
 	
 #ifdef _SHARDING_
 #if 0
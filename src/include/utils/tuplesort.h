@@ -34,6 +34,8 @@ struct ResponseCombiner;
 struct RemoteFragmentState;
 #endif
 
+struct MemGrant;
+
 /* Tuplesortstate is an opaque type whose details are not known outside
  * tuplesort.c.
  */
@@ -137,6 +139,8 @@ tuplesort_begin_merge_remote(TupleDesc tupDesc,
 					 int workMem);
 #endif
 extern void tuplesort_set_bound(Tuplesortstate *state, int64 bound);
+extern void tuplesort_attach_memgrant(Tuplesortstate *state,
+						  struct MemGrant *grant);
 
 extern void tuplesort_puttupleslot(Tuplesortstate *state,
 					   TupleTableSlot *slot);
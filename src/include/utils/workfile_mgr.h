@@ -92,6 +92,8 @@ typedef struct workfile_set
 extern int	pg_workfile_limit_per_datanode;
 extern int	pg_workfile_limit_per_query;
 extern int	pg_workfile_limit_files_per_query;
+extern bool pg_workfile_compression;
+extern bool pg_workfile_prefetch;
 
 
 /* Workfile Set operations */
@@ -91,6 +91,7 @@ typedef enum PLpgSQL_stmt_type
 	PLPGSQL_STMT_FORS,
 	PLPGSQL_STMT_FORC,
 	PLPGSQL_STMT_FOREACH_A,
+	PLPGSQL_STMT_FORALL,
 	PLPGSQL_STMT_EXIT,
 	PLPGSQL_STMT_RETURN,
 	PLPGSQL_STMT_RETURN_NEXT,
@@ -712,6 +713,8 @@ typedef struct PLpgSQL_stmt_fetch
 	PLpgSQL_expr *expr;			/* count, if expression */
 	bool		is_move;		/* is this a fetch or move? */
 	bool		returns_multiple_rows;	/* can return more than one row? */
+	bool		bulk_collect;	/* BULK COLLECT INTO array variables? */
+	PLpgSQL_expr *limit;		/* BULK COLLECT LIMIT, or NULL */
 } PLpgSQL_stmt_fetch;
 
 /*
@@ -816,9 +819,31 @@ typedef struct PLpgSQL_stmt_execsql
 								 * mod_stmt is set when we plan the query */
 	bool		into;			/* INTO supplied? */
 	bool		strict;			/* INTO STRICT flag */
+	bool		bulk_collect;	/* BULK COLLECT INTO array variables? */
 	PLpgSQL_variable *target;	/* INTO target (record or row) */
 } PLpgSQL_stmt_execsql;
 
+/*
+ * FORALL statement
+ *
+ * The DML statement is executed once for each value of the index variable,
+ * unless it could be rewritten into a single statement that processes the
+ * whole range at once.  That one refers to the bounds through bulk_lower
+ * and bulk_upper instead.
+ */
+typedef struct PLpgSQL_stmt_forall
+{
+	PLpgSQL_stmt_type cmd_type;
+	int			lineno;
+	PLpgSQL_var *var;			/* index variable */
+	PLpgSQL_expr *lower;
+	PLpgSQL_expr *upper;
+	PLpgSQL_stmt_execsql *body;	/* statement run for each index value */
+	PLpgSQL_stmt_execsql *bulk;	/* statement run once, or NULL */
+	PLpgSQL_var *bulk_lower;
+	PLpgSQL_var *bulk_upper;
+} PLpgSQL_stmt_forall;
+
 /*
  * Dynamic SQL string to execute
  */
@@ -1249,6 +1274,7 @@ extern void oraplsql_push_back_token(int token);
 extern bool oraplsql_token_is_unreserved_keyword(int token);
 extern void oraplsql_append_source_text(StringInfo buf,
 						   int startlocation, int endlocation);
+extern int	oraplsql_token_length(void);
 extern int	oraplsql_peek(void);
 extern void oraplsql_peek2(int *tok1_p, int *tok2_p, int *tok1_loc,
 			  int *tok2_loc);
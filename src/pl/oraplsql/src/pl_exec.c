@@ -17,6 +17,7 @@
 
 #include <ctype.h>
 
+#include "access/heapam.h"
 #include "access/htup_details.h"
 #include "access/transam.h"
 #include "access/tupconvert.h"
@@ -230,6 +231,10 @@ static int exec_stmt_fors(PLpgSQL_execstate *estate,
 			   PLpgSQL_stmt_fors *stmt);
 static int exec_stmt_forc(PLpgSQL_execstate *estate,
 			   PLpgSQL_stmt_forc *stmt);
+static int exec_stmt_forall(PLpgSQL_execstate *estate,
+				 PLpgSQL_stmt_forall *stmt);
+static bool exec_forall_can_bulk(PLpgSQL_execstate *estate,
+					 PLpgSQL_stmt_forall *stmt);
 static int exec_stmt_foreach_a(PLpgSQL_execstate *estate,
 					PLpgSQL_stmt_foreach_a *stmt);
 static int exec_stmt_open(PLpgSQL_execstate *estate,
@@ -337,6 +342,8 @@ static void oraplsql_param_eval_generic_ro(ExprState *state, ExprEvalStep *op,
 static void exec_move_row(PLpgSQL_execstate *estate,
 			  PLpgSQL_variable *target,
 			  HeapTuple tup, TupleDesc tupdesc);
+static void exec_move_bulk(PLpgSQL_execstate *estate, PLpgSQL_row *row,
+			   SPITupleTable *tuptab, uint64 n);
 static ExpandedRecordHeader *make_expanded_record_for_rec(PLpgSQL_execstate *estate,
 							 PLpgSQL_rec *rec,
 							 TupleDesc srctupdesc,
@@ -1967,6 +1974,10 @@ exec_stmts(PLpgSQL_execstate *estate, List *stmts)
 				rc = exec_stmt_foreach_a(estate, (PLpgSQL_stmt_foreach_a *) stmt);
 				break;
 
+			case PLPGSQL_STMT_FORALL:
+				rc = exec_stmt_forall(estate, (PLpgSQL_stmt_forall *) stmt);
+				break;
+
 			case PLPGSQL_STMT_EXIT:
 				rc = exec_stmt_exit(estate, (PLpgSQL_stmt_exit *) stmt);
 				break;
@@ -3283,6 +3294,185 @@ exec_stmt_foreach_a(PLpgSQL_execstate *estate, PLpgSQL_stmt_foreach_a *stmt)
 }
 
 
+/* ----------
+ * exec_stmt_forall			Execute a DML statement for each value
+ *					of an integer index from a lower to an upper bound
+ *
+ * If the statement could be rewritten to process the whole range at once,
+ * that version is executed a single time instead of once per index value.
+ * ----------
+ */
+static int
+exec_stmt_forall(PLpgSQL_execstate *estate, PLpgSQL_stmt_forall *stmt)
+{
+	PLpgSQL_var *var;
+	Datum		value;
+	bool		isnull;
+	Oid			valtype;
+	int32		valtypmod;
+	int32		loop_value;
+	int32		end_value;
+	uint64		processed = 0;
+
+	if (estate->check_pullup)
+	{
+		if (stmt->bulk)
+			return exec_stmt_execsql(estate, stmt->bulk);
+		return exec_stmt_execsql(estate, stmt->body);
+	}
+
+	var = (PLpgSQL_var *) (estate->datums[stmt->var->dno]);
+
+	/*
+	 * Get the value of the lower bound
+	 */
+	value = exec_eval_expr(estate, stmt->lower,
+						   &isnull, &valtype, &valtypmod);
+	value = exec_cast_value(estate, value, &isnull,
+							valtype, valtypmod,
+							var->datatype->typoid,
+							var->datatype->atttypmod);
+	if (isnull)
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("lower bound of FORALL cannot be null")));
+	loop_value = DatumGetInt32(value);
+	exec_eval_cleanup(estate);
+
+	/*
+	 * Get the value of the upper bound
+	 */
+	value = exec_eval_expr(estate, stmt->upper,
+						   &isnull, &valtype, &valtypmod);
+	value = exec_cast_value(estate, value, &isnull,
+							valtype, valtypmod,
+							var->datatype->typoid,
+							var->datatype->atttypmod);
+	if (isnull)
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("upper bound of FORALL cannot be null")));
+	end_value = DatumGetInt32(value);
+	exec_eval_cleanup(estate);
+
+	if (loop_value <= end_value)
+	{
+		/*
+		 * Process the whole range with one statement if we can, rather than
+		 * shipping one statement per index value to the datanodes.
+		 */
+		if (stmt->bulk && exec_forall_can_bulk(estate, stmt))
+		{
+			assign_simple_var(estate,
+							  (PLpgSQL_var *) estate->datums[stmt->bulk_lower->dno],
+							  Int32GetDatum(loop_value), false, false);
+			assign_simple_var(estate,
+							  (PLpgSQL_var *) estate->datums[stmt->bulk_upper->dno],
+							  Int32GetDatum(end_value), false, false);
+			return exec_stmt_execsql(estate, stmt->bulk);
+		}
+
+		for (;;)
+		{
+			assign_simple_var(estate, var, Int32GetDatum(loop_value),
+							  false, false);
+
+			exec_stmt_execsql(estate, stmt->body);
+			processed += estate->eval_processed;
+
+			/* careful not to overflow on the last iteration */
+			if (loop_value >= end_value)
+				break;
+			loop_value++;
+		}
+	}
+
+	/*
+	 * Like a single DML statement, set the row count and FOUND from the rows
+	 * processed by all the executions together.
+	 */
+	estate->eval_processed = processed;
+	exec_set_found(estate, processed != 0);
+
+	return PLPGSQL_RC_OK;
+}
+
+/*
+ * Check whether the bulk version of a FORALL statement may be used.
+ *
+ * Volatile functions in the statement could behave differently when called
+ * for all the index values in one statement, and statement triggers on the
+ * target table would fire once instead of once per index value.  Both can
+ * change after the function is compiled, so check them on every execution.
+ * Column defaults are not looked at, since they are evaluated once per row
+ * either way.
+ */
+static bool
+exec_forall_can_bulk(PLpgSQL_execstate *estate, PLpgSQL_stmt_forall *stmt)
+{
+	PLpgSQL_expr *expr = stmt->bulk->sqlstmt;
+	ListCell   *l;
+
+	if (expr->plan == NULL)
+	{
+		exec_prepare_plan(estate, expr, CURSOR_OPT_PARALLEL_OK);
+		/* it's always an INSERT or a DELETE */
+		stmt->bulk->mod_stmt = true;
+	}
+
+	foreach(l, SPI_plan_get_plan_sources(expr->plan))
+	{
+		CachedPlanSource *plansource = (CachedPlanSource *) lfirst(l);
+		ListCell   *l2;
+
+		foreach(l2, plansource->query_list)
+		{
+			Query	   *q = lfirst_node(Query, l2);
+			ListCell   *l3;
+			Relation	rel;
+			TriggerDesc *trigdesc;
+			bool		has_stmt_triggers = false;
+
+			if (contain_volatile_functions((Node *) q->jointree))
+				return false;
+			foreach(l3, q->rtable)
+			{
+				RangeTblEntry *rte = lfirst_node(RangeTblEntry, l3);
+
+				if ((rte->rtekind == RTE_SUBQUERY &&
+					 contain_volatile_functions((Node *) rte->subquery)) ||
+					(rte->rtekind == RTE_FUNCTION &&
+					 contain_volatile_functions((Node *) rte->functions)))
+					return false;
+			}
+
+			if (q->resultRelation == 0)
+				continue;
+
+			/* the table is gone, let the per index value version complain */
+			rel = try_relation_open(rt_fetch(q->resultRelation,
+											 q->rtable)->relid,
+									RowExclusiveLock);
+			if (rel == NULL)
+				return false;
+
+			trigdesc = rel->trigdesc;
+			if (trigdesc != NULL)
+				has_stmt_triggers = (trigdesc->trig_insert_before_statement ||
+									 trigdesc->trig_insert_after_statement ||
+									 trigdesc->trig_delete_before_statement ||
+									 trigdesc->trig_delete_after_statement);
+			relation_close(rel, NoLock);
+
+			if (has_stmt_triggers)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
 /* ----------
  * exec_stmt_exit			Implements EXIT and CONTINUE
  *
@@ -4453,8 +4643,10 @@ exec_stmt_execsql(PLpgSQL_execstate *estate,
 	 * In distributed mode, tcount will not be sent from cn to dn, so dn will 
 	 * run the statement to completion. Therefore, cn cannot limit tcount, 
 	 * in order to ensure the correctness of _SPI_checktuples.
+	 *
+	 * BULK COLLECT INTO wants all the rows.
 	 */
-	if (stmt->into)
+	if (stmt->into && !stmt->bulk_collect)
 	{
 		if (IS_PGXC_COORDINATOR)
 			tcount = 0;
@@ -4561,7 +4753,9 @@ exec_stmt_execsql(PLpgSQL_execstate *estate,
 		 * exactly one row, throw an error.  If STRICT was not specified, then
 		 * allow the query to find any number of rows.
 		 */
-		if (n == 0)
+		if (stmt->bulk_collect)
+			exec_move_bulk(estate, (PLpgSQL_row *) target, tuptab, n);
+		else if (n == 0)
 		{
 			if (stmt->strict)
 			{
@@ -5065,12 +5259,32 @@ exec_stmt_fetch(PLpgSQL_execstate *estate, PLpgSQL_stmt_fetch *stmt)
 		exec_eval_cleanup(estate);
 	}
 
+	/* Number of rows for FETCH ... BULK COLLECT INTO ... LIMIT */
+	if (stmt->limit)
+	{
+		bool		isnull;
+
+		how_many = exec_eval_integer(estate, stmt->limit, &isnull);
+
+		if (isnull)
+			ereport(ERROR,
+					(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+					 errmsg("LIMIT of FETCH cannot be null")));
+		if (how_many <= 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("LIMIT of FETCH must be greater than zero")));
+
+		exec_eval_cleanup(estate);
+	}
+
 	if (!stmt->is_move)
 	{
 		PLpgSQL_variable *target;
 
 		/* ----------
-		 * Fetch 1 tuple from the cursor
+		 * Fetch 1 tuple from the cursor, or all the tuples asked for by
+		 * BULK COLLECT
 		 * ----------
 		 */
 		SPI_scroll_cursor_fetch(portal, stmt->direction, how_many);
@@ -5082,7 +5296,9 @@ exec_stmt_fetch(PLpgSQL_execstate *estate, PLpgSQL_stmt_fetch *stmt)
 		 * ----------
 		 */
 		target = (PLpgSQL_variable *) estate->datums[stmt->target->dno];
-		if (n == 0)
+		if (stmt->bulk_collect)
+			exec_move_bulk(estate, (PLpgSQL_row *) target, tuptab, n);
+		else if (n == 0)
 			exec_move_row(estate, target, NULL, tuptab->tupdesc);
 		else
 			exec_move_row(estate, target, tuptab->vals[0], tuptab->tupdesc);
@@ -7217,6 +7433,110 @@ oraplsql_param_eval_generic_ro(ExprState *state, ExprEvalStep *op,
 }
 
 
+/*
+ * exec_move_bulk			Move all the tuples of a result into array
+ *							variables, for BULK COLLECT INTO
+ *
+ * Each target of the row must be an array variable.  With a single target
+ * whose element type is composite, each tuple becomes one element, else
+ * each target collects the values of the corresponding result column.
+ *
+ * Since this uses the mcontext for workspace, caller should eventually call
+ * exec_eval_cleanup to prevent long-term memory leaks.
+ */
+static void
+exec_move_bulk(PLpgSQL_execstate *estate, PLpgSQL_row *row,
+			   SPITupleTable *tuptab, uint64 n)
+{
+	TupleDesc	tupdesc = tuptab->tupdesc;
+	int			fnum;
+
+	for (fnum = 0; fnum < row->nfields; fnum++)
+	{
+		PLpgSQL_datum *target = estate->datums[row->varnos[fnum]];
+		Oid			arraytype;
+		int32		arraytypmod;
+		Oid			arraycoll;
+		Oid			elemtype;
+		ArrayBuildState *astate;
+		MemoryContext oldcontext;
+		Datum		value;
+		uint64		i;
+
+		oraplsql_exec_get_datum_type_info(estate, target,
+										  &arraytype, &arraytypmod, &arraycoll);
+		arraytype = getBaseType(arraytype);
+		elemtype = get_element_type(arraytype);
+		if (!OidIsValid(elemtype))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATATYPE_MISMATCH),
+					 errmsg("BULK COLLECT target \"%s\" is not an array variable",
+							row->fieldnames[fnum])));
+
+		oldcontext = MemoryContextSwitchTo(get_eval_mcontext(estate));
+		astate = initArrayResult(elemtype, CurrentMemoryContext, false);
+
+		if (row->nfields == 1 && type_is_rowtype(elemtype) &&
+			!(tupdesc->natts == 1 &&
+			  TupleDescAttr(tupdesc, 0)->atttypid == elemtype))
+		{
+			/* Collect whole rows */
+			TupleDesc	elemdesc;
+			TupleConversionMap *map;
+
+			if (elemtype == RECORDOID)
+			{
+				elemdesc = CreateTupleDescCopy(tupdesc);
+				BlessTupleDesc(elemdesc);
+			}
+			else
+				elemdesc = lookup_rowtype_tupdesc_copy(elemtype, -1);
+
+			map = convert_tuples_by_position(tupdesc, elemdesc,
+											 gettext_noop("returned row structure does not match the structure of the BULK COLLECT target"));
+
+			for (i = 0; i < n; i++)
+			{
+				HeapTuple	tup = tuptab->vals[i];
+
+				if (map)
+					tup = do_convert_tuple(tup, map);
+				accumArrayResult(astate,
+								 heap_copy_tuple_as_datum(tup, elemdesc),
+								 false, elemtype, CurrentMemoryContext);
+			}
+		}
+		else
+		{
+			/* Collect the column matching this target */
+			if (row->nfields != tupdesc->natts)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATATYPE_MISMATCH),
+						 errmsg("number of BULK COLLECT targets does not match the number of result columns")));
+
+			for (i = 0; i < n; i++)
+			{
+				bool		isnull;
+
+				value = SPI_getbinval(tuptab->vals[i], tupdesc, fnum + 1,
+									  &isnull);
+				value = exec_cast_value(estate, value, &isnull,
+										SPI_gettypeid(tupdesc, fnum + 1),
+										TupleDescAttr(tupdesc, fnum)->atttypmod,
+										elemtype, -1);
+				accumArrayResult(astate, value, isnull, elemtype,
+								 CurrentMemoryContext);
+			}
+		}
+
+		value = makeArrayResult(astate, CurrentMemoryContext);
+		MemoryContextSwitchTo(oldcontext);
+
+		exec_assign_value(estate, target, value, false, arraytype, -1);
+	}
+}
+
+
 /*
  * exec_move_row			Move one tuple's values into a record or row
  *
@@ -9436,6 +9756,11 @@ exec_check_stmts(PLpgSQL_function *func, List *stmts, FuncCheckData *chkdata)
 				exec_check_expr(func, ((PLpgSQL_stmt_foreach_a *)stmt)->expr, chkdata);
 				exec_check_stmts(func, ((PLpgSQL_stmt_foreach_a *)stmt)->body, chkdata);
 				break;
+			case PLPGSQL_STMT_FORALL:
+				exec_check_expr(func, ((PLpgSQL_stmt_forall *)stmt)->body->sqlstmt, chkdata);
+				if (((PLpgSQL_stmt_forall *)stmt)->bulk)
+					exec_check_expr(func, ((PLpgSQL_stmt_forall *)stmt)->bulk->sqlstmt, chkdata);
+				break;
 			case PLPGSQL_STMT_RETURN:
 				exec_check_expr(func, ((PLpgSQL_stmt_return *)stmt)->expr, chkdata);
 				break;
@@ -272,6 +272,8 @@ oraplsql_stmt_typename(PLpgSQL_stmt *stmt)
 			return _("FOR over cursor");
 		case PLPGSQL_STMT_FOREACH_A:
 			return _("FOREACH over array");
+		case PLPGSQL_STMT_FORALL:
+			return "FORALL";
 		case PLPGSQL_STMT_EXIT:
 			return ((PLpgSQL_stmt_exit *) stmt)->is_exit ? "EXIT" : "CONTINUE";
 		case PLPGSQL_STMT_RETURN:
@@ -374,6 +376,7 @@ static void free_fori(PLpgSQL_stmt_fori *stmt);
 static void free_fors(PLpgSQL_stmt_fors *stmt);
 static void free_forc(PLpgSQL_stmt_forc *stmt);
 static void free_foreach_a(PLpgSQL_stmt_foreach_a *stmt);
+static void free_forall(PLpgSQL_stmt_forall *stmt);
 static void free_exit(PLpgSQL_stmt_exit *stmt);
 static void free_return(PLpgSQL_stmt_return *stmt);
 static void free_return_next(PLpgSQL_stmt_return_next *stmt);
@@ -430,6 +433,9 @@ free_stmt(PLpgSQL_stmt *stmt)
 		case PLPGSQL_STMT_FOREACH_A:
 			free_foreach_a((PLpgSQL_stmt_foreach_a *) stmt);
 			break;
+		case PLPGSQL_STMT_FORALL:
+			free_forall((PLpgSQL_stmt_forall *) stmt);
+			break;
 		case PLPGSQL_STMT_EXIT:
 			free_exit((PLpgSQL_stmt_exit *) stmt);
 			break;
@@ -600,6 +606,16 @@ free_foreach_a(PLpgSQL_stmt_foreach_a *stmt)
 	free_stmts(stmt->body);
 }
 
+static void
+free_forall(PLpgSQL_stmt_forall *stmt)
+{
+	free_expr(stmt->lower);
+	free_expr(stmt->upper);
+	free_execsql(stmt->body);
+	if (stmt->bulk)
+		free_execsql(stmt->bulk);
+}
+
 static void
 free_open(PLpgSQL_stmt_open *stmt)
 {
@@ -618,6 +634,7 @@ static void
 free_fetch(PLpgSQL_stmt_fetch *stmt)
 {
 	free_expr(stmt->expr);
+	free_expr(stmt->limit);
 }
 
 static void
@@ -825,6 +842,7 @@ static void dump_fori(PLpgSQL_stmt_fori *stmt);
 static void dump_fors(PLpgSQL_stmt_fors *stmt);
 static void dump_forc(PLpgSQL_stmt_forc *stmt);
 static void dump_foreach_a(PLpgSQL_stmt_foreach_a *stmt);
+static void dump_forall(PLpgSQL_stmt_forall *stmt);
 static void dump_exit(PLpgSQL_stmt_exit *stmt);
 static void dump_return(PLpgSQL_stmt_return *stmt);
 static void dump_return_next(PLpgSQL_stmt_return_next *stmt);
@@ -892,6 +910,9 @@ dump_stmt(PLpgSQL_stmt *stmt)
 		case PLPGSQL_STMT_FOREACH_A:
 			dump_foreach_a((PLpgSQL_stmt_foreach_a *) stmt);
 			break;
+		case PLPGSQL_STMT_FORALL:
+			dump_forall((PLpgSQL_stmt_forall *) stmt);
+			break;
 		case PLPGSQL_STMT_EXIT:
 			dump_exit((PLpgSQL_stmt_exit *) stmt);
 			break;
@@ -1191,6 +1212,33 @@ dump_foreach_a(PLpgSQL_stmt_foreach_a *stmt)
 	printf("    ENDFOREACHA");
 }
 
+static void
+dump_forall(PLpgSQL_stmt_forall *stmt)
+{
+	dump_ind();
+	printf("FORALL %s\n", stmt->var->refname);
+
+	dump_indent += 2;
+	dump_ind();
+	printf("    lower = ");
+	dump_expr(stmt->lower);
+	printf("\n");
+	dump_ind();
+	printf("    upper = ");
+	dump_expr(stmt->upper);
+	printf("\n");
+	dump_indent -= 2;
+
+	dump_indent += 2;
+	dump_execsql(stmt->body);
+	if (stmt->bulk)
+		dump_execsql(stmt->bulk);
+	dump_indent -= 2;
+
+	dump_ind();
+	printf("    ENDFORALL\n");
+}
+
 static void
 dump_open(PLpgSQL_stmt_open *stmt)
 {
@@ -1256,9 +1304,17 @@ dump_fetch(PLpgSQL_stmt_fetch *stmt)
 		if (stmt->target != NULL)
 		{
 			dump_ind();
-			printf("    target = %d %s\n",
+			printf("    %starget = %d %s\n",
+				   stmt->bulk_collect ? "BULK COLLECT " : "",
 				   stmt->target->dno, stmt->target->refname);
 		}
+		if (stmt->limit != NULL)
+		{
+			dump_ind();
+			printf("    LIMIT ");
+			dump_expr(stmt->limit);
+			printf("\n");
+		}
 		dump_indent -= 2;
 	}
 	else
@@ -1528,7 +1584,8 @@ dump_execsql(PLpgSQL_stmt_execsql *stmt)
 	if (stmt->target != NULL)
 	{
 		dump_ind();
-		printf("    INTO%s target = %d %s\n",
+		printf("    %sINTO%s target = %d %s\n",
+			   stmt->bulk_collect ? "BULK COLLECT " : "",
 			   stmt->strict ? " STRICT" : "",
 			   stmt->target->dno, stmt->target->refname);
 	}
@@ -82,6 +82,8 @@ static	PLpgSQL_expr	*read_sql_expression2(int until, int until2,
 static	PLpgSQL_expr	*read_sql_stmt(const char *sqlstart);
 static	PLpgSQL_type	*read_datatype(int tok);
 static	PLpgSQL_stmt	*make_execsql_stmt(int firsttoken, int location);
+static	PLpgSQL_stmt	*make_forall_stmt(char *varname, int varlineno,
+										  int location);
 static	PLpgSQL_stmt_fetch *read_fetch_direction(void);
 static	void			 complete_direction(PLpgSQL_stmt_fetch *fetch,
 											bool *check_FROM);
@@ -94,6 +96,8 @@ static	char			*NameOfDatum(PLwdatum *wdatum);
 static	void			 check_assignable(PLpgSQL_datum *datum, int location);
 static	void			 read_into_target(PLpgSQL_variable **target,
 										  bool *strict);
+static	void			 check_bulk_target(PLpgSQL_variable *target,
+										   int location);
 static	PLpgSQL_row		*read_into_scalar_list(char *initial_name,
 											   PLpgSQL_datum *initial_datum,
 											   int initial_location);
@@ -200,7 +204,7 @@ static	void			check_raise_parameters(PLpgSQL_stmt_raise *stmt);
 %type <stmt>	stmt_dynexecute stmt_for stmt_perform stmt_call stmt_getdiag
 %type <stmt>	stmt_open stmt_fetch stmt_move stmt_close stmt_null
 %type <stmt>	stmt_commit stmt_rollback stmt_set
-%type <stmt>	stmt_case stmt_foreach_a
+%type <stmt>	stmt_case stmt_foreach_a stmt_forall
 
 %type <list>	proc_exceptions
 %type <exception_block> exception_sect
@@ -217,6 +221,7 @@ static	void			check_raise_parameters(PLpgSQL_stmt_raise *stmt);
 %type <ival>	getdiag_item
 
 %type <ival>	opt_scrollable
+%type <boolean>	opt_bulk_collect
 %type <fetch>	opt_fetch_direction
 
 %type <keyword>	unreserved_keyword
@@ -256,11 +261,13 @@ static	void			check_raise_parameters(PLpgSQL_stmt_raise *stmt);
 %token <keyword>	K_ASSERT
 %token <keyword>	K_BACKWARD
 %token <keyword>	K_BEGIN
+%token <keyword>	K_BULK
 %token <keyword>	K_BY
 %token <keyword>	K_CALL
 %token <keyword>	K_CASE
 %token <keyword>	K_CLOSE
 %token <keyword>	K_COLLATE
+%token <keyword>	K_COLLECT
 %token <keyword>	K_COLUMN
 %token <keyword>	K_COLUMN_NAME
 %token <keyword>	K_COMMIT
@@ -289,6 +296,7 @@ static	void			check_raise_parameters(PLpgSQL_stmt_raise *stmt);
 %token <keyword>	K_FETCH
 %token <keyword>	K_FIRST
 %token <keyword>	K_FOR
+%token <keyword>	K_FORALL
 %token <keyword>	K_FOREACH
 %token <keyword>	K_FORWARD
 %token <keyword>	K_FROM
@@ -302,6 +310,7 @@ static	void			check_raise_parameters(PLpgSQL_stmt_raise *stmt);
 %token <keyword>	K_INTO
 %token <keyword>	K_IS
 %token <keyword>	K_LAST
+%token <keyword>	K_LIMIT
 %token <keyword>	K_LOG
 %token <keyword>	K_LOOP
 %token <keyword>	K_MERGE
@@ -879,6 +888,8 @@ proc_stmt		: pl_block ';'
 						{ $$ = $1; }
 				| stmt_foreach_a
 						{ $$ = $1; }
+				| stmt_forall
+						{ $$ = $1; }
 				| stmt_exit
 						{ $$ = $1; }
 				| stmt_return
@@ -1724,6 +1735,19 @@ foreach_slice	:
 					}
 				;
 
+stmt_forall		: K_FORALL for_variable K_IN
+					{
+						/* Should have had a single variable name */
+						if ($2.scalar && $2.row)
+							ereport(ERROR,
+									(errcode(ERRCODE_SYNTAX_ERROR),
+									 errmsg("FORALL must have only one index variable"),
+									 parser_errposition(@2)));
+
+						$$ = make_forall_stmt($2.name, $2.lineno, @1);
+					}
+				;
+
 stmt_exit		: exit_type opt_label opt_exitcond
 					{
 						PLpgSQL_stmt_exit *new;
@@ -2171,22 +2195,53 @@ stmt_open		: K_OPEN cursor_variable
 					}
 				;
 
-stmt_fetch		: K_FETCH opt_fetch_direction cursor_variable K_INTO
+stmt_fetch		: K_FETCH opt_fetch_direction cursor_variable opt_bulk_collect K_INTO
 					{
 						PLpgSQL_stmt_fetch *fetch = $2;
 						PLpgSQL_variable *target;
+						int			tok;
 
 						/* We have already parsed everything through the INTO keyword */
 						read_into_target(&target, NULL);
 
-						if (yylex() != ';')
+						tok = yylex();
+						if ($4)
+						{
+							check_bulk_target(target, @5);
+							fetch->bulk_collect = true;
+
+							if (tok_is_keyword(tok, &yylval,
+											   K_LIMIT, "limit"))
+							{
+								if (fetch->direction != FETCH_FORWARD ||
+									fetch->how_many != 1 ||
+									fetch->expr != NULL)
+									ereport(ERROR,
+											(errcode(ERRCODE_SYNTAX_ERROR),
+											 errmsg("FETCH with LIMIT cannot specify a direction"),
+											 parser_errposition(yylloc)));
+								fetch->limit = read_sql_expression(';', ";");
+								fetch->returns_multiple_rows = true;
+								tok = ';';
+							}
+							else if (fetch->direction == FETCH_FORWARD &&
+									 fetch->how_many == 1 &&
+									 fetch->expr == NULL)
+							{
+								/* without LIMIT, collect all remaining rows */
+								fetch->how_many = FETCH_ALL;
+								fetch->returns_multiple_rows = true;
+							}
+						}
+
+						if (tok != ';')
 							yyerror("syntax error");
 
 						/*
 						 * We don't allow multiple rows in PL/pgSQL's FETCH
-						 * statement, only in MOVE.
+						 * statement, only in MOVE and BULK COLLECT.
 						 */
-						if (fetch->returns_multiple_rows)
+						if (fetch->returns_multiple_rows && !fetch->bulk_collect)
 							ereport(ERROR,
 									(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 									 errmsg("FETCH statement cannot return multiple rows"),
@@ -2201,6 +2256,16 @@ stmt_fetch		: K_FETCH opt_fetch_direction cursor_variable K_INTO
 					}
 				;
 
+opt_bulk_collect	:
+					{
+						$$ = false;
+					}
+				| K_BULK K_COLLECT
+					{
+						$$ = true;
+					}
+				;
+
 stmt_move		: K_MOVE opt_fetch_direction cursor_variable ';'
 					{
 						PLpgSQL_stmt_fetch *fetch = $2;
@@ -2520,9 +2585,11 @@ unreserved_keyword	:
 				| K_ARRAY
 				| K_ASSERT
 				| K_BACKWARD
+				| K_BULK
 				| K_CALL
 				| K_CLOSE
 				| K_COLLATE
+				| K_COLLECT
 				| K_COLUMN
 				| K_COLUMN_NAME
 				| K_COMMIT
@@ -2546,6 +2613,7 @@ unreserved_keyword	:
 				| K_EXIT
 				| K_FETCH
 				| K_FIRST
+				| K_FORALL
 				| K_FORWARD
 				| K_GET
 				| K_HINT
@@ -2554,6 +2622,7 @@ unreserved_keyword	:
 				| K_INSERT
 				| K_IS
 				| K_LAST
+				| K_LIMIT
 				| K_LOG
 				| K_MERGE
 				| K_MESSAGE
@@ -2997,6 +3066,7 @@ make_execsql_stmt(int firsttoken, int location)
 	int					prev_tok = -1;
 	bool				have_into = false;
 	bool				have_strict = false;
+	bool				have_bulk = false;
 	int					into_start_loc = -1;
 	int					into_end_loc = -1;
 
@@ -3061,6 +3131,33 @@ make_execsql_stmt(int firsttoken, int location)
 			read_into_target(&target, &have_strict);
 			oraplsql_IdentifierLookup = IDENTIFIER_LOOKUP_EXPR;
 		}
+		else if (tok_is_keyword(tok, &yylval, K_BULK, "bulk"))
+		{
+			/*
+			 * BULK COLLECT INTO collects all result rows into array
+			 * variables.  It's not STRICT, and the INTO text to blank out
+			 * starts at BULK.
+			 */
+			int			bulk_loc = yylloc;
+			int			tok2 = yylex();
+
+			if (!tok_is_keyword(tok2, &yylval, K_COLLECT, "collect"))
+			{
+				oraplsql_push_back_token(tok2);
+				continue;
+			}
+			if (yylex() != K_INTO)
+				yyerror("syntax error, expected \"INTO\"");
+			if (have_into)
+				yyerror("INTO specified more than once");
+			have_into = true;
+			have_bulk = true;
+			into_start_loc = bulk_loc;
+			oraplsql_IdentifierLookup = IDENTIFIER_LOOKUP_NORMAL;
+			read_into_target(&target, NULL);
+			check_bulk_target(target, bulk_loc);
+			oraplsql_IdentifierLookup = IDENTIFIER_LOOKUP_EXPR;
+		}
 	}
 
 	oraplsql_IdentifierLookup = save_IdentifierLookup;
@@ -3099,11 +3196,366 @@ make_execsql_stmt(int firsttoken, int location)
 	execsql->sqlstmt = expr;
 	execsql->into	 = have_into;
 	execsql->strict	 = have_strict;
+	execsql->bulk_collect = have_bulk;
 	execsql->target	 = target;
 
 	return (PLpgSQL_stmt *) execsql;
 }
 
+/*
+ * Build an expression for the given SQL text, using the current namespace.
+ */
+static PLpgSQL_expr *
+make_forall_expr(StringInfo ds)
+{
+	PLpgSQL_expr		*expr;
+
+	/* trim any trailing whitespace, for neatness */
+	while (ds->len > 0 && scanner_isspace(ds->data[ds->len - 1]))
+		ds->data[--ds->len] = '\0';
+
+	expr = palloc0(sizeof(PLpgSQL_expr));
+	expr->query			= pstrdup(ds->data);
+	expr->plan			= NULL;
+	expr->paramnos		= NULL;
+	expr->rwparam		= -1;
+	expr->ns			= oraplsql_ns_top();
+
+	return expr;
+}
+
+/*
+ * Choose a name for a hidden variable or the index column of a FORALL
+ * statement's bulk version.  It must not be the name of a variable in
+ * scope, nor appear anywhere in the statement, which covers the tables,
+ * aliases and columns it refers to.  Case is ignored, to be safe.
+ */
+static char *
+forall_unique_name(const char *base, const char *stmttext)
+{
+	char	   *lowertext = pstrdup(stmttext);
+	char	   *name = pstrdup(base);
+	char	   *c;
+	int			i = 0;
+
+	for (c = lowertext; *c; c++)
+		*c = pg_tolower((unsigned char) *c);
+
+	while (oraplsql_ns_lookup(oraplsql_ns_top(), false,
+							  name, NULL, NULL, NULL) != NULL ||
+		   strstr(lowertext, name) != NULL)
+		name = psprintf("%s_%d", base, ++i);
+
+	pfree(lowertext);
+	return name;
+}
+
+/*
+ * Append the function text from startloc to endloc, replacing the index
+ * variable references in idxrefs (a list of location, length pairs) by the
+ * index column idxcol.  The column is qualified by its range of the same
+ * name, so that it can't be mistaken for a column of the target table.
+ */
+static void
+append_forall_source(StringInfo ds, int startloc, int endloc, List *idxrefs,
+					 const char *idxcol)
+{
+	ListCell	   *lc = list_head(idxrefs);
+
+	while (lc != NULL)
+	{
+		int			loc = lfirst_int(lc);
+		int			len = lfirst_int(lnext(lc));
+
+		lc = lnext(lnext(lc));
+		if (loc < startloc || loc >= endloc)
+			continue;
+
+		oraplsql_append_source_text(ds, startloc, loc);
+		appendStringInfo(ds, "%s.%s", idxcol, idxcol);
+		startloc = loc + len;
+	}
+	oraplsql_append_source_text(ds, startloc, endloc);
+}
+
+/*
+ * Parse the rest of a FORALL statement, after "FORALL var IN".
+ *
+ * The bounds are read as in an integer FOR loop, and the DML statement like
+ * any other SQL statement, with the index variable in scope.  If the
+ * statement is a single-row INSERT ... VALUES or a DELETE, we also build a
+ * version of it that does the whole index range at once, by joining it with
+ * generate_series() over the bounds and replacing the references to the
+ * index variable by the series column:
+ *
+ *		INSERT INTO t VALUES (a[i], b[i])
+ *	=>	INSERT INTO t SELECT a[x], b[x] FROM generate_series(lo, hi) AS x
+ *
+ *		DELETE FROM t WHERE id = a[i]
+ *	=>	DELETE FROM t USING generate_series(lo, hi) AS x WHERE id = a[x]
+ *
+ * That ships one statement to the datanodes instead of one per index value.
+ * It does the same as executing the statement for each value in turn, as
+ * long as one execution doesn't look at the rows changed by an earlier one.
+ * So statements with a sub-SELECT keep to executing per index value, and
+ * exec_stmt_forall checks for volatile functions and statement triggers.
+ * UPDATE is always executed per index value: joined with the series, a row
+ * matched by several index values would be updated only once.
+ */
+static PLpgSQL_stmt *
+make_forall_stmt(char *varname, int varlineno, int location)
+{
+	PLpgSQL_stmt_forall	*new;
+	PLpgSQL_stmt_execsql *execsql;
+	StringInfoData		ds;
+	IdentifierLookup	save_IdentifierLookup;
+	int					tok;
+	int					startloc = -1;
+	int					prevloc = -1;
+	int					parenlevel = 0;
+	int					dmlloc;
+	int					endloc;
+	bool				is_insert;
+	bool				is_delete;
+	bool				can_bulk;
+	List			   *idxrefs = NIL;
+	int					values_loc = -1;
+	int					row_start = -1;
+	int					row_end = -1;
+	int					using_end = -1;
+	int					where_loc = -1;
+	int					subst_start;
+	int					subst_end;
+	ListCell		   *lc;
+
+	new = palloc0(sizeof(PLpgSQL_stmt_forall));
+	new->cmd_type = PLPGSQL_STMT_FORALL;
+	new->lineno = oraplsql_location_to_lineno(location);
+
+	new->lower = read_sql_expression(DOT_DOT, "..");
+
+	/*
+	 * Nothing separates the upper bound from the DML statement, so read up
+	 * to the statement's first word.
+	 */
+	save_IdentifierLookup = oraplsql_IdentifierLookup;
+	oraplsql_IdentifierLookup = IDENTIFIER_LOOKUP_EXPR;
+
+	for (;;)
+	{
+		tok = yylex();
+		if (startloc < 0)
+			startloc = yylloc;
+		if (parenlevel == 0 &&
+			(tok == K_INSERT || tok == K_MERGE ||
+			 (tok == T_WORD && !yylval.word.quoted &&
+			  (strcmp(yylval.word.ident, "update") == 0 ||
+			   strcmp(yylval.word.ident, "delete") == 0))))
+			break;
+		if (tok == '(' || tok == '[')
+			parenlevel++;
+		else if (tok == ')' || tok == ']')
+		{
+			parenlevel--;
+			if (parenlevel < 0)
+				yyerror("mismatched parentheses");
+		}
+		if (tok == 0 || tok == ';')
+			ereport(ERROR,
+					(errcode(ERRCODE_SYNTAX_ERROR),
+					 errmsg("missing INSERT, UPDATE, DELETE or MERGE statement in FORALL"),
+					 parser_errposition(yylloc)));
+	}
+
+	if (startloc >= yylloc)
+		yyerror("missing expression");
+
+	initStringInfo(&ds);
+	appendStringInfoString(&ds, "SELECT ");
+	oraplsql_append_source_text(&ds, startloc, yylloc);
+	new->upper = make_forall_expr(&ds);
+	check_sql_expr(new->upper->query, startloc, 7);
+
+	dmlloc = yylloc;
+	is_insert = (tok == K_INSERT);
+	is_delete = (tok == T_WORD && strcmp(yylval.word.ident, "delete") == 0);
+	can_bulk = is_insert || is_delete;
+
+	/* the index variable is visible only in the DML statement */
+	oraplsql_ns_push(NULL, PLPGSQL_LABEL_OTHER);
+	new->var = (PLpgSQL_var *)
+		oraplsql_build_variable(varname, varlineno,
+								oraplsql_build_datatype(INT4OID, -1,
+														InvalidOid),
+								true);
+
+	/*
+	 * Scan to the end of the statement, noting where the index variable is
+	 * used, and the parts of the statement that the bulk version rewrites.
+	 */
+	for (;;)
+	{
+		prevloc = yylloc;
+		tok = yylex();
+		if (tok == ';')
+			break;
+		if (tok == 0)
+			yyerror("unexpected end of function definition");
+
+		/* anything after the VALUES row, or a multi-row VALUES */
+		if (row_end >= 0)
+			can_bulk = false;
+
+		if (tok == T_DATUM && yylval.wdatum.ident != NULL &&
+			yylval.wdatum.datum == (PLpgSQL_datum *) new->var)
+		{
+			idxrefs = lappend_int(idxrefs, yylloc);
+			idxrefs = lappend_int(idxrefs, oraplsql_token_length());
+		}
+		else if (tok == K_INTO && parenlevel == 0 && prevloc != dmlloc)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("INTO is not supported in FORALL"),
+					 parser_errposition(yylloc)));
+		else if (tok == K_DEFAULT)
+			can_bulk = false;
+		else if (tok == '(' || tok == '[')
+		{
+			if (parenlevel == 0 && values_loc >= 0 && prevloc == values_loc)
+				row_start = yylloc;
+			parenlevel++;
+		}
+		else if (tok == ')' || tok == ']')
+		{
+			parenlevel--;
+			if (parenlevel < 0)
+				yyerror("mismatched parentheses");
+			if (parenlevel == 0 && row_start >= 0 && row_end < 0)
+				row_end = yylloc;
+		}
+		else if (tok == T_WORD && !yylval.word.quoted &&
+				 strcmp(yylval.word.ident, "select") == 0)
+			can_bulk = false;	/* a sub-SELECT would see earlier changes */
+		else if (parenlevel == 0 && tok == T_WORD && !yylval.word.quoted)
+		{
+			if (is_insert && values_loc < 0 &&
+				strcmp(yylval.word.ident, "values") == 0)
+				values_loc = yylloc;
+			else if (is_delete && where_loc < 0 &&
+					 strcmp(yylval.word.ident, "where") == 0)
+				where_loc = yylloc;
+			else if (strcmp(yylval.word.ident, "returning") == 0)
+				can_bulk = false;
+		}
+		else if (parenlevel == 0 && is_delete && tok == K_USING &&
+				 using_end < 0)
+			using_end = yylloc + oraplsql_token_length();
+		else if (tok_is_keyword(tok, &yylval, K_CURRENT, "current") &&
+				 prevloc == where_loc)
+			can_bulk = false;	/* WHERE CURRENT OF */
+	}
+	endloc = yylloc;
+
+	oraplsql_IdentifierLookup = save_IdentifierLookup;
+
+	initStringInfo(&ds);
+	oraplsql_append_source_text(&ds, dmlloc, endloc);
+	execsql = palloc0(sizeof(PLpgSQL_stmt_execsql));
+	execsql->cmd_type = PLPGSQL_STMT_EXECSQL;
+	execsql->lineno = oraplsql_location_to_lineno(dmlloc);
+	execsql->sqlstmt = make_forall_expr(&ds);
+	check_sql_expr(execsql->sqlstmt->query, dmlloc, 0);
+	new->body = execsql;
+
+	/*
+	 * The bulk version replaces the index variable only in the VALUES row or
+	 * the WHERE clause.  If it's used anywhere else, keep to executing the
+	 * statement per index value.
+	 */
+	if (is_insert)
+	{
+		if (row_end < 0)
+			can_bulk = false;
+		subst_start = row_start;
+		subst_end = row_end;
+	}
+	else
+	{
+		subst_start = where_loc >= 0 ? where_loc : endloc;
+		subst_end = endloc;
+	}
+	foreach(lc, idxrefs)
+	{
+		int			loc = lfirst_int(lc);
+
+		if (loc < subst_start || loc >= subst_end)
+			can_bulk = false;
+		lc = lnext(lc);
+	}
+
+	if (can_bulk)
+	{
+		const char *stmttext = new->body->sqlstmt->query;
+		char	   *idxcol;
+		int			insertloc;
+
+		new->bulk_lower = (PLpgSQL_var *)
+			oraplsql_build_variable(forall_unique_name("__forall_lower",
+													   stmttext),
+									varlineno,
+									oraplsql_build_datatype(INT4OID, -1,
+															InvalidOid),
+									true);
+		new->bulk_upper = (PLpgSQL_var *)
+			oraplsql_build_variable(forall_unique_name("__forall_upper",
+													   stmttext),
+									varlineno,
+									oraplsql_build_datatype(INT4OID, -1,
+															InvalidOid),
+									true);
+		idxcol = forall_unique_name("__forall_idx", stmttext);
+
+		resetStringInfo(&ds);
+		if (is_insert)
+		{
+			oraplsql_append_source_text(&ds, dmlloc, values_loc);
+			appendStringInfoString(&ds, "SELECT ");
+			append_forall_source(&ds, row_start + 1, row_end, idxrefs, idxcol);
+			appendStringInfo(&ds, " FROM pg_catalog.generate_series(%s, %s) AS %s",
+							 new->bulk_lower->refname,
+							 new->bulk_upper->refname, idxcol);
+		}
+		else
+		{
+			if (using_end >= 0)
+				insertloc = using_end;
+			else if (where_loc >= 0)
+				insertloc = where_loc;
+			else
+				insertloc = endloc;
+
+			oraplsql_append_source_text(&ds, dmlloc, insertloc);
+			appendStringInfo(&ds, "%s pg_catalog.generate_series(%s, %s) AS %s%s ",
+							 using_end >= 0 ? "" : " USING",
+							 new->bulk_lower->refname,
+							 new->bulk_upper->refname, idxcol,
+							 using_end >= 0 ? "," : "");
+			append_forall_source(&ds, insertloc, endloc, idxrefs, idxcol);
+		}
+
+		execsql = palloc0(sizeof(PLpgSQL_stmt_execsql));
+		execsql->cmd_type = PLPGSQL_STMT_EXECSQL;
+		execsql->lineno = oraplsql_location_to_lineno(dmlloc);
+		execsql->sqlstmt = make_forall_expr(&ds);
+		new->bulk = execsql;
+	}
+
+	pfree(ds.data);
+	oraplsql_ns_pop();
+
+	return (PLpgSQL_stmt *) new;
+}
+
 
 /*
  * Read FETCH or MOVE direction clause (everything through FROM/IN).
@@ -3551,6 +4003,22 @@ read_into_target(PLpgSQL_variable **target, bool *strict)
 	}
 }
 
+/*
+ * Check the target of BULK COLLECT INTO.  It must be a list of variables,
+ * which are checked to be arrays when the statement is executed.
+ */
+static void
+check_bulk_target(PLpgSQL_variable *target, int location)
+{
+	if (target->dtype == PLPGSQL_DTYPE_REC ||
+		((PLpgSQL_row *) target)->rowtupdesc != NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_SYNTAX_ERROR),
+				 errmsg("BULK COLLECT target \"%s\" is not an array variable",
+						target->refname),
+				 parser_errposition(location)));
+}
+
 /*
  * Given the first datum and name in the INTO list, continue to read
  * comma-separated scalar variables until we run out. Then construct
@@ -0,0 +1,140 @@
+--
+-- FORALL and BULK COLLECT
+--
+CREATE TABLE forall_t (id int, val text);
+
+-- INSERT ... VALUES is rewritten to do the whole range at once
+CREATE FUNCTION forall_ins(lo int, hi int) RETURNS void AS $$
+DECLARE
+    ids int[] := ARRAY[10, 20, 30, 40, 50];
+    vals text[] := ARRAY['a', 'b', 'c', 'd', 'e'];
+    n int;
+BEGIN
+    FORALL i IN lo..hi INSERT INTO forall_t VALUES (ids[i], vals[i]);
+    GET DIAGNOSTICS n = ROW_COUNT;
+    RAISE NOTICE 'found %, row_count %', FOUND, n;
+END;
+$$ LANGUAGE oraplsql;
+SELECT forall_ins(1, 3);
+SELECT forall_ins(4, 5);
+
+-- empty range
+SELECT forall_ins(3, 2);
+SELECT * FROM forall_t ORDER BY id;
+
+-- UPDATE runs once per index value, so a row can be updated twice
+CREATE FUNCTION forall_upd() RETURNS void AS $$
+DECLARE
+    ids int[] := ARRAY[20, 40, 20];
+    n int;
+BEGIN
+    FORALL i IN 1..3 UPDATE forall_t SET val = val || '!' WHERE id = ids[i];
+    GET DIAGNOSTICS n = ROW_COUNT;
+    RAISE NOTICE 'found %, row_count %', FOUND, n;
+END;
+$$ LANGUAGE oraplsql;
+SELECT forall_upd();
+SELECT * FROM forall_t ORDER BY id;
+
+-- DELETE is rewritten; a row matched twice counts once either way
+CREATE FUNCTION forall_del(lo int, hi int) RETURNS void AS $$
+DECLARE
+    ids int[] := ARRAY[10, 30, 30, 99];
+    n int;
+BEGIN
+    FORALL i IN lo..hi DELETE FROM forall_t WHERE id = ids[i];
+    GET DIAGNOSTICS n = ROW_COUNT;
+    RAISE NOTICE 'found %, row_count %', FOUND, n;
+END;
+$$ LANGUAGE oraplsql;
+SELECT forall_del(1, 4);
+SELECT forall_del(4, 4);
+SELECT * FROM forall_t ORDER BY id;
+
+-- BULK COLLECT, in batches with LIMIT and all at once
+CREATE FUNCTION forall_fetch() RETURNS void AS $$
+DECLARE
+    c CURSOR FOR SELECT id FROM forall_t ORDER BY id;
+    ids int[];
+    vals text[];
+BEGIN
+    OPEN c;
+    LOOP
+        FETCH c BULK COLLECT INTO ids LIMIT 2;
+        EXIT WHEN NOT FOUND;
+        RAISE NOTICE 'batch %', ids;
+    END LOOP;
+    CLOSE c;
+    SELECT id, val BULK COLLECT INTO ids, vals FROM forall_t ORDER BY id;
+    RAISE NOTICE 'ids %, vals %', ids, vals;
+END;
+$$ LANGUAGE oraplsql;
+SELECT forall_fetch();
+
+-- statement triggers must fire once per index value, so no rewrite
+CREATE TABLE forall_log (op text);
+CREATE FUNCTION forall_log_trig() RETURNS trigger AS $$
+BEGIN
+    INSERT INTO forall_log VALUES (TG_OP);
+    RETURN NULL;
+END;
+$$ LANGUAGE oraplsql;
+CREATE TRIGGER forall_t_stmt AFTER INSERT OR DELETE ON forall_t
+    FOR EACH STATEMENT EXECUTE PROCEDURE forall_log_trig();
+SELECT forall_ins(1, 3);
+SELECT forall_del(1, 3);
+SELECT op, count(*) FROM forall_log GROUP BY op ORDER BY op;
+DROP TRIGGER forall_t_stmt ON forall_t;
+
+-- a sub-SELECT sees the rows inserted for the earlier index values
+CREATE TABLE forall_s (id int, seen bigint);
+CREATE FUNCTION forall_sub() RETURNS void AS $$
+DECLARE
+    n int;
+BEGIN
+    FORALL i IN 1..3 INSERT INTO forall_s VALUES (i, (SELECT count(*) FROM forall_s));
+    GET DIAGNOSTICS n = ROW_COUNT;
+    RAISE NOTICE 'row_count %', n;
+END;
+$$ LANGUAGE oraplsql;
+SELECT forall_sub();
+
+-- and so does a volatile function
+CREATE FUNCTION forall_s_count() RETURNS bigint AS
+    'SELECT count(*) FROM forall_s' LANGUAGE sql VOLATILE;
+CREATE FUNCTION forall_vol() RETURNS void AS $$
+BEGIN
+    FORALL i IN 4..6 INSERT INTO forall_s VALUES (i, forall_s_count());
+END;
+$$ LANGUAGE oraplsql;
+SELECT forall_vol();
+SELECT * FROM forall_s ORDER BY id;
+
+-- the rewrite must not capture the names used by the statement
+CREATE TABLE forall_c (__forall_idx int, id int);
+CREATE FUNCTION forall_names() RETURNS void AS $$
+DECLARE
+    __forall_lower int := 100;
+    ids int[] := ARRAY[1, 2, 3];
+    n int;
+BEGIN
+    FORALL i IN 1..3 INSERT INTO forall_c VALUES (__forall_lower, ids[i]);
+    GET DIAGNOSTICS n = ROW_COUNT;
+    RAISE NOTICE 'inserted %', n;
+    FORALL i IN 2..3 DELETE FROM forall_c WHERE id = ids[i] AND __forall_idx = __forall_lower;
+    GET DIAGNOSTICS n = ROW_COUNT;
+    RAISE NOTICE 'deleted %', n;
+END;
+$$ LANGUAGE oraplsql;
+SELECT forall_names();
+SELECT * FROM forall_c;
+DROP FUNCTION forall_ins(int, int);
+DROP FUNCTION forall_upd();
+DROP FUNCTION forall_del(int, int);
+DROP FUNCTION forall_fetch();
+DROP FUNCTION forall_sub();
+DROP FUNCTION forall_vol();
+DROP FUNCTION forall_s_count();
+DROP FUNCTION forall_names();
+DROP TABLE forall_t, forall_log, forall_s, forall_c;
+DROP FUNCTION forall_log_trig();
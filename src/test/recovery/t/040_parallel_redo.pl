@@ -0,0 +1,147 @@
+# Test replay of a mixed workload on a standby that uses parallel redo
+# workers, and check that its data matches the master.
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 7;
+
+# Initialize master node
+my $node_master = get_new_node('master', 'datanode');
+$node_master->init(allows_streaming => 1,
+                   extra => ['--master_gtm_nodename', 'no_gtm',
+		             '--master_gtm_ip', '127.0.0.1',
+		             '--master_gtm_port', '25001']);
+$node_master->append_conf('postgresql.conf', qq[
+allow_dml_on_datanode = on
+is_centralized_mode = on
+autovacuum = off
+]);
+$node_master->start;
+
+# Some content that is already in the base backup
+$node_master->safe_psql('postgres', qq[
+CREATE TABLE tab_base (a int PRIMARY KEY, b text);
+INSERT INTO tab_base SELECT i, md5(i::text) FROM generate_series(1, 5000) i;
+]);
+
+my $backup_name = 'my_backup';
+$node_master->backup($backup_name);
+
+# Create a streaming standby that replays with parallel workers
+my $node_standby = get_new_node('standby', 'datanode');
+$node_standby->init_from_backup($node_master, $backup_name,
+	has_streaming => 1);
+$node_standby->append_conf('postgresql.conf', "parallel_redo_workers = 4");
+$node_standby->start;
+
+# A mixed workload touching many relations and blocks: heap and index
+# inserts, HOT and non-HOT updates, deletes, vacuum, truncate, relation
+# drops, and a rolled back transaction.
+$node_master->safe_psql('postgres', qq[
+CREATE TABLE tab_mixed (a int, b int, c text);
+CREATE INDEX tab_mixed_b_idx ON tab_mixed (b);
+INSERT INTO tab_mixed SELECT i, i % 100, repeat('x', i % 200)
+  FROM generate_series(1, 20000) i;
+UPDATE tab_base SET b = b || '-upd' WHERE a % 3 = 0;
+UPDATE tab_mixed SET b = b + 1 WHERE a % 7 = 0;
+UPDATE tab_mixed SET c = 'short' WHERE a % 11 = 0;
+DELETE FROM tab_mixed WHERE a % 5 = 0;
+DELETE FROM tab_base WHERE a > 4500;
+VACUUM tab_mixed;
+CREATE TABLE tab_trunc AS SELECT generate_series(1, 3000) AS a;
+TRUNCATE tab_trunc;
+INSERT INTO tab_trunc SELECT generate_series(1, 100);
+CREATE TABLE tab_drop AS SELECT generate_series(1, 3000) AS a;
+DROP TABLE tab_drop;
+BEGIN;
+INSERT INTO tab_mixed SELECT i, -1, 'rolled back' FROM generate_series(1, 1000) i;
+ROLLBACK;
+CHECKPOINT;
+INSERT INTO tab_base SELECT i, md5(i::text) FROM generate_series(5001, 6000) i;
+]);
+
+$node_master->wait_for_catchup($node_standby, 'replay',
+	$node_master->lsn('insert'));
+
+# Compare the contents of every table
+foreach my $query (
+	"SELECT count(*), md5(string_agg(a || ':' || b, ',' ORDER BY a)) FROM tab_base",
+	"SELECT count(*), md5(string_agg(a || ':' || b || ':' || c, ',' ORDER BY a)) FROM tab_mixed",
+	"SELECT count(*), sum(a) FROM tab_trunc")
+{
+	my $expected = $node_master->safe_psql('postgres', $query);
+	my $result = $node_standby->safe_psql('postgres', $query);
+	is($result, $expected, "standby matches master: $query");
+}
+
+# Index scans on the standby must see the same rows as the heap
+my $result = $node_standby->safe_psql('postgres', qq[
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM tab_mixed WHERE b = 8;
+]);
+my $expected = $node_master->safe_psql('postgres',
+	"SELECT count(*) FROM tab_mixed WHERE b = 8");
+is($result, $expected, 'index on standby matches master');
+
+# Run index scans on the standby while it replays inserts.  An index entry
+# must never be replayed before the heap tuple it points to, or the scan
+# would try to read a heap block that doesn't exist yet.
+$node_master->safe_psql('postgres', qq[
+CREATE TABLE tab_conc (a int PRIMARY KEY, b text);
+CREATE TABLE tab_conc_done (a int);
+]);
+$node_master->wait_for_catchup($node_standby, 'replay',
+	$node_master->lsn('insert'));
+
+my $in = '';
+my $out = '';
+my $timer = IPC::Run::timeout(180);
+my $scanner = $node_standby->background_psql('postgres', \$in, \$out, $timer);
+$in .= q[
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+DO $$
+DECLARE
+	n int;
+	i int := 0;
+BEGIN
+	WHILE NOT EXISTS (SELECT 1 FROM tab_conc_done) LOOP
+		SELECT count(*) INTO n FROM tab_conc WHERE a > (i * 97) % 20000;
+		i := i + 1;
+	END LOOP;
+END
+$$;
+\\echo scans done
+];
+$scanner->pump_nb;
+
+foreach my $i (0 .. 39)
+{
+	my $first = $i * 500 + 1;
+	my $last = $first + 499;
+	$node_master->safe_psql('postgres',
+		"INSERT INTO tab_conc SELECT i, repeat('y', 100) FROM generate_series($first, $last) i");
+}
+$node_master->safe_psql('postgres', "INSERT INTO tab_conc_done VALUES (1)");
+
+$scanner->pump until $out =~ /scans done/ || $timer->is_expired;
+like($out, qr/scans done/, 'index scans on standby during replay succeed');
+$in .= "\\q\n";
+$scanner->finish;
+
+$node_master->wait_for_catchup($node_standby, 'replay',
+	$node_master->lsn('insert'));
+$result = $node_standby->safe_psql('postgres', qq[
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM tab_conc WHERE a > 0;
+]);
+is($result, qq(20000), 'index on standby sees all replayed rows');
+
+# The walsender reports the standby's replay rate once it has seen two
+# apply positions at least a second apart
+ok($node_master->poll_query_until('postgres',
+	"SELECT replay_rate >= 0 FROM pg_stat_replication"),
+	'replay_rate is reported');
@@ -0,0 +1,67 @@
+# Test crash recovery with recovery_prefetch_distance set, so that data
+# blocks are prefetched ahead of replay.
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 5;
+
+my $node = get_new_node('prefetch', 'datanode');
+$node->init(extra => ['--master_gtm_nodename', 'no_gtm',
+                      '--master_gtm_ip', '127.0.0.1',
+                      '--master_gtm_port', '25001']);
+
+# Without full page images, redo has to read the blocks it changes, and a
+# small buffer pool makes sure they are not all in memory.
+$node->append_conf('postgresql.conf', qq[
+allow_dml_on_datanode = on
+is_centralized_mode = on
+autovacuum = off
+full_page_writes = off
+shared_buffers = 1MB
+recovery_prefetch_distance = 256kB
+]);
+$node->start;
+
+$node->safe_psql('postgres', qq[
+CREATE TABLE tab_prefetch (a int, b text);
+CREATE INDEX tab_prefetch_a_idx ON tab_prefetch (a);
+INSERT INTO tab_prefetch SELECT i, repeat('x', 100) FROM generate_series(1, 20000) i;
+CREATE TABLE tab_gone AS SELECT generate_series(1, 1000) AS a;
+CHECKPOINT;
+]);
+
+# Changes spread over existing blocks, plus relations created and dropped
+# while the read-ahead is past them
+$node->safe_psql('postgres', qq[
+UPDATE tab_prefetch SET b = 'updated' WHERE a % 10 = 0;
+DELETE FROM tab_prefetch WHERE a % 7 = 0;
+INSERT INTO tab_prefetch SELECT i, 'new' FROM generate_series(20001, 25000) i;
+DROP TABLE tab_gone;
+CREATE TABLE tab_new AS SELECT generate_series(1, 5000) AS a;
+UPDATE tab_new SET a = -a WHERE a % 2 = 0;
+]);
+
+my $query_prefetch =
+  "SELECT count(*), md5(string_agg(a || ':' || b, ',' ORDER BY a)) FROM tab_prefetch";
+my $query_new = "SELECT count(*), sum(a) FROM tab_new";
+my $expected_prefetch = $node->safe_psql('postgres', $query_prefetch);
+my $expected_new = $node->safe_psql('postgres', $query_new);
+
+$node->stop('immediate');
+ok($node->start, 'crash recovery with prefetching succeeds');
+
+is($node->safe_psql('postgres', $query_prefetch), $expected_prefetch,
+	'table matches after recovery');
+is($node->safe_psql('postgres', $query_new), $expected_new,
+	'new table matches after recovery');
+
+my $result = $node->safe_psql('postgres', qq[
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM tab_prefetch WHERE a BETWEEN 19990 AND 20010;
+]);
+is($result, '18', 'index matches after recovery');
+
+like(slurp_file($node->logfile), qr/recovery prefetch read ahead \d+ records/,
+	'prefetch statistics are logged');
@@ -0,0 +1,67 @@
+# Test sequential scans with seqscan_prefetch_pages set, on a table that
+# doesn't fit in shared buffers, so that ranges of blocks are actually
+# requested from the kernel.
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 5;
+
+my $node = get_new_node('seqscan_prefetch', 'datanode');
+$node->init(extra => ['--master_gtm_nodename', 'no_gtm',
+                      '--master_gtm_ip', '127.0.0.1',
+                      '--master_gtm_port', '25001']);
+
+# The table is a few times larger than the buffer pool, and larger than a
+# quarter of it, so scans of it are synchronized and may start in the middle.
+$node->append_conf('postgresql.conf', qq[
+allow_dml_on_datanode = on
+is_centralized_mode = on
+autovacuum = off
+shared_buffers = 1MB
+seqscan_prefetch_pages = 64
+]);
+$node->start;
+
+$node->safe_psql('postgres', qq[
+CREATE TABLE tab_seqpf (a int, b text);
+INSERT INTO tab_seqpf SELECT i, repeat('x', 100) FROM generate_series(1, 20000) i;
+CREATE INDEX tab_seqpf_a_idx ON tab_seqpf (a);
+CHECKPOINT;
+]);
+$node->restart;
+
+my $result;
+
+# Nothing is cached, so every prefetch covers a whole range of blocks
+$result = $node->safe_psql('postgres',
+	"SELECT count(*), sum(a) FROM tab_seqpf");
+is($result, qq(20000|200010000), 'scan of an uncached table');
+
+# Scattered blocks read through the index split the ranges into runs
+$result = $node->safe_psql('postgres', qq[
+SET enable_seqscan = off;
+SELECT count(*) FROM tab_seqpf WHERE a % 500 = 1 AND a > 0;
+]);
+is($result, qq(40), 'index scan caches some blocks');
+$result = $node->safe_psql('postgres',
+	"SELECT count(*), sum(a) FROM tab_seqpf");
+is($result, qq(20000|200010000), 'scan of a partially cached table');
+
+# A scan that stops early leaves the next one to start in the middle of the
+# table and wrap around at its end
+$result = $node->safe_psql('postgres', qq[
+SELECT count(*) FROM (SELECT a FROM tab_seqpf WHERE a > 12000 LIMIT 1) s;
+SELECT count(*), sum(a) FROM tab_seqpf;
+]);
+is($result, qq(1
+20000|200010000), 'scan wrapping around the end of the table');
+
+# Temporary tables are not prefetched, but must still be read correctly
+$result = $node->safe_psql('postgres', qq[
+CREATE TEMP TABLE tmp_seqpf AS SELECT * FROM tab_seqpf;
+SELECT count(*), sum(a) FROM tmp_seqpf;
+]);
+is($result, qq(20000|200010000), 'scan of a temporary table');
+
+$node->stop;
@@ -92,3 +92,45 @@ vacuum btree_tall_tbl;
 -- need to insert some rows to cause the fast root page to split.
 insert into btree_tall_tbl (id, t)
   select g, repeat('x', 100) from generate_series(1, 500) g;
+
+--
+-- Test B-tree deduplication.  Runs of equal keys are merged into posting
+-- list tuples by the bulk build, and by insertions before a leaf page split.
+--
+create table btree_dedup_tbl(id int4, status int4);
+insert into btree_dedup_tbl select g, g % 4 from generate_series(1, 20000) g;
+create index btree_dedup_plain_idx on btree_dedup_tbl (status);
+create index btree_dedup_idx on btree_dedup_tbl (status)
+  with (deduplicate_items = on);
+select pg_relation_size('btree_dedup_idx') * 2 <
+       pg_relation_size('btree_dedup_plain_idx') as dedup_smaller;
+drop index btree_dedup_plain_idx;
+
+create table btree_dedup_ins_tbl(id int4, status int4);
+create index btree_dedup_ins_plain_idx on btree_dedup_ins_tbl (status);
+create index btree_dedup_ins_idx on btree_dedup_ins_tbl (status)
+  with (deduplicate_items = on);
+insert into btree_dedup_ins_tbl select g, g % 4 from generate_series(1, 20000) g;
+select pg_relation_size('btree_dedup_ins_idx') * 2 <
+       pg_relation_size('btree_dedup_ins_plain_idx') as dedup_smaller;
+drop index btree_dedup_ins_plain_idx;
+
+-- Scans must return every heap TID of a posting list
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+select count(*), sum(id) from btree_dedup_tbl where status = 2;
+select count(*), sum(id) from btree_dedup_ins_tbl where status = 3;
+select count(*) from btree_dedup_ins_tbl where status between 1 and 2;
+
+-- Vacuum removes dead heap TIDs from posting lists
+delete from btree_dedup_tbl where id % 3 = 0;
+delete from btree_dedup_ins_tbl where id % 3 = 0;
+vacuum btree_dedup_tbl;
+vacuum btree_dedup_ins_tbl;
+select count(*), sum(id) from btree_dedup_tbl where status = 2;
+select count(*), sum(id) from btree_dedup_ins_tbl where status = 3;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+drop table btree_dedup_tbl;
+drop table btree_dedup_ins_tbl;
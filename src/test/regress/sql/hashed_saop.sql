@@ -0,0 +1,72 @@
+--
+-- Hashed "= ANY (array)" evaluation and datanode pruning by IN lists
+--
+CREATE TABLE saop_dist (a int, b int8, c text);
+INSERT INTO saop_dist SELECT i, i % 4, 'v' || i FROM generate_series(1, 40) i;
+INSERT INTO saop_dist VALUES (41, NULL, NULL);
+ANALYZE saop_dist;
+
+-- Lists of at least nine constants are hashed
+SELECT count(*) FROM saop_dist
+WHERE a IN (1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23);
+SELECT a FROM saop_dist
+WHERE c IN ('v1', 'v2', 'v3', 'v4', 'v5', 'v6', 'v7', 'v8', 'v9', 'v10', 'nope')
+ORDER BY a;
+
+-- A NULL element turns "no match" into NULL, for short and long lists
+SELECT x,
+       x IN (1, NULL) AS short_in,
+       x IN (1, 2, 3, 4, 5, 6, 7, 8, 9, NULL) AS long_in,
+       x NOT IN (1, NULL) AS short_not_in,
+       x NOT IN (1, 2, 3, 4, 5, 6, 7, 8, 9, NULL) AS long_not_in
+FROM (VALUES (1), (10), (NULL::int)) v(x)
+ORDER BY x;
+SELECT count(*) FROM saop_dist WHERE a IN (1, 2, 3, 4, 5, 6, 7, 8, 9, NULL);
+SELECT count(*) FROM saop_dist WHERE a NOT IN (1, 2, 3, 4, 5, 6, 7, 8, 9, NULL);
+SELECT count(*) FROM saop_dist WHERE a NOT IN (1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+
+-- Cross-type operators have different hash functions on each side and
+-- keep the linear search
+SELECT count(*) FROM saop_dist WHERE a = ANY ('{1,2,3,4,5,6,7,8,9,10}'::int8[]);
+SELECT count(*) FROM saop_dist WHERE b = ANY ('{0,1,2,3,4,5,6,7,8,9}'::int4[]);
+
+-- IN lists on the distribution column only go to the datanodes of the keys
+EXPLAIN (costs off) SELECT * FROM saop_dist WHERE a IN (1, 2, 15);
+EXPLAIN (costs off) SELECT * FROM saop_dist WHERE a IN (10, 11, 16, 20, 29, 30);
+EXPLAIN (costs off) SELECT * FROM saop_dist WHERE a IN (1, 2, 15, NULL);
+EXPLAIN (costs off) SELECT * FROM saop_dist WHERE a IN (1, 2, 15, 16);
+SELECT * FROM saop_dist WHERE a IN (1, 2, 15, NULL) ORDER BY a;
+SELECT * FROM saop_dist WHERE a IN (10, 11, 16, 20, 29, 30) ORDER BY a;
+
+-- "= ANY ($n)" in a generic plan picks the datanodes at execution time
+CREATE TABLE saop_rep (a int, d text) DISTRIBUTE BY REPLICATION;
+INSERT INTO saop_rep SELECT i, 'r' || i FROM generate_series(1, 40) i;
+ANALYZE saop_rep;
+SET plan_cache_mode = force_generic_plan;
+PREPARE saop_any(int[]) AS SELECT * FROM saop_dist WHERE a = ANY ($1);
+EXPLAIN (costs off) EXECUTE saop_any('{1,2,15}');
+EXECUTE saop_any('{1,2,15}');
+EXECUTE saop_any('{10,16,NULL}');
+EXECUTE saop_any('{}');
+EXECUTE saop_any(NULL);
+PREPARE saop_sum(int[]) AS SELECT count(*), sum(a) FROM saop_dist WHERE a = ANY ($1);
+EXECUTE saop_sum('{1,2,15,16,20,NULL,99}');
+
+-- Joins with replicated tables and co-located joins stay shipped
+PREPARE saop_join_rep(int[]) AS
+SELECT s.a, r.d FROM saop_dist s JOIN saop_rep r ON r.a = s.a
+WHERE s.a = ANY ($1);
+EXPLAIN (costs off) EXECUTE saop_join_rep('{1,2}');
+EXECUTE saop_join_rep('{1,2}');
+PREPARE saop_join_dist(int[]) AS
+SELECT s1.a, s2.c FROM saop_dist s1 JOIN saop_dist s2 ON s2.a = s1.a
+WHERE s1.a = ANY ($1);
+EXPLAIN (costs off) EXECUTE saop_join_dist('{1,2}');
+EXECUTE saop_join_dist('{1,2}');
+DEALLOCATE saop_any;
+DEALLOCATE saop_sum;
+DEALLOCATE saop_join_rep;
+DEALLOCATE saop_join_dist;
+RESET plan_cache_mode;
+DROP TABLE saop_rep;
+DROP TABLE saop_dist;
@@ -0,0 +1,52 @@
+--
+-- Incremental Sort
+--
+-- All rows of inc_t live on one datanode, so the queries below ship there
+-- as a whole.  The index on (k, a) returns the rows presorted on a.
+create table inc_t (k int, a int, b int);
+create index inc_t_k_a_idx on inc_t (k, a);
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+
+-- Groups of 10 rows are smaller than the minimum batch, so every sort
+-- batch spans several groups of a
+insert into inc_t select 1, i / 10 + 1, 1000 - i from generate_series(0, 999) i;
+analyze inc_t;
+explain (costs off)
+select a, b from inc_t where k = 1 order by a, b limit 33;
+set enable_incremental_sort = on;
+explain (costs off)
+select a, b from inc_t where k = 1 order by a, b limit 33;
+select a, b from inc_t where k = 1 order by a, b limit 33;
+select md5(string_agg(a || ':' || b, ','))
+  from (select a, b from inc_t where k = 1 order by a, b limit 66) s;
+select md5(string_agg(a || ':' || b, ','))
+  from (select a, b from inc_t where k = 1 order by a, b) s;
+
+-- Groups of 100 rows are larger than the minimum batch, so every sort
+-- batch holds exactly one group of a
+truncate inc_t;
+insert into inc_t select 1, i / 100 + 1, 1000 - i from generate_series(0, 999) i;
+analyze inc_t;
+explain (costs off)
+select a, b from inc_t where k = 1 order by a, b limit 33;
+select a, b from inc_t where k = 1 order by a, b limit 33;
+select md5(string_agg(a || ':' || b, ','))
+  from (select a, b from inc_t where k = 1 order by a, b limit 101) s;
+select md5(string_agg(a || ':' || b, ','))
+  from (select a, b from inc_t where k = 1 order by a, b) s;
+
+-- Backward index scan
+explain (costs off)
+select a, b from inc_t where k = 1 order by a desc, b desc limit 5;
+select a, b from inc_t where k = 1 order by a desc, b desc limit 5;
+
+-- The results must not depend on the sort method
+reset enable_incremental_sort;
+select md5(string_agg(a || ':' || b, ','))
+  from (select a, b from inc_t where k = 1 order by a, b limit 101) s;
+select md5(string_agg(a || ':' || b, ','))
+  from (select a, b from inc_t where k = 1 order by a, b) s;
+reset enable_seqscan;
+reset enable_bitmapscan;
+drop table inc_t;
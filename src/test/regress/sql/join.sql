@@ -550,6 +550,49 @@ select count(*) from tenk1 a, tenk1 b
   where a.hundred = b.thousand and (b.fivethous % 10) < 10;
 select count(*) from tenk1 a, tenk1 b
   where a.hundred = b.thousand and (b.fivethous % 10) < 10;
+-- same with compressed batch files
+set pg_workfile_compression to on;
+select count(*) from tenk1 a, tenk1 b
+  where a.hundred = b.thousand and (b.fivethous % 10) < 10;
+reset pg_workfile_compression;
+
+-- EXPLAIN (ANALYZE, BUFFERS) shows how much the batch files shrank
+create function workfile_compression(query text)
+returns table (line text, shrunk boolean)
+language plpgsql as
+$$
+declare
+    ln text;
+    m text[];
+begin
+    for ln in
+        execute format('explain (analyze, buffers, costs off, timing off, summary off) %s',
+                       query)
+    loop
+        m := regexp_match(ln, 'Temp Compression: raw=(\d+)kB compressed=(\d+)kB');
+        if m is not null then
+            line := regexp_replace(trim(ln), '\d+(\.\d+)?', 'N', 'g');
+            shrunk := m[1]::bigint > m[2]::bigint;
+            return next;
+        end if;
+    end loop;
+end;
+$$;
+set pg_workfile_compression to on;
+select distinct * from workfile_compression('select count(*) from tenk1 a, tenk1 b where a.hundred = b.thousand and (b.fivethous % 10) < 10');
+reset pg_workfile_compression;
+select count(*) from workfile_compression('select count(*) from tenk1 a, tenk1 b where a.hundred = b.thousand and (b.fivethous % 10) < 10');
+
+-- external sorts spill through logtape, which reads ahead but doesn't compress
+set pg_workfile_compression to on;
+select unique1 from tenk1 order by ten, hundred desc, unique1 offset 4997 limit 6;
+select md5(string_agg(unique1::text, ',' order by ten, hundred desc, unique1)) =
+       (select md5(string_agg((p / 1000 + 10 * (9 - p % 1000 / 100) + 100 * (p % 100))::text,
+                              ',' order by p))
+        from generate_series(0, 9999) p) as sorted
+from tenk1;
+reset pg_workfile_compression;
+drop function workfile_compression(text);
 
 reset work_mem;
 reset enable_mergejoin;
@@ -0,0 +1,70 @@
+--
+-- Run-time rebalancing of operator memory (enable_memory_rebalance)
+--
+-- Largest number of hash join batches reported by EXPLAIN ANALYZE
+create function hash_batches(query text) returns int
+language plpgsql as
+$$
+declare
+    ln text;
+    m text[];
+    batches int := 0;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off) %s',
+                       query)
+    loop
+        m := regexp_match(ln, 'Batches: min \d+ max (\d+)');
+        if m is not null then
+            batches := greatest(batches, m[1]::int);
+        end if;
+    end loop;
+    return batches;
+end;
+$$;
+create table mg_outer as select generate_series(1, 20000) as id;
+analyze mg_outer;
+
+-- The planner believes the inner side is small enough to hash in one batch
+create table mg_inner as select generate_series(1, 20000) as id;
+alter table mg_inner set (autovacuum_enabled = 'false');
+analyze mg_inner;
+update pg_class set reltuples = 1000 where relname = 'mg_inner';
+create table mg_tiny as select generate_series(1, 10) as id;
+analyze mg_tiny;
+set max_parallel_workers_per_gather = 0;
+set enable_mergejoin = off;
+set enable_nestloop = off;
+set hash_mem_multiplier = 1.0;
+set enable_memory_rebalance = on;
+
+-- With a single memory intensive operator there is nothing to borrow; the
+-- hash join must spill under the small grant and still be right
+set work_mem = '64kB';
+select hash_batches('select count(*) from mg_outer r join mg_inner s using (id)') > 1
+  as spilled;
+select count(*) from mg_outer r join mg_inner s using (id);
+
+-- The hash of mg_tiny leaves most of its budget unused.  Without
+-- rebalancing the mg_inner hash spills once it outgrows work_mem ...
+set work_mem = '384kB';
+set enable_memory_rebalance = off;
+select hash_batches('select count(*) from mg_outer r join mg_inner s using (id)
+  left join mg_tiny t using (id)') > 1 as spilled;
+
+-- ... with rebalancing it borrows that budget and stays in memory
+set enable_memory_rebalance = on;
+select hash_batches('select count(*) from mg_outer r join mg_inner s using (id)
+  left join mg_tiny t using (id)') > 1 as spilled;
+select count(*), count(t.id)
+  from mg_outer r join mg_inner s using (id) left join mg_tiny t using (id);
+reset enable_memory_rebalance;
+reset work_mem;
+reset hash_mem_multiplier;
+reset enable_nestloop;
+reset enable_mergejoin;
+reset max_parallel_workers_per_gather;
+drop table mg_outer;
+drop table mg_inner;
+drop table mg_tiny;
+drop function hash_batches(text);
@@ -0,0 +1,95 @@
+--
+-- Tests for Memoize, which caches the inner side of a parameterized
+-- nested loop
+--
+-- Collect the cache counters from EXPLAIN ANALYZE.  Each datanode keeps a
+-- cache of its own; the coordinator shows the sum over all of them.
+create function memoize_stats(query text,
+    out memoized boolean, out hits bigint, out misses bigint,
+    out evictions bigint)
+language plpgsql as
+$$
+declare
+    ln text;
+    m text[];
+begin
+    memoized := false;
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off) %s',
+                       query)
+    loop
+        if ln ~ 'Memoize' then
+            memoized := true;
+        end if;
+        m := regexp_match(ln, 'Hits: (\d+)  Misses: (\d+)');
+        if m is not null then
+            hits := m[1];
+            misses := m[2];
+        end if;
+        m := regexp_match(ln, 'Evictions: min \d+ max (\d+)');
+        if m is not null then
+            evictions := m[1];
+        end if;
+    end loop;
+end;
+$$;
+
+-- memo_outer has 10 distinct join keys, each repeated 100 times.  The
+-- inner table is replicated so that the join runs on every datanode.
+create table memo_outer (a int, k int);
+insert into memo_outer select i, i % 10 from generate_series(1, 1000) i;
+create table memo_inner (k int, v int, pad text) distribute by replication;
+insert into memo_inner select i % 50, i, repeat('x', 100)
+  from generate_series(1, 1000) i;
+create index memo_inner_k_idx on memo_inner (k);
+analyze memo_outer;
+analyze memo_inner;
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+set enable_material = off;
+set enable_bitmapscan = off;
+
+-- Memoize is off by default
+explain (costs off)
+select t1.a, t2.v from memo_outer t1 join memo_inner t2 on t2.k = t1.k;
+select count(*), sum(t2.v)
+  from memo_outer t1 join memo_inner t2 on t2.k = t1.k;
+set enable_memoize = on;
+explain (costs off)
+select t1.a, t2.v from memo_outer t1 join memo_inner t2 on t2.k = t1.k;
+explain (costs off)
+select t1.a, t2.v from memo_outer t1 left join memo_inner t2 on t2.k = t1.k;
+
+-- Results must match the plain nested loop above
+select count(*), sum(t2.v)
+  from memo_outer t1 join memo_inner t2 on t2.k = t1.k;
+
+-- Every datanode misses once per distinct key and hits for the duplicates
+select * from memoize_stats('select count(*), sum(t2.v)
+  from memo_outer t1 join memo_inner t2 on t2.k = t1.k');
+
+-- With a small hash_mem only part of the 50 keys fit in the cache.  The
+-- outer keys cycle through all of them, so entries must be evicted.
+create table memo_cycle (a int, k int);
+insert into memo_cycle select i, i % 50 from generate_series(1, 2000) i;
+analyze memo_cycle;
+set work_mem = '64kB';
+set hash_mem_multiplier = 1.0;
+select memoized, hits + misses as probes, evictions > 0 as evicted
+  from memoize_stats('select count(*), sum(t2.v)
+    from memo_cycle t1 join memo_inner t2 on t2.k = t1.k');
+select count(*), sum(t2.v)
+  from memo_cycle t1 join memo_inner t2 on t2.k = t1.k;
+reset enable_memoize;
+select count(*), sum(t2.v)
+  from memo_cycle t1 join memo_inner t2 on t2.k = t1.k;
+reset work_mem;
+reset hash_mem_multiplier;
+reset enable_hashjoin;
+reset enable_mergejoin;
+reset enable_material;
+reset enable_bitmapscan;
+drop table memo_outer;
+drop table memo_inner;
+drop table memo_cycle;
+drop function memoize_stats(text);
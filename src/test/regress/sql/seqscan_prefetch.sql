@@ -0,0 +1,34 @@
+--
+-- Sequential scan prefetching
+--
+create table seqpf (a int, b int, c text);
+insert into seqpf select i, i % 100, repeat('x', 200) from generate_series(1, 20000) i;
+set seqscan_prefetch_pages = 16;
+show seqscan_prefetch_pages;
+set enable_indexscan = off;
+set enable_bitmapscan = off;
+select count(*), sum(a), sum(b) from seqpf;
+select count(*) from seqpf where b = 42;
+select md5(string_agg(a::text, ',' order by a)) = md5(string_agg(i::text, ',' order by i)) as matches
+  from seqpf join generate_series(1, 20000) i on a = i;
+
+-- A scan that stops early must still return the right rows
+select a from seqpf where a between 101 and 105 order by a;
+select count(*) from (select a from seqpf where b = 3 limit 10) s;
+
+-- After a delete and vacuum, many pages are half empty
+delete from seqpf where a % 3 = 0;
+vacuum seqpf;
+select count(*), sum(a) from seqpf;
+
+-- Two scans of the same table in one query
+select count(*) from seqpf s1 where exists (select 1 from seqpf s2 where s2.a = s1.a + 1 and s2.b = 0);
+
+-- A larger distance than the table has pages
+set seqscan_prefetch_pages = 1000;
+select count(*), sum(a) from seqpf;
+set seqscan_prefetch_pages = -1;
+reset seqscan_prefetch_pages;
+reset enable_indexscan;
+reset enable_bitmapscan;
+drop table seqpf;
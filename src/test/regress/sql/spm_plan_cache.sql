@@ -0,0 +1,48 @@
+--
+-- SPM shared plan cache
+--
+-- The cache is sized in make_check_postgresql.conf and disabled there for
+-- other sessions, so only the statements of this test use it.
+CREATE TABLE spm_shared (a int, b int) DISTRIBUTE BY HASH(a);
+CREATE TABLE spm_shared_other (a int, c int) DISTRIBUTE BY HASH(a);
+INSERT INTO spm_shared SELECT i, i % 3 FROM generate_series(1, 30) i;
+ANALYZE spm_shared;
+
+SELECT hits AS h0, stores AS s0, invalidations AS i0
+FROM pg_spm_shared_plan_cache_stats() \gset
+
+-- The first execution stores the plan, the next ones reuse it
+SET enable_spm_plan_cache = on;
+SELECT b, count(*), sum(a) FROM spm_shared GROUP BY b ORDER BY b;
+SELECT b, count(*), sum(a) FROM spm_shared GROUP BY b ORDER BY b;
+SELECT b, count(*), sum(a) FROM spm_shared GROUP BY b ORDER BY b;
+SET enable_spm_plan_cache = off;
+SELECT hits - :h0 AS hits, stores - :s0 AS stores
+FROM pg_spm_shared_plan_cache_stats();
+
+-- Another session reuses the plan as well
+\c -
+SET enable_spm_plan_cache = on;
+SELECT b, count(*), sum(a) FROM spm_shared GROUP BY b ORDER BY b;
+SET enable_spm_plan_cache = off;
+SELECT hits - :h0 AS hits, stores - :s0 AS stores
+FROM pg_spm_shared_plan_cache_stats();
+
+-- Changing another relation leaves the plan alone
+ALTER TABLE spm_shared_other ADD COLUMN d int;
+SELECT invalidations - :i0 AS invalidations
+FROM pg_spm_shared_plan_cache_stats();
+
+-- Changing the table drops the plan, the next execution stores a new one
+ALTER TABLE spm_shared ADD COLUMN c int;
+SELECT invalidations - :i0 AS invalidations
+FROM pg_spm_shared_plan_cache_stats();
+SET enable_spm_plan_cache = on;
+SELECT b, count(*), sum(a) FROM spm_shared GROUP BY b ORDER BY b;
+SELECT b, count(*), sum(a) FROM spm_shared GROUP BY b ORDER BY b;
+SET enable_spm_plan_cache = off;
+SELECT hits - :h0 AS hits, stores - :s0 AS stores
+FROM pg_spm_shared_plan_cache_stats();
+
+DROP TABLE spm_shared_other;
+DROP TABLE spm_shared;
@@ -0,0 +1,35 @@
+--
+-- Parallel index vacuuming
+--
+create table pvac (a int, b int, c text);
+insert into pvac select i, i % 1000, repeat('x', 20) from generate_series(1, 20000) i;
+create index pvac_a_idx on pvac (a);
+create index pvac_b_idx on pvac (b);
+
+-- Too small for a worker, so the leader vacuums it while the workers run
+create index pvac_small_idx on pvac (a) where a < 10;
+delete from pvac where a % 2 = 0;
+set max_parallel_maintenance_workers = 2;
+set min_parallel_index_scan_size = '32kB';
+
+-- The cost balance is shared by the workers and the leader
+set vacuum_cost_delay = 1;
+set vacuum_cost_limit = 100;
+vacuum pvac;
+vacuum analyze pvac;
+reset vacuum_cost_delay;
+reset vacuum_cost_limit;
+reset min_parallel_index_scan_size;
+reset max_parallel_maintenance_workers;
+
+-- The indexes must agree with the heap
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select count(*) from pvac where a < 10;
+select count(*) from pvac where a > 19000;
+select count(*) from pvac where b = 7;
+select count(*) from pvac where b = 8;
+reset enable_seqscan;
+reset enable_bitmapscan;
+select count(*) from pvac;
+drop table pvac;
@@ -0,0 +1,81 @@
+# Tests for the apply progress statistics of subscriptions
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 5;
+
+# Initialize publisher node
+my $node_publisher = get_new_node('publisher');
+$node_publisher->init(allows_streaming => 'logical');
+$node_publisher->start;
+
+# Create subscriber node
+my $node_subscriber = get_new_node('subscriber');
+$node_subscriber->init(allows_streaming => 'logical');
+$node_subscriber->start;
+
+$node_publisher->safe_psql('postgres',
+	"CREATE TABLE tab_rep (a int primary key)");
+$node_subscriber->safe_psql('postgres',
+	"CREATE TABLE tab_rep (a int primary key)");
+
+# Setup logical replication
+my $publisher_connstr = $node_publisher->connstr . ' dbname=postgres';
+$node_publisher->safe_psql('postgres',
+	"CREATE PUBLICATION tap_pub FOR ALL TABLES");
+
+my $appname = 'tap_sub';
+$node_subscriber->safe_psql('postgres',
+"CREATE SUBSCRIPTION tap_sub CONNECTION '$publisher_connstr application_name=$appname' PUBLICATION tap_pub"
+);
+
+# The apply worker reports itself as soon as it starts
+$node_subscriber->poll_query_until('postgres',
+"SELECT count(*) = 1 FROM opentenbase_get_all_sub_apply_stat() WHERE subscription_name = 'tap_sub'"
+) or die "Timed out while waiting for the apply worker to report";
+
+# Apply some transactions, one row each
+foreach my $i (1 .. 10)
+{
+	$node_publisher->safe_psql('postgres',
+		"INSERT INTO tab_rep VALUES ($i)");
+}
+
+my $caughtup_query =
+"SELECT pg_current_wal_lsn() <= replay_lsn FROM pg_stat_replication WHERE application_name = '$appname';";
+$node_publisher->poll_query_until('postgres', $caughtup_query)
+  or die "Timed out while waiting for subscriber to catch up";
+
+my $result =
+  $node_subscriber->safe_psql('postgres', "SELECT count(*) FROM tab_rep");
+is($result, qq(10), 'rows replicated');
+
+# The statistics are reported after the changes are processed, so they
+# may trail the data a little
+ok( $node_subscriber->poll_query_until('postgres',
+"SELECT xacts_applied >= 10 FROM opentenbase_get_all_sub_apply_stat() WHERE subscription_name = 'tap_sub'"
+	),
+	'applied transactions are counted');
+
+my $publisher_lsn =
+  $node_publisher->safe_psql('postgres', "SELECT pg_current_wal_lsn()");
+$result = $node_subscriber->safe_psql('postgres',
+"SELECT last_commit_lsn IS NOT NULL AND last_commit_lsn <= '$publisher_lsn'::pg_lsn FROM opentenbase_get_all_sub_apply_stat() WHERE subscription_name = 'tap_sub'"
+);
+is($result, qq(t), 'last commit LSN is within the publisher WAL');
+
+$result = $node_subscriber->safe_psql('postgres',
+"SELECT last_commit_time <= now() AND apply_lag >= '0'::interval FROM opentenbase_get_all_sub_apply_stat() WHERE subscription_name = 'tap_sub'"
+);
+is($result, qq(t), 'commit time and apply lag are reported');
+
+$result = $node_subscriber->safe_psql('postgres',
+"SELECT utilization BETWEEN 0 AND 1 FROM opentenbase_get_all_sub_apply_stat() WHERE subscription_name = 'tap_sub'"
+);
+is($result, qq(t), 'utilization is a fraction');
+
+$node_subscriber->safe_psql('postgres', "DROP SUBSCRIPTION tap_sub");
+
+$node_subscriber->stop('fast');
+$node_publisher->stop('fast');